@@ -0,0 +1,381 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./benchmarks/Benchmark_IO.cc
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// Lattice file I/O bandwidth of a gauge field, for local volumes L^4, L=4..LMAX:
+//  - stages of BinaryIO, separately: munge, checksums, byte swap, and raw
+//    transfer through MPI-IO (lexicographic file) and C++ streams (one block
+//    per rank), in single and double precision;
+//  - complete write and read of binary, NERSC and ILDG (with LIME) files,
+//    reads also through --io-mmap;
+//  - binary files with all the ranks accessing the file and with 1, 2, 4, ...
+//    aggregators (--io-aggregators), the files must be identical.
+// The results are written to a JSON file for regression tracking.
+// Options: --io-file base     (default ./benchmark_io)
+//          --io-json file     (default ./benchmark_io.json)
+//          --io-lmax L        (default 16)
+//          --io-loops n       (default 3)
+//          --io-hints as usual
+
+class IOBenchmarkResult : Serializable {
+ public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(IOBenchmarkResult,
+				  std::string, format,
+				  std::string, precision,
+				  std::string, path,
+				  std::string, operation,
+				  std::vector<int>, local,
+				  int, ranks,
+				  double, bytes,
+				  double, seconds,
+				  double, GBps);
+};
+
+static std::vector<IOBenchmarkResult> results;
+static std::string fileBase("./benchmark_io");
+static int Nloop = 3;
+
+static void report(GridBase *grid, const std::string &format, const std::string &precision,
+		   const std::string &path, const std::string &operation, double bytes, double usec)
+{
+  IOBenchmarkResult r;
+
+  r.format    = format;
+  r.precision = precision;
+  r.path      = path;
+  r.operation = operation;
+  r.local     = grid->LocalDimensions();
+  r.ranks     = grid->ProcessorCount();
+  r.bytes     = bytes;
+  r.seconds   = usec/Nloop*1.0e-6;
+  r.GBps      = bytes*Nloop/usec/1000.;
+  results.push_back(r);
+  // the I/O routines are silenced during the measurements
+  GridLogMessage.Active(1);
+  std::cout<<GridLogMessage<<std::setprecision(3)<<std::left
+	   <<std::setw(6)<<r.local[0]<<std::setw(10)<<format<<std::setw(11)<<precision
+	   <<std::setw(15)<<path<<std::setw(11)<<operation<<std::setw(12)<<r.seconds<<r.GBps<<std::endl;
+  GridLogMessage.Active(0);
+}
+
+static void truncate(GridBase *grid, const std::string &file)
+{
+  if (grid->IsBoss()) std::ofstream(file, std::ios::out);
+  grid->Barrier();
+}
+
+static bool sameFile(const std::string &a, const std::string &b)
+{
+  std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+  std::string   sa((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+  std::string   sb((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+
+  return (sa.size() > 0) && (sa == sb);
+}
+
+// munge, checksum, byte swap and raw transfer timings of fobj files
+template<class fobj>
+void stages(LatticeGaugeField &Umu, const std::string &format)
+{
+  typedef LatticeGaugeField::vector_object::scalar_object sobj;
+  typedef typename getPrecision<fobj>::real_scalar_type word;
+
+  GridBase *grid = Umu._grid;
+  uint64_t lsites = grid->lSites();
+  double   bytes = sizeof(fobj)*(double)grid->gSites();
+  std::string file = fileBase + ".raw";
+  std::vector<sobj> scalardata(lsites);
+  std::vector<fobj> iodata(lsites);
+  GaugeSimpleUnmunger<fobj,sobj> munge;
+  uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+  word w = 0;
+  double t;
+
+  unvectorizeToLexOrdArray(scalardata,Umu);
+
+  t = -usecond();
+  for(int i=0;i<Nloop;i++) parallel_for(uint64_t x=0;x<lsites;x++) munge(scalardata[x],iodata[x]);
+  t += usecond();
+  report(grid,"binary",format,"memory","munge",bytes,t);
+
+  t = -usecond();
+  for(int i=0;i<Nloop;i++){
+    BinaryIO::NerscChecksum(grid,iodata,nersc_csum);
+    BinaryIO::ScidacChecksum(grid,iodata,scidac_csuma,scidac_csumb);
+  }
+  t += usecond();
+  report(grid,"binary",format,"memory","checksum",bytes,t);
+
+  t = -usecond();
+  for(int i=0;i<Nloop;i++){
+    if (format == "IEEE32BIG") BinaryIO::htobe32_v((void *)&iodata[0],sizeof(fobj)*lsites);
+    else                       BinaryIO::htobe64_v((void *)&iodata[0],sizeof(fobj)*lsites);
+  }
+  t += usecond();
+  report(grid,"binary",format,"memory","byteswap",bytes,t);
+
+  t = -usecond();
+  for(int i=0;i<Nloop;i++){
+    BinaryIO::mungeChecksumWrite(grid,scalardata,iodata,munge,format,nersc_csum,scidac_csuma,scidac_csumb);
+  }
+  t += usecond();
+  report(grid,"binary",format,"memory","fused",bytes,t);
+
+  // lexicographic file through MPI-IO with several ranks, else C++ streams
+  std::vector<std::pair<std::string,int> > paths;
+  int prepared = BinaryIO::BINARYIO_PREPARED;
+
+  if (grid->ProcessorCount() > 1) {
+    paths.push_back(std::make_pair(std::string("mpiio"),prepared|BinaryIO::BINARYIO_LEXICOGRAPHIC));
+  }
+  paths.push_back(std::make_pair(std::string("stream"),prepared));
+  for(auto &p: paths){
+    t = 0.;
+    for(int i=0;i<Nloop;i++){
+      truncate(grid,file);
+      t -= usecond();
+      BinaryIO::IOobject(w,grid,iodata,file,0,format,p.second|BinaryIO::BINARYIO_WRITE,
+			 nersc_csum,scidac_csuma,scidac_csumb);
+      t += usecond();
+    }
+    report(grid,"binary",format,p.first,"transfer_w",bytes,t);
+    t = -usecond();
+    for(int i=0;i<Nloop;i++){
+      BinaryIO::IOobject(w,grid,iodata,file,0,format,p.second|BinaryIO::BINARYIO_READ,
+			 nersc_csum,scidac_csuma,scidac_csumb);
+    }
+    t += usecond();
+    report(grid,"binary",format,p.first,"transfer_r",bytes,t);
+  }
+  if (grid->IsBoss()) std::remove(file.c_str());
+}
+
+// complete binary file write and read, through MPI-IO/streams and mmap
+template<class fobj>
+void binary(LatticeGaugeField &Umu, const std::string &format)
+{
+  typedef LatticeGaugeField::vector_object vobj;
+  typedef vobj::scalar_object sobj;
+
+  GridBase *grid = Umu._grid;
+  double   bytes = sizeof(fobj)*(double)grid->gSites();
+  std::string file = fileBase + ".bin";
+  std::string path = (grid->ProcessorCount() > 1) ? "mpiio" : "stream";
+  LatticeGaugeField Umu_read(grid);
+  GaugeSimpleUnmunger<fobj,sobj> unmunge;
+  GaugeSimpleMunger<fobj,sobj>   munge;
+  uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+  double t = 0.;
+
+  for(int i=0;i<Nloop;i++){
+    truncate(grid,file);
+    t -= usecond();
+    BinaryIO::writeLatticeObject<vobj,fobj>(Umu,file,unmunge,0,format,nersc_csum,scidac_csuma,scidac_csumb);
+    t += usecond();
+  }
+  report(grid,"binary",format,path,"write",bytes,t);
+  for(auto mmap: {false, true}){
+    bool saved = BinaryIO::mmapRead();
+
+    BinaryIO::mmapRead() = mmap;
+    t = -usecond();
+    for(int i=0;i<Nloop;i++){
+      BinaryIO::readLatticeObject<vobj,fobj>(Umu_read,file,munge,0,format,nersc_csum,scidac_csuma,scidac_csumb);
+    }
+    t += usecond();
+    BinaryIO::mmapRead() = saved;
+    report(grid,"binary",format,mmap ? "mmap" : path,"read",bytes,t);
+    Umu_read = Umu_read - Umu;
+    assert(norm2(Umu_read) <= 1.0e-12*norm2(Umu));
+  }
+  if (grid->IsBoss()) std::remove(file.c_str());
+}
+
+// NERSC (3x3 double) and ILDG configuration files
+void configurations(LatticeGaugeField &Umu)
+{
+  GridBase *grid = Umu._grid;
+  std::string path = (grid->ProcessorCount() > 1) ? "mpiio" : "stream";
+  double t;
+
+  {
+    std::string file = fileBase + ".nersc";
+    double bytes = sizeof(LorentzColourMatrixD)*(double)grid->gSites();
+    LatticeGaugeField Umu_read(grid);
+    FieldMetaData header;
+
+    t = -usecond();
+    for(int i=0;i<Nloop;i++) NerscIO::writeConfiguration(Umu,file,0,0);
+    t += usecond();
+    report(grid,"nersc","IEEE64BIG",path,"write",bytes,t);
+    t = -usecond();
+    for(int i=0;i<Nloop;i++) NerscIO::readConfiguration(Umu_read,header,file);
+    t += usecond();
+    report(grid,"nersc","IEEE64BIG",path,"read",bytes,t);
+    if (grid->IsBoss()) std::remove(file.c_str());
+  }
+#ifdef HAVE_LIME
+  {
+    std::string file = fileBase + ".ildg";
+    double bytes = sizeof(LorentzColourMatrixD)*(double)grid->gSites();
+    LatticeGaugeField Umu_read(grid);
+    FieldMetaData header;
+
+    t = -usecond();
+    for(int i=0;i<Nloop;i++){
+      IldgWriter writer;
+
+      writer.open(file);
+      writer.writeConfiguration(Umu,0,std::string("benchmark_io_LFN"),std::string("benchmark_io"));
+      writer.close();
+    }
+    t += usecond();
+    report(grid,"ildg","IEEE64BIG",path,"write",bytes,t);
+    t = -usecond();
+    for(int i=0;i<Nloop;i++){
+      IldgReader reader;
+
+      reader.open(file);
+      reader.readConfiguration(Umu_read,header);
+      reader.close();
+    }
+    t += usecond();
+    report(grid,"ildg","IEEE64BIG",path,"read",bytes,t);
+    if (grid->IsBoss()) std::remove(file.c_str());
+  }
+#endif
+}
+
+// binary files through 1, 2, 4, ... aggregators, identical to the reference
+void aggregators(LatticeGaugeField &Umu)
+{
+  typedef LatticeGaugeField::vector_object vobj;
+  typedef vobj::scalar_object sobj;
+  typedef sobj::DoublePrecision sobj_double;
+
+  GridBase *grid = Umu._grid;
+  int      nrank = grid->ProcessorCount();
+  double   bytes = sizeof(sobj_double)*(double)grid->gSites();
+  int      saved = BinaryIO::ioParameters().aggregators;
+  std::string file = fileBase + ".agg", ref = fileBase + ".bin";
+  LatticeGaugeField Umu_read(grid);
+  BinarySimpleUnmunger<sobj_double, sobj> unmunge;
+  BinarySimpleMunger<sobj_double, sobj>   munge;
+  uint32_t nersc_ref, csuma_ref, csumb_ref;
+  uint32_t nersc, csuma, csumb;
+
+  truncate(grid,ref);
+  BinaryIO::ioParameters().aggregators = 0;
+  BinaryIO::writeLatticeObject<vobj,sobj_double>(Umu,ref,unmunge,0,"IEEE64BIG",nersc_ref,csuma_ref,csumb_ref);
+  for(int nagg=1;nagg<nrank;nagg*=2){
+    double twrite = 0., tread;
+
+    BinaryIO::ioParameters().aggregators = nagg;
+    for(int i=0;i<Nloop;i++){
+      truncate(grid,file);
+      twrite -= usecond();
+      BinaryIO::writeLatticeObject<vobj,sobj_double>(Umu,file,unmunge,0,"IEEE64BIG",nersc,csuma,csumb);
+      twrite += usecond();
+    }
+    tread = -usecond();
+    for(int i=0;i<Nloop;i++){
+      BinaryIO::readLatticeObject<vobj,sobj_double>(Umu_read,file,munge,0,"IEEE64BIG",nersc,csuma,csumb);
+    }
+    tread += usecond();
+    assert(nersc == nersc_ref);
+    assert(csuma == csuma_ref);
+    assert(csumb == csumb_ref);
+    if (grid->IsBoss()) assert(sameFile(ref, file));
+    Umu_read = Umu_read - Umu;
+    assert(norm2(Umu_read) == 0.);
+    report(grid,"binary","IEEE64BIG","aggregators:"+std::to_string(nagg),"write",bytes,twrite);
+    report(grid,"binary","IEEE64BIG","aggregators:"+std::to_string(nagg),"read",bytes,tread);
+  }
+  BinaryIO::ioParameters().aggregators = saved;
+  if (grid->IsBoss()) {
+    std::remove(file.c_str());
+    std::remove(ref.c_str());
+  }
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  std::vector<int> simd_layout = GridDefaultSimd(Nd,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+  std::string      json("./benchmark_io.json");
+  int              LMAX = 16;
+
+  if( GridCmdOptionExists(argv,argv+argc,"--io-file") ){
+    fileBase = GridCmdOptionPayload(argv,argv+argc,"--io-file");
+  }
+  if( GridCmdOptionExists(argv,argv+argc,"--io-json") ){
+    json = GridCmdOptionPayload(argv,argv+argc,"--io-json");
+  }
+  if( GridCmdOptionExists(argv,argv+argc,"--io-lmax") ){
+    LMAX = std::stoi(GridCmdOptionPayload(argv,argv+argc,"--io-lmax"));
+  }
+  if( GridCmdOptionExists(argv,argv+argc,"--io-loops") ){
+    Nloop = std::stoi(GridCmdOptionPayload(argv,argv+argc,"--io-loops"));
+  }
+
+  std::cout<<GridLogMessage << "===================================================================================================="<<std::endl;
+  std::cout<<GridLogMessage << "= Benchmarking lattice file I/O, MPI-IO hints '"<<BinaryIO::ioParameters().hints<<"'"<<std::endl;
+  std::cout<<GridLogMessage << "===================================================================================================="<<std::endl;
+  std::cout<<GridLogMessage << "L     format    precision  path           operation  seconds     GB/s"<<std::endl;
+  std::cout<<GridLogMessage << "----------------------------------------------------------------------------------"<<std::endl;
+
+  for(int lat=4;lat<=LMAX;lat*=2){
+    std::vector<int> latt_size  ({lat*mpi_layout[0],lat*mpi_layout[1],lat*mpi_layout[2],lat*mpi_layout[3]});
+    GridCartesian     Grid(latt_size,simd_layout,mpi_layout);
+    GridParallelRNG   pRNG(&Grid);      pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+    LatticeGaugeField Umu(&Grid);
+
+    SU3::HotConfiguration(pRNG,Umu);
+    GridLogMessage.Active(0);
+    stages<LorentzColourMatrixF>(Umu,"IEEE32BIG");
+    stages<LorentzColourMatrixD>(Umu,"IEEE64BIG");
+    binary<LorentzColourMatrixF>(Umu,"IEEE32BIG");
+    binary<LorentzColourMatrixD>(Umu,"IEEE64BIG");
+    configurations(Umu);
+    aggregators(Umu);
+    GridLogMessage.Active(1);
+  }
+
+  if (CartesianCommunicator::RankWorld() == 0) {
+    JSONWriter writer(json);
+
+    write(writer,"benchmark_io",results);
+  }
+  std::cout<<GridLogMessage << "Results written to "<<json<<std::endl;
+
+  Grid_finalize();
+}
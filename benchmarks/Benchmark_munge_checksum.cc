@@ -0,0 +1,147 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid 
+
+    Source file: ./benchmarks/Benchmark_munge_checksum.cc
+
+    Copyright (C) 2015
+
+Author: Peter Boyle <paboyle@ph.ed.ac.uk>
+Author: Peter Boyle <peterboyle@Peters-MacBook-Pro-2.local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// Lattice write preparation: munge, byte order and checksums as separate
+// passes with zlib crc32 (reference), against the fused single pass of
+// BinaryIO::mungeChecksumWrite.
+
+template<class fobj>
+void zlibScidacChecksum(GridBase *grid,std::vector<fobj> &fbuf,uint32_t &scidac_csuma,uint32_t &scidac_csumb)
+{
+  int nd = grid->_ndimension;
+  uint64_t lsites = grid->lSites();
+  std::vector<int> local_vol   =grid->LocalDimensions();
+  std::vector<int> local_start =grid->LocalStarts();
+  std::vector<int> global_vol  =grid->FullDimensions();
+
+  scidac_csuma = 0;
+  scidac_csumb = 0;
+#pragma omp parallel
+  { 
+    std::vector<int> coor(nd);
+    uint32_t csuma=0, csumb=0;
+
+#pragma omp for
+    for(uint64_t local_site=0;local_site<lsites;local_site++){
+      int global_site;
+
+      Lexicographic::CoorFromIndex(coor,local_site,local_vol);
+      for(int d=0;d<nd;d++) coor[d] = coor[d]+local_start[d];
+      Lexicographic::IndexFromCoor(coor,global_site,global_vol);
+
+      uint32_t site_crc = crc32(0,(unsigned char *)&fbuf[local_site],sizeof(fobj));
+      csuma ^= BinaryIO::crc32Rotate(site_crc,global_site%29);
+      csumb ^= BinaryIO::crc32Rotate(site_crc,global_site%31);
+    }
+#pragma omp critical
+    {
+      scidac_csuma ^= csuma;
+      scidac_csumb ^= csumb;
+    }
+  }
+}
+
+template<class fobj,class munger>
+void benchmark(const std::string &name,munger munge,int LMAX,int Nloop)
+{
+  typedef LatticeGaugeField::vector_object::scalar_object sobj;
+
+  std::vector<int> simd_layout = GridDefaultSimd(Nd,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+
+  std::cout<<GridLogMessage << "===================================================================================================="<<std::endl;
+  std::cout<<GridLogMessage << "= Benchmarking write munge + checksums, "<<name<<", IEEE64BIG"<<std::endl;
+  std::cout<<GridLogMessage << "===================================================================================================="<<std::endl;
+  std::cout<<GridLogMessage << "  L  "<<"\t\t"<<"bytes"<<"\t\t\t"<<"separate GB/s\t fused GB/s\t speedup"<<std::endl;
+  std::cout<<GridLogMessage << "----------------------------------------------------------"<<std::endl;
+
+  for(int lat=4;lat<=LMAX;lat+=4){
+
+    std::vector<int> latt_size  ({lat*mpi_layout[0],lat*mpi_layout[1],lat*mpi_layout[2],lat*mpi_layout[3]});
+    GridCartesian     Grid(latt_size,simd_layout,mpi_layout);
+    GridParallelRNG   pRNG(&Grid);      pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+
+    LatticeGaugeField Umu(&Grid); SU3::HotConfiguration(pRNG,Umu);
+    uint64_t lsites = Grid.lSites();
+    std::vector<sobj> scalardata(lsites);
+    std::vector<fobj> iodata(lsites);
+    uint32_t nersc_ref, csuma_ref, csumb_ref;
+    uint32_t nersc, csuma, csumb;
+
+    unvectorizeToLexOrdArray(scalardata,Umu);
+
+    double start=usecond();
+    for(int i=0;i<Nloop;i++){
+      nersc_ref = 0;
+      parallel_for(uint64_t x=0;x<lsites;x++) munge(scalardata[x],iodata[x]);
+      BinaryIO::NerscChecksum(&Grid,iodata,nersc_ref);
+      BinaryIO::htobe64_v((void *)&iodata[0],sizeof(fobj)*iodata.size());
+      zlibScidacChecksum(&Grid,iodata,csuma_ref,csumb_ref);
+    }
+    double stop=usecond();
+    double tref = (stop-start)/Nloop*1000.0;
+
+    start=usecond();
+    for(int i=0;i<Nloop;i++){
+      BinaryIO::mungeChecksumWrite(&Grid,scalardata,iodata,munge,"IEEE64BIG",nersc,csuma,csumb);
+    }
+    stop=usecond();
+    double tfused = (stop-start)/Nloop*1000.0;
+
+    assert(nersc == nersc_ref);
+    assert(csuma == csuma_ref);
+    assert(csumb == csumb_ref);
+
+    double bytes=(sizeof(sobj)+sizeof(fobj))*(double)lsites;
+    std::cout<<GridLogMessage<<std::setprecision(3) << lat<<"\t\t"<<bytes<<"    \t\t"
+	     <<bytes/tref<<"\t\t"<<bytes/tfused<<"\t\t"<<tref/tfused<<std::endl;
+  }
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  typedef LatticeGaugeField::vector_object::scalar_object sobj;
+  int LMAX  = 24;
+  int Nloop = 10;
+
+  int64_t threads = GridThread::GetThreads();
+  std::cout<<GridLogMessage << "Grid is setup to use "<<threads<<" threads"<<std::endl;
+
+  benchmark<LorentzColourMatrixD>("3x3",GaugeSimpleUnmunger<LorentzColourMatrixD,sobj>(),LMAX,Nloop);
+  benchmark<LorentzColour2x3D>("3x2",Gauge3x2unmunger<LorentzColour2x3D,sobj>(),LMAX,Nloop);
+
+  Grid_finalize();
+}
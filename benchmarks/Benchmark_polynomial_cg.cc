@@ -0,0 +1,145 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./benchmarks/Benchmark_polynomial_cg.cc
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+////////////////////////////////////////////////////////////////////////
+// Time to solution of plain CG against polynomial preconditioned CG on
+// the DWF Schur operator, sweeping the local volume. Small local volumes
+// are where the global sums of CG dominate and the polynomial pays off.
+//
+//   LMIN, LMAX  local extent range (default 4..8, doubling)
+//   MASS        fermion mass (default 0.01)
+////////////////////////////////////////////////////////////////////////
+template<class Solver>
+void bench(const std::string &name,Solver &CG,LinearOperatorBase<LatticeFermion> &HermOp,
+	   LatticeFermion &src,LatticeFermion &sol,int &iters,double &t)
+{
+  sol = zero;
+  double t0=usecond();
+  CG(HermOp,src,sol);
+  double t1=usecond();
+  t = (t1-t0)/1.0e6;
+  iters = CG.IterationsToComplete;
+  std::cout << GridLogMessage << name << " done in "<< t << " s"<<std::endl;
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  const int Ls=8;
+  RealD M5   = 1.8;
+  RealD mass = 0.01;
+  RealD tol  = 1.0e-8;
+  int Lmin=4;
+  int Lmax=8;
+  if ( getenv("LMIN") ) Lmin=atoi(getenv("LMIN"));
+  if ( getenv("LMAX") ) Lmax=atoi(getenv("LMAX"));
+  if ( getenv("MASS") ) mass=atof(getenv("MASS"));
+
+  std::vector<int> degrees({4,8,16});
+
+  std::vector<std::string> table;
+
+  for(int L=Lmin;L<=Lmax;L*=2){
+
+    std::vector<int> mpi   = GridDefaultMpi();
+    std::vector<int> latt4(Nd);
+    for(int d=0;d<Nd;d++) latt4[d] = L*mpi[d];
+
+    GridCartesian         * UGrid   = SpaceTimeGrid::makeFourDimGrid(latt4, GridDefaultSimd(Nd,vComplex::Nsimd()),mpi);
+    GridRedBlackCartesian * UrbGrid = SpaceTimeGrid::makeFourDimRedBlackGrid(UGrid);
+    GridCartesian         * FGrid   = SpaceTimeGrid::makeFiveDimGrid(Ls,UGrid);
+    GridRedBlackCartesian * FrbGrid = SpaceTimeGrid::makeFiveDimRedBlackGrid(Ls,UGrid);
+
+    // lattices go out of scope before their grids are deleted
+    {
+      std::vector<int> seeds4({1,2,3,4});
+      std::vector<int> seeds5({5,6,7,8});
+      GridParallelRNG RNG4(UGrid); RNG4.SeedFixedIntegers(seeds4);
+      GridParallelRNG RNG5(FGrid); RNG5.SeedFixedIntegers(seeds5);
+
+      LatticeGaugeField Umu(UGrid);
+      SU3::HotConfiguration(RNG4,Umu);
+
+      LatticeFermion src(FGrid); random(RNG5,src);
+      LatticeFermion src_o(FrbGrid);
+      LatticeFermion sol_o(FrbGrid);
+      pickCheckerboard(Odd,src_o,src);
+
+      DomainWallFermionR Ddwf(Umu,*FGrid,*FrbGrid,*UGrid,*UrbGrid,mass,M5);
+      SchurDiagMooeeOperator<DomainWallFermionR,LatticeFermion> HermOpEO(Ddwf);
+
+      std::cout << GridLogMessage << "===================================================================="<<std::endl;
+      std::cout << GridLogMessage << " Local volume "<< L <<"^4 x "<< Ls <<" global "<< latt4 <<std::endl;
+      std::cout << GridLogMessage << "===================================================================="<<std::endl;
+
+      int iters;
+      double t;
+      std::stringstream ss;
+
+      {
+        ConjugateGradient<LatticeFermion> CG(tol,100000);
+        bench("ConjugateGradient",CG,HermOpEO,src_o,sol_o,iters,t);
+        ss.str("");
+        ss << L <<"^4\tCG\t\t"<< iters <<"\t"<< iters+2 <<"\t"<< 2*iters+3 <<"\t"<< t;
+        table.push_back(ss.str());
+      }
+      for(int i=0;i<degrees.size();i++){
+        for(int type=0;type<2;type++){
+	  PolynomialPreconditionerType ptype = type ? PolynomialLeastSquares : PolynomialChebyshev;
+	  PolynomialPreconditionedConjugateGradient<LatticeFermion> PCG(tol,100000,degrees[i],ptype);
+	  bench("PolynomialPreconditionedConjugateGradient",PCG,HermOpEO,src_o,sol_o,iters,t);
+	  ss.str("");
+	  ss << L <<"^4\tPCG-"<< (type ? "LS":"Cheb") <<"("<<degrees[i]<<")\t"
+	     << iters <<"\t"<< PCG.MatVecs <<"\t"<< PCG.Reductions <<"\t"<< t;
+	  table.push_back(ss.str());
+        }
+      }
+    }
+
+    delete FrbGrid;
+    delete FGrid;
+    delete UrbGrid;
+    delete UGrid;
+  }
+
+  std::cout << GridLogMessage << "===================================================================="<<std::endl;
+  std::cout << GridLogMessage << "Local\tSolver\t\titers\tmatvecs\treductions\ttime (s)"<<std::endl;
+  std::cout << GridLogMessage << "===================================================================="<<std::endl;
+  for(int i=0;i<table.size();i++){
+    std::cout << GridLogMessage << table[i] << std::endl;
+  }
+  std::cout << GridLogMessage << "===================================================================="<<std::endl;
+  std::cout << GridLogMessage << "Reductions count the solvers' own global sums; the operator adds two per"<<std::endl;
+  std::cout << GridLogMessage << "matvec for the norms returned by Mpc and MpcDag."<<std::endl;
+
+  Grid_finalize();
+}
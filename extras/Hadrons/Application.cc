@@ -71,7 +71,16 @@ Application::Application(const std::string parameterFileName)
 void Application::setPar(const Application::GlobalPar &par)
 {
     par_ = par;
+    if (!par_.split.mpi.empty())
+    {
+        env().createSplitGrids(strToVec<int>(par_.split.mpi));
+    }
     env().setSeed(strToVec<int>(par_.seed));
+    vm().setMemoryBudget(static_cast<VirtualMachine::Size>(
+        par_.spill.memoryBudget*1024.*1024.));
+    env().setSpillDirectory(par_.spill.directory);
+    vm().setProfileOutput(par_.profile.output);
+    vm().setCheckpointPar(par_.checkpoint);
 }
 
 const Application::GlobalPar & Application::getPar(void)
@@ -157,7 +166,19 @@ void Application::schedule(void)
 {
     if (!scheduled_ and !loadedSchedule_)
     {
-        program_   = vm().schedule(par_.genetic);
+        // genetic scheduler by default, the list one is opt-in
+        if (par_.scheduler.empty() or (par_.scheduler == "genetic"))
+        {
+            program_ = vm().schedule(par_.genetic);
+        }
+        else if (par_.scheduler == "list")
+        {
+            program_ = vm().schedule(par_.list);
+        }
+        else
+        {
+            HADRON_ERROR(Argument, "unknown scheduler '" + par_.scheduler + "'");
+        }
         scheduled_ = true;
     }
 }
@@ -53,9 +53,15 @@ public:
     {
     public:
         GRID_SERIALIZABLE_CLASS_MEMBERS(GlobalPar,
-                                        TrajRange,                  trajCounter,
-                                        VirtualMachine::GeneticPar, genetic,
-                                        std::string,                seed);
+                                        TrajRange,                     trajCounter,
+                                        std::string,                   scheduler,
+                                        VirtualMachine::GeneticPar,    genetic,
+                                        VirtualMachine::ListPar,       list,
+                                        VirtualMachine::SpillPar,      spill,
+                                        VirtualMachine::SplitPar,      split,
+                                        VirtualMachine::ProfilePar,    profile,
+                                        VirtualMachine::CheckpointPar, checkpoint,
+                                        std::string,                   seed);
     };
 public:
     // constructors
@@ -61,12 +61,15 @@ Environment::Environment(void)
 // grids ///////////////////////////////////////////////////////////////////////
 void Environment::createGrid(const unsigned int Ls)
 {
-    if (grid5d_.find(Ls) == grid5d_.end())
+    auto &grid5d   = split_ ? splitGrid5d_ : grid5d_;
+    auto &gridRb5d = split_ ? splitGridRb5d_ : gridRb5d_;
+
+    if (grid5d.find(Ls) == grid5d.end())
     {
         auto g = getGrid();
         
-        grid5d_[Ls].reset(SpaceTimeGrid::makeFiveDimGrid(Ls, g));
-        gridRb5d_[Ls].reset(SpaceTimeGrid::makeFiveDimRedBlackGrid(Ls, g));
+        grid5d[Ls].reset(SpaceTimeGrid::makeFiveDimGrid(Ls, g));
+        gridRb5d[Ls].reset(SpaceTimeGrid::makeFiveDimRedBlackGrid(Ls, g));
     }
 }
 
@@ -76,11 +79,11 @@ GridCartesian * Environment::getGrid(const unsigned int Ls) const
     {
         if (Ls == 1)
         {
-            return grid4d_.get();
+            return split_ ? splitGrid4d_.get() : grid4d_.get();
         }
         else
         {
-            return grid5d_.at(Ls).get();
+            return (split_ ? splitGrid5d_ : grid5d_).at(Ls).get();
         }
     }
     catch(std::out_of_range &)
@@ -95,11 +98,11 @@ GridRedBlackCartesian * Environment::getRbGrid(const unsigned int Ls) const
     {
         if (Ls == 1)
         {
-            return gridRb4d_.get();
+            return split_ ? splitGridRb4d_.get() : gridRb4d_.get();
         }
         else
         {
-            return gridRb5d_.at(Ls).get();
+            return (split_ ? splitGridRb5d_ : gridRb5d_).at(Ls).get();
         }
     }
     catch(std::out_of_range &)
@@ -125,7 +128,7 @@ int Environment::getDim(const unsigned int mu) const
 
 unsigned long int Environment::getLocalVolume(void) const
 {
-    return locVol_;
+    return split_ ? splitLocVol_ : locVol_;
 }
 
 // random number generator /////////////////////////////////////////////////////
@@ -136,6 +139,11 @@ void Environment::setSeed(const std::vector<int> &seed)
 
 GridParallelRNG * Environment::get4dRng(void) const
 {
+    if (split_)
+    {
+        HADRON_ERROR(Definition, "random number generator used on a split grid");
+    }
+
     return rng4d_.get();
 }
 
@@ -337,7 +345,10 @@ Environment::Size Environment::getTotalSize(void) const
     
     for (auto &o: object_)
     {
-        size += o.size;
+        if (!o.spilled)
+        {
+            size += o.size;
+        }
     }
     
     return size;
@@ -350,6 +361,11 @@ void Environment::freeObject(const unsigned int address)
         LOG(Message) << "Destroying object '" << object_[address].name
                      << "'" << std::endl;
     }
+    if (object_[address].spilled)
+    {
+        std::remove(spillFileName(address).c_str());
+        object_[address].spilled = false;
+    }
     object_[address].size = 0;
     object_[address].type = nullptr;
     object_[address].data.reset(nullptr);
@@ -378,6 +394,461 @@ bool Environment::objectsProtected(void) const
     return protect_;
 }
 
+// disk spilling ///////////////////////////////////////////////////////////////
+void Environment::setSpillDirectory(const std::string dir)
+{
+    spillDir_ = dir;
+}
+
+std::string Environment::getSpillDirectory(void) const
+{
+    return spillDir_;
+}
+
+std::string Environment::spillFileName(const unsigned int address) const
+{
+    return spillDir_ + "/" + object_[address].name + ".spill."
+           + std::to_string(getGrid()->ThisRank()) + ".bin";
+}
+
+bool Environment::isObjectSpillable(const unsigned int address) const
+{
+    if (hasCreatedObject(address))
+    {
+        return (object_[address].storage == Storage::object) and
+               object_[address].data->isSpillable();
+    }
+    else
+    {
+        return false;
+    }
+}
+
+bool Environment::isObjectSpilled(const unsigned int address) const
+{
+    if (hasObject(address))
+    {
+        return object_[address].spilled;
+    }
+    else
+    {
+        ERROR_NO_ADDRESS(address);
+    }
+}
+
+void Environment::spillObject(const unsigned int address)
+{
+    if (!isObjectSpillable(address))
+    {
+        HADRON_ERROR(Definition, "object '" + getObjectName(address)
+                     + "' cannot be spilled");
+    }
+    if (!object_[address].spilled)
+    {
+        GridStopWatch timer;
+        std::string   filename = spillFileName(address);
+        std::ofstream file(filename, std::ios::binary|std::ios::trunc);
+        
+        timer.Start();
+        if (!file.good())
+        {
+            HADRON_ERROR(Io, "cannot open spill file '" + filename + "'");
+        }
+        object_[address].data->write(file);
+        file.close();
+        if (file.fail())
+        {
+            HADRON_ERROR(Io, "cannot write spill file '" + filename + "'");
+        }
+        object_[address].data->release();
+        object_[address].spilled = true;
+        timer.Stop();
+        spillStats_.spilled   += object_[address].size;
+        spillStats_.nSpill    += 1;
+        spillStats_.spillTime += timer.useconds()*1.0e-6;
+        LOG(Message) << "Spilled object '" << object_[address].name << "' ("
+                     << sizeString(object_[address].size) << ") to disk in "
+                     << timer.Elapsed() << std::endl;
+    }
+}
+
+// reloading is split so that the read can overlap with module execution:
+// prepareReload allocates (not thread safe), readSpilled only does file I/O
+// into the allocated memory and finishReload does the bookkeeping
+void Environment::prepareReload(const unsigned int address)
+{
+    if (isObjectSpilled(address))
+    {
+        object_[address].data->allocate();
+    }
+}
+
+void Environment::readSpilled(const unsigned int address)
+{
+    std::string   filename = spillFileName(address);
+    std::ifstream file(filename, std::ios::binary);
+    
+    if (!file.good())
+    {
+        HADRON_ERROR(Io, "cannot open spill file '" + filename + "'");
+    }
+    object_[address].data->read(file);
+    if (file.fail())
+    {
+        HADRON_ERROR(Io, "cannot read spill file '" + filename + "'");
+    }
+}
+
+void Environment::finishReload(const unsigned int address, const double time)
+{
+    std::remove(spillFileName(address).c_str());
+    object_[address].spilled = false;
+    spillStats_.reloaded   += object_[address].size;
+    spillStats_.nReload    += 1;
+    spillStats_.reloadTime += time;
+}
+
+void Environment::reloadObject(const unsigned int address)
+{
+    if (isObjectSpilled(address))
+    {
+        GridStopWatch timer;
+        
+        timer.Start();
+        prepareReload(address);
+        readSpilled(address);
+        timer.Stop();
+        finishReload(address, timer.useconds()*1.0e-6);
+        LOG(Message) << "Reloaded object '" << object_[address].name << "' ("
+                     << sizeString(object_[address].size) << ") from disk in "
+                     << timer.Elapsed() << std::endl;
+    }
+}
+
+const Environment::SpillStats & Environment::getSpillStats(void) const
+{
+    return spillStats_;
+}
+
+// checkpointing ///////////////////////////////////////////////////////////////
+bool Environment::isObjectCheckpointable(const unsigned int address) const
+{
+    if (hasCreatedObject(address))
+    {
+        return (object_[address].storage != Storage::temporary) and
+               !object_[address].spilled and
+               object_[address].data->isCheckpointable();
+    }
+    else
+    {
+        return false;
+    }
+}
+
+void Environment::checkpointObject(const unsigned int address,
+                                   const std::string filename,
+                                   std::vector<uint32_t> &checksum)
+{
+    if (!isObjectCheckpointable(address))
+    {
+        HADRON_ERROR(Definition, "object '" + getObjectName(address)
+                     + "' cannot be checkpointed");
+    }
+    // the binary writer updates an existing file in place
+    if (grid4d_->IsBoss())
+    {
+        std::ofstream file(filename, std::ios::out | std::ios::trunc);
+
+        if (!file.good())
+        {
+            HADRON_ERROR(Io, "cannot open checkpoint file '" + filename + "'");
+        }
+    }
+    grid4d_->Barrier();
+    object_[address].data->checkpoint(filename, checksum);
+}
+
+bool Environment::restoreObject(const unsigned int address,
+                                const std::string filename,
+                                const std::vector<uint32_t> &checksum)
+{
+    if (!isObjectCheckpointable(address))
+    {
+        HADRON_ERROR(Definition, "object '" + getObjectName(address)
+                     + "' cannot be restored");
+    }
+    
+    return object_[address].data->restore(filename, checksum);
+}
+
+// the state of the generators is written with BinaryIO::writeRNG, the
+// distributions are not part of it (as in the Grid RNG files)
+void Environment::checkpointRng(const std::string filename,
+                                std::vector<uint32_t> &checksum)
+{
+    GridSerialRNG sRng;
+    uint32_t      nersc, scidacA, scidacB;
+
+    if (grid4d_->IsBoss())
+    {
+        std::ofstream file(filename, std::ios::out | std::ios::trunc);
+
+        if (!file.good())
+        {
+            HADRON_ERROR(Io, "cannot open checkpoint file '" + filename + "'");
+        }
+    }
+    grid4d_->Barrier();
+    BinaryIO::writeRNG(sRng, *rng4d_, filename, 0, nersc, scidacA, scidacB);
+    checksum = {nersc, scidacA, scidacB};
+}
+
+// the state is read in a separate generator, the current one is only
+// replaced if the checksums match
+bool Environment::restoreRng(const std::string filename,
+                             const std::vector<uint32_t> &checksum)
+{
+    typedef GridSerialRNG::RngStateType State;
+
+    GridSerialRNG   sRng;
+    GridParallelRNG pRng(grid4d_.get());
+    uint32_t        nersc, scidacA, scidacB;
+    uint64_t        size = (grid4d_->gSites() + 1)*GridSerialRNG::RngStateCount
+                           *sizeof(State);
+    std::ifstream   file(filename, std::ios::binary | std::ios::ate);
+
+    if (!file.good() or (static_cast<uint64_t>(file.tellg()) < size))
+    {
+        return false;
+    }
+    file.close();
+    BinaryIO::readRNG(sRng, pRng, filename, 0, nersc, scidacA, scidacB);
+    if (std::vector<uint32_t>({nersc, scidacA, scidacB}) != checksum)
+    {
+        return false;
+    }
+    *rng4d_ = pRng;
+
+    return true;
+}
+
+// split execution /////////////////////////////////////////////////////////////
+void Environment::createSplitGrids(const std::vector<int> &mpi)
+{
+    auto full = grid4d_->ProcessorGrid();
+
+    if (mpi.size() != nd_)
+    {
+        HADRON_ERROR(Size, "split processor grid has " + std::to_string(mpi.size())
+                     + " dimensions (expected " + std::to_string(nd_) + ")");
+    }
+    for (unsigned int mu = 0; mu < nd_; ++mu)
+    {
+        if ((mpi[mu] <= 0) or (full[mu] % mpi[mu] != 0))
+        {
+            HADRON_ERROR(Size, "split processor grid does not divide the "
+                         "processor grid in direction " + std::to_string(mu));
+        }
+    }
+    splitGrid5d_.clear();
+    splitGridRb5d_.clear();
+    splitGrid4d_.reset(new GridCartesian(dim_, 
+                                         GridDefaultSimd(nd_, vComplex::Nsimd()),
+                                         mpi, *grid4d_));
+    // group index in the order used by Grid_split (lexicographic in the group
+    // coordinates, which is not the split rank of the communicator)
+    auto             coor = grid4d_->ThisProcessorCoor();
+    std::vector<int> scoor(nd_), ssize(nd_);
+
+    for (unsigned int mu = 0; mu < nd_; ++mu)
+    {
+        scoor[mu] = coor[mu]/mpi[mu];
+        ssize[mu] = full[mu]/mpi[mu];
+    }
+    Lexicographic::IndexFromCoor(scoor, splitGroup_, ssize);
+    splitGridRb4d_.reset(SpaceTimeGrid::makeFourDimRedBlackGrid(splitGrid4d_.get()));
+    nSplitGroup_ = grid4d_->_Nprocessors/splitGrid4d_->_Nprocessors;
+    auto loc = splitGrid4d_->LocalDimensions();
+    splitLocVol_ = 1;
+    for (unsigned int d = 0; d < loc.size(); ++d)
+    {
+        splitLocVol_ *= loc[d];
+    }
+    LOG(Message) << "Split grids: " << nSplitGroup_ << " group(s) of " 
+                 << splitGrid4d_->_Nprocessors << " process(es)" << std::endl;
+}
+
+unsigned int Environment::getNSplitGroup(void) const
+{
+    return nSplitGroup_;
+}
+
+unsigned int Environment::getSplitGroup(void) const
+{
+    return splitGroup_;
+}
+
+// only lattices on the full (non-checkerboarded) grids can be redistributed
+bool Environment::isObjectSplittable(const unsigned int address) const
+{
+    if (hasCreatedObject(address) and !object_[address].spilled)
+    {
+        auto g = object_[address].data->getGrid();
+
+        if (g == grid4d_.get())
+        {
+            return true;
+        }
+        for (auto &g5: grid5d_)
+        {
+            if (g == g5.second.get())
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+GridBase * Environment::mapGrid(GridBase *grid, const bool toSplit)
+{
+    bool      split = split_;
+    GridBase *pt    = nullptr;
+
+    if (grid == (toSplit ? grid4d_ : splitGrid4d_).get())
+    {
+        pt = (toSplit ? splitGrid4d_ : grid4d_).get();
+    }
+    for (auto &g: (toSplit ? grid5d_ : splitGrid5d_))
+    {
+        if (grid == g.second.get())
+        {
+            split_ = toSplit;
+            createGrid(g.first);
+            pt     = getGrid(g.first);
+            split_ = split;
+        }
+    }
+    if (pt == nullptr)
+    {
+        HADRON_ERROR(Definition, "object grid is not a grid of the environment");
+    }
+
+    return pt;
+}
+
+// in[k][g] is the address of the k-th input of group g: the full environment
+// is put aside and replaced by the split inputs of this process' group
+void Environment::enterSplit(const std::vector<std::vector<unsigned int>> &in)
+{
+    if (split_)
+    {
+        HADRON_ERROR(Logic, "environment already split");
+    }
+    stash_.clear();
+    for (auto &o: object_)
+    {
+        stash_.push_back(std::move(o));
+        o         = ObjInfo();
+        o.name    = stash_.back().name;
+        o.module  = stash_.back().module;
+        o.storage = stash_.back().storage;
+    }
+    for (auto &slot: in)
+    {
+        std::vector<Object *> full;
+        unsigned int          a = slot[splitGroup_];
+        auto                  &info = stash_[a];
+
+        for (auto b: slot)
+        {
+            if (!stash_[b].data)
+            {
+                HADRON_ERROR(Definition, "object '" + stash_[b].name 
+                             + "' is empty and cannot be split");
+            }
+            full.push_back(stash_[b].data.get());
+        }
+
+        GridBase *g = mapGrid(info.data->getGrid(), true);
+
+        object_[a].Ls   = info.Ls;
+        object_[a].type = info.type;
+        object_[a].size = info.size*nSplitGroup_;
+        object_[a].data.reset(info.data->create(g));
+        object_[a].data->split(full);
+    }
+    split_ = true;
+}
+
+// out[k][g] is the address of the k-th output of group g: the outputs are
+// gathered back on the full grid, the split objects freed and the full
+// environment restored (groups without a module use the outputs of group 0)
+void Environment::leaveSplit(const std::vector<std::vector<unsigned int>> &out)
+{
+    std::vector<std::vector<std::unique_ptr<Object>>> full(out.size());
+    std::vector<ObjInfo>                              info(out.size());
+
+    if (!split_)
+    {
+        HADRON_ERROR(Logic, "environment not split");
+    }
+    for (unsigned int k = 0; k < out.size(); ++k)
+    {
+        unsigned int          g = (splitGroup_ < out[k].size()) ? splitGroup_ : 0;
+        auto                  &o = object_[out[k][g]];
+        std::vector<Object *> pt;
+
+        if (!o.data or !o.data->getGrid())
+        {
+            HADRON_ERROR(Definition, "output '" + o.name 
+                         + "' cannot be gathered on the full grid");
+        }
+
+        GridBase *fullGrid = mapGrid(o.data->getGrid(), false);
+
+        for (unsigned int i = 0; i < nSplitGroup_; ++i)
+        {
+            full[k].emplace_back(o.data->create(fullGrid));
+            pt.push_back(full[k].back().get());
+        }
+        o.data->unsplit(pt);
+        info[k].storage = o.storage;
+        info[k].Ls      = o.Ls;
+        info[k].type    = o.type;
+        info[k].size    = o.size/nSplitGroup_;
+    }
+    split_ = false;
+    for (unsigned int a = 0; a < object_.size(); ++a)
+    {
+        if (a < stash_.size())
+        {
+            object_[a] = std::move(stash_[a]);
+        }
+        else
+        {
+            object_[a].size = 0;
+            object_[a].type = nullptr;
+            object_[a].data.reset(nullptr);
+        }
+    }
+    stash_.clear();
+    for (unsigned int k = 0; k < out.size(); ++k)
+    {
+        for (unsigned int g = 0; g < out[k].size(); ++g)
+        {
+            auto &o = object_[out[k][g]];
+
+            o.storage = info[k].storage;
+            o.Ls      = info[k].Ls;
+            o.type    = info[k].type;
+            o.size    = info[k].size;
+            o.data    = std::move(full[k][g]);
+        }
+    }
+}
+
 // print environment content ///////////////////////////////////////////////////
 void Environment::printContent(void) const
 {
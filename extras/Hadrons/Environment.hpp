@@ -41,6 +41,225 @@ class Object
 public:
     Object(void) = default;
     virtual ~Object(void) = default;
+    // disk spilling (only lattice objects can be spilled)
+    virtual bool isSpillable(void) const {return false;};
+    virtual void write(std::ostream &out) {};
+    virtual void release(void) {};
+    virtual void allocate(void) {};
+    virtual void read(std::istream &in) {};
+    // checkpointing (only lattice objects can be checkpointed)
+    virtual bool isCheckpointable(void) const {return false;};
+    virtual void checkpoint(const std::string filename,
+                            std::vector<uint32_t> &checksum) {};
+    virtual bool restore(const std::string filename,
+                         const std::vector<uint32_t> &checksum) {return false;};
+    // split execution (only lattice objects can be moved between grids)
+    virtual GridBase * getGrid(void) const {return nullptr;};
+    virtual Object *   create(GridBase *grid) const {return nullptr;};
+    virtual void       split(const std::vector<Object *> &full) {};
+    virtual void       unsplit(const std::vector<Object *> &full) {};
+};
+
+// raw local dump of lattice data, used to move objects to node-local disk
+template <typename T>
+struct SpillIO
+{
+    static constexpr bool spillable = false;
+    static void write(std::ostream &out, T &obj) {};
+    static void release(T &obj) {};
+    static void allocate(T &obj) {};
+    static void read(std::istream &in, T &obj) {};
+};
+
+template <typename vobj>
+struct SpillIO<Lattice<vobj>>
+{
+    static constexpr bool spillable = true;
+    static void write(std::ostream &out, Lattice<vobj> &obj)
+    {
+        out.write(reinterpret_cast<const char *>(obj._odata.data()),
+                  obj._odata.size()*sizeof(vobj));
+    }
+    static void release(Lattice<vobj> &obj)
+    {
+        Vector<vobj>().swap(obj._odata);
+    }
+    static void allocate(Lattice<vobj> &obj)
+    {
+        obj._odata.resize(obj._grid->oSites());
+    }
+    static void read(std::istream &in, Lattice<vobj> &obj)
+    {
+        in.read(reinterpret_cast<char *>(obj._odata.data()),
+                obj._odata.size()*sizeof(vobj));
+    }
+};
+
+template <typename vobj>
+struct SpillIO<std::vector<Lattice<vobj>>>
+{
+    static constexpr bool spillable = true;
+    static void write(std::ostream &out, std::vector<Lattice<vobj>> &obj)
+    {
+        for (auto &l: obj) SpillIO<Lattice<vobj>>::write(out, l);
+    }
+    static void release(std::vector<Lattice<vobj>> &obj)
+    {
+        for (auto &l: obj) SpillIO<Lattice<vobj>>::release(l);
+    }
+    static void allocate(std::vector<Lattice<vobj>> &obj)
+    {
+        for (auto &l: obj) SpillIO<Lattice<vobj>>::allocate(l);
+    }
+    static void read(std::istream &in, std::vector<Lattice<vobj>> &obj)
+    {
+        for (auto &l: obj) SpillIO<Lattice<vobj>>::read(in, l);
+    }
+};
+
+// parallel binary I/O of lattice data with SciDAC checksums (two per lattice),
+// used to checkpoint the environment in a portable format, only floating-point
+// lattices are supported
+template <typename T, typename Enable = void>
+struct CheckpointIO
+{
+    static bool     checkpointable(const T &obj) {return false;};
+    static uint64_t size(const T &obj) {return 0;};
+    static void write(const std::string filename, T &obj, uint64_t &offset,
+                      std::vector<uint32_t> &checksum) {};
+    static void read(const std::string filename, T &obj, uint64_t &offset,
+                     std::vector<uint32_t> &checksum) {};
+};
+
+template <typename vobj>
+using EnableIfFloatLattice = typename std::enable_if<std::is_floating_point<
+    typename RealPart<typename vobj::scalar_type>::type>::value>::type;
+
+template <typename vobj>
+struct CheckpointIO<Lattice<vobj>, EnableIfFloatLattice<vobj>>
+{
+    typedef typename vobj::scalar_object   sobj;
+    typedef BinarySimpleMunger<sobj, sobj> Munger;
+
+    static bool checkpointable(const Lattice<vobj> &obj)
+    {
+        return !obj._grid->_isCheckerBoarded;
+    }
+    static uint64_t size(const Lattice<vobj> &obj)
+    {
+        return sizeof(sobj)*obj._grid->gSites();
+    }
+    static void write(const std::string filename, Lattice<vobj> &obj,
+                      uint64_t &offset, std::vector<uint32_t> &checksum)
+    {
+        Munger   munge;
+        uint32_t nersc, scidacA, scidacB;
+
+        BinaryIO::writeLatticeObject<vobj, sobj>(obj, filename, munge, offset,
+                                                 getFormatString<vobj>(),
+                                                 nersc, scidacA, scidacB);
+        checksum.push_back(scidacA);
+        checksum.push_back(scidacB);
+        offset += sizeof(sobj)*obj._grid->gSites();
+    }
+    static void read(const std::string filename, Lattice<vobj> &obj,
+                     uint64_t &offset, std::vector<uint32_t> &checksum)
+    {
+        Munger   munge;
+        uint32_t nersc, scidacA, scidacB;
+
+        BinaryIO::readLatticeObject<vobj, sobj>(obj, filename, munge, offset,
+                                                getFormatString<vobj>(),
+                                                nersc, scidacA, scidacB);
+        checksum.push_back(scidacA);
+        checksum.push_back(scidacB);
+        offset += sizeof(sobj)*obj._grid->gSites();
+    }
+};
+
+template <typename vobj>
+struct CheckpointIO<std::vector<Lattice<vobj>>, EnableIfFloatLattice<vobj>>
+{
+    static bool checkpointable(const std::vector<Lattice<vobj>> &obj)
+    {
+        for (auto &l: obj)
+        {
+            if (!CheckpointIO<Lattice<vobj>>::checkpointable(l)) return false;
+        }
+
+        return true;
+    }
+    static uint64_t size(const std::vector<Lattice<vobj>> &obj)
+    {
+        uint64_t s = 0;
+
+        for (auto &l: obj) s += CheckpointIO<Lattice<vobj>>::size(l);
+
+        return s;
+    }
+    static void write(const std::string filename, 
+                      std::vector<Lattice<vobj>> &obj, uint64_t &offset,
+                      std::vector<uint32_t> &checksum)
+    {
+        for (auto &l: obj) CheckpointIO<Lattice<vobj>>::write(filename, l, offset, checksum);
+    }
+    static void read(const std::string filename, 
+                     std::vector<Lattice<vobj>> &obj, uint64_t &offset,
+                     std::vector<uint32_t> &checksum)
+    {
+        for (auto &l: obj) CheckpointIO<Lattice<vobj>>::read(filename, l, offset, checksum);
+    }
+};
+
+// redistribution of lattice objects between the full grid and split grids,
+// the i-th full object goes to (comes from) the i-th group
+template <typename T>
+struct SplitIO
+{
+    static GridBase * grid(const T &obj) {return nullptr;};
+    static T *        create(GridBase *grid) {return nullptr;};
+    static void       split(const std::vector<T *> &full, T &obj) {};
+    static void       unsplit(const std::vector<T *> &full, T &obj) {};
+};
+
+template <typename vobj>
+struct SplitIO<Lattice<vobj>>
+{
+    static GridBase * grid(const Lattice<vobj> &obj)
+    {
+        return obj._grid;
+    }
+    static Lattice<vobj> * create(GridBase *grid)
+    {
+        return new Lattice<vobj>(grid);
+    }
+    static void split(const std::vector<Lattice<vobj> *> &full, 
+                      Lattice<vobj> &obj)
+    {
+        std::vector<Lattice<vobj>> buf(full.size(), full[0]->_grid);
+
+        for (unsigned int i = 0; i < full.size(); ++i)
+        {
+            buf[i] = *full[i];
+        }
+        Grid_split(buf, obj);
+    }
+    static void unsplit(const std::vector<Lattice<vobj> *> &full, 
+                        Lattice<vobj> &obj)
+    {
+        std::vector<Lattice<vobj>> buf(full.size(), full[0]->_grid);
+
+        for (auto &b: buf)
+        {
+            b.checkerboard = obj.checkerboard;
+        }
+        Grid_unsplit(buf, obj);
+        for (unsigned int i = 0; i < full.size(); ++i)
+        {
+            full[i]->_odata.swap(buf[i]._odata);
+            full[i]->checkerboard = buf[i].checkerboard;
+        }
+    }
 };
 
 template <typename T>
@@ -53,6 +272,25 @@ public:
     T &       get(void) const;
     T *       getPt(void) const;
     void      reset(T *pt);
+    // disk spilling
+    virtual bool isSpillable(void) const;
+    virtual void write(std::ostream &out);
+    virtual void release(void);
+    virtual void allocate(void);
+    virtual void read(std::istream &in);
+    // checkpointing
+    virtual bool isCheckpointable(void) const;
+    virtual void checkpoint(const std::string filename,
+                            std::vector<uint32_t> &checksum);
+    virtual bool restore(const std::string filename,
+                         const std::vector<uint32_t> &checksum);
+    // split execution
+    virtual GridBase * getGrid(void) const;
+    virtual Object *   create(GridBase *grid) const;
+    virtual void       split(const std::vector<Object *> &full);
+    virtual void       unsplit(const std::vector<Object *> &full);
+private:
+    std::vector<T *> cast(const std::vector<Object *> &obj) const;
 private:
     std::unique_ptr<T> objPt_{nullptr};
 };
@@ -72,6 +310,12 @@ public:
     typedef std::unique_ptr<GridRedBlackCartesian> GridRbPt;
     typedef std::unique_ptr<GridParallelRNG>       RngPt;
     enum class Storage {object, cache, temporary};
+    struct SpillStats
+    {
+        Size         spilled{0}, reloaded{0};
+        unsigned int nSpill{0}, nReload{0};
+        double       spillTime{0.}, reloadTime{0.};
+    };
 private:
     struct ObjInfo
     {
@@ -81,6 +325,7 @@ private:
         const std::type_info    *type{nullptr};
         std::string             name;
         int                     module{-1};
+        bool                    spilled{false};
         std::unique_ptr<Object> data{nullptr};
     };
 public:
@@ -143,6 +388,37 @@ public:
     void                    freeAll(void);
     void                    protectObjects(const bool protect);
     bool                    objectsProtected(void) const;
+    // disk spilling
+    void                    setSpillDirectory(const std::string dir);
+    std::string             getSpillDirectory(void) const;
+    bool                    isObjectSpillable(const unsigned int address) const;
+    bool                    isObjectSpilled(const unsigned int address) const;
+    void                    spillObject(const unsigned int address);
+    void                    reloadObject(const unsigned int address);
+    void                    prepareReload(const unsigned int address);
+    void                    readSpilled(const unsigned int address);
+    void                    finishReload(const unsigned int address,
+                                         const double time);
+    const SpillStats &      getSpillStats(void) const;
+    // checkpointing
+    bool                    isObjectCheckpointable(const unsigned int address) const;
+    void                    checkpointObject(const unsigned int address,
+                                             const std::string filename,
+                                             std::vector<uint32_t> &checksum);
+    bool                    restoreObject(const unsigned int address,
+                                          const std::string filename,
+                                          const std::vector<uint32_t> &checksum);
+    void                    checkpointRng(const std::string filename,
+                                          std::vector<uint32_t> &checksum);
+    bool                    restoreRng(const std::string filename,
+                                       const std::vector<uint32_t> &checksum);
+    // split execution
+    void                    createSplitGrids(const std::vector<int> &mpi);
+    unsigned int            getNSplitGroup(void) const;
+    unsigned int            getSplitGroup(void) const;
+    bool                    isObjectSplittable(const unsigned int address) const;
+    void                    enterSplit(const std::vector<std::vector<unsigned int>> &in);
+    void                    leaveSplit(const std::vector<std::vector<unsigned int>> &out);
     // print environment content
     void                    printContent(void) const;
 private:
@@ -161,6 +437,22 @@ private:
     // object store
     std::vector<ObjInfo>                   object_;
     std::map<std::string, unsigned int>    objectAddress_;
+    // disk spilling
+    std::string                            spillDir_{"."};
+    SpillStats                             spillStats_;
+    // split execution
+    bool                                   split_{false};
+    unsigned int                           nSplitGroup_{1};
+    int                                    splitGroup_{0};
+    unsigned long int                      splitLocVol_;
+    GridPt                                 splitGrid4d_;
+    std::map<unsigned int, GridPt>         splitGrid5d_;
+    GridRbPt                               splitGridRb4d_;
+    std::map<unsigned int, GridRbPt>       splitGridRb5d_;
+    std::vector<ObjInfo>                   stash_;
+private:
+    std::string spillFileName(const unsigned int address) const;
+    GridBase *  mapGrid(GridBase *grid, const bool toSplit);
 };
 
 /******************************************************************************
@@ -191,6 +483,121 @@ void Holder<T>::reset(T *pt)
     objPt_.reset(pt);
 }
 
+// disk spilling ///////////////////////////////////////////////////////////////
+template <typename T>
+bool Holder<T>::isSpillable(void) const
+{
+    return SpillIO<T>::spillable;
+}
+
+template <typename T>
+void Holder<T>::write(std::ostream &out)
+{
+    SpillIO<T>::write(out, *objPt_);
+}
+
+template <typename T>
+void Holder<T>::release(void)
+{
+    SpillIO<T>::release(*objPt_);
+}
+
+template <typename T>
+void Holder<T>::allocate(void)
+{
+    SpillIO<T>::allocate(*objPt_);
+}
+
+template <typename T>
+void Holder<T>::read(std::istream &in)
+{
+    SpillIO<T>::read(in, *objPt_);
+}
+
+// checkpointing //////////////////////////////////////////////////////////////
+template <typename T>
+bool Holder<T>::isCheckpointable(void) const
+{
+    return CheckpointIO<T>::checkpointable(*objPt_);
+}
+
+template <typename T>
+void Holder<T>::checkpoint(const std::string filename,
+                           std::vector<uint32_t> &checksum)
+{
+    uint64_t offset = 0;
+
+    checksum.clear();
+    CheckpointIO<T>::write(filename, *objPt_, offset, checksum);
+}
+
+template <typename T>
+bool Holder<T>::restore(const std::string filename,
+                        const std::vector<uint32_t> &checksum)
+{
+    uint64_t              offset = 0;
+    std::vector<uint32_t> readChecksum;
+    std::ifstream         file(filename, std::ios::binary | std::ios::ate);
+
+    // missing or truncated file
+    if (!file.good() or 
+        (static_cast<uint64_t>(file.tellg()) < CheckpointIO<T>::size(*objPt_)))
+    {
+        return false;
+    }
+    file.close();
+    CheckpointIO<T>::read(filename, *objPt_, offset, readChecksum);
+
+    return (readChecksum == checksum);
+}
+
+// split execution /////////////////////////////////////////////////////////////
+template <typename T>
+GridBase * Holder<T>::getGrid(void) const
+{
+    return SplitIO<T>::grid(*objPt_);
+}
+
+template <typename T>
+Object * Holder<T>::create(GridBase *grid) const
+{
+    T *pt = SplitIO<T>::create(grid);
+
+    return (pt != nullptr) ? new Holder<T>(pt) : nullptr;
+}
+
+template <typename T>
+void Holder<T>::split(const std::vector<Object *> &full)
+{
+    SplitIO<T>::split(cast(full), *objPt_);
+}
+
+template <typename T>
+void Holder<T>::unsplit(const std::vector<Object *> &full)
+{
+    SplitIO<T>::unsplit(cast(full), *objPt_);
+}
+
+template <typename T>
+std::vector<T *> Holder<T>::cast(const std::vector<Object *> &obj) const
+{
+    std::vector<T *> pt;
+
+    for (auto o: obj)
+    {
+        if (auto h = dynamic_cast<Holder<T> *>(o))
+        {
+            pt.push_back(h->getPt());
+        }
+        else
+        {
+            HADRON_ERROR(Definition, "cannot redistribute objects of different types");
+        }
+    }
+
+    return pt;
+}
+
 /******************************************************************************
  *                     Environment template implementation                    *
  ******************************************************************************/
@@ -210,21 +617,21 @@ void Environment::createDerivedObject(const std::string name,
     
     if (!object_[address].data or !objectsProtected())
     {
-        MemoryStats memStats;
+        MemoryStats memStats, *outerStats = MemoryProfiler::stats;
     
-        if (!MemoryProfiler::stats)
-        {
-            MemoryProfiler::stats = &memStats;
-        }
-        size_t initMem           = MemoryProfiler::stats->currentlyAllocated;
+        // always count with fresh statistics, the peak of an enclosing 
+        // profiler (e.g. the VM run time profile) is not the object size
+        MemoryProfiler::stats    = &memStats;
         object_[address].storage = storage;
         object_[address].Ls      = Ls;
+        object_[address].spilled = false;
         object_[address].data.reset(new Holder<B>(new T(std::forward<Ts>(args)...)));
-        object_[address].size    = MemoryProfiler::stats->maxAllocated - initMem;
+        object_[address].size    = memStats.maxAllocated;
         object_[address].type    = &typeid(T);
-        if (MemoryProfiler::stats == &memStats)
+        MemoryProfiler::stats    = outerStats;
+        if (outerStats)
         {
-            MemoryProfiler::stats = nullptr;
+            mergeMemoryStats(*outerStats, memStats);
         }
     }
     // object already exists, no error if it is a cache, error otherwise
@@ -253,6 +660,11 @@ T * Environment::getObject(const unsigned int address) const
     {
         if (hasCreatedObject(address))
         {
+            if (object_[address].spilled)
+            {
+                HADRON_ERROR(Definition, "object with address " + std::to_string(address) +
+                             " is spilled to disk");
+            }
             if (auto h = dynamic_cast<Holder<T> *>(object_[address].data.get()))
             {
                 return h->getPt();
@@ -68,6 +68,17 @@ std::string Hadrons::typeName(const std::type_info *info)
     return name;
 }
 
+// nested memory profiling ///////////////////////////////////////////////////
+void Hadrons::mergeMemoryStats(MemoryStats &outer, const MemoryStats &inner)
+{
+    outer.maxAllocated        = std::max(outer.maxAllocated, 
+                                         outer.currentlyAllocated 
+                                         + inner.maxAllocated);
+    outer.totalAllocated     += inner.totalAllocated;
+    outer.currentlyAllocated += inner.currentlyAllocated;
+    outer.totalFreed         += inner.totalFreed;
+}
+
 // default writers/readers /////////////////////////////////////////////////////
 #ifdef HAVE_HDF5
 const std::string Hadrons::resultFileExt = "h5";
@@ -32,6 +32,7 @@ See the full license in the file "LICENSE" in the top level distribution directo
 
 #include <set>
 #include <stack>
+#include <future>
 #include <Grid/Grid.h>
 #include <cxxabi.h>
 
@@ -84,7 +85,9 @@ typedef typename SImpl::Field PropagatorField##suffix;
 
 #define SOLVER_TYPE_ALIASES(FImpl, suffix)\
 typedef std::function<void(FermionField##suffix &,\
-                      const FermionField##suffix &)> SolverFn##suffix;
+                      const FermionField##suffix &)> SolverFn##suffix;\
+typedef std::function<void(std::vector<FermionField##suffix> &,\
+                      const std::vector<FermionField##suffix> &)> BatchSolverFn##suffix;
 
 #define SINK_TYPE_ALIASES(suffix)\
 typedef std::function<SlicedPropagator##suffix\
@@ -166,6 +169,9 @@ std::string typeName(void)
     return typeName(typeIdPt<T>());
 }
 
+// nested memory profiling, adds the allocations counted in inner to outer
+void mergeMemoryStats(MemoryStats &outer, const MemoryStats &inner);
+
 // default writers/readers
 extern const std::string resultFileExt;
 
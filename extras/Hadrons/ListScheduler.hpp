@@ -0,0 +1,787 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid
+
+Source file: extras/Hadrons/ListScheduler.hpp
+
+Copyright (C) 2015-2018
+
+Author: Antonin Portelli <antonin.portelli@me.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution directory
+*************************************************************************************/
+/*  END LEGAL */
+
+#ifndef Hadrons_ListScheduler_hpp_
+#define Hadrons_ListScheduler_hpp_
+
+#include <Grid/Hadrons/Global.hpp>
+
+BEGIN_HADRONS_NAMESPACE
+
+/******************************************************************************
+ *                   Memory-aware priority list scheduler                     *
+ ******************************************************************************/
+// The dependencies and the memory model are both given by the objects: an
+// object of a given size is allocated when its producer runs and, depending on
+// its lifetime, freed after its last user, right after its producer or never.
+//
+// A list schedule is built one vertex at a time from the vertices which are
+// ready. Each of them is scored by the memory it allocates and frees, followed
+// by the best chain (up to a depth of 'lookahead') of the vertices it makes
+// ready which reduce the memory held. The vertex chosen is the one which
+// raises the peak the least and leaves the least memory held (in either order
+// of priority), then the first in the vertex list, so that the result is
+// deterministic. Lists are built forward, and backward from the last vertices
+// (objects are then allocated by their last user and freed by their producer).
+// Each list is refined by a local search releasing the objects held at the
+// first step reaching the peak, and the best schedule is kept.
+template <typename V, typename T>
+class ListScheduler
+{
+public:
+    typedef std::vector<T> Schedule;
+    enum class Lifetime {lastUse, producer, never};
+    struct Object
+    {
+        V              size;
+        T              producer;
+        std::vector<T> user;
+        Lifetime       lifetime;
+    };
+    struct Parameters
+    {
+        unsigned int lookahead, maxIter;
+    };
+public:
+    // constructor
+    ListScheduler(const std::vector<T> &vertex,
+                  const std::vector<Object> &object, const Parameters &par);
+    // destructor
+    virtual ~ListScheduler(void) = default;
+    // access
+    const Schedule & getSchedule(void);
+    V                getPeak(void);
+    unsigned int     getNIter(void);
+private:
+    // memory variation due to a vertex (relative to the memory held before)
+    struct Score
+    {
+        V peak, alloc, freed;
+    };
+    // memory peak and number of steps reaching it
+    struct Peak
+    {
+        V            value;
+        unsigned int count;
+    };
+    // steps from lo reordered as seq
+    struct Move
+    {
+        unsigned int              lo;
+        std::vector<unsigned int> seq;
+    };
+    // number of objects considered at each local search iteration
+    static constexpr unsigned int maxMove = 32;
+private:
+    // list scheduling
+    void  makeList(const bool backward);
+    Score stepScore(const unsigned int v) const;
+    Score chainScore(const unsigned int v, const unsigned int depth);
+    void  apply(const unsigned int v, std::vector<unsigned int> &newReady);
+    void  unapply(const unsigned int v);
+    // local search
+    void  refine(void);
+    void  makeProfile(void);
+    Peak  movePeak(const Move &m);
+    Move  delayMove(const unsigned int a, const unsigned int s);
+    Move  advanceMove(const unsigned int a, const unsigned int s);
+    static Peak merge(const Peak &a, const Peak &b);
+    static bool less(const Peak &a, const Peak &b);
+private:
+    const std::vector<T>                   vertex_;
+    const Parameters                       par_;
+    bool                                   done_{false};
+    unsigned int                           nIter_{0};
+    // graph and memory model (vertices and objects are indices)
+    std::vector<V>                         vAlloc_;
+    std::vector<std::vector<unsigned int>> vParent_, vChild_, vTouch_;
+    std::vector<V>                         oSize_;
+    std::vector<Lifetime>                  oLife_;
+    std::vector<unsigned int>              oProducer_;
+    std::vector<std::vector<unsigned int>> oTouch_;
+    // list scheduling state
+    bool                                   backward_{false}, netFirst_{false};
+    std::vector<unsigned int>              nPending_, remaining_;
+    // schedule and its memory profile
+    std::vector<unsigned int>              order_, pos_, oLast_;
+    std::vector<V>                         vFreed_, level_;
+    std::vector<Peak>                      prefix_, suffix_;
+    Peak                                   peak_;
+    Schedule                               schedule_;
+    // local search scratch
+    std::vector<unsigned int>              wPos_, vMark_, oMark_;
+    unsigned int                           vStamp_{0}, oStamp_{0};
+};
+
+/******************************************************************************
+ *                       template implementation                              *
+ ******************************************************************************/
+// constructor /////////////////////////////////////////////////////////////////
+template <typename V, typename T>
+ListScheduler<V, T>::ListScheduler(const std::vector<T> &vertex,
+                                   const std::vector<Object> &object,
+                                   const Parameters &par)
+: vertex_(vertex)
+, par_(par)
+{
+    std::map<T, unsigned int> index;
+    unsigned int              n = vertex_.size();
+
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        index[vertex_[v]] = v;
+    }
+    vAlloc_.assign(n, 0);
+    vParent_.resize(n);
+    vChild_.resize(n);
+    vTouch_.resize(n);
+    for (auto &o: object)
+    {
+        unsigned int a = oSize_.size(), p = index.at(o.producer);
+        std::vector<unsigned int> touch = {p};
+
+        for (auto &u: o.user)
+        {
+            unsigned int c = index.at(u);
+
+            if (c != p)
+            {
+                touch.push_back(c);
+                vParent_[c].push_back(p);
+                vChild_[p].push_back(c);
+            }
+        }
+        std::sort(touch.begin(), touch.end());
+        touch.erase(std::unique(touch.begin(), touch.end()), touch.end());
+        oSize_.push_back(o.size);
+        oLife_.push_back(o.lifetime);
+        oProducer_.push_back(p);
+        oTouch_.push_back(touch);
+        vAlloc_[p] += o.size;
+        for (auto v: touch)
+        {
+            vTouch_[v].push_back(a);
+        }
+    }
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        for (auto l: {&vParent_[v], &vChild_[v]})
+        {
+            std::sort(l->begin(), l->end());
+            l->erase(std::unique(l->begin(), l->end()), l->end());
+        }
+    }
+}
+
+// access //////////////////////////////////////////////////////////////////////
+template <typename V, typename T>
+const typename ListScheduler<V, T>::Schedule &
+ListScheduler<V, T>::getSchedule(void)
+{
+    if (!done_)
+    {
+        std::vector<unsigned int> best;
+        Peak                      bestPeak;
+        unsigned int              bestIter;
+
+        // forward and backward lists, ranked by peak rise or net memory first
+        for (int k = 0; k < 4; ++k)
+        {
+            netFirst_ = (k / 2 == 1);
+            makeList(k % 2 == 1);
+            refine();
+            if ((k == 0) or less(peak_, bestPeak))
+            {
+                best     = order_;
+                bestPeak = peak_;
+                bestIter = nIter_;
+            }
+        }
+        order_ = best;
+        peak_  = bestPeak;
+        nIter_ = bestIter;
+        schedule_.clear();
+        for (auto v: order_)
+        {
+            schedule_.push_back(vertex_[v]);
+        }
+        done_ = true;
+    }
+
+    return schedule_;
+}
+
+template <typename V, typename T>
+V ListScheduler<V, T>::getPeak(void)
+{
+    getSchedule();
+
+    return peak_.value;
+}
+
+template <typename V, typename T>
+unsigned int ListScheduler<V, T>::getNIter(void)
+{
+    getSchedule();
+
+    return nIter_;
+}
+
+// list scheduling /////////////////////////////////////////////////////////////
+// forward, objects are allocated by their producer and freed by their last
+// user; backward, they are allocated by the first user met (the last one in
+// the final order) and freed by their producer, caches being held from the
+// start
+template <typename V, typename T>
+typename ListScheduler<V, T>::Score
+ListScheduler<V, T>::stepScore(const unsigned int v) const
+{
+    Score s = {0, 0, 0};
+
+    for (auto a: vTouch_[v])
+    {
+        bool produced = (oProducer_[a] == v);
+
+        if (!backward_)
+        {
+            s.alloc += produced ? oSize_[a] : 0;
+            if (((oLife_[a] == Lifetime::lastUse) and (remaining_[a] == 1)) or
+                ((oLife_[a] == Lifetime::producer) and produced))
+            {
+                s.freed += oSize_[a];
+            }
+        }
+        else if (oLife_[a] == Lifetime::never)
+        {
+            s.freed += produced ? oSize_[a] : 0;
+        }
+        else if ((oLife_[a] == Lifetime::producer) or 
+                 (remaining_[a] == oTouch_[a].size()))
+        {
+            s.alloc += (produced or (oLife_[a] == Lifetime::lastUse)) 
+                       ? oSize_[a] : 0;
+            s.freed += produced ? oSize_[a] : 0;
+        }
+        else
+        {
+            s.freed += produced ? oSize_[a] : 0;
+        }
+    }
+    s.peak = s.alloc;
+
+    return s;
+}
+
+template <typename V, typename T>
+void ListScheduler<V, T>::apply(const unsigned int v,
+                                std::vector<unsigned int> &newReady)
+{
+    for (auto a: vTouch_[v])
+    {
+        remaining_[a]--;
+    }
+    for (auto c: backward_ ? vParent_[v] : vChild_[v])
+    {
+        if (--nPending_[c] == 0)
+        {
+            newReady.push_back(c);
+        }
+    }
+}
+
+template <typename V, typename T>
+void ListScheduler<V, T>::unapply(const unsigned int v)
+{
+    for (auto a: vTouch_[v])
+    {
+        remaining_[a]++;
+    }
+    for (auto c: backward_ ? vParent_[v] : vChild_[v])
+    {
+        nPending_[c]++;
+    }
+}
+
+// v followed by the chain of vertices it makes ready lowering the memory held
+// the most (a continuation is only taken if it frees more than it allocates)
+template <typename V, typename T>
+typename ListScheduler<V, T>::Score
+ListScheduler<V, T>::chainScore(const unsigned int v, const unsigned int depth)
+{
+    Score s = stepScore(v);
+
+    if (depth > 1)
+    {
+        std::vector<unsigned int> newReady;
+        Score                     best;
+        bool                      found = false;
+
+        apply(v, newReady);
+        for (auto c: newReady)
+        {
+            Score cs = chainScore(c, depth - 1);
+
+            if ((cs.freed > cs.alloc) and (!found or
+                (cs.alloc + best.freed < best.alloc + cs.freed)))
+            {
+                best  = cs;
+                found = true;
+            }
+        }
+        unapply(v);
+        if (found)
+        {
+            V p = s.alloc + best.peak;
+
+            if ((p > s.freed) and (p - s.freed > s.peak))
+            {
+                s.peak = p - s.freed;
+            }
+            s.alloc += best.alloc;
+            s.freed += best.freed;
+        }
+    }
+
+    return s;
+}
+
+template <typename V, typename T>
+void ListScheduler<V, T>::makeList(const bool backward)
+{
+    unsigned int              n = vertex_.size();
+    std::vector<unsigned int> ready, mark(n, 0);
+    std::vector<Score>        score(n);
+    std::vector<bool>         dirty(n, true);
+    unsigned int              stamp = 0;
+    V                         current = 0, peak;
+
+    backward_ = backward;
+    nPending_.resize(n);
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        nPending_[v] = backward_ ? vChild_[v].size() : vParent_[v].size();
+        if (nPending_[v] == 0)
+        {
+            ready.push_back(v);
+        }
+    }
+    remaining_.resize(oTouch_.size());
+    for (unsigned int a = 0; a < oTouch_.size(); ++a)
+    {
+        remaining_[a] = oTouch_[a].size();
+        if (backward_ and (oLife_[a] == Lifetime::never))
+        {
+            current += oSize_[a];
+        }
+    }
+    peak = current;
+    order_.clear();
+    while (!ready.empty())
+    {
+        unsigned int best = 0;
+        V            slack = peak - current, bestPeak = 0;
+
+        // score the ready vertices whose neighbourhood changed
+        for (unsigned int i = 0; i < ready.size(); ++i)
+        {
+            unsigned int v = ready[i];
+
+            if (dirty[v])
+            {
+                score[v] = chainScore(v, std::max(par_.lookahead, 1u));
+                dirty[v] = false;
+            }
+
+            Score &s = score[v], &b = score[ready[best]];
+            V     p  = std::max(slack, s.peak);
+            int   rise  = (p < bestPeak) ? -1 : ((p == bestPeak) ? 0 : 1);
+            int   net   = (s.alloc + b.freed < b.alloc + s.freed) ? -1 :
+                          ((s.alloc + b.freed == b.alloc + s.freed) ? 0 : 1);
+            int   first = netFirst_ ? net : rise, second = netFirst_ ? rise : net;
+
+            if ((i == 0) or (first < 0) or ((first == 0) and
+                ((second < 0) or ((second == 0) and (v < ready[best])))))
+            {
+                best     = i;
+                bestPeak = p;
+            }
+        }
+
+        // run it
+        unsigned int              v = ready[best];
+        Score                     s = stepScore(v);
+        std::vector<unsigned int> newReady;
+
+        current += s.alloc;
+        peak     = std::max(peak, current);
+        current -= s.freed;
+        ready[best] = ready.back();
+        ready.pop_back();
+        apply(v, newReady);
+        ready.insert(ready.end(), newReady.begin(), newReady.end());
+        order_.push_back(v);
+
+        // the score of a vertex depends on the state of the vertices it can
+        // make ready up to the lookahead depth, invalidate the vertices which
+        // can reach what changed
+        auto                      &next = backward_ ? vChild_ : vParent_;
+        std::vector<unsigned int> front = backward_ ? vParent_[v] : vChild_[v];
+
+        stamp++;
+        for (auto a: vTouch_[v])
+        {
+            front.insert(front.end(), oTouch_[a].begin(), oTouch_[a].end());
+        }
+        for (unsigned int d = 0; d < par_.lookahead and !front.empty(); ++d)
+        {
+            std::vector<unsigned int> up;
+
+            for (auto w: front)
+            {
+                if (mark[w] != stamp)
+                {
+                    mark[w]  = stamp;
+                    dirty[w] = true;
+                    up.insert(up.end(), next[w].begin(), next[w].end());
+                }
+            }
+            front.swap(up);
+        }
+    }
+    if (order_.size() != n)
+    {
+        HADRON_ERROR(Range, "cannot schedule a cyclic graph");
+    }
+    if (backward_)
+    {
+        std::reverse(order_.begin(), order_.end());
+    }
+}
+
+// local search ////////////////////////////////////////////////////////////////
+template <typename V, typename T>
+typename ListScheduler<V, T>::Peak
+ListScheduler<V, T>::merge(const Peak &a, const Peak &b)
+{
+    if (a.value == b.value)
+    {
+        return {a.value, a.count + b.count};
+    }
+    else
+    {
+        return (a.value > b.value) ? a : b;
+    }
+}
+
+template <typename V, typename T>
+bool ListScheduler<V, T>::less(const Peak &a, const Peak &b)
+{
+    return (a.value < b.value) or ((a.value == b.value) and (a.count < b.count));
+}
+
+// memory held before each step, last user of each object, objects freed by
+// each vertex and prefix/suffix peaks of the current schedule
+template <typename V, typename T>
+void ListScheduler<V, T>::makeProfile(void)
+{
+    unsigned int n = order_.size();
+    V            current = 0;
+
+    pos_.resize(n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        pos_[order_[i]] = i;
+    }
+    vFreed_.assign(n, 0);
+    oLast_.resize(oTouch_.size());
+    for (unsigned int a = 0; a < oTouch_.size(); ++a)
+    {
+        unsigned int last = oTouch_[a][0];
+
+        for (auto v: oTouch_[a])
+        {
+            last = (pos_[v] > pos_[last]) ? v : last;
+        }
+        oLast_[a] = last;
+        if (oLife_[a] == Lifetime::lastUse)
+        {
+            vFreed_[last] += oSize_[a];
+        }
+        else if (oLife_[a] == Lifetime::producer)
+        {
+            vFreed_[oProducer_[a]] += oSize_[a];
+        }
+    }
+    level_.resize(n + 1);
+    prefix_.resize(n + 1);
+    suffix_.resize(n + 1);
+    prefix_[0] = {0, 0};
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        level_[i]      = current;
+        current       += vAlloc_[order_[i]];
+        prefix_[i + 1] = merge(prefix_[i], {current, 1});
+        current       -= vFreed_[order_[i]];
+    }
+    level_[n]  = current;
+    suffix_[n] = {0, 0};
+    for (unsigned int i = n; i > 0; --i)
+    {
+        suffix_[i - 1] = merge(suffix_[i],
+                               {level_[i - 1] + vAlloc_[order_[i - 1]], 1});
+    }
+    peak_ = prefix_[n];
+}
+
+// peak of the schedule with the steps from m.lo reordered as m.seq, only the
+// objects last used inside this window can change their last user
+template <typename V, typename T>
+typename ListScheduler<V, T>::Peak
+ListScheduler<V, T>::movePeak(const Move &m)
+{
+    unsigned int lo = m.lo, hi = m.lo + m.seq.size() - 1;
+    auto         newPos = [this, lo, hi](const unsigned int w)
+    {
+        return ((pos_[w] >= lo) and (pos_[w] <= hi)) ? wPos_[w] : pos_[w];
+    };
+    std::vector<std::pair<unsigned int, V>> add, sub;
+    Peak                                    window = {0, 0};
+    V                                       current = level_[lo];
+
+    for (unsigned int i = 0; i < m.seq.size(); ++i)
+    {
+        wPos_[m.seq[i]] = lo + i;
+    }
+    oStamp_++;
+    for (auto w: m.seq)
+    for (auto a: vTouch_[w])
+    {
+        unsigned int old = oLast_[a];
+
+        if ((oLife_[a] == Lifetime::lastUse) and (oMark_[a] != oStamp_) and
+            (pos_[old] >= lo) and (pos_[old] <= hi))
+        {
+            unsigned int last = old;
+
+            oMark_[a] = oStamp_;
+            for (auto t: oTouch_[a])
+            {
+                last = (newPos(t) > newPos(last)) ? t : last;
+            }
+            if (last != old)
+            {
+                add.push_back({last, oSize_[a]});
+                sub.push_back({old, oSize_[a]});
+            }
+        }
+    }
+    for (auto &p: add)
+    {
+        vFreed_[p.first] += p.second;
+    }
+    for (auto &p: sub)
+    {
+        vFreed_[p.first] -= p.second;
+    }
+    for (auto w: m.seq)
+    {
+        current += vAlloc_[w];
+        window   = merge(window, {current, 1});
+        current -= vFreed_[w];
+    }
+    for (auto &p: sub)
+    {
+        vFreed_[p.first] += p.second;
+    }
+    for (auto &p: add)
+    {
+        vFreed_[p.first] -= p.second;
+    }
+
+    return merge(merge(prefix_[lo], window), suffix_[hi + 1]);
+}
+
+// an object held at step s is released there either by delaying its producer
+// after s, together with its descendants scheduled up to s, or by advancing
+// its users scheduled after s, together with their ancestors scheduled from s
+template <typename V, typename T>
+typename ListScheduler<V, T>::Move
+ListScheduler<V, T>::delayMove(const unsigned int a, const unsigned int s)
+{
+    Move                      m;
+    std::vector<unsigned int> moved;
+
+    m.lo = pos_[oProducer_[a]];
+    vStamp_++;
+    for (unsigned int i = m.lo; i <= s; ++i)
+    {
+        unsigned int w  = order_[i];
+        bool         in = (i == m.lo);
+
+        for (auto p: vParent_[w])
+        {
+            in = in or (vMark_[p] == vStamp_);
+        }
+        if (in)
+        {
+            vMark_[w] = vStamp_;
+            moved.push_back(w);
+        }
+        else
+        {
+            m.seq.push_back(w);
+        }
+    }
+    m.seq.insert(m.seq.end(), moved.begin(), moved.end());
+
+    return m;
+}
+
+template <typename V, typename T>
+typename ListScheduler<V, T>::Move
+ListScheduler<V, T>::advanceMove(const unsigned int a, const unsigned int s)
+{
+    Move                      m;
+    std::vector<unsigned int> moved, rest;
+    unsigned int              hi = pos_[oLast_[a]];
+
+    m.lo = s;
+    vStamp_++;
+    for (auto t: oTouch_[a])
+    {
+        if (pos_[t] > s)
+        {
+            vMark_[t] = vStamp_;
+        }
+    }
+    for (unsigned int i = hi + 1; i > s; --i)
+    {
+        unsigned int w  = order_[i - 1];
+        bool         in = (vMark_[w] == vStamp_);
+
+        for (auto c: vChild_[w])
+        {
+            in = in or (vMark_[c] == vStamp_);
+        }
+        if (in)
+        {
+            vMark_[w] = vStamp_;
+            moved.push_back(w);
+        }
+        else
+        {
+            rest.push_back(w);
+        }
+    }
+    m.seq.assign(moved.rbegin(), moved.rend());
+    m.seq.insert(m.seq.end(), rest.rbegin(), rest.rend());
+
+    return m;
+}
+
+template <typename V, typename T>
+void ListScheduler<V, T>::refine(void)
+{
+    unsigned int n = order_.size();
+
+    wPos_.resize(n);
+    vMark_.assign(n, 0);
+    oMark_.assign(oTouch_.size(), 0);
+    makeProfile();
+    for (nIter_ = 0; nIter_ < par_.maxIter; ++nIter_)
+    {
+        std::vector<std::pair<V, unsigned int>> held;
+        std::vector<Move>                       move;
+        unsigned int                            s = 0;
+
+        // first step reaching the peak
+        while ((s < n) and (level_[s] + vAlloc_[order_[s]] != peak_.value))
+        {
+            s++;
+        }
+        if (s == n)
+        {
+            break;
+        }
+
+        // candidate moves for the largest objects held at the peak step (the
+        // cost of a move being proportional to its length)
+        for (unsigned int a = 0; a < oTouch_.size(); ++a)
+        {
+            if ((pos_[oProducer_[a]] < s) and (oSize_[a] > 0) and
+                ((oLife_[a] == Lifetime::never) or
+                 ((oLife_[a] == Lifetime::lastUse) and (pos_[oLast_[a]] >= s))))
+            {
+                held.push_back({oSize_[a], a});
+            }
+        }
+        std::stable_sort(held.begin(), held.end(),
+                         [](const std::pair<V, unsigned int> &x,
+                            const std::pair<V, unsigned int> &y)
+                         {
+                             return x.first > y.first;
+                         });
+        held.resize(std::min(held.size(), size_t(maxMove)));
+        for (auto &h: held)
+        {
+            move.push_back(delayMove(h.second, s));
+            if ((oLife_[h.second] == Lifetime::lastUse) and 
+                (pos_[oLast_[h.second]] > s))
+            {
+                move.push_back(advanceMove(h.second, s));
+            }
+        }
+
+        // take the best improving move
+        int  best  = -1;
+        Peak bestP = peak_;
+
+        for (unsigned int i = 0; i < move.size(); ++i)
+        {
+            Peak p = movePeak(move[i]);
+
+            if (less(p, bestP))
+            {
+                best  = i;
+                bestP = p;
+            }
+        }
+        if (best < 0)
+        {
+            break;
+        }
+        std::copy(move[best].seq.begin(), move[best].seq.end(),
+                  order_.begin() + move[best].lo);
+        makeProfile();
+    }
+}
+
+END_HADRONS_NAMESPACE
+
+#endif // Hadrons_ListScheduler_hpp_
+
@@ -159,6 +159,9 @@ public:
         return std::vector<std::string>(0);
     };
     virtual std::vector<std::string> getOutput(void) = 0;
+    // random number generator (such modules never run on split grids, so
+    // that the random stream is the one of a sequential run)
+    virtual bool usesRng(void) {return false;};
     // parse parameters
     virtual void parseParameters(XmlReader &reader, const std::string name) = 0;
     virtual void saveParameters(XmlWriter &writer, const std::string name) = 0;
@@ -0,0 +1,467 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid 
+
+Source file: extras/Hadrons/Modules/MContraction/A2AMesonField.hpp
+
+Copyright (C) 2015-2018
+
+Author: Antonin Portelli <antonin.portelli@me.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution directory
+*************************************************************************************/
+/*  END LEGAL */
+
+#ifndef Hadrons_MContraction_A2AMesonField_hpp_
+#define Hadrons_MContraction_A2AMesonField_hpp_
+
+#include <Grid/Hadrons/Global.hpp>
+#include <Grid/Hadrons/Module.hpp>
+#include <Grid/Hadrons/ModuleFactory.hpp>
+#include <Grid/Hadrons/Modules/MContraction/Meson.hpp>
+
+BEGIN_HADRONS_NAMESPACE
+
+/*
+ 
+ All-to-all meson fields
+ -----------------------------
+ 
+   M_ij(p, g, t) = sum_{x, x_T = t} exp(2 i pi p.x/L) w_i(x)^dag G_g v_j(x)
+ 
+ * options:
+ - left: set of w vectors (std::vector<FermionField>)
+ - right: set of v vectors (std::vector<FermionField>)
+ - gammas: space-separated list of gamma matrices (e.g. "Gamma5 GammaT").
+           Special values: "all" - the 16 gamma matrices.
+ - mom: list of momenta, integers in units of 2 pi/L for each spatial 
+        direction (e.g. "0 0 0")
+ - block: number of vectors per block. All the gammas and momenta of a 
+          block x block tile of M are computed in one pass over its vectors
+          and reduced across processes at once.
+ - cacheBlock: number of vectors per tile of the site loop (fits the
+               vectors of a few sites in cache)
+ - output: stem of the output files
+
+ <output>.<traj>.bin holds M as complex<double>, little endian, in the order
+ [p][g][t][i][j], so that the Ni x Nj matrix of each (p, g, t) is contiguous.
+ <output>.<traj>.xml describes the layout.
+*/
+
+BEGIN_MODULE_NAMESPACE(MContraction)
+
+/******************************************************************************
+ *                         Meson field kernel                                 *
+ ******************************************************************************/
+// For a tile of w and v vectors, the kernel forms the colour-contracted spin
+// matrices
+//
+//   S_ij(p, t)_{ab} = sum_{x, x_T = t} ph_p(x) sum_c conj(w_i(x)_ac) v_j(x)_bc
+//
+// site by site on the SIMD vectors, one lane per timeslice plane. Gamma 
+// matrices are signed permutations, so M_ij(p, g, t) = sum_a phase_g[a] 
+// S_ij(p, t)_{a perm_g[a]} is applied after the reduction.
+template <typename FImpl>
+class A2AMesonFieldKernel
+{
+public:
+    FERM_TYPE_ALIASES(FImpl,);
+    typedef typename FermionField::vector_type vec;
+    typedef typename FermionField::scalar_type scalar;
+    typedef Lattice<iSinglet<vec>>             ComplexField;
+    static constexpr unsigned int siteBlock = 16;
+public:
+    // res[(((t*ni + i)*nj + j)*nMom + p)*Ns*Ns + a*Ns + b] = S_ij(p, t)_{ab}
+    // for i < ni, j < nj, summed over all processes
+    static void apply(std::vector<ComplexD> &res, const FermionField *w,
+                      const unsigned int ni, const FermionField *v,
+                      const unsigned int nj, 
+                      const std::vector<ComplexField> &ph,
+                      const unsigned int cacheBlock)
+    {
+        GridBase     *grid   = w[0]._grid;
+        const int    nd      = grid->_ndimension;
+        const int    nSimd   = grid->Nsimd();
+        const int    orthog  = nd - 1;
+        const int    fd      = grid->_fdimensions[orthog];
+        const int    ld      = grid->_ldimensions[orthog];
+        const int    rd      = grid->_rdimensions[orthog];
+        const int    e2      = grid->_slice_block[orthog];
+        const int    stride  = grid->_slice_stride[orthog];
+        unsigned int nPlane  = grid->_slice_nblock[orthog]*e2;
+        unsigned int nMom    = ph.size(), nSpin = Ns*Ns, nEl = nMom*nSpin;
+        unsigned int cb      = std::max(cacheBlock, 1u);
+        unsigned int nci     = (ni + cb - 1)/cb;
+
+        std::vector<vec, alignedAllocator<vec>> acc(rd*ni*nj*nEl);
+
+        // threads own (plane, i tile) pairs, so that the accumulators are
+        // written without synchronisation
+        parallel_for (unsigned int rc = 0; rc < rd*nci; ++rc)
+        {
+            unsigned int r  = rc/nci;
+            unsigned int i0 = (rc%nci)*cb, i1 = std::min(i0 + cb, ni);
+            int          so = r*grid->_ostride[orthog];
+            vec          s[Ns*Ns];
+
+            for (unsigned int i = i0; i < i1; ++i)
+            for (unsigned int j = 0; j < nj; ++j)
+            {
+                vec *a = &acc[((r*ni + i)*nj + j)*nEl];
+
+                for (unsigned int n = 0; n < nEl; ++n)
+                {
+                    a[n] = zero;
+                }
+            }
+            for (unsigned int j0 = 0; j0 < nj; j0 += cb)
+            for (unsigned int k0 = 0; k0 < nPlane; k0 += siteBlock)
+            {
+                unsigned int j1 = std::min(j0 + cb, nj);
+                unsigned int k1 = std::min(k0 + siteBlock, nPlane);
+
+                for (unsigned int i = i0; i < i1; ++i)
+                for (unsigned int j = j0; j < j1; ++j)
+                {
+                    vec *a = &acc[((r*ni + i)*nj + j)*nEl];
+
+                    for (unsigned int k = k0; k < k1; ++k)
+                    {
+                        int  ss  = so + (k/e2)*stride + k%e2;
+                        auto &wx = w[i]._odata[ss];
+                        auto &vx = v[j]._odata[ss];
+
+                        for (unsigned int sa = 0; sa < Ns; ++sa)
+                        for (unsigned int sb = 0; sb < Ns; ++sb)
+                        {
+                            s[sa*Ns + sb] = TensorRemove(innerProduct(wx()(sa), 
+                                                                      vx()(sb)));
+                        }
+                        for (unsigned int p = 0; p < nMom; ++p)
+                        {
+                            vec f  = ph[p]._odata[ss]()()();
+                            vec *o = a + p*nSpin;
+
+                            for (unsigned int n = 0; n < nSpin; ++n)
+                            {
+                                o[n] = o[n] + f*s[n];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        // lanes to global timeslices, then one reduction for the whole tile
+        std::vector<int>                              icoor(nd), lane(nSimd);
+        std::vector<scalar, alignedAllocator<scalar>> buf(nSimd);
+        int                                           tOffset;
+
+        tOffset = grid->_processor_coor[orthog]*ld;
+
+        for (int l = 0; l < nSimd; ++l)
+        {
+            grid->iCoorFromIindex(icoor, l);
+            lane[l] = icoor[orthog]*rd + tOffset;
+        }
+        res.assign(fd*ni*nj*nEl, 0.);
+        for (int r = 0; r < rd; ++r)
+        for (unsigned int ij = 0; ij < ni*nj; ++ij)
+        for (unsigned int n = 0; n < nEl; ++n)
+        {
+            vstore(acc[(r*ni*nj + ij)*nEl + n], buf.data());
+            for (int l = 0; l < nSimd; ++l)
+            {
+                res[((r + lane[l])*ni*nj + ij)*nEl + n] += buf[l];
+            }
+        }
+        grid->GlobalSumVector(res.data(), res.size());
+    }
+
+    // number of floating point operations of apply() per site and (i, j)
+    static double flopsPerSite(const unsigned int nMom)
+    {
+        // Ns^2 colour inner products (Nc complex multiply-adds each), then 
+        // Ns^2 complex multiply-adds per momentum
+        return 8.*Ns*Ns*(Nc + nMom);
+    }
+};
+
+/******************************************************************************
+ *                            A2AMesonField                                   *
+ ******************************************************************************/
+class A2AMesonFieldPar: Serializable
+{
+public:
+    GRID_SERIALIZABLE_CLASS_MEMBERS(A2AMesonFieldPar,
+                                    std::string,              left,
+                                    std::string,              right,
+                                    std::string,              gammas,
+                                    std::vector<std::string>, mom,
+                                    unsigned int,             block,
+                                    unsigned int,             cacheBlock,
+                                    std::string,              output);
+};
+
+class A2AMesonFieldMetadata: Serializable
+{
+public:
+    GRID_SERIALIZABLE_CLASS_MEMBERS(A2AMesonFieldMetadata,
+                                    std::string,                 format,
+                                    unsigned int,                ni,
+                                    unsigned int,                nj,
+                                    unsigned int,                nt,
+                                    unsigned int,                block,
+                                    std::vector<Gamma::Algebra>, gammas,
+                                    std::vector<std::string>,    mom);
+};
+
+template <typename FImpl>
+class TA2AMesonField: public Module<A2AMesonFieldPar>
+{
+public:
+    FERM_TYPE_ALIASES(FImpl,);
+    typedef A2AMesonFieldKernel<FImpl>      Kernel;
+    typedef typename Kernel::ComplexField   ComplexField;
+public:
+    // constructor
+    TA2AMesonField(const std::string name);
+    // destructor
+    virtual ~TA2AMesonField(void) = default;
+    // dependency relation
+    virtual std::vector<std::string> getInput(void);
+    virtual std::vector<std::string> getOutput(void);
+protected:
+    // setup
+    virtual void setup(void);
+    // execution
+    virtual void execute(void);
+private:
+    std::vector<Gamma::Algebra> parseGammaString(void);
+private:
+    bool        hasPhase_{false};
+    std::string momphName_;
+};
+
+MODULE_REGISTER_NS(A2AMesonField, TA2AMesonField<FIMPL>, MContraction);
+
+/******************************************************************************
+ *                      TA2AMesonField implementation                         *
+ ******************************************************************************/
+// constructor /////////////////////////////////////////////////////////////////
+template <typename FImpl>
+TA2AMesonField<FImpl>::TA2AMesonField(const std::string name)
+: Module<A2AMesonFieldPar>(name)
+, momphName_(name + "_momph")
+{}
+
+// dependencies/products ///////////////////////////////////////////////////////
+template <typename FImpl>
+std::vector<std::string> TA2AMesonField<FImpl>::getInput(void)
+{
+    std::vector<std::string> in = {par().left, par().right};
+    
+    return in;
+}
+
+template <typename FImpl>
+std::vector<std::string> TA2AMesonField<FImpl>::getOutput(void)
+{
+    std::vector<std::string> out = {};
+    
+    return out;
+}
+
+template <typename FImpl>
+std::vector<Gamma::Algebra> TA2AMesonField<FImpl>::parseGammaString(void)
+{
+    std::vector<Gamma::Algebra> gammaList;
+    
+    if (par().gammas.compare("all") == 0)
+    {
+        for (unsigned int i = 1; i < Gamma::nGamma; i += 2)
+        {
+            gammaList.push_back((Gamma::Algebra)i);
+        }
+    }
+    else
+    {
+        gammaList = strToVec<Gamma::Algebra>(par().gammas);
+    }
+    
+    return gammaList;
+}
+
+// setup ///////////////////////////////////////////////////////////////////////
+template <typename FImpl>
+void TA2AMesonField<FImpl>::setup(void)
+{
+    if (par().block == 0)
+    {
+        HADRON_ERROR(Argument, "block size must be positive");
+    }
+    if (par().mom.empty())
+    {
+        HADRON_ERROR(Argument, "no momentum given");
+    }
+    envCache(std::vector<ComplexField>, momphName_, 1, par().mom.size(),
+             ComplexField(env().getGrid()));
+    envTmpLat(ComplexField, "coor");
+    // the cached phases may have been freed since the last execution
+    hasPhase_ = false;
+}
+
+// execution ///////////////////////////////////////////////////////////////////
+template <typename FImpl>
+void TA2AMesonField<FImpl>::execute(void)
+{
+    auto         &w     = envGet(std::vector<FermionField>, par().left);
+    auto         &v     = envGet(std::vector<FermionField>, par().right);
+    auto         &ph    = envGet(std::vector<ComplexField>, momphName_);
+    auto         gammas = parseGammaString();
+    unsigned int ni = w.size(), nj = v.size(), nt = env().getDim(Tp);
+    unsigned int nMom = ph.size(), nGamma = gammas.size(), block = par().block;
+    std::string  stem = par().output + "." + std::to_string(vm().getTrajectory());
+    bool         boss = env().getGrid()->IsBoss();
+    std::fstream file;
+    double       kernelTime = 0., ioTime = 0.;
+
+    LOG(Message) << "Computing all-to-all meson fields '" << getName() 
+                 << "' between " << ni << " vector(s) '" << par().left
+                 << "' and " << nj << " vector(s) '" << par().right << "' ("
+                 << nGamma << " gamma(s), " << nMom << " momenta, block "
+                 << block << ")" << std::endl;
+    if (!hasPhase_)
+    {
+        Complex i(0.0,1.0);
+
+        envGetTmp(ComplexField, coor);
+        for (unsigned int p = 0; p < nMom; ++p)
+        {
+            std::vector<Real> mom = strToVec<Real>(par().mom[p]);
+
+            if (mom.size() != env().getNd() - 1)
+            {
+                HADRON_ERROR(Size, "momentum '" + par().mom[p] + "' has " 
+                             + std::to_string(mom.size()) + " components (expected "
+                             + std::to_string(env().getNd() - 1) + ")");
+            }
+            ph[p] = zero;
+            for (unsigned int mu = 0; mu < mom.size(); ++mu)
+            {
+                LatticeCoordinate(coor, mu);
+                ph[p] = ph[p] + (mom[mu]/env().getGrid()->_fdimensions[mu])*coor;
+            }
+            ph[p] = exp((Real)(2*M_PI)*i*ph[p]);
+        }
+        hasPhase_ = true;
+    }
+
+    std::vector<MesonKernel::SpinPerm> perm;
+    std::vector<ComplexD>              s, row;
+    GridStopWatch                      timer;
+
+    for (auto g: gammas)
+    {
+        perm.push_back(MesonKernel::makePerm(Gamma(g)));
+    }
+    if (boss)
+    {
+        A2AMesonFieldMetadata md;
+        XmlWriter             writer(stem + ".xml");
+
+        md.format = "IEEE64LE complex [p][g][t][i][j]";
+        md.ni     = ni;
+        md.nj     = nj;
+        md.nt     = nt;
+        md.block  = block;
+        md.gammas = gammas;
+        md.mom    = par().mom;
+        write(writer, "A2AMesonField", md);
+        file.open(stem + ".bin", std::ios::in | std::ios::out 
+                                 | std::ios::binary | std::ios::trunc);
+        if (!file.good())
+        {
+            HADRON_ERROR(Io, "cannot open file '" + stem + ".bin'");
+        }
+    }
+    for (unsigned int i0 = 0; i0 < ni; i0 += block)
+    for (unsigned int j0 = 0; j0 < nj; j0 += block)
+    {
+        unsigned int bi = std::min(block, ni - i0), bj = std::min(block, nj - j0);
+
+        timer.Reset();
+        timer.Start();
+        Kernel::apply(s, &w[i0], bi, &v[j0], bj, ph, par().cacheBlock);
+        timer.Stop();
+        kernelTime += timer.useconds()*1.0e-6;
+        LOG(Debug) << "tile [" << i0 << ", " << i0 + bi << ") x [" << j0 
+                   << ", " << j0 + bj << ") in " << timer.Elapsed() << std::endl;
+        if (!boss)
+        {
+            continue;
+        }
+        // gammas, then one contiguous row of the tile per (p, g, t, i)
+        timer.Reset();
+        timer.Start();
+        row.resize(bj);
+        for (unsigned int p = 0; p < nMom; ++p)
+        for (unsigned int g = 0; g < nGamma; ++g)
+        for (unsigned int t = 0; t < nt; ++t)
+        for (unsigned int i = 0; i < bi; ++i)
+        {
+            for (unsigned int j = 0; j < bj; ++j)
+            {
+                const ComplexD *sij = &s[(((t*bi + i)*bj + j)*nMom + p)*Ns*Ns];
+
+                row[j] = 0.;
+                for (unsigned int a = 0; a < Ns; ++a)
+                {
+                    row[j] += ComplexD(perm[g].phase[a])*sij[a*Ns + perm[g].perm[a]];
+                }
+            }
+            BinaryIO::htole64_v(row.data(), bj*sizeof(ComplexD));
+            file.seekp(((((p*nGamma + g)*nt + t)*ni + i0 + i)*nj + j0)
+                       *sizeof(ComplexD));
+            file.write(reinterpret_cast<const char *>(row.data()), 
+                       bj*sizeof(ComplexD));
+        }
+        timer.Stop();
+        ioTime += timer.useconds()*1.0e-6;
+    }
+    if (boss)
+    {
+        file.close();
+        if (file.fail())
+        {
+            HADRON_ERROR(Io, "error while writing '" + stem + ".bin'");
+        }
+    }
+    env().getGrid()->Barrier();
+
+    double flops = Kernel::flopsPerSite(nMom)*ni*nj*env().getGrid()->gSites();
+
+    vm().addFlops(flops);
+    LOG(Message) << "Meson fields computed in " << kernelTime << " s ("
+                 << flops/kernelTime*1.0e-9 << " GFlop/s), written to '" 
+                 << stem << ".bin' in " << ioTime << " s" << std::endl;
+}
+
+END_MODULE_NAMESPACE
+
+END_HADRONS_NAMESPACE
+
+#endif // Hadrons_MContraction_A2AMesonField_hpp_
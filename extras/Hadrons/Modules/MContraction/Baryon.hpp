@@ -33,14 +33,333 @@ See the full license in the file "LICENSE" in the top level distribution directo
 #include <Grid/Hadrons/Global.hpp>
 #include <Grid/Hadrons/Module.hpp>
 #include <Grid/Hadrons/ModuleFactory.hpp>
+#include <Grid/Hadrons/Modules/MContraction/Meson.hpp>
 
 BEGIN_HADRONS_NAMESPACE
 
+/*
+ 
+ Baryon contractions
+ -----------------------------
+ 
+   O(x) = eps_abc (q1_a^T C G_snk q2_b) q3_c
+ 
+   C_{aa'}(t) = sum_{x, x_T = t} < O_a(x) Obar_a'(0) >,
+   Obar = eps_abc (q2bar_b Gbar q1bar_a^T) q3bar_c, Gbar = g_T (C G_src)^dag g_T
+ 
+ with C = g_Y g_T the charge conjugation matrix. The Wick contractions are
+ summed over all the permutations of the source quarks allowed by the 
+ propagator names (e.g. q1 = q2 = q3 gives the six terms of a single
+ flavour).
+ 
+ * options:
+ - q1: input propagator 1 (string)
+ - q2: input propagator 2 (string)
+ - q3: input propagator 3 (string), carrying the open spin index
+ - gammas: gamma matrices G of the sink & source diquarks, pairs of gamma 
+           matrices (space-separated strings) in angled brackets (i.e. 
+           <g_sink g_src>), in a sequence (e.g. "<Gamma5 Gamma5><Identity 
+           Identity>"). Default: "<Gamma5 Gamma5>" (nucleon).
+ - projectors: space-separated list of parity projectors applied to the open
+               spin indices, "P+" or "P-" for (1 +/- g_T)/2. Default: "P+ P-".
+ - output: name of the file to save the correlators.
+
+ All the requested gamma pairs and projectors are evaluated in a single pass
+ over the propagators (see BaryonKernel below).
+*/
+
+BEGIN_MODULE_NAMESPACE(MContraction)
+
 /******************************************************************************
- *                               Baryon                                       *
+ *                       Site-local baryon kernel                             *
  ******************************************************************************/
-BEGIN_MODULE_NAMESPACE(MContraction)
+// Only the 6 non-zero entries of each epsilon tensor are visited, and the
+// diquark gamma matrices are signed permutations, so every spin matrix
+// product with them is a signed gather. Per pair of colour permutations
+// (abc, a'b'c') the kernel forms
+//
+//   direct, (12):  D_{cc'} += s tr[G^T S1 Gbar^T S2^T] - s tr[G^T S1 Gbar S2^T]
+//   (13), (23), (123), (132):  C += +/- s S3 (A S^T B) S
+//
+// and D is closed with S3 once per site. Only the spin elements of C needed
+// by the requested projectors are computed; the projections themselves are
+// linear and are applied after the timeslice reduction.
+class BaryonKernel
+{
+public:
+    typedef MesonKernel::SpinPerm SpinPerm;
+    // Wick contractions, labelled by the permutation of the source quarks
+    enum Term {direct = 0, ex12, ex13, ex23, cyc123, cyc132, nTerm};
+    // N_ij = coef_ij S_{row[i] col[j]} (or S_{col[j] row[i]} if transposed)
+    struct SpinGather
+    {
+        unsigned int row[Ns], col[Ns];
+        Complex      coef[Ns*Ns];
+        bool         transpose;
+    };
+public:
+    BaryonKernel(const std::vector<GammaPair> &gammaList, 
+                 const std::vector<bool> &mask, const bool term[nTerm])
+    : n_(gammaList.size()), gather_(n_*nTerm), mask_(mask)
+    {
+        Gamma gC = Gamma(Gamma::Algebra::GammaY)*Gamma(Gamma::Algebra::GammaT);
+        Gamma gT(Gamma::Algebra::GammaT);
+        
+        for (unsigned int t = 0; t < nTerm; ++t)
+        {
+            term_[t] = term[t];
+        }
+        for (unsigned int p = 0; p < n_; ++p)
+        {
+            SpinPerm g    = MesonKernel::makePerm(gC*Gamma(gammaList[p].first));
+            SpinPerm gBar = MesonKernel::makePerm(gT*adj(gC*Gamma(gammaList[p].second))*gT);
+            SpinPerm gt   = transpose(g), gBart = transpose(gBar);
+            
+            gather_[p*nTerm + direct] = makeGather(gt, gBart, false);
+            gather_[p*nTerm + ex12]   = makeGather(gt, gBar, false);
+            gather_[p*nTerm + ex13]   = makeGather(gBart, gt, true);
+            gather_[p*nTerm + ex23]   = makeGather(gBar, g, true);
+            gather_[p*nTerm + cyc123] = makeGather(gBart, g, true);
+            gather_[p*nTerm + cyc132] = makeGather(gBar, gt, true);
+        }
+        for (unsigned int a = 0; a < Ns; ++a)
+        {
+            row_[a] = false;
+            for (unsigned int b = 0; b < Ns; ++b)
+            {
+                row_[a] = row_[a] or mask_[a*Ns + b];
+            }
+        }
+    }
+    
+    unsigned int size(void) const
+    {
+        return n_;
+    }
+    
+    // res[p*Ns*Ns + a*Ns + a'] = C_{aa'} at this site for all gamma pairs p
+    // (zero outside of the mask)
+    template <typename SiteProp1, typename SiteProp2, typename SiteProp3,
+              typename vec>
+    inline void operator()(vec *res, const SiteProp1 &q1, const SiteProp2 &q2,
+                           const SiteProp3 &q3) const
+    {
+        static const int eps[6][3]   = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1},
+                                        {0, 2, 1}, {2, 1, 0}, {1, 0, 2}};
+        static const int epsSign[6]  = {1, 1, 1, -1, -1, -1};
+        bool             diquark     = term_[direct] or term_[ex12];
+        
+        for (unsigned int p = 0; p < n_; ++p)
+        {
+            const SpinGather *g = &gather_[p*nTerm];
+            vec              d[Nc*Nc], *c = res + p*Ns*Ns;
+            
+            for (unsigned int i = 0; i < Nc*Nc; ++i)
+            {
+                d[i] = zero;
+            }
+            for (unsigned int i = 0; i < Ns*Ns; ++i)
+            {
+                c[i] = zero;
+            }
+            for (unsigned int e1 = 0; e1 < 6; ++e1)
+            for (unsigned int e2 = 0; e2 < 6; ++e2)
+            {
+                int  a  = eps[e1][0], b  = eps[e1][1], cc  = eps[e1][2];
+                int  ap = eps[e2][0], bp = eps[e2][1], ccp = eps[e2][2];
+                bool s  = (epsSign[e1]*epsSign[e2] > 0);
+                
+                if (diquark)
+                {
+                    vec t;
+                    
+                    t = zero;
+                    if (term_[direct])
+                    {
+                        trace(t, true, g[direct], q1, a, ap, q2, b, bp);
+                    }
+                    if (term_[ex12])
+                    {
+                        trace(t, false, g[ex12], q1, a, bp, q2, b, ap);
+                    }
+                    d[cc*Nc + ccp] = s ? d[cc*Nc + ccp] + t : d[cc*Nc + ccp] - t;
+                }
+                if (term_[ex13])
+                {
+                    chain(c, not s, g[ex13], q3, cc, ap, q2, b, bp, q1, a, ccp);
+                }
+                if (term_[ex23])
+                {
+                    chain(c, not s, g[ex23], q3, cc, bp, q1, a, ap, q2, b, ccp);
+                }
+                if (term_[cyc123])
+                {
+                    chain(c, s, g[cyc123], q3, cc, ap, q1, a, bp, q2, b, ccp);
+                }
+                if (term_[cyc132])
+                {
+                    chain(c, s, g[cyc132], q3, cc, bp, q2, b, ap, q1, a, ccp);
+                }
+            }
+            if (diquark)
+            {
+                for (unsigned int i = 0; i < Ns*Ns; ++i)
+                {
+                    if (!mask_[i])
+                    {
+                        continue;
+                    }
+                    for (unsigned int k = 0; k < Nc*Nc; ++k)
+                    {
+                        c[i] = c[i] + d[k]*q3()(i/Ns, i%Ns)(k/Nc, k%Nc);
+                    }
+                }
+            }
+        }
+    }
+    
+    // approximate number of floating point operations per site
+    double flopsPerSite(void) const
+    {
+        double nMask = 0., nRow = 0., nTrace = 0., nChain = 0.;
+        
+        for (unsigned int i = 0; i < Ns*Ns; ++i)
+        {
+            nMask += mask_[i] ? 1. : 0.;
+        }
+        for (unsigned int a = 0; a < Ns; ++a)
+        {
+            nRow += row_[a] ? 1. : 0.;
+        }
+        nTrace = (term_[direct] ? 1. : 0.) + (term_[ex12] ? 1. : 0.);
+        for (unsigned int t = ex13; t < nTerm; ++t)
+        {
+            nChain += term_[t] ? 1. : 0.;
+        }
+        
+        // 6 flops per complex product, 2 per complex sum
+        return n_*(36.*(nTrace*Ns*Ns*14. 
+                        + nChain*(Ns*Ns*6. + (nRow*Ns*Ns + nMask*Ns)*8.))
+                   + ((nTrace > 0.) ? nMask*Nc*Nc*8. : 0.));
+    }
+    
+    static SpinPerm transpose(const SpinPerm &g)
+    {
+        SpinPerm t;
+        
+        for (unsigned int a = 0; a < Ns; ++a)
+        {
+            t.perm[g.perm[a]]  = a;
+            t.phase[g.perm[a]] = g.phase[a];
+        }
+        
+        return t;
+    }
+private:
+    // gather form of A S B (or A S^T B) for signed permutations A and B
+    static SpinGather makeGather(const SpinPerm &A, const SpinPerm &B,
+                                 const bool transpose)
+    {
+        SpinGather sg;
+        
+        sg.transpose = transpose;
+        for (unsigned int i = 0; i < Ns; ++i)
+        {
+            sg.row[i] = A.perm[i];
+        }
+        for (unsigned int l = 0; l < Ns; ++l)
+        {
+            sg.col[B.perm[l]] = l;
+        }
+        for (unsigned int i = 0; i < Ns; ++i)
+        for (unsigned int j = 0; j < Ns; ++j)
+        {
+            sg.coef[i*Ns + j] = A.phase[i]*B.phase[sg.col[j]];
+        }
+        
+        return sg;
+    }
+    
+    // r +/-= sum_ij N_ij T_ij with N the gather of S^{ab}, T = T^{cd}
+    template <typename SiteProp1, typename SiteProp2, typename vec>
+    static inline void trace(vec &r, const bool add, const SpinGather &g,
+                             const SiteProp1 &S, const int a, const int b,
+                             const SiteProp2 &T, const int c, const int d)
+    {
+        typedef typename vec::scalar_type scalar;
+        
+        vec t;
+        
+        t = zero;
+        for (unsigned int i = 0; i < Ns; ++i)
+        for (unsigned int j = 0; j < Ns; ++j)
+        {
+            t = t + (S()(g.row[i], g.col[j])(a, b)*T()(i, j)(c, d))
+                    *scalar(g.coef[i*Ns + j]);
+        }
+        r = add ? r + t : r - t;
+    }
+    
+    // res +/-= L^{ab} N R^{ef} with N the gather of M^{cd}, on the mask
+    template <typename SiteL, typename SiteM, typename SiteR, typename vec>
+    inline void chain(vec *res, const bool add, const SpinGather &g,
+                      const SiteL &L, const int a, const int b, 
+                      const SiteM &M, const int c, const int d,
+                      const SiteR &R, const int e, const int f) const
+    {
+        typedef typename vec::scalar_type scalar;
+        
+        vec n[Ns*Ns], ln[Ns];
+        
+        for (unsigned int i = 0; i < Ns; ++i)
+        for (unsigned int j = 0; j < Ns; ++j)
+        {
+            n[i*Ns + j] = (g.transpose ? M()(g.col[j], g.row[i])(c, d) 
+                                       : M()(g.row[i], g.col[j])(c, d))
+                          *scalar(g.coef[i*Ns + j]);
+        }
+        for (unsigned int al = 0; al < Ns; ++al)
+        {
+            if (!row_[al])
+            {
+                continue;
+            }
+            for (unsigned int j = 0; j < Ns; ++j)
+            {
+                ln[j] = zero;
+                for (unsigned int i = 0; i < Ns; ++i)
+                {
+                    ln[j] = ln[j] + L()(al, i)(a, b)*n[i*Ns + j];
+                }
+            }
+            for (unsigned int alp = 0; alp < Ns; ++alp)
+            {
+                vec r;
+                
+                if (!mask_[al*Ns + alp])
+                {
+                    continue;
+                }
+                r = zero;
+                for (unsigned int j = 0; j < Ns; ++j)
+                {
+                    r = r + ln[j]*R()(j, alp)(e, f);
+                }
+                res[al*Ns + alp] = add ? res[al*Ns + alp] + r 
+                                       : res[al*Ns + alp] - r;
+            }
+        }
+    }
+private:
+    unsigned int            n_;
+    std::vector<SpinGather> gather_;
+    std::vector<bool>       mask_;
+    bool                    row_[Ns], term_[nTerm];
+};
 
+/******************************************************************************
+ *                               Baryon                                       *
+ ******************************************************************************/
 class BaryonPar: Serializable
 {
 public:
@@ -48,6 +367,8 @@ public:
                                     std::string, q1,
                                     std::string, q2,
                                     std::string, q3,
+                                    std::string, gammas,
+                                    std::string, projectors,
                                     std::string, output);
 };
 
@@ -62,7 +383,10 @@ public:
     {
     public:
         GRID_SERIALIZABLE_CLASS_MEMBERS(Result,
-                                        std::vector<std::vector<std::vector<Complex>>>, corr);
+                                        Gamma::Algebra,       gamma_snk,
+                                        Gamma::Algebra,       gamma_src,
+                                        std::string,          projector,
+                                        std::vector<Complex>, corr);
     };
 public:
     // constructor
@@ -72,6 +396,9 @@ public:
     // dependency relation
     virtual std::vector<std::string> getInput(void);
     virtual std::vector<std::string> getOutput(void);
+    virtual void parseGammaString(std::vector<GammaPair> &gammaList);
+    virtual void parseProjectorString(std::vector<std::string> &projList,
+                                      std::vector<SpinMatrix> &proj);
 protected:
     // setup
     virtual void setup(void);
@@ -107,31 +434,209 @@ std::vector<std::string> TBaryon<FImpl1, FImpl2, FImpl3>::getOutput(void)
     return out;
 }
 
+template <typename FImpl1, typename FImpl2, typename FImpl3>
+void TBaryon<FImpl1, FImpl2, FImpl3>::parseGammaString(std::vector<GammaPair> &gammaList)
+{
+    if (par().gammas.empty())
+    {
+        gammaList = {std::make_pair(Gamma::Algebra::Gamma5, 
+                                    Gamma::Algebra::Gamma5)};
+    }
+    else
+    {
+        gammaList = strToVec<GammaPair>(par().gammas);
+    }
+}
+
+template <typename FImpl1, typename FImpl2, typename FImpl3>
+void TBaryon<FImpl1, FImpl2, FImpl3>::parseProjectorString(
+    std::vector<std::string> &projList, std::vector<SpinMatrix> &proj)
+{
+    SpinMatrix id;
+    Gamma      gT(Gamma::Algebra::GammaT);
+    
+    if (par().projectors.empty())
+    {
+        projList = {"P+", "P-"};
+    }
+    else
+    {
+        projList = strToVec<std::string>(par().projectors);
+    }
+    id = zero;
+    for (unsigned int a = 0; a < Ns; ++a)
+    {
+        id()(a, a)() = 1.;
+    }
+    proj.clear();
+    for (auto &p: projList)
+    {
+        if (p == "P+")
+        {
+            proj.push_back(0.5*(id + gT*id));
+        }
+        else if (p == "P-")
+        {
+            proj.push_back(0.5*(id - gT*id));
+        }
+        else
+        {
+            HADRON_ERROR(Argument, "unknown projector '" + p + "'");
+        }
+    }
+}
+
 // setup ///////////////////////////////////////////////////////////////////////
 template <typename FImpl1, typename FImpl2, typename FImpl3>
 void TBaryon<FImpl1, FImpl2, FImpl3>::setup(void)
 {
-    envTmpLat(LatticeComplex, "c");
+    std::vector<GammaPair>   gammaList;
+    std::vector<std::string> projList;
+    std::vector<SpinMatrix>  proj;
+    
+    parseGammaString(gammaList);
+    parseProjectorString(projList, proj);
 }
 
 // execution ///////////////////////////////////////////////////////////////////
 template <typename FImpl1, typename FImpl2, typename FImpl3>
 void TBaryon<FImpl1, FImpl2, FImpl3>::execute(void)
 {
+    typedef typename PropagatorField1::vector_object::vector_type vec;
+    typedef typename vec::scalar_type                             scalar;
+    
     LOG(Message) << "Computing baryon contractions '" << getName() << "' using"
                  << " quarks '" << par().q1 << "', '" << par().q2 << "', and '"
                  << par().q3 << "'" << std::endl;
     
-    ResultWriter writer(RESULT_FILE_NAME(par().output));
-    auto       &q1 = envGet(PropagatorField1, par().q1);
-    auto       &q2 = envGet(PropagatorField2, par().q2);
-    auto       &q3 = envGet(PropagatorField3, par().q2);
-    envGetTmp(LatticeComplex, c);
-    Result     result;
+    ResultWriter             writer(RESULT_FILE_NAME(par().output));
+    auto                     &q1 = envGet(PropagatorField1, par().q1);
+    auto                     &q2 = envGet(PropagatorField2, par().q2);
+    auto                     &q3 = envGet(PropagatorField3, par().q3);
+    std::vector<GammaPair>   gammaList;
+    std::vector<std::string> projList;
+    std::vector<SpinMatrix>  proj;
+    std::vector<bool>        mask(Ns*Ns, false);
+    bool                     term[BaryonKernel::nTerm];
+    
+    parseGammaString(gammaList);
+    parseProjectorString(projList, proj);
+    // spin elements C_{aa'} needed by tr[P C]
+    for (auto &p: proj)
+    for (unsigned int a = 0; a < Ns; ++a)
+    for (unsigned int ap = 0; ap < Ns; ++ap)
+    {
+        mask[a*Ns + ap] = mask[a*Ns + ap] or (std::abs(p()(ap, a)()) > 0.);
+    }
+    // source permutations allowed by the flavours
+    term[BaryonKernel::direct] = true;
+    term[BaryonKernel::ex12]   = (par().q1 == par().q2);
+    term[BaryonKernel::ex13]   = (par().q1 == par().q3);
+    term[BaryonKernel::ex23]   = (par().q2 == par().q3);
+    term[BaryonKernel::cyc123] = term[BaryonKernel::ex12] and term[BaryonKernel::ex23];
+    term[BaryonKernel::cyc132] = term[BaryonKernel::cyc123];
+    
+    BaryonKernel kernel(gammaList, mask, term);
+    GridBase     *grid   = q1._grid;
+    const int    nd      = grid->_ndimension;
+    const int    nsimd   = grid->Nsimd();
+    const int    nt      = env().getDim(Tp);
+    const int    ld      = grid->_ldimensions[Tp];
+    const int    rd      = grid->_rdimensions[Tp];
+    const int    e2      = grid->_slice_block[Tp];
+    const int    str     = grid->_slice_stride[Tp];
+    const int    nPlane  = grid->_slice_nblock[Tp]*e2;
+    const int    nEl     = kernel.size()*Ns*Ns;
+    // enough (plane, chunk) pairs to keep all the threads busy
+    const int    nChunk  = std::min(nPlane, 
+                                    (4*GridThread::GetThreads() + rd - 1)/rd);
+    GridStopWatch timer;
+    
+    LOG(Message) << "(" << kernel.size() << " gamma pair(s), " 
+                 << projList.size() << " projector(s) in one pass)" 
+                 << std::endl;
+    timer.Start();
+    
+    // per (plane, chunk) sums, kept vectorised until the end
+    std::vector<vec, alignedAllocator<vec>> lvSum(rd*nChunk*nEl);
     
-    // FIXME: do contractions
+    parallel_for(int rc = 0; rc < rd*nChunk; ++rc)
+    {
+        int r   = rc/nChunk;
+        int k0  = (rc%nChunk)*nPlane/nChunk, k1 = (rc%nChunk + 1)*nPlane/nChunk;
+        int so  = r*grid->_ostride[Tp];
+        vec *acc = &lvSum[rc*nEl];
+        std::vector<vec, alignedAllocator<vec>> site(nEl);
+        
+        for (int i = 0; i < nEl; ++i)
+        {
+            acc[i] = zero;
+        }
+        for (int k = k0; k < k1; ++k)
+        {
+            int ss = so + (k/e2)*str + k%e2;
+            
+            kernel(site.data(), q1._odata[ss], q2._odata[ss], q3._odata[ss]);
+            for (int i = 0; i < nEl; ++i)
+            {
+                acc[i] = acc[i] + site[i];
+            }
+        }
+    }
+    
+    // SIMD lanes to global timeslices, then one global sum
+    std::vector<ComplexD>                         gSum(nt*nEl, 0.);
+    std::vector<scalar, alignedAllocator<scalar>> lane(nsimd);
+    std::vector<int>                              icoor(nd), tl(nsimd);
+    int                                           t0;
     
-    // write(writer, "meson", result);
+    t0 = grid->_processor_coor[Tp]*ld;
+    for (int l = 0; l < nsimd; ++l)
+    {
+        grid->iCoorFromIindex(icoor, l);
+        tl[l] = t0 + icoor[Tp]*rd;
+    }
+    for (int rc = 0; rc < rd*nChunk; ++rc)
+    for (int i = 0; i < nEl; ++i)
+    {
+        vstore(lvSum[rc*nEl + i], lane.data());
+        for (int l = 0; l < nsimd; ++l)
+        {
+            gSum[(tl[l] + rc/nChunk)*nEl + i] += lane[l];
+        }
+    }
+    grid->GlobalSumVector(gSum.data(), gSum.size());
+    timer.Stop();
+    vm().addFlops(kernel.flopsPerSite()*grid->gSites());
+    LOG(Message) << "Contractions done in " << timer.Elapsed() << std::endl;
+    
+    // projections
+    std::vector<Result> result;
+    
+    for (unsigned int p = 0; p < kernel.size(); ++p)
+    for (unsigned int j = 0; j < proj.size(); ++j)
+    {
+        Result r;
+        
+        r.gamma_snk = gammaList[p].first;
+        r.gamma_src = gammaList[p].second;
+        r.projector = projList[j];
+        r.corr.resize(nt);
+        for (int t = 0; t < nt; ++t)
+        {
+            ComplexD c = 0.;
+            
+            for (unsigned int a = 0; a < Ns; ++a)
+            for (unsigned int ap = 0; ap < Ns; ++ap)
+            {
+                c += ComplexD(proj[j]()(ap, a)())
+                     *gSum[t*nEl + (p*Ns + a)*Ns + ap];
+            }
+            r.corr[t] = c;
+        }
+        result.push_back(r);
+    }
+    write(writer, "baryon", result);
 }
 
 END_MODULE_NAMESPACE
@@ -33,6 +33,7 @@ See the full license in the file "LICENSE" in the top level distribution directo
 #include <Grid/Hadrons/Global.hpp>
 #include <Grid/Hadrons/Module.hpp>
 #include <Grid/Hadrons/ModuleFactory.hpp>
+#include <Grid/Hadrons/Modules/MContraction/MomentumProjector.hpp>
 
 BEGIN_HADRONS_NAMESPACE
 
@@ -50,6 +51,20 @@ BEGIN_HADRONS_NAMESPACE
 
            Special values: "all" - perform all possible contractions.
  - sink: module to compute the sink to use in contraction (string).
+ - mom: list of sink momenta, integers in units of 2 pi/L for each spatial
+        direction (e.g. "0 0 0"). When given, 'sink' must be empty and the
+        correlators are projected on all the momenta in the same pass (see
+        MomentumProjector.hpp), the results are ordered by momentum first.
+
+ * results (one entry per gamma pair, and per momentum when 'mom' is given):
+ - gamma_snk, gamma_src: sink and source gamma matrices
+ - mom: sink momentum of the entry, empty for contractions with a 'sink'
+        module. This field was added to the result files together with the
+        'mom' option, readers of the older files have to skip it.
+ - corr: correlator as a function of the sink time
+
+ All the requested gamma pairs are evaluated in a single pass over q1 and q2
+ (see MesonKernel below) rather than one full lattice expression per pair.
 */
 
 /******************************************************************************
@@ -59,6 +74,126 @@ BEGIN_MODULE_NAMESPACE(MContraction)
 
 typedef std::pair<Gamma::Algebra, Gamma::Algebra> GammaPair;
 
+/******************************************************************************
+ *                     Fused all-gamma meson kernel                           *
+ ******************************************************************************/
+// Gamma matrices are signed permutations in spin space, so the site trace
+//
+//   tr[G1 q1 G2 W] , G1 = g5*gSnk, G2 = adj(gSrc)*g5, W = adj(q2)*sink
+//
+// reduces to sum_{a,j} ph1[a] ph2[j] tr_c[q1(p1[a],j) W(p2[j],a)]. The 256
+// colour traces tr_c[q1(i,j) W(k,l)] are formed once per site and every gamma
+// pair is then 16 complex multiply-adds on them.
+class MesonKernel
+{
+public:
+    struct SpinPerm
+    {
+        int     perm[Ns];
+        Complex phase[Ns];
+    };
+public:
+    MesonKernel(const std::vector<GammaPair> &gammaList)
+    : n_(gammaList.size()), coef_(n_*Ns*Ns), idx_(n_*Ns*Ns)
+    {
+        Gamma g5(Gamma::Algebra::Gamma5);
+        
+        for (unsigned int p = 0; p < n_; ++p)
+        {
+            Gamma    gSnk(gammaList[p].first);
+            Gamma    gSrc(gammaList[p].second);
+            SpinPerm g1 = makePerm(g5*gSnk), g2 = makePerm(adj(gSrc)*g5);
+            
+            for (unsigned int a = 0; a < Ns; ++a)
+            for (unsigned int j = 0; j < Ns; ++j)
+            {
+                unsigned int o = (p*Ns + a)*Ns + j;
+                
+                coef_[o] = g1.phase[a]*g2.phase[j];
+                idx_[o]  = ((g1.perm[a]*Ns + j)*Ns + g2.perm[j])*Ns + a;
+            }
+        }
+        // only the colour traces used by the requested pairs are formed
+        trIdx_ = idx_;
+        std::sort(trIdx_.begin(), trIdx_.end());
+        trIdx_.erase(std::unique(trIdx_.begin(), trIdx_.end()), trIdx_.end());
+    }
+    
+    unsigned int size(void) const
+    {
+        return n_;
+    }
+    
+    // res[p] = tr[G1_p q1 G2_p w] for all gamma pairs p
+    template <typename SiteProp1, typename SiteProp2, typename vec>
+    inline void operator()(vec *res, const SiteProp1 &q1,
+                           const SiteProp2 &w) const
+    {
+        typedef typename vec::scalar_type scalar;
+        
+        vec tr[Ns*Ns*Ns*Ns];
+        
+        for (auto o: trIdx_)
+        {
+            unsigned int i = o/(Ns*Ns*Ns), j = (o/(Ns*Ns))%Ns;
+            unsigned int k = (o/Ns)%Ns,    l = o%Ns;
+            vec          t;
+            
+            t = zero;
+            for (unsigned int c = 0; c < Nc; ++c)
+            for (unsigned int d = 0; d < Nc; ++d)
+            {
+                t = t + q1()(i, j)(c, d)*w()(k, l)(d, c);
+            }
+            tr[o] = t;
+        }
+        for (unsigned int p = 0; p < n_; ++p)
+        {
+            vec r;
+            
+            r = zero;
+            for (unsigned int o = p*Ns*Ns; o < (p + 1)*Ns*Ns; ++o)
+            {
+                r = r + tr[idx_[o]]*scalar(coef_[o]);
+            }
+            res[p] = r;
+        }
+    }
+    
+    // signed permutation form of a gamma matrix, G_{a perm[a]} = phase[a]
+    static SpinPerm makePerm(const Gamma &g)
+    {
+        SpinMatrix id, m;
+        SpinPerm   sp;
+        
+        id = zero;
+        for (unsigned int a = 0; a < Ns; ++a)
+        {
+            id()(a, a)() = 1.;
+        }
+        m = g*id;
+        for (unsigned int a = 0; a < Ns; ++a)
+        {
+            sp.perm[a] = -1;
+            for (unsigned int b = 0; b < Ns; ++b)
+            {
+                if (std::abs(m()(a, b)()) > 0.5)
+                {
+                    sp.perm[a]  = b;
+                    sp.phase[a] = m()(a, b)();
+                }
+            }
+            assert(sp.perm[a] >= 0);
+        }
+        
+        return sp;
+    }
+private:
+    unsigned int              n_;
+    std::vector<Complex>      coef_;
+    std::vector<unsigned int> idx_, trIdx_;
+};
+
 class MesonPar: Serializable
 {
 public:
@@ -67,6 +202,7 @@ public:
                                     std::string, q2,
                                     std::string, gammas,
                                     std::string, sink,
+                                    std::vector<std::string>, mom,
                                     std::string, output);
 };
 
@@ -78,12 +214,15 @@ public:
     FERM_TYPE_ALIASES(FImpl2, 2);
     FERM_TYPE_ALIASES(ScalarImplCR, Scalar);
     SINK_TYPE_ALIASES(Scalar);
+    typedef TMomentumProjector<typename PropagatorField1::vector_object::vector_type> 
+        Projector;
     class Result: Serializable
     {
     public:
         GRID_SERIALIZABLE_CLASS_MEMBERS(Result,
                                         Gamma::Algebra, gamma_snk,
                                         Gamma::Algebra, gamma_src,
+                                        std::string, mom,
                                         std::vector<Complex>, corr);
     };
 public:
@@ -100,6 +239,8 @@ protected:
     virtual void setup(void);
     // execution
     virtual void execute(void);
+private:
+    std::string projName_;
 };
 
 MODULE_REGISTER_NS(Meson, ARG(TMeson<FIMPL, FIMPL>), MContraction);
@@ -111,13 +252,19 @@ MODULE_REGISTER_NS(Meson, ARG(TMeson<FIMPL, FIMPL>), MContraction);
 template <typename FImpl1, typename FImpl2>
 TMeson<FImpl1, FImpl2>::TMeson(const std::string name)
 : Module<MesonPar>(name)
+, projName_(name + "_momproj")
 {}
 
 // dependencies/products ///////////////////////////////////////////////////////
 template <typename FImpl1, typename FImpl2>
 std::vector<std::string> TMeson<FImpl1, FImpl2>::getInput(void)
 {
-    std::vector<std::string> input = {par().q1, par().q2, par().sink};
+    std::vector<std::string> input = {par().q1, par().q2};
+    
+    if (par().mom.empty())
+    {
+        input.push_back(par().sink);
+    }
     
     return input;
 }
@@ -158,7 +305,22 @@ void TMeson<FImpl1, FImpl2>::parseGammaString(std::vector<GammaPair> &gammaList)
 template <typename FImpl1, typename FImpl2>
 void TMeson<FImpl1, FImpl2>::setup(void)
 {
-    envTmpLat(LatticeComplex, "c");
+    std::vector<GammaPair> gammaList;
+    
+    parseGammaString(gammaList);
+    if (!par().mom.empty())
+    {
+        if (!par().sink.empty())
+        {
+            HADRON_ERROR(Argument, "'sink' and 'mom' cannot be used together");
+        }
+        envCache(Projector, projName_, 1, env().getGrid(), par().mom);
+    }
+    else if (vm().getModuleNamespace(env().getObjectModule(par().sink)) == "MSink")
+    {
+        envTmp(std::vector<LatticeComplex>, "c", 1, gammaList.size(),
+               LatticeComplex(env().getGrid()));
+    }
 }
 
 // execution ///////////////////////////////////////////////////////////////////
@@ -193,49 +355,153 @@ void TMeson<FImpl1, FImpl2>::execute(void)
         auto &q1 = envGet(SlicedPropagator1, par().q1);
         auto &q2 = envGet(SlicedPropagator2, par().q2);
         
+        if (!par().mom.empty())
+        {
+            HADRON_ERROR(Argument, "cannot project sinked propagators on momenta");
+        }
         LOG(Message) << "(propagator already sinked)" << std::endl;
         for (unsigned int i = 0; i < result.size(); ++i)
         {
             Gamma gSnk(gammaList[i].first);
             Gamma gSrc(gammaList[i].second);
             
-            for (unsigned int t = 0; t < buf.size(); ++t)
+            for (unsigned int t = 0; t < q1.size(); ++t)
             {
                 result[i].corr[t] = TensorRemove(trace(mesonConnected(q1[t], q2[t], gSnk, gSrc)));
             }
         }
     }
+    else if (!par().mom.empty())
+    {
+        typedef typename PropagatorField1::vector_object::vector_type vec;
+        
+        auto               &q1   = envGet(PropagatorField1, par().q1);
+        auto               &q2   = envGet(PropagatorField2, par().q2);
+        auto               &proj = envGet(Projector, projName_);
+        MesonKernel        kernel(gammaList);
+        const unsigned int np    = kernel.size();
+        typename Projector::Result c;
+        
+        LOG(Message) << "(" << np << " gamma pairs and " << proj.nMom() 
+                     << " momenta in one pass)" << std::endl;
+        auto density = [&kernel, &q1, &q2](vec *f, const int ss)
+        {
+            kernel(f, q1._odata[ss], adj(q2._odata[ss]));
+        };
+        proj(c, np, density);
+        result.resize(proj.nMom()*np);
+        for (unsigned int m = 0; m < proj.nMom(); ++m)
+        for (unsigned int p = 0; p < np; ++p)
+        {
+            Result &r = result[m*np + p];
+            
+            r.gamma_snk = gammaList[p].first;
+            r.gamma_src = gammaList[p].second;
+            r.mom       = proj.getMomenta()[m];
+            r.corr.assign(c[p][m].begin(), c[p][m].end());
+        }
+        vm().addFlops(proj.flops(np));
+    }
     else
     {
-        auto &q1 = envGet(PropagatorField1, par().q1);
-        auto &q2 = envGet(PropagatorField2, par().q2);
+        typedef typename PropagatorField1::vector_object::vector_type vec;
         
-        envGetTmp(LatticeComplex, c);
-        LOG(Message) << "(using sink '" << par().sink << "')" << std::endl;
-        for (unsigned int i = 0; i < result.size(); ++i)
+        auto        &q1 = envGet(PropagatorField1, par().q1);
+        auto        &q2 = envGet(PropagatorField2, par().q2);
+        MesonKernel kernel(gammaList);
+        std::string ns;
+        
+        LOG(Message) << "(using sink '" << par().sink << "', "
+                     << kernel.size() << " gamma pairs in one pass)"
+                     << std::endl;
+        ns = vm().getModuleNamespace(env().getObjectModule(par().sink));
+        if (ns == "MSource")
         {
-            Gamma       gSnk(gammaList[i].first);
-            Gamma       gSrc(gammaList[i].second);
-            std::string ns;
-                
-            ns = vm().getModuleNamespace(env().getObjectModule(par().sink));
-            if (ns == "MSource")
+            PropagatorField1 &sink = envGet(PropagatorField1, par().sink);
+            GridBase         *grid = q1._grid;
+            const int        nd    = grid->_ndimension;
+            const int        nsimd = grid->Nsimd();
+            const int        np    = kernel.size();
+            int              ld    = grid->_ldimensions[Tp];
+            int              rd    = grid->_rdimensions[Tp];
+            int              e1    = grid->_slice_nblock[Tp];
+            int              e2    = grid->_slice_block[Tp];
+            int              str   = grid->_slice_stride[Tp];
+            
+            // local per-timeslice sums, kept vectorised until the end
+            std::vector<vec, alignedAllocator<vec>> lvSum(rd*np);
+            
+            parallel_for(int r = 0; r < rd; ++r)
             {
-                PropagatorField1 &sink = envGet(PropagatorField1, par().sink);
+                int so = r*grid->_ostride[Tp];
+                std::vector<vec, alignedAllocator<vec>> site(np);
                 
-                c = trace(mesonConnected(q1, q2, gSnk, gSrc)*sink);
-                sliceSum(c, buf, Tp);
+                for (int p = 0; p < np; ++p)
+                {
+                    lvSum[r*np + p] = zero;
+                }
+                for (int n = 0; n < e1; ++n)
+                for (int b = 0; b < e2; ++b)
+                {
+                    int ss = so + n*str + b;
+                    
+                    kernel(site.data(), q1._odata[ss],
+                           adj(q2._odata[ss])*sink._odata[ss]);
+                    for (int p = 0; p < np; ++p)
+                    {
+                        lvSum[r*np + p] = lvSum[r*np + p] + site[p];
+                    }
+                }
+            }
+            
+            // SIMD lanes to global timeslices, then one global sum
+            std::vector<ComplexD>                     gSum(nt*np, 0.);
+            std::vector<typename vec::scalar_type>    lane(nsimd);
+            std::vector<int>                          icoor(nd);
+            int                                       t0;
+            
+            t0 = grid->_processor_coor[Tp]*ld;
+            for (int r = 0; r < rd; ++r)
+            for (int p = 0; p < np; ++p)
+            {
+                extract<vec, typename vec::scalar_type>(lvSum[r*np + p], lane);
+                for (int idx = 0; idx < nsimd; ++idx)
+                {
+                    grid->iCoorFromIindex(icoor, idx);
+                    gSum[(t0 + r + icoor[Tp]*rd)*np + p] += lane[idx];
+                }
             }
-            else if (ns == "MSink")
+            grid->GlobalSumVector(gSum.data(), gSum.size());
+            for (int p = 0; p < np; ++p)
+            for (int t = 0; t < nt; ++t)
+            {
+                result[p].corr[t] = gSum[t*np + p];
+            }
+        }
+        else if (ns == "MSink")
+        {
+            SinkFnScalar &sink = envGet(SinkFnScalar, par().sink);
+            const int    np    = kernel.size();
+            
+            envGetTmp(std::vector<LatticeComplex>, c);
+            parallel_for(int ss = 0; ss < q1._grid->oSites(); ++ss)
             {
-                SinkFnScalar &sink = envGet(SinkFnScalar, par().sink);
+                std::vector<vec, alignedAllocator<vec>> site(np);
                 
-                c   = trace(mesonConnected(q1, q2, gSnk, gSrc));
-                buf = sink(c);
+                kernel(site.data(), q1._odata[ss], adj(q2._odata[ss]));
+                for (int p = 0; p < np; ++p)
+                {
+                    c[p]._odata[ss]()()() = site[p];
+                }
             }
-            for (unsigned int t = 0; t < buf.size(); ++t)
+            // the sink function is opaque, so it is applied per correlator
+            for (int p = 0; p < np; ++p)
             {
-                result[i].corr[t] = TensorRemove(buf[t]);
+                buf = sink(c[p]);
+                for (unsigned int t = 0; t < buf.size(); ++t)
+                {
+                    result[p].corr[t] = TensorRemove(buf[t]);
+                }
             }
         }
     }
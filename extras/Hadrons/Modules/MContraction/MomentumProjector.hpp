@@ -0,0 +1,260 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid
+
+Source file: extras/Hadrons/Modules/MContraction/MomentumProjector.hpp
+
+Copyright (C) 2015-2018
+
+Author: Antonin Portelli <antonin.portelli@me.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution directory
+*************************************************************************************/
+/*  END LEGAL */
+
+#ifndef Hadrons_MContraction_MomentumProjector_hpp_
+#define Hadrons_MContraction_MomentumProjector_hpp_
+
+#include <Grid/Hadrons/Global.hpp>
+
+BEGIN_HADRONS_NAMESPACE
+
+/*
+
+ Momentum projection of correlator densities
+ -----------------------------
+
+   C_i(p, t) = sum_{x, x_T = t} exp(2 i pi p.x/L) f_i(x)
+
+ for a list of spatial momenta p (integers in units of 2 pi/L) and site-local
+ complex densities f_i, all computed in a single sweep over the volume. The
+ phases only depend on the position of a site within its timeslice, they are
+ tabulated once as SIMD vectors for the sites of one outer timeslice. The
+ projection is then one vector multiply-add per density, momentum and site,
+ instead of one phase lattice and one sliceSum per momentum.
+
+ The densities are given by a functor density(f, ss) filling f[i] with f_i at
+ the outer site ss, so that contraction kernels can feed the projector site by
+ site without building intermediate lattices.
+
+ It is only used by MContraction::Meson ('mom' option). A2AMesonField already
+ applies all its momentum phases within its single pass over the vector
+ products, and the WeakHamiltonian modules only compute zero-momentum
+ timeslice sums, so neither of them builds one phase lattice per momentum.
+*/
+
+BEGIN_MODULE_NAMESPACE(MContraction)
+
+template <typename vtype>
+class TMomentumProjector
+{
+public:
+    typedef typename vtype::scalar_type                     scalar;
+    typedef std::vector<std::vector<std::vector<ComplexD>>> Result;
+public:
+    TMomentumProjector(GridBase *grid, const std::vector<std::string> &mom);
+
+    unsigned int nMom(void) const
+    {
+        return nMom_;
+    }
+
+    const std::vector<std::string> & getMomenta(void) const
+    {
+        return mom_;
+    }
+
+    // res[i][p][t] = C_i(p, t)
+    template <typename Density>
+    void operator()(Result &res, const unsigned int nDensity,
+                    const Density &density) const;
+    template <typename vobj>
+    void operator()(Result &res, const std::vector<Lattice<vobj>> &field) const;
+
+    // complex multiply-adds
+    double flops(const unsigned int nDensity) const
+    {
+        return 8.*nDensity*nMom_*grid_->gSites();
+    }
+private:
+    GridBase                                    *grid_;
+    unsigned int                                nMom_, nPlane_;
+    std::vector<std::string>                    mom_;
+    std::vector<vtype, alignedAllocator<vtype>> phase_;
+};
+
+typedef TMomentumProjector<vComplex> MomentumProjector;
+
+/******************************************************************************
+ *                    TMomentumProjector implementation                       *
+ ******************************************************************************/
+template <typename vtype>
+TMomentumProjector<vtype>::TMomentumProjector(GridBase *grid,
+                                              const std::vector<std::string> &mom)
+: grid_(grid), nMom_(mom.size()), mom_(mom)
+{
+    const int                      nd    = grid->_ndimension;
+    const int                      nsimd = grid->Nsimd();
+    std::vector<std::vector<Real>> p(nMom_);
+
+    nPlane_ = grid->_slice_nblock[Tp]*grid->_slice_block[Tp];
+    for (unsigned int m = 0; m < nMom_; ++m)
+    {
+        p[m] = strToVec<Real>(mom[m]);
+        if (p[m].size() != nd - 1)
+        {
+            HADRON_ERROR(Size, "momentum '" + mom[m] + "' has "
+                         + std::to_string(p[m].size()) + " components (expected "
+                         + std::to_string(nd - 1) + ")");
+        }
+    }
+    phase_.resize(nPlane_*nMom_);
+    parallel_for(int k = 0; k < nPlane_; ++k)
+    {
+        int                 e2 = grid->_slice_block[Tp];
+        int                 ss = (k/e2)*grid->_slice_stride[Tp] + k%e2;
+        std::vector<int>    ocoor(nd), icoor(nd);
+        std::vector<scalar> lane(nsimd);
+
+        grid->oCoorFromOindex(ocoor, ss);
+        for (unsigned int m = 0; m < nMom_; ++m)
+        {
+            for (int l = 0; l < nsimd; ++l)
+            {
+                double phi = 0.;
+
+                grid->iCoorFromIindex(icoor, l);
+                for (int mu = 0; mu < nd - 1; ++mu)
+                {
+                    int x = ocoor[mu] + icoor[mu]*grid->_rdimensions[mu]
+                            + grid->_processor_coor[mu]*grid->_ldimensions[mu];
+
+                    phi += p[m][mu]*x/grid->_fdimensions[mu];
+                }
+                lane[l] = scalar(std::cos(2.*M_PI*phi), std::sin(2.*M_PI*phi));
+            }
+            merge<vtype, scalar>(phase_[k*nMom_ + m], lane);
+        }
+    }
+}
+
+template <typename vtype>
+template <typename Density>
+void TMomentumProjector<vtype>::operator()(Result &res,
+                                           const unsigned int nDensity,
+                                           const Density &density) const
+{
+    GridBase   *grid  = grid_;
+    const int  nd     = grid->_ndimension;
+    const int  nsimd  = grid->Nsimd();
+    const int  nt     = grid->_fdimensions[Tp];
+    const int  ld     = grid->_ldimensions[Tp];
+    const int  rd     = grid->_rdimensions[Tp];
+    const int  e2     = grid->_slice_block[Tp];
+    const int  str    = grid->_slice_stride[Tp];
+    const int  nPlane = nPlane_;
+    const int  nEl    = nDensity*nMom_;
+    // enough (plane, chunk) pairs to keep all the threads busy
+    const int  nChunk = std::min(nPlane,
+                                 (4*GridThread::GetThreads() + rd - 1)/rd);
+
+    // per (plane, chunk) sums, kept vectorised until the end
+    std::vector<vtype, alignedAllocator<vtype>> lvSum(rd*nChunk*nEl);
+
+    parallel_for(int rc = 0; rc < rd*nChunk; ++rc)
+    {
+        int   r   = rc/nChunk;
+        int   k0  = (rc%nChunk)*nPlane/nChunk, k1 = (rc%nChunk + 1)*nPlane/nChunk;
+        int   so  = r*grid->_ostride[Tp];
+        vtype *acc = &lvSum[rc*nEl];
+        std::vector<vtype, alignedAllocator<vtype>> f(nDensity);
+
+        for (int i = 0; i < nEl; ++i)
+        {
+            acc[i] = zero;
+        }
+        for (int k = k0; k < k1; ++k)
+        {
+            const vtype *ph = &phase_[k*nMom_];
+
+            density(f.data(), so + (k/e2)*str + k%e2);
+            for (unsigned int i = 0; i < nDensity; ++i)
+            for (unsigned int m = 0; m < nMom_; ++m)
+            {
+                acc[i*nMom_ + m] = acc[i*nMom_ + m] + ph[m]*f[i];
+            }
+        }
+    }
+
+    // SIMD lanes to global timeslices, then one global sum
+    std::vector<ComplexD>                         gSum(nt*nEl, 0.);
+    std::vector<scalar>                           lane(nsimd);
+    std::vector<int>                              icoor(nd), tl(nsimd);
+    int                                           t0;
+
+    t0 = grid->_processor_coor[Tp]*ld;
+    for (int l = 0; l < nsimd; ++l)
+    {
+        grid->iCoorFromIindex(icoor, l);
+        tl[l] = t0 + icoor[Tp]*rd;
+    }
+    for (int rc = 0; rc < rd*nChunk; ++rc)
+    for (int i = 0; i < nEl; ++i)
+    {
+        int r = rc/nChunk;
+
+        extract<vtype, scalar>(lvSum[rc*nEl + i], lane);
+        for (int l = 0; l < nsimd; ++l)
+        {
+            gSum[i*nt + tl[l] + r] += lane[l];
+        }
+    }
+    grid->GlobalSumVector(gSum.data(), gSum.size());
+    res.resize(nDensity);
+    for (unsigned int i = 0; i < nDensity; ++i)
+    {
+        res[i].resize(nMom_);
+        for (unsigned int m = 0; m < nMom_; ++m)
+        {
+            auto b = gSum.begin() + (i*nMom_ + m)*nt;
+
+            res[i][m].assign(b, b + nt);
+        }
+    }
+}
+
+template <typename vtype>
+template <typename vobj>
+void TMomentumProjector<vtype>::operator()(Result &res,
+                                           const std::vector<Lattice<vobj>> &field) const
+{
+    auto density = [&field](vtype *f, const int ss)
+    {
+        for (unsigned int i = 0; i < field.size(); ++i)
+        {
+            f[i] = TensorRemove(field[i]._odata[ss]);
+        }
+    };
+
+    (*this)(res, field.size(), density);
+}
+
+END_MODULE_NAMESPACE
+
+END_HADRONS_NAMESPACE
+
+#endif // Hadrons_MContraction_MomentumProjector_hpp_
@@ -88,8 +88,15 @@ protected:
     virtual void setup(void);
     // execution
     virtual void execute(void);
+private:
+    void makeSource(FermionField &source, FermionField &tmp,
+                    const PropagatorField &fullSrc,
+                    const unsigned int s, const unsigned int c);
+    void saveSolution(FermionField &sol, FermionField &tmp,
+                      const unsigned int s, const unsigned int c);
 private:
     unsigned int Ls_;
+    bool         batch_{false};
     SolverFn     *solver_{nullptr};
 };
 
@@ -124,17 +131,82 @@ std::vector<std::string> TGaugeProp<FImpl>::getOutput(void)
 template <typename FImpl>
 void TGaugeProp<FImpl>::setup(void)
 {
-    Ls_ = env().getObjectLs(par().solver);
+    Ls_    = env().getObjectLs(par().solver);
+    // a batched solver (e.g. from MSolver::RBPrecBlockCG) gets all the
+    // spin-colour components in a single call
+    batch_ = envHasType(BatchSolverFn, par().solver);
     envCreateLat(PropagatorField, getName());
-    envTmpLat(FermionField, "source", Ls_);
-    envTmpLat(FermionField, "sol", Ls_);
     envTmpLat(FermionField, "tmp");
+    if (batch_)
+    {
+        unsigned int nSrc = Ns*FImpl::Dimension;
+        
+        envTmp(std::vector<FermionField>, "sources", Ls_, nSrc,
+               FermionField(env().getGrid(Ls_)));
+        envTmp(std::vector<FermionField>, "sols", Ls_, nSrc,
+               FermionField(env().getGrid(Ls_)));
+    }
+    else
+    {
+        envTmpLat(FermionField, "source", Ls_);
+        envTmpLat(FermionField, "sol", Ls_);
+    }
     if (Ls_ > 1)
     {
         envCreateLat(PropagatorField, getName() + "_5d", Ls_);
     }
 }
 
+// source/solution conversions ////////////////////////////////////////////////
+template <typename FImpl>
+void TGaugeProp<FImpl>::makeSource(FermionField &source, FermionField &tmp,
+                                   const PropagatorField &fullSrc,
+                                   const unsigned int s, const unsigned int c)
+{
+    // source conversion for 4D sources
+    if (!env().isObject5d(par().source))
+    {
+        if (Ls_ == 1)
+        {
+           PropToFerm<FImpl>(source, fullSrc, s, c);
+        }
+        else
+        {
+            PropToFerm<FImpl>(tmp, fullSrc, s, c);
+            make_5D(tmp, source, Ls_);
+        }
+    }
+    // source conversion for 5D sources
+    else
+    {
+        if (Ls_ != env().getObjectLs(par().source))
+        {
+            HADRON_ERROR(Size, "Ls mismatch between quark action and source");
+        }
+        else
+        {
+            PropToFerm<FImpl>(source, fullSrc, s, c);
+        }
+    }
+}
+
+template <typename FImpl>
+void TGaugeProp<FImpl>::saveSolution(FermionField &sol, FermionField &tmp,
+                                     const unsigned int s, const unsigned int c)
+{
+    std::string propName = (Ls_ == 1) ? getName() : (getName() + "_5d");
+    auto        &prop    = envGet(PropagatorField, propName);
+    
+    FermToProp<FImpl>(prop, sol, s, c);
+    // create 4D propagators from 5D one if necessary
+    if (Ls_ > 1)
+    {
+        PropagatorField &p4d = envGet(PropagatorField, getName());
+        make_4D(sol, tmp, Ls_);
+        FermToProp<FImpl>(p4d, tmp, s, c);
+    }
+}
+
 // execution ///////////////////////////////////////////////////////////////////
 template <typename FImpl>
 void TGaugeProp<FImpl>::execute(void)
@@ -142,55 +214,49 @@ void TGaugeProp<FImpl>::execute(void)
     LOG(Message) << "Computing quark propagator '" << getName() << "'"
                  << std::endl;
     
-    std::string propName = (Ls_ == 1) ? getName() : (getName() + "_5d");
-    auto        &prop    = envGet(PropagatorField, propName);
-    auto        &fullSrc = envGet(PropagatorField, par().source);
-    auto        &solver  = envGet(SolverFn, par().solver);
+    auto &fullSrc = envGet(PropagatorField, par().source);
     
-    envGetTmp(FermionField, source);
-    envGetTmp(FermionField, sol);
     envGetTmp(FermionField, tmp);
-    LOG(Message) << "Inverting using solver '" << par().solver
-                 << "' on source '" << par().source << "'" << std::endl;
-    for (unsigned int s = 0; s < Ns; ++s)
-      for (unsigned int c = 0; c < FImpl::Dimension; ++c)
+    if (batch_)
     {
-        LOG(Message) << "Inversion for spin= " << s << ", color= " << c
+        auto &solver = envGet(BatchSolverFn, par().solver);
+        
+        envGetTmp(std::vector<FermionField>, sources);
+        envGetTmp(std::vector<FermionField>, sols);
+        LOG(Message) << "Inverting using solver '" << par().solver
+                     << "' on source '" << par().source << "' ("
+                     << sources.size() << " spin-colour components at once)"
                      << std::endl;
-        // source conversion for 4D sources
-        if (!env().isObject5d(par().source))
+        for (unsigned int s = 0; s < Ns; ++s)
+        for (unsigned int c = 0; c < FImpl::Dimension; ++c)
         {
-            if (Ls_ == 1)
-            {
-               PropToFerm<FImpl>(source, fullSrc, s, c);
-            }
-            else
-            {
-                PropToFerm<FImpl>(tmp, fullSrc, s, c);
-                make_5D(tmp, source, Ls_);
-            }
+            makeSource(sources[s*FImpl::Dimension + c], tmp, fullSrc, s, c);
+            sols[s*FImpl::Dimension + c] = zero;
         }
-        // source conversion for 5D sources
-        else
+        solver(sols, sources);
+        for (unsigned int s = 0; s < Ns; ++s)
+        for (unsigned int c = 0; c < FImpl::Dimension; ++c)
         {
-            if (Ls_ != env().getObjectLs(par().source))
-            {
-                HADRON_ERROR(Size, "Ls mismatch between quark action and source");
-            }
-            else
-            {
-                PropToFerm<FImpl>(source, fullSrc, s, c);
-            }
+            saveSolution(sols[s*FImpl::Dimension + c], tmp, s, c);
         }
-        sol = zero;
-        solver(sol, source);
-        FermToProp<FImpl>(prop, sol, s, c);
-        // create 4D propagators from 5D one if necessary
-        if (Ls_ > 1)
+    }
+    else
+    {
+        auto &solver = envGet(SolverFn, par().solver);
+        
+        envGetTmp(FermionField, source);
+        envGetTmp(FermionField, sol);
+        LOG(Message) << "Inverting using solver '" << par().solver
+                     << "' on source '" << par().source << "'" << std::endl;
+        for (unsigned int s = 0; s < Ns; ++s)
+          for (unsigned int c = 0; c < FImpl::Dimension; ++c)
         {
-            PropagatorField &p4d = envGet(PropagatorField, getName());
-            make_4D(sol, tmp, Ls_);
-            FermToProp<FImpl>(p4d, tmp, s, c);
+            LOG(Message) << "Inversion for spin= " << s << ", color= " << c
+                         << std::endl;
+            makeSource(source, tmp, fullSrc, s, c);
+            sol = zero;
+            solver(sol, source);
+            saveSolution(sol, tmp, s, c);
         }
     }
 }
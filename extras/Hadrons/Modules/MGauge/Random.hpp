@@ -50,6 +50,8 @@ public:
     // dependency relation
     virtual std::vector<std::string> getInput(void);
     virtual std::vector<std::string> getOutput(void);
+    // random number generator
+    virtual bool usesRng(void) {return true;};
 protected:
     // setup
     virtual void setup(void);
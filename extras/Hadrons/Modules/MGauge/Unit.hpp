@@ -50,6 +50,8 @@ public:
     // dependencies/products
     virtual std::vector<std::string> getInput(void);
     virtual std::vector<std::string> getOutput(void);
+    // random number generator
+    virtual bool usesRng(void) {return true;};
 protected:
     // setup
     virtual void setup(void);
@@ -109,6 +109,8 @@ void TPoint<FImpl>::setup(void)
     envTmpLat(LatticeComplex, "coor");
     envCacheLat(LatticeComplex, momphName_);
     envCreate(SinkFn, getName(), 1, nullptr);
+    // the cached phase may have been freed since the last execution
+    hasPhase_ = false;
 }
 
 // execution ///////////////////////////////////////////////////////////////////
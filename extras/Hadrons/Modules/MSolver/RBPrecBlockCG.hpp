@@ -0,0 +1,147 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid 
+
+Source file: extras/Hadrons/Modules/MSolver/RBPrecBlockCG.hpp
+
+Copyright (C) 2015-2018
+
+Author: Antonin Portelli <antonin.portelli@me.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution directory
+*************************************************************************************/
+/*  END LEGAL */
+
+#ifndef Hadrons_MSolver_RBPrecBlockCG_hpp_
+#define Hadrons_MSolver_RBPrecBlockCG_hpp_
+
+#include <Grid/Hadrons/Global.hpp>
+#include <Grid/Hadrons/Module.hpp>
+#include <Grid/Hadrons/ModuleFactory.hpp>
+
+BEGIN_HADRONS_NAMESPACE
+
+/******************************************************************************
+ *             Schur red-black preconditioned block CG (batched)              *
+ ******************************************************************************/
+BEGIN_MODULE_NAMESPACE(MSolver)
+
+class RBPrecBlockCGPar: Serializable
+{
+public:
+    GRID_SERIALIZABLE_CLASS_MEMBERS(RBPrecBlockCGPar,
+                                    std::string, action,
+                                    double     , residual);
+};
+
+template <typename FImpl>
+class TRBPrecBlockCG: public Module<RBPrecBlockCGPar>
+{
+public:
+    FGS_TYPE_ALIASES(FImpl,);
+public:
+    // constructor
+    TRBPrecBlockCG(const std::string name);
+    // destructor
+    virtual ~TRBPrecBlockCG(void) = default;
+    // dependencies/products
+    virtual std::vector<std::string> getInput(void);
+    virtual std::vector<std::string> getReference(void);
+    virtual std::vector<std::string> getOutput(void);
+protected:
+    // setup
+    virtual void setup(void);
+    // execution
+    virtual void execute(void);
+};
+
+MODULE_REGISTER_NS(RBPrecBlockCG, TRBPrecBlockCG<FIMPL>, MSolver);
+
+/******************************************************************************
+ *                   TRBPrecBlockCG template implementation                   *
+ ******************************************************************************/
+// constructor /////////////////////////////////////////////////////////////////
+template <typename FImpl>
+TRBPrecBlockCG<FImpl>::TRBPrecBlockCG(const std::string name)
+: Module(name)
+{}
+
+// dependencies/products ///////////////////////////////////////////////////////
+template <typename FImpl>
+std::vector<std::string> TRBPrecBlockCG<FImpl>::getInput(void)
+{
+    std::vector<std::string> in = {};
+    
+    return in;
+}
+
+template <typename FImpl>
+std::vector<std::string> TRBPrecBlockCG<FImpl>::getReference(void)
+{
+    std::vector<std::string> ref = {par().action};
+    
+    return ref;
+}
+
+template <typename FImpl>
+std::vector<std::string> TRBPrecBlockCG<FImpl>::getOutput(void)
+{
+    std::vector<std::string> out = {getName()};
+    
+    return out;
+}
+
+// setup ///////////////////////////////////////////////////////////////////////
+template <typename FImpl>
+void TRBPrecBlockCG<FImpl>::setup(void)
+{
+    LOG(Message) << "setting up Schur red-black preconditioned block CG for"
+                 << " action '" << par().action << "' with residual "
+                 << par().residual << std::endl;
+
+    auto Ls     = env().getObjectLs(par().action);
+    auto &mat   = envGet(FMat, par().action);
+    // flop estimate for the run time profile, per application of the
+    // preconditioned operator and its adjoint (see MSolver::RBPrecCG)
+    auto iterFlops = [&mat](void)
+    {
+        return 2.*1344.*mat.FermionGrid()->gSites();
+    };
+    // all the sources of one call go through a single block solve
+    auto solver = [&mat, iterFlops, this](std::vector<FermionField> &sol,
+                                          const std::vector<FermionField> &source)
+    {
+        ReliableBlockConjugateGradient<FermionField> bcg(par().residual, 10000);
+        SchurRedBlackDiagMooeeSolve<FermionField>    schurSolver(bcg);
+        
+        schurSolver(mat, source, sol);
+        vm().addSolverIterations(bcg.IterationsToComplete);
+        vm().addFlops(bcg.MatVecs*iterFlops());
+    };
+    envCreate(BatchSolverFn, getName(), Ls, solver);
+}
+
+// execution ///////////////////////////////////////////////////////////////////
+template <typename FImpl>
+void TRBPrecBlockCG<FImpl>::execute(void)
+{}
+
+END_MODULE_NAMESPACE
+
+END_HADRONS_NAMESPACE
+
+#endif // Hadrons_MSolver_RBPrecBlockCG_hpp_
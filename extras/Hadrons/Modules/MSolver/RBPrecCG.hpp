@@ -115,12 +115,22 @@ void TRBPrecCG<FImpl>::setup(void)
 
     auto Ls     = env().getObjectLs(par().action);
     auto &mat   = envGet(FMat, par().action);
-    auto solver = [&mat, this](FermionField &sol, const FermionField &source)
+    // flop estimate for the run time profile: one iteration applies the 
+    // preconditioned operator and its adjoint, i.e. two full-volume hopping
+    // terms at 1344 flops per site
+    auto iterFlops = [&mat](void)
+    {
+        return 2.*1344.*mat.FermionGrid()->gSites();
+    };
+    auto solver = [&mat, iterFlops, this](FermionField &sol,
+                                          const FermionField &source)
     {
         ConjugateGradient<FermionField>           cg(par().residual, 10000);
         SchurRedBlackDiagMooeeSolve<FermionField> schurSolver(cg);
         
         schurSolver(mat, source, sol);
+        vm().addSolverIterations(cg.IterationsToComplete);
+        vm().addFlops(cg.IterationsToComplete*iterFlops());
     };
     envCreate(SolverFn, getName(), Ls, solver);
 }
@@ -128,6 +128,8 @@ void TSeqGamma<FImpl>::setup(void)
     envCacheLat(Lattice<iScalar<vInteger>>, tName_);
     envCacheLat(LatticeComplex, momphName_);
     envTmpLat(LatticeComplex, "coor");
+    // the cached phase may have been freed since the last execution
+    hasPhase_ = false;
 }
 
 // execution ///////////////////////////////////////////////////////////////////
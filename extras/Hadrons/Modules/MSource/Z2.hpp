@@ -75,6 +75,8 @@ public:
     // dependency relation
     virtual std::vector<std::string> getInput(void);
     virtual std::vector<std::string> getOutput(void);
+    // random number generator
+    virtual bool usesRng(void) {return true;};
 protected:
     // setup
     virtual void setup(void);
@@ -122,6 +124,8 @@ void TZ2<FImpl>::setup(void)
     envCreateLat(PropagatorField, getName());
     envCacheLat(Lattice<iScalar<vInteger>>, tName_);
     envTmpLat(LatticeComplex, "eta");
+    // the cached coordinate may have been freed since the last execution
+    hasT_ = false;
 }
 
 // execution ///////////////////////////////////////////////////////////////////
@@ -0,0 +1,140 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid 
+
+Source file: extras/Hadrons/Modules/MUtilities/RandomVectors.hpp
+
+Copyright (C) 2015-2018
+
+Author: Antonin Portelli <antonin.portelli@me.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution directory
+*************************************************************************************/
+/*  END LEGAL */
+
+#ifndef Hadrons_MUtilities_RandomVectors_hpp_
+#define Hadrons_MUtilities_RandomVectors_hpp_
+
+#include <Grid/Hadrons/Global.hpp>
+#include <Grid/Hadrons/Module.hpp>
+#include <Grid/Hadrons/ModuleFactory.hpp>
+
+BEGIN_HADRONS_NAMESPACE
+
+/*
+ 
+ Set of random fermion fields
+ -----------------------------
+ 
+ * options:
+ - size: number of fields (unsigned int)
+
+ The fields are drawn from the Gaussian distribution of the 4D parallel RNG
+ and are stored as a std::vector<FermionField>, the type used for the 
+ vector sets of all-to-all modules (e.g. MContraction::A2AMesonField).
+*/
+
+/******************************************************************************
+ *                              RandomVectors                                 *
+ ******************************************************************************/
+BEGIN_MODULE_NAMESPACE(MUtilities)
+
+class RandomVectorsPar: Serializable
+{
+public:
+    GRID_SERIALIZABLE_CLASS_MEMBERS(RandomVectorsPar,
+                                    unsigned int, size);
+};
+
+template <typename FImpl>
+class TRandomVectors: public Module<RandomVectorsPar>
+{
+public:
+    FERM_TYPE_ALIASES(FImpl,);
+public:
+    // constructor
+    TRandomVectors(const std::string name);
+    // destructor
+    virtual ~TRandomVectors(void) = default;
+    // dependency relation
+    virtual std::vector<std::string> getInput(void);
+    virtual std::vector<std::string> getOutput(void);
+    // random number generator
+    virtual bool usesRng(void) {return true;};
+protected:
+    // setup
+    virtual void setup(void);
+    // execution
+    virtual void execute(void);
+};
+
+MODULE_REGISTER_NS(RandomVectors, TRandomVectors<FIMPL>, MUtilities);
+
+/******************************************************************************
+ *                      TRandomVectors implementation                         *
+ ******************************************************************************/
+// constructor /////////////////////////////////////////////////////////////////
+template <typename FImpl>
+TRandomVectors<FImpl>::TRandomVectors(const std::string name)
+: Module<RandomVectorsPar>(name)
+{}
+
+// dependencies/products ///////////////////////////////////////////////////////
+template <typename FImpl>
+std::vector<std::string> TRandomVectors<FImpl>::getInput(void)
+{
+    std::vector<std::string> in;
+    
+    return in;
+}
+
+template <typename FImpl>
+std::vector<std::string> TRandomVectors<FImpl>::getOutput(void)
+{
+    std::vector<std::string> out = {getName()};
+    
+    return out;
+}
+
+// setup ///////////////////////////////////////////////////////////////////////
+template <typename FImpl>
+void TRandomVectors<FImpl>::setup(void)
+{
+    envCreate(std::vector<FermionField>, getName(), 1, par().size,
+              FermionField(env().getGrid()));
+}
+
+// execution ///////////////////////////////////////////////////////////////////
+template <typename FImpl>
+void TRandomVectors<FImpl>::execute(void)
+{
+    LOG(Message) << "Generating " << par().size << " random fermion fields"
+                 << std::endl;
+
+    auto &vec = envGet(std::vector<FermionField>, getName());
+
+    for (auto &v: vec)
+    {
+        gaussian(*env().get4dRng(), v);
+    }
+}
+
+END_MODULE_NAMESPACE
+
+END_HADRONS_NAMESPACE
+
+#endif // Hadrons_MUtilities_RandomVectors_hpp_
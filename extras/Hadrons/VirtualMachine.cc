@@ -28,7 +28,9 @@ See the full license in the file "LICENSE" in the top level distribution directo
 
 #include <Grid/Hadrons/VirtualMachine.hpp>
 #include <Grid/Hadrons/GeneticScheduler.hpp>
+#include <Grid/Hadrons/ListScheduler.hpp>
 #include <Grid/Hadrons/ModuleFactory.hpp>
+#include <sys/resource.h>
 
 using namespace Grid;
 using namespace QCD;
@@ -371,8 +373,9 @@ void VirtualMachine::resizeProfile(void)
     {
         MemoryPrint empty;
 
-        empty.size   = 0;
-        empty.module = -1;
+        empty.size       = 0;
+        empty.module     = -1;
+        empty.splittable = false;
         profile_.object.resize(env().getMaxAddress(), empty);
     }
 }
@@ -384,9 +387,10 @@ void VirtualMachine::updateProfile(const unsigned int address)
     {
         if (env().hasCreatedObject(a) and (profile_.object[a].module == -1))
         {
-            profile_.object[a].size     = env().getObjectSize(a);
-            profile_.object[a].storage  = env().getObjectStorage(a);
-            profile_.object[a].module   = address;
+            profile_.object[a].size       = env().getObjectSize(a);
+            profile_.object[a].storage    = env().getObjectStorage(a);
+            profile_.object[a].module     = address;
+            profile_.object[a].splittable = env().isObjectSplittable(a);
             profile_.module[address][a] = profile_.object[a].size;
             if (env().getObjectModule(a) < 0)
             {
@@ -442,10 +446,23 @@ void VirtualMachine::memoryProfile(const std::string name)
 
 // garbage collector ///////////////////////////////////////////////////////////
 VirtualMachine::GarbageSchedule 
-VirtualMachine::makeGarbageSchedule(const Program &p) const
+VirtualMachine::makeGarbageSchedule(const Program &p, const bool split) const
 {
-    GarbageSchedule freeProg;
+    GarbageSchedule                        freeProg;
+    std::vector<std::vector<unsigned int>> in(module_.size());
     
+    // with split execution, lattices used to rebuild the dependencies of a
+    // module are inputs too
+    for (unsigned int m = 0; m < module_.size(); ++m)
+    {
+        in[m] = module_[m].input;
+        if (split and isModuleSplittable(m))
+        {
+            Program rerun;
+
+            splitDependencies(m, rerun, in[m]);
+        }
+    }
     freeProg.resize(p.size());
     for (unsigned int a = 0; a < env().getMaxAddress(); ++a)
     {
@@ -460,12 +477,11 @@ VirtualMachine::makeGarbageSchedule(const Program &p) const
         }
         else if (env().getObjectStorage(a) == Environment::Storage::object)
         {
-            auto pred = [a, this](const unsigned int b)
+            auto pred = [a, &in, this](const unsigned int b)
             {
-                auto &in = module_[b].input;
-                auto it  = std::find(in.begin(), in.end(), a);
+                auto it = std::find(in[b].begin(), in[b].end(), a);
                 
-                return (it != in.end()) or (b == env().getObjectModule(a));
+                return (it != in[b].end()) or (b == env().getObjectModule(a));
             };
             auto it = std::find_if(p.rbegin(), p.rend(), pred);
             if (it != p.rend())
@@ -559,29 +575,1156 @@ VirtualMachine::Program VirtualMachine::schedule(const GeneticPar &par)
     return scheduler.getMinSchedule();
 }
 
+// list scheduler //////////////////////////////////////////////////////////////
+// the dependencies and memory model are built directly from the objects, so
+// neither the garbage schedule nor the module graph are recomputed
+VirtualMachine::Program VirtualMachine::schedule(const ListPar &par)
+{
+    typedef ListScheduler<Size, unsigned int> Scheduler;
+
+    const MemoryProfile                    &profile = getMemoryProfile();
+    std::vector<unsigned int>              vertex(getNModule());
+    std::vector<std::vector<unsigned int>> user(env().getMaxAddress());
+    std::vector<Scheduler::Object>         object;
+    Scheduler::Parameters                  lpar;
+    GridStopWatch                          timer;
+
+    LOG(Message) << "Scheduling computation..." << std::endl;
+    LOG(Message) << "               #module= " << getNModule() << std::endl;
+    LOG(Message) << "             lookahead= " << par.lookahead << std::endl;
+    LOG(Message) << "  max. local search it.= " << par.maxIter << std::endl;
+    timer.Start();
+    for (unsigned int m = 0; m < getNModule(); ++m)
+    {
+        vertex[m] = m;
+        for (auto a: module_[m].input)
+        {
+            user[a].push_back(m);
+        }
+    }
+    for (unsigned int a = 0; a < env().getMaxAddress(); ++a)
+    {
+        Scheduler::Object o;
+        int               m = env().getObjectModule(a);
+
+        if (m < 0)
+        {
+            continue;
+        }
+        o.producer = m;
+        o.user     = user[a];
+        o.size     = ((a < profile.object.size()) 
+                      and (profile.object[a].module >= 0)) 
+                     ? profile.object[a].size : 0;
+        switch (env().getObjectStorage(a))
+        {
+            case Environment::Storage::temporary:
+                o.lifetime = Scheduler::Lifetime::producer;
+                break;
+            case Environment::Storage::cache:
+                o.lifetime = Scheduler::Lifetime::never;
+                break;
+            default:
+                o.lifetime = Scheduler::Lifetime::lastUse;
+                break;
+        }
+        object.push_back(o);
+    }
+    lpar.lookahead = par.lookahead;
+    lpar.maxIter   = par.maxIter;
+
+    Scheduler scheduler(vertex, object, lpar);
+    Program   p = scheduler.getSchedule();
+
+    timer.Stop();
+    LOG(Message) << "Schedule found in " << timer.Elapsed() << " ("
+                 << scheduler.getNIter() << " local search iteration(s)), "
+                 << "memory peak " << sizeString(scheduler.getPeak()) 
+                 << std::endl;
+
+    return p;
+}
+
+// disk spilling ///////////////////////////////////////////////////////////////
+void VirtualMachine::setMemoryBudget(const Size budget)
+{
+    memoryBudget_ = budget;
+}
+
+VirtualMachine::Size VirtualMachine::getMemoryBudget(void) const
+{
+    return memoryBudget_;
+}
+
+// memory allocated by a module (outputs and temporaries), from the profile
+VirtualMachine::Size VirtualMachine::stepMemory(const unsigned int address) const
+{
+    Size size = 0;
+    
+    if (!memoryProfileOutdated_)
+    {
+        for (auto &o: profile_.module[address])
+        {
+            size += o.second;
+        }
+    }
+    
+    return size;
+}
+
+// first step after i using object a as an input, p.size() if none
+unsigned int VirtualMachine::nextUse(const Program &p, const unsigned int i,
+                                     const unsigned int a) const
+{
+    for (unsigned int j = i + 1; j < p.size(); ++j)
+    {
+        auto &in = module_[p[j]].input;
+        
+        if (std::find(in.begin(), in.end(), a) != in.end())
+        {
+            return j;
+        }
+    }
+    
+    return p.size();
+}
+
+// spill objects until step i fits in the budget with `need` more bytes,
+// evicting first the object whose next use is the furthest away
+void VirtualMachine::makeRoom(const Program &p, const unsigned int i,
+                              const Size need) const
+{
+    auto &in = module_[p[i]].input;
+    
+    while (env().getTotalSize() + need > memoryBudget_)
+    {
+        int          victim = -1;
+        unsigned int far    = i;
+        
+        for (unsigned int a = 0; a < env().getMaxAddress(); ++a)
+        {
+            if (env().isObjectSpillable(a) and !env().isObjectSpilled(a) and
+                (std::find(in.begin(), in.end(), a) == in.end()))
+            {
+                unsigned int n = nextUse(p, i, a);
+                
+                if ((victim < 0) or (n > far) or ((n == far) and 
+                    (env().getObjectSize(a) > env().getObjectSize(victim))))
+                {
+                    victim = a;
+                    far    = n;
+                }
+            }
+        }
+        if (victim < 0)
+        {
+            LOG(Warning) << "memory budget of " << sizeString(memoryBudget_)
+                         << " exceeded by module '" << module_[p[i]].name
+                         << "' and nothing left to spill" << std::endl;
+            break;
+        }
+        LOG(Message) << "Memory budget: spilling '" 
+                     << env().getObjectName(victim) << "' (next use "
+                     << ((far < p.size()) ? "at step " + std::to_string(far + 1)
+                                          : std::string("none")) 
+                     << ")" << std::endl;
+        env().spillObject(victim);
+    }
+}
+
+// split execution /////////////////////////////////////////////////////////////
+// a module can run on a split grid if all its outputs are lattices which can be
+// gathered back on the full grid (declared outputs never created are ignored).
+// Caches hold module state (e.g. a momentum phase computed once), so they have
+// to be lattices too, for the module and for the modules rebuilt for it.
+// Modules drawing random numbers run on the full grid, in program order.
+bool VirtualMachine::isModuleSplittable(const unsigned int address) const
+{
+    Program                   rerun;
+    std::vector<unsigned int> lat;
+
+    if (memoryProfileOutdated_ or module_[address].data->usesRng())
+    {
+        return false;
+    }
+    for (auto a: splitOutput(address))
+    {
+        if (!profile_.object[a].splittable)
+        {
+            return false;
+        }
+    }
+    splitDependencies(address, rerun, lat);
+    for (auto m: rerun)
+    {
+        if (module_[m].data->usesRng())
+        {
+            return false;
+        }
+        for (auto a: splitCache(m))
+        {
+            if (!profile_.object[a].splittable)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+std::vector<unsigned int> 
+VirtualMachine::splitOutput(const unsigned int address) const
+{
+    std::vector<unsigned int> out;
+
+    for (auto &o: module_[address].data->getOutput())
+    {
+        auto a = env().getObjectAddress(o);
+
+        if ((a < profile_.object.size()) and (profile_.object[a].module >= 0))
+        {
+            out.push_back(a);
+        }
+    }
+    for (auto a: splitCache(address))
+    {
+        out.push_back(a);
+    }
+
+    return out;
+}
+
+std::vector<unsigned int> 
+VirtualMachine::splitCache(const unsigned int address) const
+{
+    std::vector<unsigned int> cache;
+
+    for (auto &o: profile_.module[address])
+    {
+        if (profile_.object[o.first].storage == Environment::Storage::cache)
+        {
+            cache.push_back(o.first);
+        }
+    }
+
+    return cache;
+}
+
+// group the program into batches of modules of the same type which do not
+// depend on each other, a batch being moved up to the position of its first
+// module (the result is still a valid topological order)
+std::vector<VirtualMachine::Program> 
+VirtualMachine::makeBatches(const Program &p) const
+{
+    std::vector<Program>   batch;
+    std::vector<bool>      inBatch(p.size(), false);
+    std::set<unsigned int> done;
+    unsigned int           nGroup = env().getNSplitGroup();
+    auto                   ready  = [this, &done](const unsigned int m)
+    {
+        for (auto &in: module_[m].input)
+        {
+            if (done.find(env().getObjectModule(in)) == done.end())
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    for (unsigned int i = 0; i < p.size(); ++i)
+    {
+        if (!inBatch[i])
+        {
+            Program b = {p[i]};
+
+            inBatch[i] = true;
+            if (isModuleSplittable(p[i]))
+            {
+                for (unsigned int j = i + 1; (j < p.size()) and (b.size() < nGroup); ++j)
+                {
+                    if (!inBatch[j] and (module_[p[j]].type == module_[p[i]].type)
+                        and isModuleSplittable(p[j]) and ready(p[j]))
+                    {
+                        b.push_back(p[j]);
+                        inBatch[j] = true;
+                    }
+                }
+            }
+            done.insert(b.begin(), b.end());
+            batch.push_back(b);
+        }
+    }
+
+    return batch;
+}
+
+// lattice inputs are redistributed on the split grids, other inputs (actions,
+// solvers, ...) are rebuilt by running again the modules producing them (the
+// garbage collector keeps the lattices they need alive).
+// Repeated lattice inputs are kept so that modules of the same type have the
+// same input list whatever their parameters.
+void VirtualMachine::splitDependencies(const unsigned int address, 
+                                       Program &rerun,
+                                       std::vector<unsigned int> &lat) const
+{
+    for (auto a: module_[address].input)
+    {
+        if ((a < profile_.object.size()) and profile_.object[a].splittable)
+        {
+            lat.push_back(a);
+        }
+        else
+        {
+            int m = env().getObjectModule(a);
+
+            if (m < 0)
+            {
+                HADRON_ERROR(Definition, "object '" + env().getObjectName(a)
+                             + "' is not produced by any module");
+            }
+            if (std::find(rerun.begin(), rerun.end(), m) == rerun.end())
+            {
+                splitDependencies(m, rerun, lat);
+                rerun.push_back(m);
+            }
+        }
+    }
+}
+
+void VirtualMachine::executeBatch(const Program &b) const
+{
+    unsigned int                           nGroup = env().getNSplitGroup();
+    unsigned int                           group  = env().getSplitGroup();
+    std::vector<Program>                   rerun(b.size());
+    std::vector<std::vector<unsigned int>> lat(b.size()), in, out;
+    bool                                   match = true;
+
+    // the k-th lattice inputs of all groups are redistributed together, so
+    // they must have the same type
+    for (unsigned int g = 0; g < b.size(); ++g)
+    {
+        splitDependencies(b[g], rerun[g], lat[g]);
+        for (auto m: rerun[g])
+        {
+            for (auto a: splitCache(m))
+            {
+                if (env().hasCreatedObject(a))
+                {
+                    lat[g].push_back(a);
+                }
+            }
+        }
+        for (auto a: splitCache(b[g]))
+        {
+            if (env().hasCreatedObject(a))
+            {
+                lat[g].push_back(a);
+            }
+        }
+        match = match and (lat[g].size() == lat[0].size());
+        for (unsigned int k = 0; match and (k < lat[g].size()); ++k)
+        {
+            match = (env().getObjectType(lat[g][k]) == env().getObjectType(lat[0][k]))
+                    and (env().getObjectLs(lat[g][k]) == env().getObjectLs(lat[0][k]));
+        }
+    }
+    if (!match)
+    {
+        std::string names;
+
+        for (auto m: b)
+        {
+            names += " '" + module_[m].name + "'";
+        }
+        LOG(Warning) << "modules" << names << " have different inputs, "
+                     << "running them sequentially" << std::endl;
+        for (auto m: b)
+        {
+            (*module_[m].data)();
+        }
+
+        return;
+    }
+    in.resize(lat[0].size());
+    for (unsigned int k = 0; k < in.size(); ++k)
+    {
+        for (unsigned int g = 0; g < nGroup; ++g)
+        {
+            in[k].push_back(lat[(g < b.size()) ? g : 0][k]);
+        }
+    }
+    out.resize(splitOutput(b[0]).size());
+    for (unsigned int g = 0; g < b.size(); ++g)
+    {
+        auto o = splitOutput(b[g]);
+
+        for (unsigned int k = 0; k < out.size(); ++k)
+        {
+            out[k].push_back(o[k]);
+        }
+    }
+    LOG(Message) << "Running " << b.size() << " module(s) on " << nGroup
+                 << " split group(s):" << std::endl;
+    for (unsigned int g = 0; g < b.size(); ++g)
+    {
+        LOG(Message) << "  group " << g << ": '" << module_[b[g]].name << "' ("
+                     << lat[g].size() << " input(s) redistributed, "
+                     << rerun[g].size() << " module(s) rebuilt)" << std::endl;
+    }
+    env().enterSplit(in);
+    // groups without a module only set up the outputs of the first one, the 
+    // result is discarded but they have to take part in the gathering
+    unsigned int me = (group < b.size()) ? group : 0;
+
+    for (auto m: rerun[me])
+    {
+        (*module_[m].data)();
+    }
+    if (group < b.size())
+    {
+        (*module_[b[me]].data)();
+    }
+    else
+    {
+        module_[b[me]].data->setup();
+    }
+    env().leaveSplit(out);
+}
+
+// run time profile ////////////////////////////////////////////////////////////
+void VirtualMachine::setProfileOutput(const std::string output)
+{
+    profileOutput_ = output;
+}
+
+// flops are the total over all processes and must be reported identically by
+// all the processes running the module
+void VirtualMachine::addFlops(const double flops)
+{
+    flops_ += flops;
+}
+
+void VirtualMachine::addSolverIterations(const unsigned int n)
+{
+    solverIterations_ += n;
+}
+
+const std::vector<VirtualMachine::ModuleRecord> & 
+VirtualMachine::getRunProfile(void) const
+{
+    return runProfile_;
+}
+
+void VirtualMachine::recordStep(const Program &p, const unsigned int i,
+                                const unsigned int batch, const double time,
+                                const Size peakMemory)
+{
+    std::vector<RealD> counter(2*batch, 0.);
+    struct rusage      usage;
+    double             maxRss;
+
+    // in a split batch each group only counted its own module, the counters
+    // are gathered from all groups
+    if (batch > 1)
+    {
+        auto         grid  = env().getGrid();
+        unsigned int group = env().getSplitGroup();
+
+        if (group < batch)
+        {
+            counter[2*group]     = flops_;
+            counter[2*group + 1] = solverIterations_;
+        }
+        grid->GlobalSumVector(counter.data(), counter.size());
+        for (auto &c: counter)
+        {
+            c *= static_cast<double>(env().getNSplitGroup())
+                 /grid->ProcessorCount();
+        }
+    }
+    else
+    {
+        counter[0] = flops_;
+        counter[1] = solverIterations_;
+    }
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    maxRss = usage.ru_maxrss;
+#else
+    maxRss = usage.ru_maxrss*1024.;
+#endif
+    for (unsigned int j = 0; j < batch; ++j)
+    {
+        ModuleRecord r;
+        unsigned int m = p[i + j];
+
+        r.name             = module_[m].name;
+        r.type             = getModuleType(m);
+        r.step             = i + j;
+        r.batch            = batch;
+        r.time             = time;
+        r.flops            = counter[2*j];
+        r.solverIterations = static_cast<unsigned int>(counter[2*j + 1] + .5);
+        r.bytes            = 0.;
+        for (auto a: module_[m].input)
+        {
+            r.bytes += env().getObjectSize(a);
+        }
+        for (auto &o: module_[m].data->getOutput())
+        {
+            if (env().hasCreatedObject(o))
+            {
+                r.bytes += env().getObjectSize(o);
+            }
+        }
+        r.memory           = env().getTotalSize();
+        r.peakMemory       = peakMemory;
+        r.maxRss           = maxRss;
+        runProfile_.push_back(r);
+    }
+    double nIter = 0.;
+
+    for (unsigned int j = 0; j < batch; ++j)
+    {
+        nIter += counter[2*j + 1];
+    }
+    if (nIter > 0.)
+    {
+        LOG(Message) << "Solver iterations: " << nIter << std::endl;
+    }
+    LOG(Message) << "Module time: " << time << " s, peak memory: " 
+                 << sizeString(peakMemory) << std::endl;
+}
+
+void VirtualMachine::printRunProfile(void) const
+{
+    std::vector<const ModuleRecord *> order;
+    double                            total = 0.;
+
+    // batched modules share their wall time, it is only counted once
+    for (auto &r: runProfile_)
+    {
+        order.push_back(&r);
+        total += r.time/r.batch;
+    }
+    std::stable_sort(order.begin(), order.end(), 
+                     [](const ModuleRecord *a, const ModuleRecord *b)
+    {
+        return (a->time > b->time);
+    });
+    LOG(Message) << "Run time profile (" << runProfile_.size() 
+                 << " modules, " << total << " s):" << std::endl;
+    LOG(Message) << std::right << std::setw(10) << "time (s)" 
+                 << std::setw(7) << "%" << std::setw(10) << "GFlop/s" 
+                 << std::setw(7) << "iter." << std::setw(11) << "in+out" 
+                 << std::setw(11) << "peak" << "  module" << std::endl;
+    for (auto r: order)
+    {
+        std::ostringstream line;
+        double             gflops = (r->time > 0.) ? r->flops/r->time*1.0e-9 : 0.;
+
+        line << std::right << std::fixed << std::setprecision(3)
+             << std::setw(10) << r->time << std::setprecision(1) 
+             << std::setw(7) << 100.*r->time/r->batch/total 
+             << std::setprecision(2) << std::setw(10) << gflops 
+             << std::setw(7) << r->solverIterations
+             << std::setw(11) << sizeString(static_cast<Size>(r->bytes))
+             << std::setw(11) << sizeString(static_cast<Size>(r->peakMemory))
+             << "  " << r->name << " (" << r->type << ")";
+        LOG(Message) << line.str() << std::endl;
+    }
+}
+
+void VirtualMachine::writeRunProfile(void) const
+{
+    std::string filename = profileOutput_ + "." + std::to_string(traj_) 
+                           + ".xml";
+
+    if (env().getGrid()->IsBoss())
+    {
+        XmlWriter writer(filename);
+
+        write(writer, "profile", runProfile_);
+    }
+    LOG(Message) << "Run time profile saved in '" << filename << "'"
+                 << std::endl;
+}
+
+// checkpointing ///////////////////////////////////////////////////////////////
+void VirtualMachine::setCheckpointPar(const CheckpointPar &par)
+{
+    checkpointPar_ = par;
+}
+
+std::string VirtualMachine::checkpointFileName(void) const
+{
+    return checkpointPar_.directory + "/checkpoint." + std::to_string(traj_)
+           + ".xml";
+}
+
+std::string VirtualMachine::checkpointFileName(const std::string objName) const
+{
+    return checkpointPar_.directory + "/" + objName + "." 
+           + std::to_string(traj_) + ".bin";
+}
+
+// setup only (allocation of the outputs), the modules producing missing 
+// inputs are set up first
+void VirtualMachine::setupForRestart(const unsigned int address)
+{
+    auto m = getModule(address);
+
+    try
+    {
+        m->setup();
+    }
+    catch (Exceptions::Definition &)
+    {
+        for (auto in: module_[address].input)
+        {
+            if (!env().hasCreatedObject(in) and (env().getObjectModule(in) >= 0))
+            {
+                setupForRestart(env().getObjectModule(in));
+            }
+        }
+        m->setup();
+    }
+}
+
+// returns the part of p still to execute. The inputs of these modules that
+// were produced before the checkpoint are read back if their checksums match,
+// the other ones are rebuilt by running their modules (and recursively the
+// modules producing the inputs of those) again.
+VirtualMachine::Program VirtualMachine::restart(const Program &p)
+{
+    std::string                          filename = checkpointFileName();
+    Checkpoint                           ck;
+    std::set<unsigned int>               done, needed, restored, rerun;
+    std::map<unsigned int, unsigned int> entry;
+    Program                              rem;
+    GridStopWatch                        timer;
+    Size                                 bytes = 0;
+
+    executed_.clear();
+    checkpoint_.clear();
+    rngCheckpoint_ = CheckpointObject();
+    if (!checkpointPar_.restart or !std::ifstream(filename).good())
+    {
+        return p;
+    }
+    {
+        XmlReader reader(filename);
+
+        read(reader, "checkpoint", ck);
+    }
+    for (auto &name: ck.executed)
+    {
+        if (!hasModule(name))
+        {
+            LOG(Warning) << "checkpoint '" << filename << "' refers to unknown"
+                         << " module '" << name << "', ignored" << std::endl;
+            return p;
+        }
+        executed_.push_back(getModuleAddress(name));
+        done.insert(executed_.back());
+    }
+    for (auto m: p)
+    {
+        if (done.find(m) == done.end())
+        {
+            rem.push_back(m);
+        }
+    }
+    LOG(Message) << "Restarting from checkpoint '" << filename << "' ("
+                 << p.size() - rem.size() << "/" << p.size() 
+                 << " modules executed)" << std::endl;
+    if (rem.empty())
+    {
+        return rem;
+    }
+    timer.Start();
+    for (auto m: rem)
+    for (auto in: module_[m].input)
+    {
+        int producer = env().getObjectModule(in);
+
+        if ((producer >= 0) and (done.find(producer) != done.end()))
+        {
+            needed.insert(in);
+        }
+    }
+    for (unsigned int i = 0; i < ck.object.size(); ++i)
+    {
+        if (env().hasObject(ck.object[i].name))
+        {
+            entry[env().getObjectAddress(ck.object[i].name)] = i;
+        }
+    }
+
+    // allocate the checkpointed objects through the setup of their modules,
+    // then read them
+    bool protect = env().objectsProtected();
+    bool hmsg    = HadronsLogMessage.isActive();
+    bool gmsg    = GridLogMessage.isActive();
+
+    env().protectObjects(false);
+    GridLogMessage.Active(false);
+    HadronsLogMessage.Active(false);
+    for (auto a: needed)
+    {
+        if ((entry.find(a) != entry.end()) and 
+            !ck.object[entry[a]].file.empty() and !env().hasCreatedObject(a))
+        {
+            setupForRestart(env().getObjectModule(a));
+        }
+    }
+    env().protectObjects(protect);
+    GridLogMessage.Active(gmsg);
+    HadronsLogMessage.Active(hmsg);
+    for (auto a: needed)
+    {
+        if ((entry.find(a) == entry.end()) or ck.object[entry[a]].file.empty()
+            or !env().isObjectCheckpointable(a))
+        {
+            continue;
+        }
+
+        auto &o = ck.object[entry[a]];
+
+        if (env().restoreObject(a, o.file, o.checksum))
+        {
+            restored.insert(a);
+            checkpoint_[a] = o;
+            bytes         += env().getObjectSize(a);
+            LOG(Message) << "Restored object '" << o.name << "' from '" 
+                         << o.file << "'" << std::endl;
+        }
+        else
+        {
+            LOG(Warning) << "checkpoint file '" << o.file << "' of object '"
+                         << o.name << "' is missing or corrupted, the object"
+                         << " will be recomputed" << std::endl;
+        }
+    }
+
+    // modules to run again
+    std::function<void(const unsigned int)> rebuild = [&](const unsigned int a)
+    {
+        int m = env().getObjectModule(a);
+
+        if (restored.find(a) != restored.end())
+        {
+            return;
+        }
+        if ((m < 0) or (done.find(m) == done.end()))
+        {
+            HADRON_ERROR(Definition, "cannot rebuild object '" 
+                         + env().getObjectName(a) + "' from checkpoint");
+        }
+        if (rerun.insert(m).second)
+        {
+            for (auto in: module_[m].input)
+            {
+                rebuild(in);
+            }
+        }
+    };
+    for (auto a: needed)
+    {
+        rebuild(a);
+    }
+    // the generator state of the checkpoint is the one after the executed
+    // modules: without it the modules still to run would not draw the random
+    // numbers of an uninterrupted run, and a module drawing random numbers
+    // cannot be run again from it; in both cases the trajectory is run again
+    // from the start (checkpoints written without the state are resumed
+    // without it)
+    auto fromStart = [this, &p](const std::string reason)
+    {
+        LOG(Warning) << reason << ", the trajectory is run again from the start"
+                     << std::endl;
+        for (unsigned int a = 0; a < env().getMaxAddress(); ++a)
+        {
+            if (env().hasCreatedObject(a))
+            {
+                env().freeObject(a);
+            }
+        }
+        executed_.clear();
+        checkpoint_.clear();
+
+        return p;
+    };
+
+    for (auto m: executed_)
+    {
+        if ((rerun.find(m) != rerun.end()) and module_[m].data->usesRng())
+        {
+            return fromStart("module '" + module_[m].name + "' draws random "
+                             + "numbers and has to be run again");
+        }
+    }
+    if (!ck.rng.file.empty())
+    {
+        if (!env().restoreRng(ck.rng.file, ck.rng.checksum))
+        {
+            return fromStart("checkpoint file '" + ck.rng.file + "' of the "
+                             + "random number generator is missing or "
+                             + "corrupted");
+        }
+        rngCheckpoint_ = ck.rng;
+        LOG(Message) << "Restored random number generator from '" 
+                     << ck.rng.file << "'" << std::endl;
+    }
+    for (unsigned int a = 0; a < env().getMaxAddress(); ++a)
+    {
+        if (env().hasCreatedObject(a) and 
+            ((restored.find(a) == restored.end()) or 
+             (rerun.find(env().getObjectModule(a)) != rerun.end())))
+        {
+            env().freeObject(a);
+            checkpoint_.erase(a);
+        }
+    }
+    for (auto m: executed_)
+    {
+        if (rerun.find(m) != rerun.end())
+        {
+            LOG(Message) << "Running module '" << module_[m].name 
+                         << "' again" << std::endl;
+            (*module_[m].data)();
+        }
+    }
+    for (unsigned int a = 0; a < env().getMaxAddress(); ++a)
+    {
+        if (env().hasCreatedObject(a) and (needed.find(a) == needed.end()))
+        {
+            env().freeObject(a);
+        }
+    }
+    // the files of the objects not read back are never used again, a crash
+    // before the next checkpoint just means rebuilding the objects again
+    if (env().getGrid()->IsBoss())
+    {
+        std::set<std::string> keep;
+
+        for (auto &o: checkpoint_)
+        {
+            keep.insert(o.second.file);
+        }
+        for (auto &o: ck.object)
+        {
+            if (!o.file.empty() and (keep.find(o.file) == keep.end()))
+            {
+                std::remove(o.file.c_str());
+            }
+        }
+    }
+    timer.Stop();
+    LOG(Message) << "Restart: " << restored.size() << " object(s) read (" 
+                 << sizeString(bytes) << "), " << rerun.size() 
+                 << " module(s) run again, in " << timer.Elapsed() << std::endl;
+
+    return rem;
+}
+
+// objects do not change once their module has run, so an object already in
+// the previous checkpoint is not written again. The XML file is renamed into
+// place at the end, a crash while checkpointing leaves the previous one valid.
+void VirtualMachine::writeCheckpoint(const bool final)
+{
+    std::string                              filename = checkpointFileName();
+    Checkpoint                               ck;
+    std::map<unsigned int, CheckpointObject> current;
+    GridStopWatch                            timer;
+    unsigned int                             nWrite = 0;
+    Size                                     bytes = 0;
+    bool                                     boss = env().getGrid()->IsBoss();
+
+    timer.Start();
+    ck.trajectory = traj_;
+    for (auto m: executed_)
+    {
+        ck.executed.push_back(module_[m].name);
+    }
+    for (unsigned int a = 0; (a < env().getMaxAddress()) and !final; ++a)
+    {
+        if (!env().hasCreatedObject(a) or 
+            (env().getObjectStorage(a) == Environment::Storage::temporary))
+        {
+            continue;
+        }
+
+        auto             it = checkpoint_.find(a);
+        CheckpointObject o;
+
+        if ((it != checkpoint_.end()) and !it->second.file.empty())
+        {
+            o = it->second;
+        }
+        else
+        {
+            o.name = env().getObjectName(a);
+            if (env().isObjectCheckpointable(a))
+            {
+                o.file = checkpointFileName(o.name);
+                env().checkpointObject(a, o.file, o.checksum);
+                nWrite++;
+                bytes += env().getObjectSize(a);
+            }
+        }
+        current[a] = o;
+        ck.object.push_back(o);
+    }
+    // the generator state only changes with the modules drawing random
+    // numbers, the file is named after their count and written once
+    if (!final)
+    {
+        unsigned int nRng = 0;
+
+        for (auto m: executed_)
+        {
+            nRng += module_[m].data->usesRng() ? 1 : 0;
+        }
+        ck.rng.name = "rng";
+        ck.rng.file = checkpointFileName("rng." + std::to_string(nRng));
+        if (ck.rng.file == rngCheckpoint_.file)
+        {
+            ck.rng = rngCheckpoint_;
+        }
+        else
+        {
+            env().checkpointRng(ck.rng.file, ck.rng.checksum);
+            nWrite++;
+        }
+    }
+    if (boss)
+    {
+        {
+            XmlWriter writer(filename + ".tmp");
+
+            write(writer, "checkpoint", ck);
+        }
+        std::rename((filename + ".tmp").c_str(), filename.c_str());
+        for (auto &o: checkpoint_)
+        {
+            if ((current.find(o.first) == current.end()) and 
+                !o.second.file.empty())
+            {
+                std::remove(o.second.file.c_str());
+            }
+        }
+        if (!rngCheckpoint_.file.empty() and (rngCheckpoint_.file != ck.rng.file))
+        {
+            std::remove(rngCheckpoint_.file.c_str());
+        }
+    }
+    env().getGrid()->Barrier();
+    checkpoint_    = current;
+    rngCheckpoint_ = ck.rng;
+    timer.Stop();
+    LOG(Message) << "Checkpoint '" << filename << "': " << ck.executed.size()
+                 << " module(s) executed, " << ck.object.size() 
+                 << " object(s), " << nWrite << " written (" 
+                 << sizeString(bytes) << ") in " << timer.Elapsed() 
+                 << std::endl;
+}
+
 // general execution ///////////////////////////////////////////////////////////
 #define BIG_SEP "==============="
 #define SEP     "---------------"
 #define MEM_MSG(size) sizeString(size)
 
-void VirtualMachine::executeProgram(const Program &p) const
+void VirtualMachine::executeProgram(const Program &program)
 {
-    Size            memPeak = 0, sizeBefore, sizeAfter;
-    GarbageSchedule freeProg;
+    Size                      memPeak = 0, sizeBefore, sizeAfter;
+    GarbageSchedule           freeProg;
+    Program                   p = program;
+    bool                      split = (env().getNSplitGroup() > 1);
+    bool                      spill = (memoryBudget_ > 0);
+    bool                      checkpoint = !checkpointPar_.directory.empty();
+    std::vector<unsigned int> prefetch;
+    std::future<void>         prefetchIo;
+    GridStopWatch             prefetchTimer, checkpointTimer;
+    unsigned int              nPrefetch = 0, nDemand = 0, nRestored;
     
+    // skip the modules already executed in a previous run
+    executed_.clear();
+    checkpoint_.clear();
+    rngCheckpoint_ = CheckpointObject();
+    if (checkpoint)
+    {
+        p = restart(program);
+        if (p.empty())
+        {
+            LOG(Message) << "All modules already executed for trajectory " 
+                         << traj_ << std::endl;
+            return;
+        }
+    }
+    nRestored = executed_.size();
+    
+    std::vector<unsigned int> batchSize(p.size(), 1);
+    
+    // group independent modules for split execution, batchSize[i] is the 
+    // number of modules run at step i (0 if already run in a batch)
+    if (split)
+    {
+        if (spill)
+        {
+            LOG(Warning) << "memory budget ignored with split execution"
+                         << std::endl;
+            spill = false;
+        }
+        if (memoryProfileOutdated_)
+        {
+            LOG(Warning) << "no memory profile, split execution disabled"
+                         << std::endl;
+        }
+        Program todo = p;
+        
+        p.clear();
+        for (auto &b: makeBatches(todo))
+        {
+            batchSize[p.size()] = b.size();
+            for (unsigned int j = 1; j < b.size(); ++j)
+            {
+                batchSize[p.size() + j] = 0;
+            }
+            p.insert(p.end(), b.begin(), b.end());
+        }
+    }
     // build garbage collection schedule
     LOG(Debug) << "Building garbage collection schedule..." << std::endl;
-    freeProg = makeGarbageSchedule(p);
+    freeProg = makeGarbageSchedule(p, split);
+    runProfile_.clear();
+    checkpointTimer.Start();
 
     // program execution
     LOG(Debug) << "Executing program..." << std::endl;
     for (unsigned int i = 0; i < p.size(); ++i)
     {
-        // execute module
         LOG(Message) << SEP << " Measurement step " << i + 1 << "/"
                      << p.size() << " (module '" << module_[p[i]].name
                      << "') " << SEP << std::endl;
-        (*module_[p[i]].data)();
+        if (spill)
+        {
+            Size need = stepMemory(p[i]), next = 0;
+            
+            // inputs still on disk (not prefetched) are reloaded now
+            for (auto a: module_[p[i]].input)
+            {
+                if (env().isObjectSpilled(a))
+                {
+                    need += env().getObjectSize(a);
+                }
+            }
+            makeRoom(p, i, need);
+            for (auto a: module_[p[i]].input)
+            {
+                if (env().isObjectSpilled(a))
+                {
+                    env().reloadObject(a);
+                    nDemand++;
+                }
+            }
+            // read the spilled inputs of the next step while this one runs,
+            // if they fit in the budget
+            if (i + 1 < p.size())
+            {
+                need = stepMemory(p[i]);
+                for (auto a: module_[p[i + 1]].input)
+                {
+                    if (env().isObjectSpilled(a) and 
+                        (env().getTotalSize() + need + next 
+                         + env().getObjectSize(a) <= memoryBudget_))
+                    {
+                        env().prepareReload(a);
+                        prefetch.push_back(a);
+                        next += env().getObjectSize(a);
+                    }
+                }
+                if (!prefetch.empty())
+                {
+                    auto &e = env();
+                    
+                    prefetchTimer.Reset();
+                    prefetchTimer.Start();
+                    prefetchIo = std::async(std::launch::async, [&e, prefetch](void)
+                    {
+                        for (auto a: prefetch)
+                        {
+                            e.readSpilled(a);
+                        }
+                    });
+                }
+            }
+        }
+        // execute module, the Grid allocations are counted from the current
+        // environment size to get the peak memory of the step
+        MemoryStats   stats, *outerStats = MemoryProfiler::stats;
+        GridStopWatch timer;
+
+        sizeBefore               = env().getTotalSize();
+        stats.currentlyAllocated = sizeBefore;
+        stats.maxAllocated       = sizeBefore;
+        flops_                   = 0.;
+        solverIterations_        = 0;
+        MemoryProfiler::stats    = &stats;
+        timer.Start();
+        try
+        {
+            if (batchSize[i] > 1)
+            {
+                executeBatch(Program(p.begin() + i, p.begin() + i + batchSize[i]));
+            }
+            else if (batchSize[i] == 1)
+            {
+                (*module_[p[i]].data)();
+            }
+            else
+            {
+                LOG(Message) << "Module already executed in split batch" << std::endl;
+            }
+        }
+        catch (...)
+        {
+            MemoryProfiler::stats = outerStats;
+            throw;
+        }
+        timer.Stop();
+        for (unsigned int j = 0; j < batchSize[i]; ++j)
+        {
+            executed_.push_back(p[i + j]);
+        }
+        MemoryProfiler::stats     = outerStats;
+        stats.currentlyAllocated -= sizeBefore;
+        stats.maxAllocated       -= sizeBefore;
+        if (outerStats)
+        {
+            mergeMemoryStats(*outerStats, stats);
+        }
+        if (batchSize[i] > 0)
+        {
+            recordStep(p, i, batchSize[i], timer.useconds()*1.0e-6, 
+                       sizeBefore + stats.maxAllocated);
+        }
+        if (!prefetch.empty())
+        {
+            prefetchIo.get();
+            prefetchTimer.Stop();
+            for (auto a: prefetch)
+            {
+                env().finishReload(a, prefetchTimer.useconds()*1.0e-6/prefetch.size());
+                LOG(Message) << "Prefetched object '" << env().getObjectName(a)
+                             << "' from disk" << std::endl;
+            }
+            nPrefetch += prefetch.size();
+            prefetch.clear();
+        }
         sizeBefore = env().getTotalSize();
         // print used memory after execution
         LOG(Message) << "Allocated objects: " << MEM_MSG(sizeBefore)
@@ -607,10 +1750,43 @@ void VirtualMachine::executeProgram(const Program &p) const
         {
             LOG(Message) << "Nothing to free" << std::endl;
         }
+        // checkpoint, not in the middle of a split batch
+        if (checkpoint and (executed_.size() == nRestored + i + 1) and
+            (i + 1 < p.size()))
+        {
+            checkpointTimer.Stop();
+            if (checkpointTimer.useconds()*1.0e-6 >= checkpointPar_.interval)
+            {
+                writeCheckpoint(false);
+                checkpointTimer.Reset();
+            }
+            checkpointTimer.Start();
+        }
+    }
+    if (spill)
+    {
+        auto &st = env().getSpillStats();
+        
+        LOG(Message) << "Disk spilling (budget " << MEM_MSG(memoryBudget_)
+                     << "): " << st.nSpill << " spills (" 
+                     << MEM_MSG(st.spilled) << ", " << st.spillTime 
+                     << " s), " << st.nReload << " reloads ("
+                     << MEM_MSG(st.reloaded) << ", " << st.reloadTime 
+                     << " s, " << nPrefetch << " prefetched, " << nDemand
+                     << " on demand)" << std::endl;
+    }
+    if (checkpoint)
+    {
+        writeCheckpoint(true);
+    }
+    printRunProfile();
+    if (!profileOutput_.empty())
+    {
+        writeRunProfile();
     }
 }
 
-void VirtualMachine::executeProgram(const std::vector<std::string> &p) const
+void VirtualMachine::executeProgram(const std::vector<std::string> &p)
 {
     Program pAddress;
     
@@ -60,6 +60,7 @@ public:
         Size                 size;
         Environment::Storage storage;
         int                  module;
+        bool                 splittable;
     };
     struct MemoryProfile
     {
@@ -78,6 +79,107 @@ public:
                                         unsigned int, maxCstGen,
                                         double      , mutationRate);
     };
+    class ListPar: Serializable
+    {
+    public:
+        ListPar(void):
+            lookahead{2}, maxIter{1000} {};
+    public:
+        // maxIter: local search iterations after the list scheduling (0 for
+        // none)
+        GRID_SERIALIZABLE_CLASS_MEMBERS(ListPar,
+                                        unsigned int, lookahead,
+                                        unsigned int, maxIter);
+    };
+    class SpillPar: Serializable
+    {
+    public:
+        SpillPar(void):
+            memoryBudget{0.}, directory{"."} {};
+    public:
+        // memoryBudget in MB per process, 0 means no limit (no spilling)
+        GRID_SERIALIZABLE_CLASS_MEMBERS(SpillPar,
+                                        double     , memoryBudget,
+                                        std::string, directory);
+    };
+    class SplitPar: Serializable
+    {
+    public:
+        // mpi: processor grid of each group (e.g. "1 1 1 2"), empty for no
+        // split execution
+        GRID_SERIALIZABLE_CLASS_MEMBERS(SplitPar,
+                                        std::string, mpi);
+    };
+    class ProfilePar: Serializable
+    {
+    public:
+        // output: stem of the XML profile written after each trajectory, 
+        // empty for none (the summary table is always printed)
+        GRID_SERIALIZABLE_CLASS_MEMBERS(ProfilePar,
+                                        std::string, output);
+    };
+    class CheckpointPar: Serializable
+    {
+    public:
+        CheckpointPar(void):
+            interval{3600.}, restart{true} {};
+    public:
+        // directory: where checkpoints are written, empty for none
+        // interval: minimum wall time between two checkpoints (s), 0 to
+        //           checkpoint after every step
+        // restart: resume the trajectory from its checkpoint if there is one
+        GRID_SERIALIZABLE_CLASS_MEMBERS(CheckpointPar,
+                                        std::string, directory,
+                                        double     , interval,
+                                        bool       , restart);
+    };
+    // checkpoint of a trajectory: the modules executed so far, the live
+    // objects and the state of the random number generator, written with the
+    // parallel binary I/O together with their SciDAC checksums. An object
+    // with no file (e.g. not a lattice) is rebuilt by running its module
+    // again on restart.
+    class CheckpointObject: Serializable
+    {
+    public:
+        GRID_SERIALIZABLE_CLASS_MEMBERS(CheckpointObject,
+                                        std::string          , name,
+                                        std::string          , file,
+                                        std::vector<uint32_t>, checksum);
+    };
+    class Checkpoint: Serializable
+    {
+    public:
+        GRID_SERIALIZABLE_CLASS_MEMBERS(Checkpoint,
+                                        unsigned int                 , trajectory,
+                                        std::vector<std::string>     , executed,
+                                        std::vector<CheckpointObject>, object,
+                                        CheckpointObject             , rng);
+    };
+    // run time record of one module execution:
+    // - time: wall time of setup() and execute() (s)
+    // - flops/solverIterations: as reported by the module (see addFlops)
+    // - bytes: size of the input and output objects of the module
+    // - memory: size of the environment after execution
+    // - peakMemory: size of the environment before execution plus the peak
+    //   of the Grid allocations during execution (temporaries included)
+    // - maxRss: resident set high-water mark of the process after execution
+    // - batch: number of modules run concurrently on split grids
+    class ModuleRecord: Serializable
+    {
+    public:
+        GRID_SERIALIZABLE_CLASS_MEMBERS(ModuleRecord,
+                                        std::string , name,
+                                        std::string , type,
+                                        unsigned int, step,
+                                        unsigned int, batch,
+                                        double      , time,
+                                        double      , flops,
+                                        unsigned int, solverIterations,
+                                        double      , bytes,
+                                        double      , memory,
+                                        double      , peakMemory,
+                                        double      , maxRss);
+    };
 private:
     struct ModuleInfo
     {
@@ -123,14 +225,27 @@ public:
     // memory profile
     const MemoryProfile &getMemoryProfile(void);
     // garbage collector
-    GarbageSchedule     makeGarbageSchedule(const Program &p) const;
+    GarbageSchedule     makeGarbageSchedule(const Program &p,
+                                            const bool split = false) const;
     // high-water memory function
     Size                memoryNeeded(const Program &p);
     // genetic scheduler
     Program             schedule(const GeneticPar &par);
+    // list scheduler
+    Program             schedule(const ListPar &par);
+    // memory budget for disk spilling
+    void                setMemoryBudget(const Size budget);
+    Size                getMemoryBudget(void) const;
+    // run time profile
+    void                setProfileOutput(const std::string output);
+    void                addFlops(const double flops);
+    void                addSolverIterations(const unsigned int n);
+    const std::vector<ModuleRecord> & getRunProfile(void) const;
+    // checkpointing
+    void                setCheckpointPar(const CheckpointPar &par);
     // general execution
-    void                executeProgram(const Program &p) const;
-    void                executeProgram(const std::vector<std::string> &p) const;
+    void                executeProgram(const Program &p);
+    void                executeProgram(const std::vector<std::string> &p);
 private:
     // environment shortcut
     DEFINE_ENV_ALIAS;
@@ -144,6 +259,33 @@ private:
     void cleanEnvironment(void);
     void memoryProfile(const std::string name);
     void memoryProfile(const unsigned int address);
+    // disk spilling
+    Size         stepMemory(const unsigned int address) const;
+    unsigned int nextUse(const Program &p, const unsigned int i,
+                         const unsigned int a) const;
+    void         makeRoom(const Program &p, const unsigned int i,
+                          const Size need) const;
+    // split execution
+    bool                      isModuleSplittable(const unsigned int address) const;
+    std::vector<unsigned int> splitOutput(const unsigned int address) const;
+    std::vector<unsigned int> splitCache(const unsigned int address) const;
+    std::vector<Program>      makeBatches(const Program &p) const;
+    void                      splitDependencies(const unsigned int address,
+                                                Program &rerun,
+                                                std::vector<unsigned int> &lat) const;
+    void                      executeBatch(const Program &b) const;
+    // run time profile
+    void         recordStep(const Program &p, const unsigned int i,
+                            const unsigned int batch, const double time,
+                            const Size peakMemory);
+    void         printRunProfile(void) const;
+    void         writeRunProfile(void) const;
+    // checkpointing
+    std::string  checkpointFileName(void) const;
+    std::string  checkpointFileName(const std::string objName) const;
+    Program      restart(const Program &p);
+    void         setupForRestart(const unsigned int address);
+    void         writeCheckpoint(const bool final);
 private:
     // general
     unsigned int                        traj_;
@@ -157,6 +299,18 @@ private:
     // memory profile
     bool                                memoryProfileOutdated_{true};
     MemoryProfile                       profile_;
+    // disk spilling
+    Size                                memoryBudget_{0};
+    // run time profile
+    std::string                         profileOutput_;
+    double                              flops_{0.};
+    unsigned int                        solverIterations_{0};
+    std::vector<ModuleRecord>           runProfile_;
+    // checkpointing
+    CheckpointPar                       checkpointPar_;
+    std::vector<unsigned int>           executed_;
+    std::map<unsigned int, CheckpointObject> checkpoint_;
+    CheckpointObject                    rngCheckpoint_;
 };
 
 /******************************************************************************
@@ -0,0 +1,147 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./extras/remez-cache/remez-cache.cc
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace Grid;
+
+////////////////////////////////////////////////////////////////////////////////
+// Precompute and validate a table of Remez approximations in the on disk cache
+//
+//   remez-cache --remez-cache <dir> [--table <file.xml>] [--generate] [--validate]
+//               [--write-table <file.xml>]
+//
+// Without --table the built in list of approximations used by the rational
+// actions in tests/ is taken. --generate runs Remez for every entry missing
+// from the cache; --validate reloads every entry and checks both partial
+// fraction expansions against x^(+-p/q) across the range.
+////////////////////////////////////////////////////////////////////////////////
+
+class RemezCacheTable : Serializable {
+public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(RemezCacheTable,
+				  std::vector<RemezApproximationKey>, approximations);
+};
+
+static RemezCacheTable defaultTable(void)
+{
+  RemezCacheTable table;
+  std::vector<std::vector<RealD> > ranges({ {1.0e-4,64.0}, {1.0e-2,64.0}, {0.95,100.0} });
+  std::vector<int> degrees({6,10,12,16});
+  std::vector<int> denominators({2,4});
+  for(auto &r : ranges){
+  for(auto  n : degrees){
+  for(auto  q : denominators){
+    table.approximations.push_back(RemezApproximationKey(1,q,n,r[0],r[1],64));
+  }}}
+  return table;
+}
+
+// Largest relative deviation of the partial fraction expansion from x^power
+static RealD pfeError(RealD norm,const std::vector<RealD> &res,const std::vector<RealD> &pole,
+		      RealD power,RealD lo,RealD hi)
+{
+  const int npoint = 2000;
+  RealD err = 0.0;
+  for(int i=0;i<=npoint;i++){
+    long double x = lo*std::pow(hi/lo,(RealD)i/npoint);
+    long double f = norm;
+    for(int k=0;k<res.size();k++) f += res[k]/(x+pole[k]);
+    long double exact = std::pow(x,(long double)power);
+    err = std::max(err,(RealD)std::fabs((f-exact)/exact));
+  }
+  return err;
+}
+
+static bool validate(const RemezApproximationKey &key,const RemezApproximation &approx)
+{
+  RealD power = (RealD)key.power_num/key.power_den;
+  RealD err   = pfeError(approx.pfe_norm, approx.pfe_res, approx.pfe_pole, power,key.lo,key.hi);
+  RealD ierr  = pfeError(approx.ipfe_norm,approx.ipfe_res,approx.ipfe_pole,-power,key.lo,key.hi);
+
+  // Shifts must be positive for the multishift solvers
+  bool ok = true;
+  for(int k=0;k<key.degree;k++){
+    ok = ok && (approx.pfe_pole[k]>0.0) && (approx.ipfe_pole[k]>0.0);
+  }
+  // Sampled error can only be below the minimax error, up to double rounding
+  RealD tol = 1.01*approx.error + 1.0e-13;
+  ok = ok && (err<=tol) && (ierr<=tol);
+
+  std::cout << GridLogMessage << (ok ? "PASS " : "FAIL ")
+	    << "x^(" << key.power_num << "/" << key.power_den << ") degree " << key.degree
+	    << " [" << key.lo << "," << key.hi << "] prec " << key.precision
+	    << " : remez error " << approx.error << " pfe " << err << " ipfe " << ierr << std::endl;
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  Grid_init(&argc,&argv);
+
+  if ( !RemezCache::enabled() ) {
+    std::cout << GridLogError << "usage: " << argv[0]
+	      << " --remez-cache <dir> [--table <file.xml>] [--generate] [--validate] [--write-table <file.xml>]"
+	      << std::endl;
+    Grid_finalize();
+    return EXIT_FAILURE;
+  }
+
+  RemezCacheTable table;
+  if ( GridCmdOptionExists(argv,argv+argc,"--table") ) {
+    XmlReader RD(GridCmdOptionPayload(argv,argv+argc,"--table"));
+    read(RD,"RemezCacheTable",table);
+  } else {
+    table = defaultTable();
+  }
+  if ( GridCmdOptionExists(argv,argv+argc,"--write-table") ) {
+    XmlWriter WR(GridCmdOptionPayload(argv,argv+argc,"--write-table"));
+    write(WR,"RemezCacheTable",table);
+  }
+
+  int failures = 0;
+  for(auto &key : table.approximations){
+    RemezApproximation approx;
+    bool present = RemezCache::lookup(key,approx);
+
+    if ( !present && GridCmdOptionExists(argv,argv+argc,"--generate") ) {
+      AlgRemez remez(key.lo,key.hi,key.precision);
+      remez.generateApprox(key.degree,key.power_num,key.power_den);
+      present = RemezCache::lookup(key,approx);
+    }
+
+    if ( !present ) {
+      std::cout << GridLogMessage << "MISSING " << RemezCache::fileName(key) << std::endl;
+      failures++;
+    } else if ( GridCmdOptionExists(argv,argv+argc,"--validate") ) {
+      if ( !validate(key,approx) ) failures++;
+    }
+  }
+  std::cout << GridLogMessage << table.approximations.size() << " approximations, "
+	    << failures << " missing or failed" << std::endl;
+
+  Grid_finalize();
+  return (failures==0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -44,6 +44,10 @@ Author: paboyle <paboyle@ph.ed.ac.uk>
 #include <Grid/qcd/utils/GaugeFix.h>
 #include <Grid/qcd/smearing/Smearing.h>
 #include <Grid/parallelIO/MetaData.h>
+#include <Grid/parallelIO/CompressedEigenvectorIO.h>
+#ifdef HAVE_HDF5
+#include <Grid/parallelIO/Hdf5FieldIO.h>
+#endif
 #include <Grid/qcd/hmc/HMC_aggregate.h>
 
 #endif
@@ -357,6 +357,13 @@ namespace Grid {
     template<class Field> class OperatorFunction {
     public:
       virtual void operator() (LinearOperatorBase<Field> &Linop, const Field &in, Field &out) = 0;
+      // Several right hand sides; solved one at a time unless a block solver overrides this
+      virtual void operator() (LinearOperatorBase<Field> &Linop, const std::vector<Field> &in, std::vector<Field> &out) {
+	assert(in.size()==out.size());
+	for(int k=0;k<in.size();k++){
+	  (*this)(Linop,in[k],out[k]);
+	}
+      };
     };
 
     template<class Field> class LinearFunction {
@@ -436,6 +443,7 @@ namespace Grid {
   private:
     std::vector<RealD> Coeffs;
   public:
+    using OperatorFunction<Field>::operator();
     Polynomial(std::vector<RealD> &_Coeffs) : Coeffs(_Coeffs) { };
 
     // Implement the required interface
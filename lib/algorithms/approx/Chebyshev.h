@@ -53,6 +53,7 @@ struct ChebyParams : Serializable {
     RealD lo;
 
   public:
+    using OperatorFunction<Field>::operator();
     void csv(std::ostream &out){
       RealD diff = hi-lo;
       RealD delta = (hi-lo)*1.0e-9;
@@ -93,6 +94,17 @@ struct ChebyParams : Serializable {
       Coeffs[order-1] = 1.;
     };
 
+    // Explicit coefficients of sum' c_n T_n, as produced by the other Init's
+    void Init(RealD _lo,RealD _hi,const std::vector<RealD> &_Coeffs)
+    {
+      lo=_lo;
+      hi=_hi;
+      order=_Coeffs.size();
+      
+      if(order < 2) exit(-1);
+      Coeffs=_Coeffs;
+    };
+
     void Init(RealD _lo,RealD _hi,int _order, RealD (* func)(RealD))
     {
       lo=_lo;
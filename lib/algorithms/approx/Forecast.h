@@ -147,6 +147,212 @@ namespace Grid {
       };
   };
 
+  // Forwarding linear operator counting applications of the Hermitian operator,
+  // so iteration counts can be taken from any solver.
+  template<class Field>
+  class CountingLinearOperator : public LinearOperatorBase<Field>
+  {
+    private:
+      LinearOperatorBase<Field> &_Op;
+    public:
+      uint64_t Count;
+      CountingLinearOperator(LinearOperatorBase<Field> &Op) : _Op(Op), Count(0) {};
+
+      void OpDiag (const Field &in, Field &out)                    { _Op.OpDiag(in,out); }
+      void OpDir  (const Field &in, Field &out,int dir,int disp)   { _Op.OpDir(in,out,dir,disp); }
+      void Op     (const Field &in, Field &out)                    { _Op.Op(in,out); }
+      void AdjOp  (const Field &in, Field &out)                    { _Op.AdjOp(in,out); }
+      void HermOpAndNorm(const Field &in, Field &out,RealD &n1,RealD &n2){ Count++; _Op.HermOpAndNorm(in,out,n1,n2); }
+      void HermOp (const Field &in, Field &out)                    { Count++; _Op.HermOp(in,out); }
+  };
+
+  // Forwarding solver accumulating the Hermitian operator applications it makes
+  template<class Field>
+  class CountingOperatorFunction : public OperatorFunction<Field>
+  {
+    private:
+      OperatorFunction<Field> &_Solver;
+    public:
+      uint64_t Count;
+      using OperatorFunction<Field>::operator();
+      CountingOperatorFunction(OperatorFunction<Field> &Solver) : _Solver(Solver), Count(0) {};
+
+      void operator()(LinearOperatorBase<Field> &Linop, const Field &in, Field &out)
+      {
+        CountingLinearOperator<Field> CountOp(Linop);
+        _Solver(CountOp,in,out);
+        Count += CountOp.Count;
+      }
+  };
+
+  // Chronological initial guess for the repeated Hermitian positive solves
+  // A x = phi made along an MD trajectory (Brower et al., hep-lat/9509012).
+  //
+  // The last Depth solutions are kept in a ring allocated on first use, so the
+  // cost is a fixed Depth+1 fields. The guess is the Galerkin solution in the
+  // span of the ring, G_ij = <v_i,A v_j>, b_i = <v_i,phi>. Each column of G is a
+  // single batched reduction and the basis is never orthogonalised or copied:
+  // nearly dependent history directions are dropped by truncating the spectrum
+  // of G below Cutoff*lambda_max instead.
+  //
+  // Reset() is called at trajectory boundaries; it reports the operator
+  // applications saved against the first (cold) solve of the trajectory, all
+  // counted as applications of the operator the solver sees. Only the starting
+  // vector changes, so forces agree with cold starts to the solver tolerance
+  // and the history never touches the RNG. The same holds for reversibility:
+  // a reversed trajectory forecasts from a different history, so it retraces
+  // the forward one to solver tolerance only.
+  //
+  // Solves through SchurRedBlackDiagMooeeSolve keep odd checkerboard solutions
+  // and forecast with the same Schur operator as the red-black solver
+  // (GuessSchur/UpdateSchur).
+  template<class Field>
+  class ChronoSolutionHistory
+  {
+    private:
+      int Depth;
+      int Nvec;                 // valid entries in the ring
+      int Next;                 // slot for the next solution
+      std::vector<Field> ring;
+      std::vector<Field> Av;    // single work vector
+
+      // Per trajectory statistics, in Hermitian operator applications
+      int      Solves;
+      uint64_t Cold;
+      uint64_t Warm;
+      RealD    Extra;           // spent forming guesses
+
+    public:
+      std::string Name;
+      RealD Cutoff;
+
+      ChronoSolutionHistory(std::string name="ChronoSolutionHistory",int depth=0) :
+        Depth(depth), Nvec(0), Next(0), Solves(0), Cold(0), Warm(0), Extra(0), Name(name), Cutoff(1.0e-10) {};
+
+      int  size(void)            { return Nvec; }
+      bool enabled(void)         { return Depth>0; }
+      void setDepth(int depth)   { Depth=depth; Nvec=0; Next=0; ring.clear(); Av.clear(); }
+
+      void Reset(void)
+      {
+        if ( Solves > 1 ) {
+          RealD saved = (RealD)(Solves-1)*Cold - (RealD)Warm - Extra;
+          std::cout << GridLogMessage << Name << ": " << Solves << " solves, cold start " << Cold
+                    << " HermOp, forecast " << Warm << " + " << Extra
+                    << " HermOp ; saved " << saved << " HermOp this trajectory" << std::endl;
+        }
+        Nvec = 0; Next = 0;
+        Solves = 0; Cold = 0; Warm = 0; Extra = 0;
+      }
+
+      void Guess(LinearOperatorBase<Field> &HermOp, const Field &phi, Field &x)
+      {
+        if ( Nvec == 0 ) return;
+
+        std::vector<ComplexD> col;
+        std::vector<ComplexD> b;
+        Eigen::MatrixXcd G(Nvec,Nvec);
+        Eigen::VectorXcd B(Nvec);
+
+        innerProductVector(b,ring,Nvec,phi);
+        for(int j=0; j<Nvec; j++){
+          HermOp.HermOp(ring[j],Av[0]);
+          innerProductVector(col,ring,Nvec,Av[0]);
+          for(int i=0; i<Nvec; i++) G(i,j) = col[i];
+          B(j) = b[j];
+        }
+        Extra += Nvec;
+
+        // Symmetrise against rounding and solve in the retained eigenspace
+        Eigen::MatrixXcd H = 0.5*(G + G.adjoint());
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> eig(H);
+        Eigen::VectorXd  lambda = eig.eigenvalues();
+        Eigen::MatrixXcd U      = eig.eigenvectors();
+        Eigen::VectorXcd a      = Eigen::VectorXcd::Zero(Nvec);
+        RealD lmax = lambda(Nvec-1);
+        int rank=0;
+        for(int k=0; k<Nvec; k++){
+          if ( lambda(k) > Cutoff*lmax ) {
+            a += U.col(k) * ( U.col(k).dot(B) / lambda(k) );
+            rank++;
+          }
+        }
+
+        x = zero;
+        x.checkerboard = phi.checkerboard;
+        for(int i=0; i<Nvec; i++){
+          ComplexD ai = a(i);
+          axpy(x,ai,ring[i],x);
+        }
+        std::cout << GridLogMessage << Name << ": forecast from " << Nvec << " solutions, rank " << rank << std::endl;
+      }
+
+      // Guess for M x = src solved by SchurRedBlackDiagMooeeSolve: the Galerkin
+      // solution of its odd checkerboard system, set on the odd checkerboard of
+      // the full field x. Forming the Schur source costs three of the four
+      // Meooe of a Schur operator application, counted as such.
+      template<class Matrix>
+      void GuessSchur(Matrix &M, const Field &src, Field &x)
+      {
+        if ( Nvec == 0 ) return;
+        GridBase *grid = M.RedBlackGrid();
+        SchurDiagMooeeOperator<Matrix,Field> HermOp(M);
+        Field src_e(grid), src_o(grid), tmp(grid), Mtmp(grid), x_o(grid);
+
+        pickCheckerboard(Even,src_e,src);
+        pickCheckerboard(Odd ,src_o,src);
+        M.MooeeInv(src_e,tmp);
+        M.Meooe   (tmp,Mtmp);
+        tmp = src_o - Mtmp;
+        HermOp.MpcDag(tmp,src_o);
+        Extra += 0.75;
+
+        x_o = zero;
+        x_o.checkerboard = Odd;
+        Guess(HermOp,src_o,x_o);
+        setCheckerboard(x,x_o);
+      }
+
+      // Records the odd checkerboard of a full solution from GuessSchur
+      template<class Matrix>
+      void UpdateSchur(Matrix &M, const Field &x, uint64_t count)
+      {
+        if ( !enabled() ) return;
+        Field x_o(M.RedBlackGrid());
+        pickCheckerboard(Odd,x_o,x);
+        Update(x_o,count);
+      }
+
+      void Update(const Field &x, uint64_t count)
+      {
+        if ( !enabled() ) return;
+        if ( ring.size() == 0 ) {
+          ring.resize(Depth,x);
+          Av.resize(1,x);
+        }
+        ring[Next] = x;
+        Next = (Next+1) % Depth;
+        Nvec = std::min(Nvec+1,Depth);
+
+        if ( Solves==0 ) Cold  = count;
+        else             Warm += count;
+        Solves++;
+      }
+
+      // Guess, solve and record for solves through a LinearOperator
+      void operator()(OperatorFunction<Field> &Solver, LinearOperatorBase<Field> &HermOp, const Field &phi, Field &x)
+      {
+        if ( !enabled() ) {
+          Solver(HermOp,phi,x);
+          return;
+        }
+        Guess(HermOp,phi,x);
+        CountingLinearOperator<Field> CountOp(HermOp);
+        Solver(CountOp,phi,x);
+        Update(x,CountOp.Count);
+      }
+  };
+
 }
 
 #endif
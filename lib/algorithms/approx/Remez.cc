@@ -20,6 +20,7 @@
 #include<iomanip>
 #include<cassert>
 
+#include<Grid/GridCore.h>
 #include<Grid/algorithms/approx/Remez.h>
 
 // Constructor
@@ -40,6 +41,8 @@ AlgRemez::AlgRemez(double lower, double upper, long precision)
   d = 0;
 
   foundRoots = 0;
+  cached = 0;
+  error = 0.0;
 
   // Only require the approximation spread to be less than 1 ulp
   tolerance = 1e-15;
@@ -56,6 +59,10 @@ AlgRemez::~AlgRemez()
     delete [] mm;
     delete [] a_power;
     delete [] a;
+    delete [] pfe_res;
+    delete [] pfe_pole;
+    delete [] ipfe_res;
+    delete [] ipfe_pole;
   }
 }
 
@@ -69,6 +76,10 @@ void AlgRemez::allocate(int num_degree, int den_degree)
     delete [] poles;
     delete [] xx;
     delete [] mm;
+    delete [] pfe_res;
+    delete [] pfe_pole;
+    delete [] ipfe_res;
+    delete [] ipfe_pole;
   }
 
   // Note use of new and delete in memory allocation - cannot run on qcdsp
@@ -77,6 +88,10 @@ void AlgRemez::allocate(int num_degree, int den_degree)
   poles = new bigfloat[den_degree];
   xx = new bigfloat[num_degree+den_degree+3];
   mm = new bigfloat[num_degree+den_degree+2];
+  pfe_res   = new double[num_degree];
+  pfe_pole  = new double[den_degree];
+  ipfe_res  = new double[den_degree];
+  ipfe_pole = new double[num_degree];
 
   if (!alloc) {
     // The coefficients of the sum in the exponential
@@ -123,6 +138,36 @@ double AlgRemez::generateApprox(int num_degree, int den_degree,
 
   assert(a_len<=SUM_MAX);
 
+  // Only plain powers with n=d are cached
+  int cacheable = (a_len==0) && (num_degree==den_degree);
+  Grid::RemezApproximationKey key(pnum,pden,num_degree,(double)apstrt,(double)apend,prec);
+  Grid::RemezApproximation approx;
+  cached = 0;
+  if ( cacheable && Grid::RemezCache::lookup(key,approx) ) {
+    power_num = pnum;
+    power_den = pden;
+    a_length  = 0;
+    n   = num_degree;
+    d   = den_degree;
+    neq = n + d + 1;
+    for (int i=0; i<neq; i++) param[i] = approx.coefficients[i];
+    for (int i=0; i<n; i++) {
+      roots[i]     = approx.roots[i];
+      poles[i]     = approx.poles[i];
+      pfe_res[i]   = approx.pfe_res[i];
+      pfe_pole[i]  = approx.pfe_pole[i];
+      ipfe_res[i]  = approx.ipfe_res[i];
+      ipfe_pole[i] = approx.ipfe_pole[i];
+    }
+    norm      = approx.norm;
+    pfe_norm  = approx.pfe_norm;
+    ipfe_norm = approx.ipfe_norm;
+    foundRoots = 1;
+    cached = 1;
+    error = approx.error;
+    return error;
+  }
+
   step = new bigfloat[num_degree+den_degree+2];
 
   a_length = a_len;
@@ -159,7 +204,7 @@ double AlgRemez::generateApprox(int num_degree, int den_degree,
   }
 
   int sign;
-  double error = (double)getErr(mm[0],&sign);
+  error = (double)getErr(mm[0],&sign);
   std::cout<<"Converged at "<<iter<<" iterations; error = "<<error<<std::endl;
 
   // Once the approximation has been generated, calculate the roots
@@ -171,6 +216,27 @@ double AlgRemez::generateApprox(int num_degree, int den_degree,
   
   delete [] step;
 
+  if ( cacheable && foundRoots && Grid::RemezCache::enabled() ) {
+    approx.key   = key;
+    approx.error = error;
+    approx.coefficients.resize(neq);
+    approx.roots.resize(n);
+    approx.poles.resize(d);
+    approx.pfe_res.resize(n);
+    approx.pfe_pole.resize(n);
+    approx.ipfe_res.resize(n);
+    approx.ipfe_pole.resize(n);
+    for (int i=0; i<neq; i++) approx.coefficients[i] = (double)param[i];
+    for (int i=0; i<n; i++) {
+      approx.roots[i] = (double)roots[i];
+      approx.poles[i] = (double)poles[i];
+    }
+    approx.norm = (double)norm;
+    getPFE (&approx.pfe_res[0], &approx.pfe_pole[0], &approx.pfe_norm);
+    getIPFE(&approx.ipfe_res[0],&approx.ipfe_pole[0],&approx.ipfe_norm);
+    Grid::RemezCache::store(approx);
+  }
+
   // Return the maximum error in the approximation
   return error;
 }
@@ -193,6 +259,13 @@ int AlgRemez::getPFE(double *Res, double *Pole, double *Norm) {
     return 0;
   }
 
+  if (cached) {
+    *Norm = pfe_norm;
+    for (int i=0; i<n; i++) Res[i]  = pfe_res[i];
+    for (int i=0; i<d; i++) Pole[i] = pfe_pole[i];
+    return 0;
+  }
+
   bigfloat *r = new bigfloat[n];
   bigfloat *p = new bigfloat[d];
   
@@ -232,6 +305,15 @@ int AlgRemez::getIPFE(double *Res, double *Pole, double *Norm) {
     return 0;
   }
 
+  if (cached) {
+    *Norm = ipfe_norm;
+    for (int i=0; i<n; i++) {
+      Res[i]  = ipfe_res[i];
+      Pole[i] = ipfe_pole[i];
+    }
+    return 0;
+  }
+
   bigfloat *r = new bigfloat[d];
   bigfloat *p = new bigfloat[n];
   
@@ -61,6 +61,15 @@ class AlgRemez
   // Flag to determine whether the roots have been found
   int foundRoots;
 
+  // Maximum error of the approximation found
+  double error;
+
+  // Flag set when the approximation was restored from the RemezCache,
+  // together with the partial fraction expansions it holds
+  int cached;
+  double pfe_norm, ipfe_norm;
+  double *pfe_res, *pfe_pole, *ipfe_res, *ipfe_pole;
+
   // Variables used to calculate the approximation
   int nd1, iter;
   bigfloat *xx, *mm, *step;
@@ -137,6 +146,8 @@ class AlgRemez
     assert(n==d);
     return n;
   }
+  // Maximum error of the last approximation generated or loaded
+  double getError(void){ return error; }
   // Reset the bounds of the approximation
   void setBounds(double lower, double upper);
   // Reset the bounds of the approximation
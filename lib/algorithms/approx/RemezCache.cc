@@ -0,0 +1,90 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/algorithms/approx/RemezCache.cc
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/GridCore.h>
+#include <cstdio>
+#include <unistd.h>
+
+namespace Grid {
+
+std::string RemezCache::Directory;
+
+// Bounds in hex float so that the name is exact
+std::string RemezCache::fileName(const RemezApproximationKey &key)
+{
+  char buf[256];
+  snprintf(buf,sizeof(buf),"remez_x%d_%d_deg%d_prec%d_%a_%a.xml",
+	   key.power_num,key.power_den,key.degree,key.precision,key.lo,key.hi);
+  return Directory + "/" + std::string(buf);
+}
+
+bool RemezCache::lookup(const RemezApproximationKey &key,RemezApproximation &approx)
+{
+  if ( !enabled() ) return false;
+
+  std::string file = fileName(key);
+  if ( access(file.c_str(),R_OK) != 0 ) return false;
+
+  {
+    XmlReader RD(file);
+    read(RD,"RemezApproximation",approx);
+  }
+  if ( !(approx.key == key) ) {
+    std::cout << GridLogWarning << "RemezCache: key mismatch in "<< file <<"; ignoring entry"<<std::endl;
+    return false;
+  }
+  int n = key.degree;
+  if ( (approx.roots.size()!=n) || (approx.poles.size()!=n) || (approx.coefficients.size()!=2*n+1) ||
+       (approx.pfe_res.size()!=n) || (approx.pfe_pole.size()!=n) ||
+       (approx.ipfe_res.size()!=n) || (approx.ipfe_pole.size()!=n) ) {
+    std::cout << GridLogWarning << "RemezCache: truncated entry "<< file <<"; ignoring entry"<<std::endl;
+    return false;
+  }
+  std::cout << GridLogMessage << "RemezCache: loaded "<< file <<" error "<< approx.error <<std::endl;
+  return true;
+}
+
+void RemezCache::store(const RemezApproximation &approx)
+{
+  if ( !enabled() ) return;
+  if ( CartesianCommunicator::RankWorld() != 0 ) return;
+
+  std::string file = fileName(approx.key);
+  std::string tmp  = file + ".tmp." + std::to_string(getpid());
+  {
+    XmlWriter WR(tmp);
+    // enough digits for the doubles to read back exactly
+    WR.setPrecision(std::numeric_limits<double>::max_digits10);
+    write(WR,"RemezApproximation",approx);
+  }
+  if ( rename(tmp.c_str(),file.c_str()) != 0 ) {
+    std::cout << GridLogWarning << "RemezCache: could not create "<< file <<std::endl;
+    remove(tmp.c_str());
+    return;
+  }
+  std::cout << GridLogMessage << "RemezCache: stored "<< file <<std::endl;
+}
+
+}
@@ -0,0 +1,89 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/algorithms/approx/RemezCache.h
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#ifndef GRID_REMEZ_CACHE_H
+#define GRID_REMEZ_CACHE_H
+
+namespace Grid {
+
+// Identifies an approximation to x^(power_num/power_den) on [lo,hi]
+class RemezApproximationKey : Serializable {
+public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(RemezApproximationKey,
+				  int,   power_num,
+				  int,   power_den,
+				  int,   degree,
+				  RealD, lo,
+				  RealD, hi,
+				  int,   precision);
+  RemezApproximationKey(int _power_num=1,int _power_den=2,int _degree=10,
+			RealD _lo=0.0,RealD _hi=1.0,int _precision=64)
+    : power_num(_power_num), power_den(_power_den), degree(_degree),
+      lo(_lo), hi(_hi), precision(_precision) {};
+};
+
+// Everything AlgRemez returns for one approximation:
+//   f(x) = norm prod (x-roots)/(x-poles) = coefficients P(x)/Q(x)
+//        = pfe_norm + sum pfe_res/(x+pfe_pole)
+//   1/f(x)                                 = ipfe_norm + sum ipfe_res/(x+ipfe_pole)
+class RemezApproximation : Serializable {
+public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(RemezApproximation,
+				  RemezApproximationKey, key,
+				  RealD, error,
+				  std::vector<RealD>, coefficients,
+				  RealD, norm,
+				  std::vector<RealD>, roots,
+				  std::vector<RealD>, poles,
+				  RealD, pfe_norm,
+				  std::vector<RealD>, pfe_res,
+				  std::vector<RealD>, pfe_pole,
+				  RealD, ipfe_norm,
+				  std::vector<RealD>, ipfe_res,
+				  std::vector<RealD>, ipfe_pole);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// On disk cache of Remez approximations, one XML file per key, consulted by
+// AlgRemez::generateApprox before it starts the minimax iteration. Disabled
+// while Directory is empty; set with --remez-cache <dir> on the command line.
+////////////////////////////////////////////////////////////////////////////////
+class RemezCache {
+public:
+  static std::string Directory;
+
+  static bool enabled(void) { return Directory != std::string(""); }
+
+  static std::string fileName(const RemezApproximationKey &key);
+
+  // Entry for key if present and matching exactly
+  static bool lookup(const RemezApproximationKey &key,RemezApproximation &approx);
+
+  // Written under a temporary name and renamed so readers never see a partial file
+  static void store(const RemezApproximation &approx);
+};
+
+}
+#endif
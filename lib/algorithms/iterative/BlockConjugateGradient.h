@@ -42,6 +42,8 @@ template <class Field>
 class BlockConjugateGradient : public OperatorFunction<Field> {
  public:
 
+  using OperatorFunction<Field>::operator();
+
 
   typedef typename Field::scalar_type scomplex;
 
@@ -0,0 +1,458 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/algorithms/iterative/BlockConjugateGradientMixedPrec.h
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#ifndef GRID_BLOCK_CONJUGATE_GRADIENT_MIXED_PREC_H
+#define GRID_BLOCK_CONJUGATE_GRADIENT_MIXED_PREC_H
+
+namespace Grid {
+
+//////////////////////////////////////////////////////////////////////////////
+// Mixed precision block CG (rQ form, Dubrulle 2001) over a list of right hand
+// sides, iterating in single precision with reliable updates in double.
+//
+// The residual block is kept as R = Q C with Q orthonormal. The thin QR is
+// rank revealing, so linearly dependent directions are dropped and the block
+// of search directions D can be narrower than the number of right hand sides
+// (breakdown free BCGrQ). A right hand side whose estimated residual reaches
+// the target is removed from C in flight; D and Q are contracted onto the
+// remaining columns with small dense algebra, so no restart is needed and
+// later iterations only apply the operator to the remaining directions.
+//
+// Reliable update: once every active residual has fallen by Delta since the
+// last update, the single precision correction is accumulated into the double
+// solution, the residual is recomputed in double and refactorised, and the
+// search directions are re-expressed against the new factor C. If the rank of
+// the residual block changed the search restarts, so Delta should be small
+// (1e-3 or so) compared with the value typical for ConjugateGradientReliableUpdate.
+//
+// FieldF may also be FieldD; the reliable updates then act as residual
+// replacement (see ReliableBlockConjugateGradient below).
+//////////////////////////////////////////////////////////////////////////////
+template<class FieldD,class FieldF, typename std::enable_if< getPrecision<FieldD>::value == 2, int>::type = 0,typename std::enable_if< getPrecision<FieldF>::value <= 2, int>::type = 0>
+class MixedPrecisionBlockConjugateGradient {
+public:
+  bool    ErrorOnNoConverge;
+  RealD   Tolerance;
+  Integer MaxIterations;
+  RealD   Delta;          // reliable update when every residual has dropped by this factor (squared norm)
+  RealD   RankTolerance;  // relative Gram eigenvalue below which a direction counts as dependent
+  GridBase *SinglePrecGrid;
+  LinearOperatorBase<FieldF> &Linop_f;
+  LinearOperatorBase<FieldD> &Linop_d;
+
+  Integer IterationsToComplete;
+  Integer ReliableUpdatesPerformed;
+  Integer MatVecsF;       // single precision applications, one per search direction
+  Integer MatVecsD;       // double precision applications, one per column per reliable update
+
+  MixedPrecisionBlockConjugateGradient(RealD tol,Integer maxit,RealD _delta,GridBase *_sp_grid,
+				       LinearOperatorBase<FieldF> &_Linop_f,LinearOperatorBase<FieldD> &_Linop_d,
+				       bool err_on_no_conv = true)
+    : Tolerance(tol),
+      MaxIterations(maxit),
+      Delta(_delta),
+      RankTolerance(1.0e-6),
+      SinglePrecGrid(_sp_grid),
+      Linop_f(_Linop_f),
+      Linop_d(_Linop_d),
+      ErrorOnNoConverge(err_on_no_conv)
+  {};
+
+  ////////////////////////////////////////////////////////////////////////////
+  // T = Q S for the first n columns of T; Q orthonormal with r <= n columns,
+  // S is r x n. Cholesky QR through the eigen decomposition of the Gram
+  // matrix, discarding directions with eigenvalue below RankTolerance * max,
+  // then repeated once (CholQR2) to restore orthogonality lost in single
+  // precision.
+  ////////////////////////////////////////////////////////////////////////////
+  int GramQR(std::vector<FieldF> &T,int n,std::vector<FieldF> &Q,Eigen::MatrixXcd &S,RealD tol)
+  {
+    Eigen::MatrixXcd G;
+    innerProductMatrix(G,T,n,T,n);
+    G = 0.5*(G+G.adjoint());
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> eig(G);
+    Eigen::VectorXd  lambda = eig.eigenvalues();
+    RealD lmax = (n>0) ? lambda(n-1) : 0.0;
+    int r=0;
+    for(int i=0;i<n;i++) if ( (lmax>0.0) && (lambda(i) > tol*lmax) ) r++;
+
+    Eigen::MatrixXcd U = eig.eigenvectors().rightCols(r);
+    Eigen::MatrixXcd W(n,r);
+    S.resize(r,n);
+    for(int j=0;j<r;j++){
+      RealD l = lambda(n-r+j);
+      W.col(j) = U.col(j)/::sqrt(l);
+      S.row(j) = ::sqrt(l)*U.col(j).adjoint();
+    }
+    mulMatrix(Q,W,T);
+    return r;
+  }
+  // precision change between the two fields; a plain copy when FieldF is FieldD
+  template<class FieldOut,class FieldIn> static void convert(FieldOut &out,const FieldIn &in) { precisionChange(out,in); }
+  static void convert(FieldD &out,const FieldD &in) { out = in; }
+
+  int ThinQRfact(std::vector<FieldF> &T,int n,std::vector<FieldF> &Q,Eigen::MatrixXcd &S)
+  {
+    Eigen::MatrixXcd S2;
+    int r = GramQR(T,n,Q,S,RankTolerance);
+    int r2= GramQR(Q,r,Q,S2,RankTolerance);
+    assert(r2==r);
+    S = S2*S;
+    return r;
+  }
+
+  void operator()(const std::vector<FieldD> &src,std::vector<FieldD> &psi)
+  {
+    int Nrhs = src.size();
+    assert(psi.size()==Nrhs);
+    assert(Nrhs>0);
+
+    GridBase *DoublePrecGrid = src[0]._grid;
+    int cb = src[0].checkerboard;
+
+    std::cout << GridLogMessage << "MixedPrecisionBlockConjugateGradient: "<< Nrhs <<" right hand sides"<<std::endl;
+
+    std::vector<RealD> ssq(Nrhs);
+    std::vector<RealD> rsq(Nrhs);
+    std::vector<RealD> true_rr(Nrhs);
+    std::vector<int>   verified(Nrhs,0);
+    for(int j=0;j<Nrhs;j++){
+      psi[j].checkerboard = cb;
+      conformable(psi[j],src[j]);
+      ssq[j] = norm2(src[j]);
+      rsq[j] = Tolerance*Tolerance*ssq[j];
+      assert(std::isnan(norm2(psi[j]))==0);
+    }
+
+    FieldD tmp_d(DoublePrecGrid);
+    FieldD r_d(DoublePrecGrid);
+    tmp_d.checkerboard = cb;
+
+    std::vector<FieldF> Q(Nrhs,SinglePrecGrid);
+    std::vector<FieldF> D(Nrhs,SinglePrecGrid);
+    std::vector<FieldF> Z(Nrhs,SinglePrecGrid);
+    std::vector<FieldF> T(Nrhs,SinglePrecGrid);
+    std::vector<FieldF> E(Nrhs,SinglePrecGrid); // single precision correction since the last update
+
+    Eigen::MatrixXcd C, S, M, W;
+
+    std::vector<int>   active;  // right hand side of each column of C
+    std::vector<RealD> MaxResidSinceLastRelUp;
+    for(int j=0;j<Nrhs;j++) active.push_back(j);
+
+    GridStopWatch MatrixTimer;
+    GridStopWatch InnerTimer;
+    GridStopWatch MaddTimer;
+    GridStopWatch QRTimer;
+    GridStopWatch ReliableTimer;
+    GridStopWatch SolverTimer;
+    SolverTimer.Start();
+
+    IterationsToComplete     = 0;
+    ReliableUpdatesPerformed = 0;
+    MatVecsF = 0;
+    MatVecsD = 0;
+
+    int  r = 0;
+    int  k = 0;
+    bool restart = true;
+    bool correction = false;
+
+    while ( 1 ) {
+
+      ///////////////////////////////////////////////////
+      // Reliable update: X += E ; R = B - A X in double
+      ///////////////////////////////////////////////////
+      ReliableTimer.Start();
+      std::vector<int> keep;
+      for(int a=0;a<active.size();a++){
+	int j = active[a];
+	if ( correction ) {
+	  convert(tmp_d,E[a]);
+	  psi[j] = psi[j] + tmp_d;
+	}
+	Linop_d.HermOp(psi[j],tmp_d);
+	r_d = src[j] - tmp_d;
+	true_rr[j] = norm2(r_d);
+	verified[j] = 1;
+	MatVecsD++;
+	if ( true_rr[j] > rsq[j] ) {
+	  convert(T[keep.size()],r_d);
+	  keep.push_back(j);
+	}
+      }
+      ReliableTimer.Stop();
+
+      // Columns dropped in flight are checked once at the end
+      if ( keep.size()==0 ) {
+	for(int j=0;j<Nrhs;j++){
+	  if ( !verified[j] ) {
+	    Linop_d.HermOp(psi[j],tmp_d);
+	    r_d = src[j] - tmp_d;
+	    true_rr[j] = norm2(r_d);
+	    verified[j] = 1;
+	    MatVecsD++;
+	    if ( true_rr[j] > rsq[j] ) {
+	      convert(T[keep.size()],r_d);
+	      keep.push_back(j);
+	    }
+	  }
+	}
+	if ( keep.size()==0 ) break;
+	restart = true;
+      }
+      if ( keep != active ) restart = true;
+      active = keep;
+      int s = active.size();
+
+      QRTimer.Start();
+      Eigen::MatrixXcd Cold = C;
+      int rn = ThinQRfact(T,s,Q,C);
+      QRTimer.Stop();
+
+      // Keep P = D C by D' = D Cold C^+ (close to a unitary rotation) while the
+      // rank is unchanged; a rank change or an ill conditioned map restarts from Q.
+      if ( !restart && (rn==r) ) {
+	W = Cold * C.adjoint() * (C*C.adjoint()).inverse();
+	Eigen::JacobiSVD<Eigen::MatrixXcd> svdW(W);
+	Eigen::VectorXd sw = svdW.singularValues();
+	if ( sw(rn-1) < ::sqrt(RankTolerance)*sw(0) ) restart = true;
+      } else {
+	restart = true;
+      }
+      if ( restart ) {
+	for(int i=0;i<rn;i++) D[i] = Q[i];
+      } else {
+	MaddTimer.Start();
+	mulMatrix(D,W,D);
+	MaddTimer.Stop();
+      }
+      r = rn;
+      for(int a=0;a<s;a++){
+	E[a].checkerboard = cb;
+	E[a] = zero;
+      }
+      MaxResidSinceLastRelUp.resize(s);
+      for(int a=0;a<s;a++) MaxResidSinceLastRelUp[a] = true_rr[active[a]];
+      if ( k>0 ) ReliableUpdatesPerformed++;
+      std::cout << GridLogIterative << "MixedPrecisionBlockConjugateGradient: reliable update at iteration "<< k
+		<<" active "<< s <<" directions "<< r << (restart ? " restart" : "") <<std::endl;
+
+      correction = true;
+      restart = false;
+
+      ///////////////////////////////////////////////////
+      // Single precision BCGrQ on the active columns
+      ///////////////////////////////////////////////////
+      bool update = false;
+      while ( !update ) {
+
+	if ( k>=MaxIterations ) {
+	  std::cout << GridLogMessage << "MixedPrecisionBlockConjugateGradient did NOT converge" << std::endl;
+	  if (ErrorOnNoConverge) assert(0);
+	  IterationsToComplete = k;
+	  return;
+	}
+	k++;
+
+	// Z = A D
+	MatrixTimer.Start();
+	for(int i=0;i<r;i++) Linop_f.HermOp(D[i],Z[i]);
+	MatrixTimer.Stop();
+	MatVecsF += r;
+
+	// M = [D^dag Z]^{-1}
+	InnerTimer.Start();
+	innerProductMatrix(M,D,r,Z,r);
+	InnerTimer.Stop();
+	M = M.inverse();
+
+	// E = E + D M C ; T = Q - Z M
+	MaddTimer.Start();
+	maddMatrix(E,M*C,D,E);
+	maddMatrix(T,M,Z,Q,-1.0);
+	MaddTimer.Stop();
+
+	// Q S = T
+	QRTimer.Start();
+	rn = ThinQRfact(T,r,Q,S);
+	QRTimer.Stop();
+
+	// D = Q + D S^dag ; C = S C
+	MaddTimer.Start();
+	maddMatrix(D,S.adjoint(),D,Q);
+	MaddTimer.Stop();
+	C = S*C;
+	r = rn;
+
+	///////////////////////////////////////////////////
+	// Convergence monitor on the estimated residuals
+	///////////////////////////////////////////////////
+	Eigen::MatrixXcd RR = C.adjoint()*C;
+	std::vector<int> keep;
+	RealD max_resid = 0;
+	bool  dropped   = false;
+	update = true;
+	for(int a=0;a<s;a++){
+	  int j = active[a];
+	  RealD rr = real(RR(a,a));
+	  if ( rr/ssq[j] > max_resid ) max_resid = rr/ssq[j];
+	  if ( rr > MaxResidSinceLastRelUp[a] ) MaxResidSinceLastRelUp[a] = rr;
+	  if ( rr > Delta*MaxResidSinceLastRelUp[a] ) update = false;
+	  if ( rr <= rsq[j] ) dropped = true;
+	  else                keep.push_back(a);
+	}
+
+	std::cout << GridLogIterative << "MixedPrecisionBlockConjugateGradient: iteration "<< k
+		  <<" active "<< s <<" directions "<< r <<" max resid "<< ::sqrt(max_resid) <<std::endl;
+
+	if ( r==0 ) {
+	  update  = true;
+	  restart = true;
+	}
+	if ( update || !dropped ) continue;
+
+	////////////////////////////////////////////////////////
+	// Drop converged columns: commit their correction and
+	// contract Q, D onto the remaining columns of C
+	////////////////////////////////////////////////////////
+	for(int a=0;a<s;a++){
+	  if ( RR(a,a).real() <= rsq[active[a]] ) {
+	    int j = active[a];
+	    convert(tmp_d,E[a]);
+	    psi[j] = psi[j] + tmp_d;
+	    verified[j] = 0;
+	    std::cout << GridLogIterative << "MixedPrecisionBlockConjugateGradient: rhs "<< j
+		      <<" converged at iteration "<< k <<std::endl;
+	  }
+	}
+	int sn = keep.size();
+	std::vector<int> active_new(sn);
+	Eigen::MatrixXcd Ck(r,sn);
+	for(int a=0;a<sn;a++){
+	  active_new[a] = active[keep[a]];
+	  Ck.col(a) = C.col(keep[a]);
+	  if ( a!=keep[a] ) {
+	    E[a] = E[keep[a]];
+	    MaxResidSinceLastRelUp[a] = MaxResidSinceLastRelUp[keep[a]];
+	  }
+	}
+	active = active_new;
+	s = sn;
+	MaxResidSinceLastRelUp.resize(sn);
+	if ( sn==0 ) {
+	  update = true;
+	  correction = false;
+	  continue;
+	}
+
+	// Ck = U Sigma V^dag ; Q' = Q U_r ; C' = U_r^dag Ck ; D' = D Ck C'^+
+	QRTimer.Start();
+	Eigen::JacobiSVD<Eigen::MatrixXcd> svd(Ck,Eigen::ComputeThinU);
+	Eigen::VectorXd sigma = svd.singularValues();
+	int rk=0;
+	for(int i=0;i<sigma.size();i++) if ( sigma(i) > ::sqrt(RankTolerance)*sigma(0) ) rk++;
+	Eigen::MatrixXcd Ur = svd.matrixU().leftCols(rk);
+	Eigen::MatrixXcd Cn = Ur.adjoint()*Ck;
+	W = Ck * Cn.adjoint() * (Cn*Cn.adjoint()).inverse();
+	QRTimer.Stop();
+
+	MaddTimer.Start();
+	mulMatrix(Q,Ur,Q);
+	mulMatrix(D,W,D);
+	MaddTimer.Stop();
+	C = Cn;
+	r = rk;
+      }
+    }
+    SolverTimer.Stop();
+
+    RealD max_resid=0;
+    for(int j=0;j<Nrhs;j++){
+      RealD rr = ::sqrt(true_rr[j]/ssq[j]);
+      if ( rr>max_resid ) max_resid = rr;
+      std::cout << GridLogMessage << "\t\trhs "<< j <<" true residual "<< rr << std::endl;
+    }
+    std::cout << GridLogMessage << "MixedPrecisionBlockConjugateGradient converged in "<< k <<" iterations, "
+	      << ReliableUpdatesPerformed <<" reliable updates"<<std::endl;
+    std::cout << GridLogMessage << "\tMax true residual "<< max_resid <<" target "<< Tolerance <<std::endl;
+    std::cout << GridLogMessage << "\tSingle prec matvecs "<< MatVecsF <<" double prec matvecs "<< MatVecsD
+	      <<" ; "<< k*Nrhs <<" for a fixed width block"<<std::endl;
+
+    std::cout << GridLogMessage << "Time Breakdown "<<std::endl;
+    std::cout << GridLogMessage << "\tElapsed    " << SolverTimer.Elapsed()   <<std::endl;
+    std::cout << GridLogMessage << "\tMatrix     " << MatrixTimer.Elapsed()   <<std::endl;
+    std::cout << GridLogMessage << "\tInnerProd  " << InnerTimer.Elapsed()    <<std::endl;
+    std::cout << GridLogMessage << "\tMaddMatrix " << MaddTimer.Elapsed()     <<std::endl;
+    std::cout << GridLogMessage << "\tThinQRfact " << QRTimer.Elapsed()       <<std::endl;
+    std::cout << GridLogMessage << "\tReliable   " << ReliableTimer.Elapsed() <<std::endl;
+
+    IterationsToComplete = k;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// The same solver in the precision of Field, as an OperatorFunction so that it
+// can sit under SchurRedBlackDiagMooeeSolve and friends. The operator passed in
+// is used both for the iteration and for the residual replacement.
+//////////////////////////////////////////////////////////////////////////////
+template<class Field>
+class ReliableBlockConjugateGradient : public OperatorFunction<Field> {
+public:
+  using OperatorFunction<Field>::operator();
+
+  bool    ErrorOnNoConverge;
+  RealD   Tolerance;
+  Integer MaxIterations;
+  RealD   Delta;
+
+  Integer IterationsToComplete;
+  Integer MatVecs;
+
+  ReliableBlockConjugateGradient(RealD tol,Integer maxit,RealD _delta=1.0e-3,bool err_on_no_conv = true)
+    : Tolerance(tol), MaxIterations(maxit), Delta(_delta), ErrorOnNoConverge(err_on_no_conv)
+  {};
+
+  void operator()(LinearOperatorBase<Field> &Linop,const Field &src,Field &psi)
+  {
+    std::vector<Field> src1(1,src);
+    std::vector<Field> psi1(1,psi);
+    (*this)(Linop,src1,psi1);
+    psi = psi1[0];
+  }
+  void operator()(LinearOperatorBase<Field> &Linop,const std::vector<Field> &src,std::vector<Field> &psi)
+  {
+    assert(src.size()>0);
+    MixedPrecisionBlockConjugateGradient<Field,Field> BCG(Tolerance,MaxIterations,Delta,src[0]._grid,
+							  Linop,Linop,ErrorOnNoConverge);
+    BCG(src,psi);
+    IterationsToComplete = BCG.IterationsToComplete;
+    MatVecs              = BCG.MatVecsF+BCG.MatVecsD;
+  }
+};
+
+}
+#endif
@@ -0,0 +1,200 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/algorithms/iterative/CompressedEigenvectors.h
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#ifndef GRID_COMPRESSED_EIGENVECTORS_H
+#define GRID_COMPRESSED_EIGENVECTORS_H
+
+namespace Grid {
+
+//////////////////////////////////////////////////////////////////////////////
+// IEEE binary16 conversion, round to nearest even.
+// Done in software so that stored coefficients do not depend on the half
+// precision support (or lack of it) of the SIMD target.
+//////////////////////////////////////////////////////////////////////////////
+inline uint16_t fp16FromFloat(float f)
+{
+  uint32_t x;
+  memcpy(&x,&f,sizeof(x));
+  uint32_t sign = (x>>16)&0x8000;
+  uint32_t absx = x&0x7fffffff;
+
+  if ( absx >= 0x7f800000 ) return sign | ((absx > 0x7f800000) ? 0x7e00 : 0x7c00); // NaN, Inf
+  if ( absx >= 0x47800000 ) return sign | 0x7c00;                                   // overflow
+  if ( absx <  0x38800000 ) {                                                       // subnormal
+    if ( absx < 0x33000000 ) return sign;
+    uint32_t e     = absx>>23;
+    uint32_t m     = (absx&0x7fffff)|0x800000;
+    uint32_t shift = 126-e;
+    uint32_t h     = m>>shift;
+    uint32_t rem   = m&((1u<<shift)-1);
+    uint32_t half  = 1u<<(shift-1);
+    if ( (rem>half) || ((rem==half)&&(h&0x1)) ) h++;
+    return sign|h;
+  }
+  uint32_t h   = (absx-0x38000000)>>13;
+  uint32_t rem = absx&0x1fff;
+  if ( (rem>0x1000) || ((rem==0x1000)&&(h&0x1)) ) h++;
+  return sign|h;
+}
+
+inline float fp16ToFloat(uint16_t h)
+{
+  uint32_t sign = ((uint32_t)(h&0x8000))<<16;
+  uint32_t e    = (h>>10)&0x1f;
+  uint32_t m    = h&0x3ff;
+  uint32_t x;
+  if ( e==0x1f ) {
+    x = sign|0x7f800000|(m<<13);
+  } else if ( e==0 ) {
+    if ( m==0 ) {
+      x = sign;
+    } else {
+      e = 113;
+      while ( !(m&0x400) ) { m<<=1; e--; }
+      x = sign|(e<<23)|((m&0x3ff)<<13);
+    }
+  } else {
+    x = sign|((e+112)<<23)|(m<<13);
+  }
+  float f;
+  memcpy(&f,&x,sizeof(f));
+  return f;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Eigenvectors of a fine operator stored as a block basis (the local coherence
+// subspace) plus coarse coefficient vectors held in fp16. Each coarse vector is
+// scaled by its norm before rounding so every coefficient lies in [-1,1].
+// Fine vectors are only ever reconstructed on demand.
+//////////////////////////////////////////////////////////////////////////////
+template<class Fobj,class CComplex,int nbasis>
+class CompressedEigenvectors
+{
+public:
+  typedef iVector<CComplex,nbasis >                          CoarseSiteVector;
+  typedef Lattice<CoarseSiteVector>                          CoarseField;
+  typedef Lattice<Fobj>                                      FineField;
+  typedef typename getPrecision<CoarseSiteVector>::real_scalar_type CoeffWord;
+
+  GridBase *_FineGrid;
+  GridBase *_CoarseGrid;
+  int       _checkerboard;
+  int       _coarse_checkerboard;
+
+  std::vector<FineField>              subspace; // block basis, full precision
+  std::vector<RealD>                  evals;
+  std::vector<RealD>                  scale;    // per vector norm removed before rounding
+  std::vector<std::vector<uint16_t> > coef;     // fp16 coarse coefficients in simd layout
+
+  CompressedEigenvectors(GridBase *FineGrid,GridBase *CoarseGrid,int checkerboard) :
+    _FineGrid(FineGrid),
+    _CoarseGrid(CoarseGrid),
+    _checkerboard(checkerboard),
+    _coarse_checkerboard(0),
+    subspace(nbasis,FineGrid)
+  {
+    for(int b=0;b<nbasis;b++) subspace[b].checkerboard = checkerboard;
+  };
+
+  int size(void) const { return evals.size(); }
+
+  uint64_t coefWords(void) const {
+    return (uint64_t)_CoarseGrid->oSites()*sizeof(CoarseSiteVector)/sizeof(CoeffWord);
+  }
+
+  void resize(int n) {
+    evals.resize(n);
+    scale.resize(n);
+    coef.resize(n);
+    for(int i=0;i<n;i++) coef[i].resize(coefWords());
+  }
+
+  void setSubspace(const std::vector<FineField> &basis) {
+    assert(basis.size()==nbasis);
+    for(int b=0;b<nbasis;b++) {
+      subspace[b] = basis[b];
+      subspace[b].checkerboard = _checkerboard;
+    }
+  }
+
+  void compress(int i,const CoarseField &in,RealD eval)
+  {
+    compress(i,in,eval,::sqrt(norm2(in)));
+  }
+
+  // Explicit scale, used when restoring vectors whose norm is already known
+  void compress(int i,const CoarseField &in,RealD eval,RealD nn)
+  {
+    assert(i<size());
+    conformable(in._grid,_CoarseGrid);
+    RealD inv = (nn>0.0) ? 1.0/nn : 0.0;
+    evals[i] = eval;
+    scale[i] = nn;
+    _coarse_checkerboard = in.checkerboard;
+
+    uint64_t words = coefWords();
+    CoeffWord *ip = (CoeffWord *)&in._odata[0];
+    uint16_t  *cp = &coef[i][0];
+    parallel_for(uint64_t w=0;w<words;w++){
+      cp[w] = fp16FromFloat((float)(ip[w]*inv));
+    }
+  }
+
+  void decompressCoarse(int i,CoarseField &out) const
+  {
+    assert(i<size());
+    conformable(out._grid,_CoarseGrid);
+    out.checkerboard = _coarse_checkerboard;
+    uint64_t words = coefWords();
+    CoeffWord      *op = (CoeffWord *)&out._odata[0];
+    const uint16_t *cp = &coef[i][0];
+    CoeffWord        s = scale[i];
+    parallel_for(uint64_t w=0;w<words;w++){
+      op[w] = s*fp16ToFloat(cp[w]);
+    }
+  }
+
+  void decompress(int i,FineField &out) const
+  {
+    CoarseField tmp(_CoarseGrid);
+    decompressCoarse(i,tmp);
+    out.checkerboard = _checkerboard;
+    blockPromote(tmp,out,subspace);
+  }
+
+  // Memory held compared with storing every fine vector in full
+  void report(void) const
+  {
+    double GB = 1024.0*1024.0*1024.0;
+    double basis  = (double)nbasis*_FineGrid->oSites()*sizeof(Fobj)/GB;
+    double coarse = (double)size()*coefWords()*sizeof(uint16_t)/GB;
+    double full   = (double)size()*_FineGrid->oSites()*sizeof(Fobj)/GB;
+    std::cout << GridLogMessage << "CompressedEigenvectors: "<< size() << " vectors in "<< nbasis <<" basis vectors "
+	      << basis << " GB + coefficients "<< coarse << " GB ; uncompressed "<< full << " GB per rank"<<std::endl;
+  }
+};
+
+}
+#endif
@@ -41,6 +41,7 @@ namespace Grid {
 template <class Field>
 class ConjugateGradient : public OperatorFunction<Field> {
  public:
+  using OperatorFunction<Field>::operator();
   bool ErrorOnNoConverge;  // throw an assert when the CG fails to converge.
                            // Defaults true.
   RealD Tolerance;
@@ -0,0 +1,92 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/algorithms/iterative/Deflation.h
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#ifndef GRID_DEFLATION_H
+#define GRID_DEFLATION_H
+
+namespace Grid {
+
+//////////////////////////////////////////////////////////////////////////////
+// Initial guess  x0 = sum_i v_i <v_i,src> / lambda_i  from stored eigenpairs
+//////////////////////////////////////////////////////////////////////////////
+template<class Field>
+class DeflatedGuesser : public LinearFunction<Field> {
+private:
+  const std::vector<Field> &evec;
+  const std::vector<RealD> &eval;
+
+public:
+  DeflatedGuesser(const std::vector<Field> & _evec,const std::vector<RealD> & _eval) : evec(_evec), eval(_eval) {};
+
+  virtual void operator()(const Field &src,Field &guess) {
+    guess = zero;
+    assert(evec.size()==eval.size());
+    auto N = evec.size();
+    for (int i=0;i<N;i++) {
+      const Field& tmp = evec[i];
+      axpy(guess,TensorRemove(innerProduct(tmp,src)) / eval[i],tmp,guess);
+    }
+    guess.checkerboard = src.checkerboard;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Same guess for block compressed eigenvectors. The source is projected into
+// the block basis once, the deflation is done entirely on the coarse grid and
+// the result promoted once, so no fine eigenvector is ever formed.
+//////////////////////////////////////////////////////////////////////////////
+template<class Fobj,class CComplex,int nbasis>
+class LocalCoherenceDeflatedGuesser : public LinearFunction<Lattice<Fobj> > {
+public:
+  typedef CompressedEigenvectors<Fobj,CComplex,nbasis> Evecs;
+  typedef typename Evecs::FineField                    FineField;
+  typedef typename Evecs::CoarseField                  CoarseField;
+
+private:
+  const Evecs &evecs;
+
+public:
+  LocalCoherenceDeflatedGuesser(const Evecs &_evecs) : evecs(_evecs) {};
+
+  virtual void operator()(const FineField &src,FineField &guess) {
+    CoarseField src_coarse(evecs._CoarseGrid);
+    CoarseField guess_coarse(evecs._CoarseGrid);
+    CoarseField evec_coarse(evecs._CoarseGrid);
+
+    blockProject(src_coarse,src,evecs.subspace);
+    src_coarse.checkerboard   = evecs._coarse_checkerboard;
+    guess_coarse.checkerboard = evecs._coarse_checkerboard;
+    guess_coarse = zero;
+    for (int i=0;i<evecs.size();i++) {
+      evecs.decompressCoarse(i,evec_coarse);
+      axpy(guess_coarse,TensorRemove(innerProduct(evec_coarse,src_coarse)) / evecs.evals[i],evec_coarse,guess_coarse);
+    }
+    blockPromote(guess_coarse,guess,evecs.subspace);
+    guess.checkerboard = src.checkerboard;
+  }
+};
+
+}
+#endif
@@ -346,6 +346,26 @@ public:
       std::cout << i << " Coarse eval = " << evals_coarse[i]  << std::endl;
     }
   }
+
+  ////////////////////////////////////////////////////////////////////////
+  // Export the block basis and coarse eigenvectors as fp16 compressed
+  // eigenvectors; the full precision coarse vectors may then be released.
+  ////////////////////////////////////////////////////////////////////////
+  void compress(CompressedEigenvectors<Fobj,CComplex,nbasis> &evecs,bool release=false)
+  {
+    assert(_Aggregate.subspace.size() == nbasis);
+    int n = evec_coarse.size();
+    evecs.setSubspace(_Aggregate.subspace);
+    evecs.resize(n);
+    for(int i=0;i<n;i++){
+      evecs.compress(i,evec_coarse[i],evals_coarse[i]);
+    }
+    if ( release ) {
+      evec_coarse.resize(0,_CoarseGrid);
+      evals_coarse.resize(0);
+    }
+    evecs.report();
+  }
 };
 
 }
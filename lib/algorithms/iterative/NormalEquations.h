@@ -39,6 +39,7 @@ namespace Grid {
     OperatorFunction<Field> & _HermitianSolver;
 
   public:
+    using OperatorFunction<Field>::operator();
 
     /////////////////////////////////////////////////////
     // Wrap the usual normal equations trick
@@ -0,0 +1,375 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/algorithms/iterative/PolynomialPreconditionedConjugateGradient.h
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#ifndef GRID_POLYNOMIAL_PRECONDITIONED_CONJUGATE_GRADIENT_H
+#define GRID_POLYNOMIAL_PRECONDITIONED_CONJUGATE_GRADIENT_H
+
+namespace Grid {
+
+//////////////////////////////////////////////////////////////////////////////
+// Bounds [lo,hi] on the spectrum of a hermitian positive operator from a few
+// unreorthogonalised Lanczos steps started on src. lo is the lowest Ritz value
+// (an over estimate of lambda_min, which is harmless for the polynomials below);
+// hi is the top Ritz value plus its residual bound |beta_m s_m|.
+// Returns the number of steps taken, fewer than Nsteps on breakdown.
+//////////////////////////////////////////////////////////////////////////////
+template<class Field>
+int LanczosSpectralBounds(LinearOperatorBase<Field> &HermOp,const Field &src,int Nsteps,RealD &lo,RealD &hi)
+{
+  GridBase *grid = src._grid;
+  Field v0(grid);
+  Field v1(grid);
+  Field w(grid);
+
+  std::vector<RealD> alpha;
+  std::vector<RealD> beta;
+
+  RealD nn = norm2(src);
+  assert(nn>0.0);
+  v1 = (1.0/::sqrt(nn))*src;
+  v0 = zero;
+  v0.checkerboard = src.checkerboard;
+
+  RealD b = 0.0;
+  for(int j=0;j<Nsteps;j++){
+    HermOp.HermOp(v1,w);
+    if ( j>0 ) axpy(w,-b,v0,w);
+    RealD a = real(innerProduct(v1,w));
+    b = ::sqrt(axpy_norm(w,-a,v1,w));
+    alpha.push_back(a);
+    beta.push_back(b);
+    if ( b < 1.0e-12*std::fabs(a) ) break; // invariant subspace, Ritz values exact
+    v0 = v1;
+    v1 = (1.0/b)*w;
+  }
+
+  int m = alpha.size();
+  Eigen::MatrixXd T = Eigen::MatrixXd::Zero(m,m);
+  for(int i=0;i<m;i++){
+    T(i,i) = alpha[i];
+    if ( i+1<m ) T(i,i+1) = T(i+1,i) = beta[i];
+  }
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(T);
+  lo = eig.eigenvalues()(0);
+  hi = eig.eigenvalues()(m-1) + std::fabs(beta[m-1]*eig.eigenvectors()(m-1,m-1));
+
+  std::cout << GridLogMessage << "LanczosSpectralBounds: "<< m <<" steps lo = "<< lo <<" hi = "<< hi << std::endl;
+  return m;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// z = p(A) r for a fixed polynomial p of degree Degree, i.e. Degree applications
+// of HermOp and no global reductions beyond those the operator itself performs.
+//
+//  PolynomialChebyshev    : Chebyshev semi-iteration for A z = r on [lo,hi]. The
+//                           residual polynomial is a shifted, scaled T_n, so
+//                           p(x) > 0 on (0,hi] and p(A) is a valid CG preconditioner.
+//  PolynomialLeastSquares : p minimises |1 - x p(x)| in the discrete least squares
+//                           sense at Chebyshev nodes of [lo,hi], applied through
+//                           Chebyshev<Field>. Falls back to the semi-iteration if
+//                           the fit is not positive on (0,hi].
+//
+// hi must bound the spectrum from above; it is widened by SafetyFactor.
+//////////////////////////////////////////////////////////////////////////////
+enum PolynomialPreconditionerType { PolynomialChebyshev, PolynomialLeastSquares };
+
+template<class Field>
+class PolynomialPreconditioner : public LinearFunction<Field> {
+public:
+  LinearOperatorBase<Field> &Linop;
+  PolynomialPreconditionerType Type;
+  int   Degree;
+  RealD lo;
+  RealD hi;
+  Chebyshev<Field> Cheby;
+
+  PolynomialPreconditioner(LinearOperatorBase<Field> &_Linop,PolynomialPreconditionerType _Type,int _Degree,
+			   RealD _lo,RealD _hi,RealD SafetyFactor=1.05) :
+    Linop(_Linop), Type(_Type), Degree(_Degree), lo(_lo), hi(_hi*SafetyFactor)
+  {
+    assert(Degree>=1);
+    assert((lo>0.0)&&(hi>lo));
+    if ( Type==PolynomialLeastSquares ) LeastSquaresFit();
+  };
+
+  // Value of the polynomial at x, for checking and plotting
+  RealD approx(RealD x)
+  {
+    if ( Type==PolynomialLeastSquares ) return Cheby.approx(x);
+    RealD theta = 0.5*(hi+lo);
+    RealD delta = 0.5*(hi-lo);
+    RealD sigma = theta/delta;
+    RealD rho   = 1.0/sigma;
+    RealD r = 1.0;
+    RealD d = 1.0/theta;
+    RealD z = d;
+    for(int n=0;n<Degree;n++){
+      r = r - x*d;
+      RealD rhon = 1.0/(2.0*sigma-rho);
+      d = rhon*rho*d + (2.0*rhon/delta)*r;
+      z = z + d;
+      rho = rhon;
+    }
+    return z;
+  }
+
+  void operator()(const Field &in,Field &out)
+  {
+    out.checkerboard = in.checkerboard;
+    if ( Type==PolynomialLeastSquares ) {
+      Cheby(Linop,in,out);
+      return;
+    }
+
+    GridBase *grid = in._grid;
+    Field r(grid);
+    Field d(grid);
+    Field Ad(grid);
+
+    RealD theta = 0.5*(hi+lo);
+    RealD delta = 0.5*(hi-lo);
+    RealD sigma = theta/delta;
+    RealD rho   = 1.0/sigma;
+
+    r   = in;
+    d   = (1.0/theta)*in;
+    out = d;
+    for(int n=0;n<Degree;n++){
+      Linop.HermOp(d,Ad);
+      axpy(r,-1.0,Ad,r);
+      RealD rhon = 1.0/(2.0*sigma-rho);
+      axpby(d,rhon*rho,2.0*rhon/delta,d,r);
+      axpy(out,1.0,d,out);
+      rho = rhon;
+    }
+  }
+
+private:
+  void LeastSquaresFit(void)
+  {
+    int Nc = Degree+1;
+    int Nx = 4*Nc;
+    Eigen::MatrixXd A(Nx,Nc);
+    Eigen::VectorXd b = Eigen::VectorXd::Ones(Nx);
+    for(int k=0;k<Nx;k++){
+      RealD y  = std::cos(M_PI*(k+0.5)/Nx);
+      RealD x  = 0.5*(y*(hi-lo)+(hi+lo));
+      RealD Tm = 1.0;
+      RealD Tn = y;
+      A(k,0) = x;
+      A(k,1) = x*y;
+      for(int j=2;j<Nc;j++){
+	RealD Tp = 2.0*y*Tn-Tm;
+	Tm = Tn;
+	Tn = Tp;
+	A(k,j) = x*Tn;
+      }
+    }
+    Eigen::VectorXd c = A.colPivHouseholderQr().solve(b);
+
+    std::vector<RealD> coeffs(Nc);
+    coeffs[0] = 2.0*c(0); // Chebyshev<Field> sums 0.5 c_0 T_0
+    for(int j=1;j<Nc;j++) coeffs[j] = c(j);
+    Cheby.Init(lo,hi,coeffs);
+
+    int Ncheck = 1000;
+    for(int i=1;i<=Ncheck;i++){
+      RealD x = hi*i/Ncheck;
+      if ( Cheby.approx(x) <= 0.0 ) {
+	std::cout << GridLogWarning << "PolynomialPreconditioner: least squares polynomial of degree "<< Degree
+		  <<" not positive at x = "<< x <<" ; using Chebyshev semi-iteration"<< std::endl;
+	Type = PolynomialChebyshev;
+	return;
+      }
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// CG on A preconditioned by p(A). Each outer iteration costs Degree+1 matrix
+// applications but only the <p,Ap> reduction of HermOpAndNorm plus one batched
+// GlobalSumVector for <r,r> and <z,r>, so reductions per unit of convergence
+// drop roughly by the degree. The spectral bounds are estimated with Nlanczos
+// Lanczos steps on every solve unless fixed with SetBounds.
+//
+// Use PolynomialPreconditioner directly with PrecGeneralisedConjugateResidual
+// for the flexible GCR variant.
+//////////////////////////////////////////////////////////////////////////////
+template<class Field>
+class PolynomialPreconditionedConjugateGradient : public OperatorFunction<Field> {
+public:
+  using OperatorFunction<Field>::operator();
+  bool    ErrorOnNoConverge;
+  RealD   Tolerance;
+  Integer MaxIterations;
+  PolynomialPreconditionerType Type;
+  int     Degree;
+  int     Nlanczos;
+  RealD   lo;
+  RealD   hi;
+  bool    FixedBounds;
+  Integer IterationsToComplete; // outer iterations, filled in upon completion
+  Integer MatVecs;              // HermOp applications of the last solve, including Lanczos
+  Integer Reductions;           // global sums issued by the solver itself
+
+  PolynomialPreconditionedConjugateGradient(RealD tol,Integer maxit,int degree,
+					    PolynomialPreconditionerType type=PolynomialChebyshev,
+					    int nlanczos=20,bool err_on_no_conv=true)
+    : Tolerance(tol),
+      MaxIterations(maxit),
+      Type(type),
+      Degree(degree),
+      Nlanczos(nlanczos),
+      lo(0.0), hi(0.0),
+      FixedBounds(false),
+      ErrorOnNoConverge(err_on_no_conv) {};
+
+  void SetBounds(RealD _lo,RealD _hi) { lo=_lo; hi=_hi; FixedBounds=true; };
+
+  void operator()(LinearOperatorBase<Field> &Linop,const Field &src,Field &psi)
+  {
+    GridBase *grid = src._grid;
+    psi.checkerboard = src.checkerboard;
+    conformable(psi,src);
+
+    MatVecs    = 0;
+    Reductions = 0;
+
+    GridStopWatch LanczosTimer;
+    GridStopWatch PrecTimer;
+    GridStopWatch MatrixTimer;
+    GridStopWatch LinalgTimer;
+    GridStopWatch SolverTimer;
+
+    SolverTimer.Start();
+    if ( !FixedBounds ) {
+      LanczosTimer.Start();
+      int nsteps = LanczosSpectralBounds(Linop,src,Nlanczos,lo,hi);
+      LanczosTimer.Stop();
+      MatVecs    += nsteps;
+      Reductions += 2*nsteps+1;
+    }
+    PolynomialPreconditioner<Field> Prec(Linop,Type,Degree,lo,hi);
+
+    std::vector<Field> rz(2,grid); // batched <r,r>, <z,r>
+    std::vector<ComplexD> ip(2);
+    Field &r = rz[0];
+    Field &z = rz[1];
+    Field p(grid);
+    Field Ap(grid);
+
+    RealD guess = norm2(psi);
+    assert(std::isnan(guess) == 0);
+
+    RealD d, qq;
+    Linop.HermOpAndNorm(psi,Ap,d,qq);
+    r = src - Ap;
+
+    PrecTimer.Start();
+    Prec(r,z);
+    PrecTimer.Stop();
+    p = z;
+
+    innerProductVector(ip,rz,2,r);
+    RealD cp  = real(ip[0]);
+    RealD rho = real(ip[1]);
+    RealD ssq = norm2(src);
+    RealD rsq = Tolerance*Tolerance*ssq;
+    MatVecs    += 1+Degree;
+    Reductions += 3;
+
+    std::cout << GridLogIterative << std::setprecision(8) << "PolynomialPreconditionedConjugateGradient: guess "<< guess << std::endl;
+    std::cout << GridLogIterative << std::setprecision(8) << "PolynomialPreconditionedConjugateGradient:   src "<< ssq << std::endl;
+    std::cout << GridLogIterative << std::setprecision(8) << "PolynomialPreconditionedConjugateGradient:  cp,r "<< cp << std::endl;
+
+    if ( cp <= rsq ) {
+      IterationsToComplete = 0;
+      return;
+    }
+
+    int k;
+    for (k=1;k<=MaxIterations;k++){
+
+      MatrixTimer.Start();
+      Linop.HermOpAndNorm(p,Ap,d,qq);
+      MatrixTimer.Stop();
+
+      LinalgTimer.Start();
+      RealD a = rho/d;
+      axpy(psi, a,p ,psi);
+      axpy(r  ,-a,Ap,r);
+      LinalgTimer.Stop();
+
+      PrecTimer.Start();
+      Prec(r,z);
+      PrecTimer.Stop();
+
+      LinalgTimer.Start();
+      innerProductVector(ip,rz,2,r);
+      cp = real(ip[0]);
+      RealD rhon = real(ip[1]);
+      RealD b = rhon/rho;
+      rho = rhon;
+      axpy(p,b,p,z);
+      LinalgTimer.Stop();
+
+      MatVecs    += 1+Degree;
+      Reductions += 2;
+
+      std::cout << GridLogIterative << "PolynomialPreconditionedConjugateGradient: Iteration " << k
+		<< " residual " << cp << " target " << rsq << std::endl;
+
+      if ( cp <= rsq ) {
+	SolverTimer.Stop();
+	Linop.HermOp(psi,Ap);
+	p = Ap - src;
+	RealD true_residual = ::sqrt(norm2(p)/ssq);
+
+	std::cout << GridLogMessage << "PolynomialPreconditionedConjugateGradient("<< Degree <<") Converged on iteration " << k
+		  << " matvecs "<< MatVecs <<" reductions "<< Reductions << std::endl;
+	std::cout << GridLogMessage << "\tComputed residual " << ::sqrt(cp/ssq) << std::endl;
+	std::cout << GridLogMessage << "\tTrue residual " << true_residual << std::endl;
+	std::cout << GridLogMessage << "\tTarget " << Tolerance << std::endl;
+
+	std::cout << GridLogMessage << "Time breakdown "<<std::endl;
+	std::cout << GridLogMessage << "\tElapsed    " << SolverTimer.Elapsed() <<std::endl;
+	std::cout << GridLogMessage << "\tLanczos    " << LanczosTimer.Elapsed() <<std::endl;
+	std::cout << GridLogMessage << "\tPrecon     " << PrecTimer.Elapsed() <<std::endl;
+	std::cout << GridLogMessage << "\tMatrix     " << MatrixTimer.Elapsed() <<std::endl;
+	std::cout << GridLogMessage << "\tLinalg     " << LinalgTimer.Elapsed() <<std::endl;
+
+	if (ErrorOnNoConverge) assert(true_residual / Tolerance < 10000.0);
+	IterationsToComplete = k;
+	return;
+      }
+    }
+    std::cout << GridLogMessage << "PolynomialPreconditionedConjugateGradient did NOT converge" << std::endl;
+    if (ErrorOnNoConverge) assert(0);
+    IterationsToComplete = k;
+  }
+};
+
+}
+#endif
@@ -38,6 +38,7 @@ namespace Grid {
   template<class Field> 
     class PrecConjugateResidual : public OperatorFunction<Field> {
   public:                                                
+    using OperatorFunction<Field>::operator();
     RealD   Tolerance;
     Integer MaxIterations;
     int verbose;
@@ -41,6 +41,7 @@ namespace Grid {
   template<class Field>
     class PrecGeneralisedConjugateResidual : public OperatorFunction<Field> {
   public:                                                
+    using OperatorFunction<Field>::operator();
     RealD   Tolerance;
     Integer MaxIterations;
     int verbose;
@@ -245,6 +245,61 @@ namespace Grid {
 
       std::cout<<GridLogMessage << "SchurRedBlackDiagMooee solver true unprec resid "<< std::sqrt(nr/ns) <<" nr "<< nr <<" ns "<<ns << std::endl;
     }     
+
+    /////////////////////////////////////////////////////
+    // Several sources at once: the red-black solver sees
+    // all the odd checkerboard systems in a single call
+    /////////////////////////////////////////////////////
+    template<class Matrix>
+      void operator() (Matrix & _Matrix,const std::vector<Field> &in, std::vector<Field> &out){
+
+      GridBase *grid = _Matrix.RedBlackGrid();
+      GridBase *fgrid= _Matrix.Grid();
+      int nblock = in.size();
+      assert(out.size()==nblock);
+
+      SchurDiagMooeeOperator<Matrix,Field> _HermOpEO(_Matrix);
+ 
+      std::vector<Field> src_o(nblock,grid);
+      std::vector<Field> sol_o(nblock,grid);
+      Field src_e(grid);
+      Field sol_e(grid);
+      Field   tmp(grid);
+      Field  Mtmp(grid);
+      Field resid(fgrid);
+
+      for(int b=0;b<nblock;b++){
+	pickCheckerboard(Even,src_e,in[b]);
+	pickCheckerboard(Odd ,src_o[b],in[b]);
+	pickCheckerboard(Odd ,sol_o[b],out[b]);
+
+	_Matrix.MooeeInv(src_e,tmp);     assert(  tmp.checkerboard ==Even);
+	_Matrix.Meooe   (tmp,Mtmp);      assert( Mtmp.checkerboard ==Odd);     
+	tmp=src_o[b]-Mtmp;               assert(  tmp.checkerboard ==Odd);     
+	_HermOpEO.MpcDag(tmp,src_o[b]);  assert(src_o[b].checkerboard ==Odd);       
+      }
+
+      std::cout<<GridLogMessage << "SchurRedBlack solver calling the MpcDagMp solver on "<< nblock <<" sources" <<std::endl;
+      _HermitianRBSolver(_HermOpEO,src_o,sol_o);
+
+      for(int b=0;b<nblock;b++){
+	assert(sol_o[b].checkerboard==Odd);
+	pickCheckerboard(Even,src_e,in[b]);
+	_Matrix.Meooe(sol_o[b],tmp);     assert(  tmp.checkerboard   ==Even);
+	src_e = src_e-tmp;               assert(  src_e.checkerboard ==Even);
+	_Matrix.MooeeInv(src_e,sol_e);   assert(  sol_e.checkerboard ==Even);
+     
+	setCheckerboard(out[b],sol_e);
+	setCheckerboard(out[b],sol_o[b]);
+
+	_Matrix.M(out[b],resid); 
+	resid = resid-in[b];
+	RealD ns = norm2(in[b]);
+	RealD nr = norm2(resid);
+
+	std::cout<<GridLogMessage << "SchurRedBlackDiagMooee solver true unprec resid["<<b<<"] "<< std::sqrt(nr/ns) <<" nr "<< nr <<" ns "<<ns << std::endl;
+      }
+    }     
   };
 
 
@@ -68,7 +68,179 @@ inline ComplexD innerProduct(const Lattice<vobj> &left,const Lattice<vobj> &righ
   right._grid->GlobalSum(nrm);
   return nrm;
 }
- 
+
+// Inner products <left[i],right> for i<n with a single global sum.
+// Thread and simd summation order is that of innerProduct.
+template<class vobj>
+inline void innerProductVector(std::vector<ComplexD> &result,const std::vector<Lattice<vobj> > &left,int n,
+			       const Lattice<vobj> &right)
+{
+  typedef typename vobj::vector_typeD vector_type;
+
+  GridBase *grid = right._grid;
+  int nthr = grid->SumArraySize();
+  assert(n<=left.size());
+
+  std::vector<vector_type,alignedAllocator<vector_type> > sumarray(nthr*n);
+
+  parallel_for(int thr=0;thr<nthr;thr++){
+    int mywork, myoff;
+    GridThread::GetWork(grid->oSites(),thr,mywork,myoff);
+    for(int i=0;i<n;i++){
+      decltype(innerProductD(left[i]._odata[0],right._odata[0])) vnrm=zero;
+      for(int ss=myoff;ss<mywork+myoff; ss++){
+	vnrm = vnrm + innerProductD(left[i]._odata[ss],right._odata[ss]);
+      }
+      sumarray[i*nthr+thr]=TensorRemove(vnrm) ;
+    }
+  }
+
+  result.resize(n);
+  for(int i=0;i<n;i++){
+    vector_type vvnrm; vvnrm=zero;
+    for(int thr=0;thr<nthr;thr++){
+      vvnrm = vvnrm+sumarray[i*nthr+thr];
+    }
+    result[i] = Reduce(vvnrm);
+  }
+  if ( n>0 ) grid->GlobalSumVector(&result[0],n);
+}
+
+// Block operations where the block index runs over a list of fields rather
+// than a lattice dimension (c.f. the slice* versions below).
+//
+// mat(i,j) = <left[i],right[j]> for i<nl, j<nr with a single global sum
+template<class vobj>
+inline void innerProductMatrix(Eigen::MatrixXcd &mat,const std::vector<Lattice<vobj> > &left,int nl,
+			       const std::vector<Lattice<vobj> > &right,int nr)
+{
+  typedef typename vobj::vector_typeD vector_type;
+
+  assert((nl<=left.size())&&(nr<=right.size()));
+  mat = Eigen::MatrixXcd::Zero(nl,nr);
+  if ( nl*nr==0 ) return;
+
+  GridBase *grid = right[0]._grid;
+  int nthr = grid->SumArraySize();
+  int nn   = nl*nr;
+
+  // accumulated in place: the aligned allocator must not be called inside a thread region
+  std::vector<vector_type,alignedAllocator<vector_type> > sumarray(nthr*nn);
+
+  parallel_for(int thr=0;thr<nthr;thr++){
+    int mywork, myoff;
+    GridThread::GetWork(grid->oSites(),thr,mywork,myoff);
+    for(int ij=0;ij<nn;ij++) sumarray[thr*nn+ij]=zero;
+    for(int ss=myoff;ss<mywork+myoff; ss++){
+      for(int i=0;i<nl;i++){
+      for(int j=0;j<nr;j++){
+	sumarray[thr*nn+i*nr+j] = sumarray[thr*nn+i*nr+j] + TensorRemove(innerProductD(left[i]._odata[ss],right[j]._odata[ss]));
+      }}
+    }
+  }
+
+  std::vector<ComplexD> result(nn);
+  for(int ij=0;ij<nn;ij++){
+    vector_type vvnrm; vvnrm=zero;
+    for(int thr=0;thr<nthr;thr++){
+      vvnrm = vvnrm+sumarray[thr*nn+ij];
+    }
+    result[ij] = Reduce(vvnrm);
+  }
+  grid->GlobalSumVector(&result[0],nn);
+  for(int i=0;i<nl;i++){
+  for(int j=0;j<nr;j++){
+    mat(i,j) = result[i*nr+j];
+  }}
+}
+
+// R[j] = Y[j] + scale * sum_i X[i] aa(i,j) for j<aa.cols(); R may alias X or Y
+template<class vobj>
+inline void maddMatrix(std::vector<Lattice<vobj> > &R,const Eigen::MatrixXcd &aa,
+		       const std::vector<Lattice<vobj> > &X,const std::vector<Lattice<vobj> > &Y,RealD scale=1.0)
+{
+  typedef typename vobj::scalar_type scalar_type;
+
+  int nx = aa.rows();
+  int nr = aa.cols();
+  assert((nx<=X.size())&&(nr<=Y.size())&&(nr<=R.size()));
+  if ( nr==0 ) return;
+
+  GridBase *grid = Y[0]._grid;
+  std::vector<scalar_type> coef(nx*nr);
+  for(int i=0;i<nx;i++){
+  for(int j=0;j<nr;j++){
+    coef[i*nr+j] = scalar_type(scale*aa(i,j));
+  }}
+  for(int j=0;j<nr;j++) R[j].checkerboard = Y[j].checkerboard;
+
+  // per thread site buffers, allocated outside the thread region
+  int nthr = GridThread::GetThreads();
+  std::vector<vobj,alignedAllocator<vobj> > buf(nthr*(nx+nr));
+
+  parallel_for(int thr=0;thr<nthr;thr++){
+    int mywork, myoff;
+    GridThread::GetWork(grid->oSites(),thr,mywork,myoff);
+    vobj *s_x = &buf[thr*(nx+nr)];
+    vobj *s_r = s_x+nx;
+    for(int ss=myoff;ss<mywork+myoff; ss++){
+      for(int i=0;i<nx;i++) s_x[i] = X[i]._odata[ss];
+      for(int j=0;j<nr;j++){
+	vobj dot = Y[j]._odata[ss];
+	for(int i=0;i<nx;i++){
+	  dot = dot + s_x[i]*coef[i*nr+j];
+	}
+	s_r[j] = dot;
+      }
+      for(int j=0;j<nr;j++) R[j]._odata[ss] = s_r[j];
+    }
+  }
+}
+
+// R[j] = scale * sum_i X[i] aa(i,j) for j<aa.cols(); R may alias X
+template<class vobj>
+inline void mulMatrix(std::vector<Lattice<vobj> > &R,const Eigen::MatrixXcd &aa,
+		      const std::vector<Lattice<vobj> > &X,RealD scale=1.0)
+{
+  typedef typename vobj::scalar_type scalar_type;
+
+  int nx = aa.rows();
+  int nr = aa.cols();
+  assert((nx<=X.size())&&(nr<=R.size()));
+  if ( nr==0 ) return;
+  assert(nx>0);
+
+  GridBase *grid = X[0]._grid;
+  std::vector<scalar_type> coef(nx*nr);
+  for(int i=0;i<nx;i++){
+  for(int j=0;j<nr;j++){
+    coef[i*nr+j] = scalar_type(scale*aa(i,j));
+  }}
+  for(int j=0;j<nr;j++) R[j].checkerboard = X[0].checkerboard;
+
+  // per thread site buffers, allocated outside the thread region
+  int nthr = GridThread::GetThreads();
+  std::vector<vobj,alignedAllocator<vobj> > buf(nthr*(nx+nr));
+
+  parallel_for(int thr=0;thr<nthr;thr++){
+    int mywork, myoff;
+    GridThread::GetWork(grid->oSites(),thr,mywork,myoff);
+    vobj *s_x = &buf[thr*(nx+nr)];
+    vobj *s_r = s_x+nx;
+    for(int ss=myoff;ss<mywork+myoff; ss++){
+      for(int i=0;i<nx;i++) s_x[i] = X[i]._odata[ss];
+      for(int j=0;j<nr;j++){
+	vobj dot = s_x[0]*coef[j];
+	for(int i=1;i<nx;i++){
+	  dot = dot + s_x[i]*coef[i*nr+j];
+	}
+	s_r[j] = dot;
+      }
+      for(int j=0;j<nr;j++) R[j]._odata[ss] = s_r[j];
+    }
+  }
+}
+
 template<class Op,class T1>
 inline auto sum(const LatticeUnaryExpression<Op,T1> & expr)
   ->typename decltype(expr.first.func(eval(0,std::get<0>(expr.second))))::scalar_object
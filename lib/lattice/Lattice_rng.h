@@ -128,7 +128,8 @@ namespace Grid {
 #ifdef RNG_MT19937 
     typedef std::mt19937 RngEngine;
     typedef uint32_t     RngStateType;
-    static const int     RngStateCount = std::mt19937::state_size;
+    // the state words and the position in them
+    static const int     RngStateCount = std::mt19937::state_size+1;
 #endif
 #ifdef RNG_SITMO
     typedef sitmo::prng_engine 	RngEngine;
@@ -40,7 +40,22 @@
 #endif
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <algorithm>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace Grid { 
 
@@ -82,10 +97,432 @@ inline void removeWhitespace(std::string &key)
 class BinaryIO {
  public:
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Asynchronous writes.
+  // A single background thread performs the file writes in submission order.
+  // Submission order is the same on all ranks, so the MPI-IO collectives of
+  // the I/O threads match; they use a duplicate of the grid communicator and
+  // never interleave with the collectives of the compute threads.
+  /////////////////////////////////////////////////////////////////////////////
+  class AsyncQueue {
+  public:
+    static AsyncQueue &instance(void) {
+      static AsyncQueue queue;
+      created() = true;
+      return queue;
+    }
+    static bool &created(void) {
+      static bool c = false;
+      return c;
+    }
+    std::shared_future<void> push(std::function<void(void)> task) {
+      std::packaged_task<void(void)> t(task);
+      std::shared_future<void>       f = t.get_future().share();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(t));
+      }
+      cv_.notify_one();
+      return f;
+    }
+    void wait(void) {
+      push([](){}).wait();
+    }
+#ifdef USE_MPI_IO
+    // called by the compute threads only, duplicates are kept until exit.
+    // The duplicate is found through an attribute of comm: a freed
+    // communicator handle can be reused, differently on each rank.
+    MPI_Comm communicator(MPI_Comm comm) {
+      static int key = MPI_KEYVAL_INVALID;
+      MPI_Comm   *dup;
+      int        flag;
+
+      if (key == MPI_KEYVAL_INVALID) {
+        MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, MPI_COMM_NULL_DELETE_FN, &key, nullptr);
+      }
+      MPI_Comm_get_attr(comm, key, &dup, &flag);
+      if (!flag) {
+        comms_.push_back(MPI_COMM_NULL);
+        dup = &comms_.back();
+        MPI_Comm_dup(comm, dup);
+        MPI_Comm_set_attr(comm, key, dup);
+      }
+      return *dup;
+    }
+#endif
+    ~AsyncQueue(void) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      cv_.notify_one();
+      thread_.join();
+    }
+  private:
+    AsyncQueue(void) : thread_([this](){ run(); }) {}
+    void run(void) {
+      while (true) {
+        std::packaged_task<void(void)> t;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          cv_.wait(lock, [this](){ return stop_ or !queue_.empty(); });
+          if (queue_.empty()) return;
+          t = std::move(queue_.front());
+          queue_.pop_front();
+        }
+        t();
+      }
+    }
+  private:
+    std::mutex                                 mutex_;
+    std::condition_variable                    cv_;
+    std::deque<std::packaged_task<void(void)>> queue_;
+    bool                                       stop_{false};
+#ifdef USE_MPI_IO
+    std::list<MPI_Comm>                        comms_;
+#endif
+    std::thread                                thread_;
+  };
+
+  // Completion handle of asynchronous writes, the checksums are available as
+  // soon as the request is returned.
+  class AsyncRequest {
+  public:
+    uint32_t nersc_csum   = 0;
+    uint32_t scidac_csuma = 0;
+    uint32_t scidac_csumb = 0;
+    uint64_t bytes        = 0;
+  public:
+    bool test(void) const {
+      for (auto &f: done) {
+        if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+      }
+      return true;
+    }
+    void wait(void) {
+      for (auto &f: done) f.get();
+      done.clear();
+    }
+    // further writes, run after the ones already in the request
+    void then(std::function<void(void)> task) {
+      done.push_back(AsyncQueue::instance().push(task));
+    }
+    // combined checksums as in writeRNG
+    void merge(const AsyncRequest &r) {
+      nersc_csum   = nersc_csum   + r.nersc_csum;
+      scidac_csuma = scidac_csuma ^ r.scidac_csuma;
+      scidac_csumb = scidac_csumb ^ r.scidac_csumb;
+      bytes       += r.bytes;
+      done.insert(done.end(), r.done.begin(), r.done.end());
+    }
+  private:
+    std::vector<std::shared_future<void>> done;
+  };
+
+  // wait for all the pending writes, must be called before MPI_Finalize
+  static inline void asyncFinalize(void) {
+    if (AsyncQueue::created()) AsyncQueue::instance().wait();
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   // more byte manipulation helpers
   /////////////////////////////////////////////////////////////////////////////
 
+  /////////////////////////////////////////////////////////////////////////////
+  // CRC-32 with the zlib polynomial, same result as zlib crc32: carry-less
+  // multiply folding when the CPU has it, otherwise slicing-by-8 (eight table
+  // lookups per 8 bytes instead of one per byte).
+  /////////////////////////////////////////////////////////////////////////////
+  static inline const uint32_t *crc32Tables(void)
+  {
+    static const std::vector<uint32_t> table = [](void)
+    {
+      std::vector<uint32_t> t(8*256);
+
+      for (uint32_t n = 0; n < 256; n++) {
+	uint32_t c = n;
+	for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : (c >> 1);
+	t[n] = c;
+      }
+      for (uint32_t n = 0; n < 256; n++) {
+	for (int s = 1; s < 8; s++) t[s*256 + n] = (t[(s-1)*256 + n] >> 8) ^ t[t[(s-1)*256 + n] & 0xFF];
+      }
+
+      return t;
+    }();
+
+    return table.data();
+  }
+
+#if defined(__x86_64__) && defined(__GNUC__)
+  // Carry-less multiply folding (PCLMULQDQ) of the reflected zlib polynomial,
+  // 64 bytes per iteration, for len >= 64 and a multiple of 16; crc is
+  // pre- and post-inverted by the caller.
+  __attribute__((target("pclmul,sse4.1")))
+  static inline uint32_t crc32Clmul(uint32_t crc, const unsigned char *buf, uint64_t len)
+  {
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+    const __m128i k5k0 = _mm_set_epi64x(0x0000000000LL, 0x0163cd6124LL);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(buf + 0x00)), _mm_cvtsi32_si128(crc));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    buf += 64; len -= 64;
+    while (len >= 64) {
+      x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00); x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+      x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00); x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+      x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00); x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+      x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00); x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(buf + 0x00)));
+      x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(buf + 0x10)));
+      x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(buf + 0x20)));
+      x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(buf + 0x30)));
+      buf += 64; len -= 64;
+    }
+    // fold 4x128 -> 128 bits, then the remaining 16 byte blocks
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00); x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00); x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00); x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+    while (len >= 16) {
+      x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00); x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)buf)), x5);
+      buf += 16; len -= 16;
+    }
+    // 128 -> 64 bits, then Barrett reduction to 32 bits
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5k0, 0x00), x2);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), poly, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return _mm_extract_epi32(x1, 1);
+  }
+
+  static inline bool crc32HasClmul(void)
+  {
+    static const bool has = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+
+    return has;
+  }
+#endif
+
+  static inline uint32_t crc32Sliced(uint32_t crc, const unsigned char *buf, uint64_t len)
+  {
+#if BYTE_ORDER == BIG_ENDIAN 
+    return crc32(crc, buf, len);
+#else
+    const uint32_t *t = crc32Tables();
+
+    crc = ~crc;
+#if defined(__x86_64__) && defined(__GNUC__)
+    if ((len >= 64) && crc32HasClmul()) {
+      uint64_t bulk = len & ~(uint64_t)15;
+
+      crc  = crc32Clmul(crc, buf, bulk);
+      buf += bulk;
+      len -= bulk;
+    }
+#endif
+    while (len && ((uintptr_t)buf & 7)) {
+      crc = t[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+      len--;
+    }
+    while (len >= 8) {
+      uint64_t w = *(const uint64_t *)buf ^ crc;
+
+      crc = t[7*256 + ( w        & 0xFF)] ^ t[6*256 + ((w >>  8) & 0xFF)] ^
+	    t[5*256 + ((w >> 16) & 0xFF)] ^ t[4*256 + ((w >> 24) & 0xFF)] ^
+	    t[3*256 + ((w >> 32) & 0xFF)] ^ t[2*256 + ((w >> 40) & 0xFF)] ^
+	    t[1*256 + ((w >> 48) & 0xFF)] ^ t[0*256 + ( w >> 56        )];
+      buf += 8;
+      len -= 8;
+    }
+    while (len--) {
+      crc = t[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+#endif
+  }
+
+  // SciDAC site contribution, the checksum of site n is rotated by n%29 and n%31
+  static inline uint32_t crc32Rotate(uint32_t crc, uint32_t r)
+  {
+    return (r == 0) ? crc : (crc << r) | (crc >> (32 - r));
+  }
+
+  // Byte order of a single site, same conversions as the *_v functions
+  // below (they are their own inverse)
+  static const int BINARYIO_ORDER_NONE      = 0;
+  static const int BINARYIO_ORDER_IEEE32BIG = 1;
+  static const int BINARYIO_ORDER_IEEE32    = 2;
+  static const int BINARYIO_ORDER_IEEE64BIG = 3;
+  static const int BINARYIO_ORDER_IEEE64    = 4;
+
+  static inline int byteOrder(const std::string &format)
+  {
+    if (format == std::string("IEEE32BIG")) return BINARYIO_ORDER_IEEE32BIG;
+    if (format == std::string("IEEE32"))    return BINARYIO_ORDER_IEEE32;
+    if (format == std::string("IEEE64BIG")) return BINARYIO_ORDER_IEEE64BIG;
+    if (format == std::string("IEEE64"))    return BINARYIO_ORDER_IEEE64;
+    return BINARYIO_ORDER_NONE;
+  }
+
+  static inline void siteByteOrder(void *site, uint64_t bytes, int order)
+  {
+    uint32_t *f32 = (uint32_t *)site;
+    uint64_t *f64 = (uint64_t *)site;
+
+    switch (order) {
+    case BINARYIO_ORDER_IEEE32BIG:
+      for (uint64_t i = 0; i < bytes/sizeof(uint32_t); i++) f32[i] = ntohl(f32[i]);
+      break;
+    case BINARYIO_ORDER_IEEE32:
+      for (uint64_t i = 0; i < bytes/sizeof(uint32_t); i++) f32[i] = ntohl(byte_reverse32(f32[i]));
+      break;
+    case BINARYIO_ORDER_IEEE64BIG:
+      for (uint64_t i = 0; i < bytes/sizeof(uint64_t); i++) f64[i] = Grid_ntohll(f64[i]);
+      break;
+    case BINARYIO_ORDER_IEEE64:
+      for (uint64_t i = 0; i < bytes/sizeof(uint64_t); i++) f64[i] = Grid_ntohll(byte_reverse64(f64[i]));
+      break;
+    default:
+      break;
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Single pass over the local sites for lattice writes: munge, NERSC
+  // checksum, byte order and SciDAC checksum, while the site is in cache.
+  // The checksums are local, the caller does the global reductions.
+  /////////////////////////////////////////////////////////////////////////////
+  template<class sobj,class fobj,class munger>
+  static inline void mungeChecksumWrite(GridBase *grid,
+					std::vector<sobj> &scalardata,
+					std::vector<fobj> &iodata,
+					munger munge,
+					const std::string &format,
+					uint32_t &nersc_csum,
+					uint32_t &scidac_csuma,
+					uint32_t &scidac_csumb)
+  {
+    const uint64_t size32 = sizeof(fobj)/sizeof(uint32_t);
+    const int      order  = byteOrder(format);
+    const int      nd     = grid->_ndimension;
+    uint64_t       lsites = grid->lSites();
+
+    std::vector<int> local_vol   = grid->LocalDimensions();
+    std::vector<int> local_start = grid->LocalStarts();
+    std::vector<int> global_vol  = grid->FullDimensions();
+
+    nersc_csum   = 0;
+    scidac_csuma = 0;
+    scidac_csumb = 0;
+#pragma omp parallel
+    {
+      std::vector<int> coor(nd);
+      uint32_t nersc_csum_thr   = 0;
+      uint32_t scidac_csuma_thr = 0;
+      uint32_t scidac_csumb_thr = 0;
+
+#pragma omp for
+      for(uint64_t local_site=0;local_site<lsites;local_site++){
+	uint32_t *site_buf = (uint32_t *)&iodata[local_site];
+	uint32_t site_crc;
+	int      global_site;
+
+	munge(scalardata[local_site],iodata[local_site]);
+	for (uint64_t j = 0; j < size32; j++) nersc_csum_thr += site_buf[j];
+	siteByteOrder(site_buf,sizeof(fobj),order);
+	site_crc = crc32Sliced(0,(unsigned char *)site_buf,sizeof(fobj));
+
+	Lexicographic::CoorFromIndex(coor,local_site,local_vol);
+	for(int d=0;d<nd;d++) coor[d] += local_start[d];
+	Lexicographic::IndexFromCoor(coor,global_site,global_vol);
+	scidac_csuma_thr ^= crc32Rotate(site_crc,global_site%29);
+	scidac_csumb_thr ^= crc32Rotate(site_crc,global_site%31);
+      }
+
+#pragma omp critical
+      {
+	nersc_csum   += nersc_csum_thr;
+	scidac_csuma ^= scidac_csuma_thr;
+	scidac_csumb ^= scidac_csumb_thr;
+      }
+    }
+  }
+
+  // Reverse sequence for reads: SciDAC checksum, byte order, NERSC checksum
+  // and munge. For slabs of a larger file, the site positions in the file
+  // are given by file_start (of the local volume) and file_vol.
+  template<class sobj,class fobj,class munger>
+  static inline void mungeChecksumRead(GridBase *grid,
+				       std::vector<sobj> &scalardata,
+				       std::vector<fobj> &iodata,
+				       munger munge,
+				       const std::string &format,
+				       uint32_t &nersc_csum,
+				       uint32_t &scidac_csuma,
+				       uint32_t &scidac_csumb,
+				       const std::vector<int> &file_start = std::vector<int>(),
+				       const std::vector<int> &file_vol   = std::vector<int>())
+  {
+    const uint64_t size32 = sizeof(fobj)/sizeof(uint32_t);
+    const int      order  = byteOrder(format);
+    const int      nd     = grid->_ndimension;
+    uint64_t       lsites = grid->lSites();
+
+    std::vector<int> local_vol   = grid->LocalDimensions();
+    std::vector<int> local_start = file_start.empty() ? grid->LocalStarts()     : file_start;
+    std::vector<int> global_vol  = file_vol.empty()   ? grid->FullDimensions()  : file_vol;
+
+    nersc_csum   = 0;
+    scidac_csuma = 0;
+    scidac_csumb = 0;
+#pragma omp parallel
+    {
+      std::vector<int> coor(nd);
+      uint32_t nersc_csum_thr   = 0;
+      uint32_t scidac_csuma_thr = 0;
+      uint32_t scidac_csumb_thr = 0;
+
+#pragma omp for
+      for(uint64_t local_site=0;local_site<lsites;local_site++){
+	uint32_t *site_buf = (uint32_t *)&iodata[local_site];
+	uint32_t site_crc;
+	int      global_site;
+
+	site_crc = crc32Sliced(0,(unsigned char *)site_buf,sizeof(fobj));
+	Lexicographic::CoorFromIndex(coor,local_site,local_vol);
+	for(int d=0;d<nd;d++) coor[d] += local_start[d];
+	Lexicographic::IndexFromCoor(coor,global_site,global_vol);
+	scidac_csuma_thr ^= crc32Rotate(site_crc,global_site%29);
+	scidac_csumb_thr ^= crc32Rotate(site_crc,global_site%31);
+
+	siteByteOrder(site_buf,sizeof(fobj),order);
+	for (uint64_t j = 0; j < size32; j++) nersc_csum_thr += site_buf[j];
+	munge(iodata[local_site],scalardata[local_site]);
+      }
+
+#pragma omp critical
+      {
+	nersc_csum   += nersc_csum_thr;
+	scidac_csuma ^= scidac_csuma_thr;
+	scidac_csumb ^= scidac_csumb_thr;
+      }
+    }
+  }
+
   template<class vobj> static inline void Uint32Checksum(Lattice<vobj> &lat,uint32_t &nersc_csum)
   {
     typedef typename vobj::scalar_object sobj;
@@ -174,11 +611,11 @@ class BinaryIO {
 	uint32_t gsite29   = global_site%29;
 	uint32_t gsite31   = global_site%31;
 	
-	site_crc = crc32(0,(unsigned char *)site_buf,sizeof(fobj));
+	site_crc = crc32Sliced(0,(unsigned char *)site_buf,sizeof(fobj));
 	//	std::cout << "Site "<<local_site << " crc "<<std::hex<<site_crc<<std::dec<<std::endl;
 	//	std::cout << "Site "<<local_site << std::hex<<site_buf[0] <<site_buf[1]<<std::dec <<std::endl;
-	scidac_csuma_thr ^= site_crc<<gsite29 | site_crc>>(32-gsite29);
-	scidac_csumb_thr ^= site_crc<<gsite31 | site_crc>>(32-gsite31);
+	scidac_csuma_thr ^= crc32Rotate(site_crc,gsite29);
+	scidac_csumb_thr ^= crc32Rotate(site_crc,gsite31);
       }
 
 #pragma omp critical
@@ -250,18 +687,242 @@ class BinaryIO {
   // Read or Write distributed lexico array of ANY object to a specific location in file 
   //////////////////////////////////////////////////////////////////////////////////////
 
+  // PREPARED: iodata is already in file byte order (write) or is left in it
+  // (read), the checksums are done by the caller, see mungeChecksumWrite/Read
+  static const int BINARYIO_PREPARED      = 0x20;
   static const int BINARYIO_MASTER_APPEND = 0x10;
   static const int BINARYIO_UNORDERED     = 0x08;
   static const int BINARYIO_LEXICOGRAPHIC = 0x04;
   static const int BINARYIO_READ          = 0x02;
   static const int BINARYIO_WRITE         = 0x01;
 
+  /////////////////////////////////////////////////////////////////////////////
+  // MPI-IO tuning (--io-aggregators, --io-hints, or checkpointer parameters).
+  // aggregators: number of ranks doing the file accesses of lexicographic
+  //   objects, 0 for all ranks. The ranks are split in groups of consecutive
+  //   ranks (usually on the same node, so the gathers go through shared
+  //   memory), the first rank of each group gathers the data of the group and
+  //   the aggregators alone do the collective write or read, in large blocks.
+  // hints: comma separated key=value MPI_Info hints given to MPI_File_open and
+  //   MPI_File_set_view, e.g. "striping_factor=16,cb_nodes=8,romio_cb_write=enable"
+  /////////////////////////////////////////////////////////////////////////////
+  struct IOParameters {
+    int         aggregators = 0;
+    std::string hints;
+  };
+
+  static inline IOParameters &ioParameters(void)
+  {
+    static IOParameters p;
+    return p;
+  }
+
+  // number of aggregators actually used for nrank ranks, 0 if all ranks write
+  static inline int ioAggregators(int nrank)
+  {
+    int nagg = ioParameters().aggregators;
+
+    return ((nagg > 0) && (nagg < nrank)) ? nagg : 0;
+  }
+
+#ifdef USE_MPI_IO
+  // to be freed with MPI_Info_free if not MPI_INFO_NULL
+  static inline MPI_Info ioInfo(void)
+  {
+    MPI_Info          info = MPI_INFO_NULL;
+    std::stringstream hints(ioParameters().hints);
+    std::string       kv;
+
+    while (std::getline(hints, kv, ',')) {
+      removeWhitespace(kv);
+      if (kv.empty()) continue;
+
+      size_t eq = kv.find('=');
+
+      if ((eq == std::string::npos) || (eq == 0)) {
+	std::cout << GridLogError << "Invalid MPI-IO hint '" << kv << "' (expected key=value)" << std::endl;
+	MPI_Abort(MPI_COMM_WORLD, 1);
+      }
+      if (info == MPI_INFO_NULL) MPI_Info_create(&info);
+      MPI_Info_set(info, (char *)kv.substr(0, eq).c_str(), (char *)kv.substr(eq + 1).c_str());
+    }
+
+    return info;
+  }
+
+  // group and aggregator communicators of comm for nagg aggregators, created
+  // collectively on comm and kept as an attribute of comm, so that they are
+  // freed with it
+  struct IOAggregatorComms {
+    int      nagg;
+    MPI_Comm group, aggr;
+  };
+
+  static inline int ioAggregatorCommsFree(MPI_Comm, int, void *val, void *)
+  {
+    IOAggregatorComms *c = (IOAggregatorComms *)val;
+
+    MPI_Comm_free(&c->group);
+    if (c->aggr != MPI_COMM_NULL) MPI_Comm_free(&c->aggr);
+    delete c;
+
+    return MPI_SUCCESS;
+  }
+
+  static inline void ioAggregatorComms(MPI_Comm comm, int nagg, MPI_Comm &group, MPI_Comm &aggr)
+  {
+    static int         key = [](void) {
+      int k;
+
+      MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, ioAggregatorCommsFree, &k, nullptr);
+      return k;
+    }();
+    IOAggregatorComms *c;
+    int               flag;
+
+    MPI_Comm_get_attr(comm, key, &c, &flag);
+    if (!flag || (c->nagg != nagg)) {
+      int nrank, rank, grank;
+
+      if (flag) MPI_Comm_delete_attr(comm, key);
+      c = new IOAggregatorComms;
+      c->nagg = nagg;
+      MPI_Comm_size(comm, &nrank);
+      MPI_Comm_rank(comm, &rank);
+      MPI_Comm_split(comm, (int)(((int64_t)rank*nagg)/nrank), rank, &c->group);
+      MPI_Comm_rank(c->group, &grank);
+      MPI_Comm_split(comm, (grank == 0) ? 0 : MPI_UNDEFINED, rank, &c->aggr);
+      MPI_Comm_set_attr(comm, key, c);
+    }
+    group = c->group;
+    aggr  = c->aggr;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Aggregated collective transfer of the local lexicographic array data
+  // (sites of siteBytes bytes, local volume lLattice at gStart) to or from
+  // the global lexicographic array starting at offset in file. The
+  // aggregators order the gathered rows of sites (contiguous along x) in file
+  // order, merge the rows that are adjacent in the file and access the file
+  // through one indexed view. The rows are not moved: the buffer is accessed
+  // through an indexed memory type in file order, so that an aggregator only
+  // holds the data of its group once. All the transfers are of one derived
+  // datatype, so that no count overflows an int for large groups.
+  //////////////////////////////////////////////////////////////////////////////
+  static inline void aggregatedIO(MPI_Comm comm, int nagg,
+				  const std::string &file, uint64_t offset,
+				  void *data, int siteBytes,
+				  const std::vector<int> &gLattice,
+				  const std::vector<int> &lLattice,
+				  const std::vector<int> &gStart,
+				  bool write)
+  {
+    const uint64_t intMax = std::numeric_limits<int>::max();
+    MPI_Comm       group, aggr;
+    MPI_Datatype   siteType, localType;
+    int            ndim = gLattice.size(), gsize, ierr;
+    uint64_t       lsites = 1;
+
+    for (int d = 0; d < ndim; d++) lsites *= lLattice[d];
+    if (lsites > intMax) {
+      std::cerr << "aggregatedIO: local volume of " << lsites << " sites too large" << std::endl;
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    ioAggregatorComms(comm, nagg, group, aggr);
+    MPI_Comm_size(group, &gsize);
+    ierr=MPI_Type_contiguous(siteBytes, MPI_BYTE, &siteType);    assert(ierr==0);
+    ierr=MPI_Type_commit(&siteType);    assert(ierr==0);
+    ierr=MPI_Type_contiguous((int)lsites, siteType, &localType);    assert(ierr==0);
+    ierr=MPI_Type_commit(&localType);    assert(ierr==0);
+
+    // origins of the members of the group
+    std::vector<int> starts(gsize*ndim);
+
+    ierr=MPI_Gather((void *)&gStart[0], ndim, MPI_INT, &starts[0], ndim, MPI_INT, 0, group);    assert(ierr==0);
+
+    std::vector<char> gathered;
+
+    if (aggr != MPI_COMM_NULL) gathered.resize((uint64_t)gsize*lsites*siteBytes);
+    if (write) {
+      ierr=MPI_Gather(data, 1, localType, gathered.data(), 1, localType, 0, group);    assert(ierr==0);
+    }
+    if (aggr != MPI_COMM_NULL) {
+      // rows of the group in file order: (file site, position in gathered)
+      int      lx    = lLattice[0];
+      uint64_t nrows = lsites/lx;
+      std::vector<std::pair<uint64_t, uint64_t>> rows(gsize*nrows);
+
+      parallel_for(uint64_t i = 0; i < gsize*nrows; i++) {
+	uint64_t m = i/nrows, r = i%nrows, fsite = 0;
+	std::vector<int> lcoor(ndim);
+
+	Lexicographic::CoorFromIndex(lcoor, r*lx, lLattice);
+	for (int d = ndim - 1; d >= 0; d--) {
+	  fsite = fsite*gLattice[d] + starts[m*ndim + d] + lcoor[d];
+	}
+	rows[i] = std::make_pair(fsite, i*lx);
+      }
+      std::sort(rows.begin(), rows.end());
+      if (rows.size() > intMax) {
+	std::cerr << "aggregatedIO: " << rows.size() << " rows per aggregator, too many" << std::endl;
+	MPI_Abort(MPI_COMM_WORLD, 1);
+      }
+
+      // merged file blocks (of at most intMax sites), and rows in memory
+      std::vector<MPI_Aint> disp, memDisp(rows.size());
+      std::vector<int>      len, memLen(rows.size(), lx);
+
+      for (uint64_t i = 0; i < rows.size(); i++) {
+	memDisp[i] = rows[i].second*siteBytes;
+	if (!len.empty() && ((uint64_t)disp.back() + (uint64_t)len.back()*siteBytes == rows[i].first*siteBytes)
+	    && ((uint64_t)len.back() + lx <= intMax)) {
+	  len.back() += lx;
+	} else {
+	  disp.push_back(rows[i].first*siteBytes);
+	  len.push_back(lx);
+	}
+      }
+
+      MPI_Datatype fileType, memType;
+      MPI_File     fh;
+      MPI_Status   status;
+      MPI_Info     info = ioInfo();
+      int          mode = write ? (MPI_MODE_RDWR | MPI_MODE_CREATE) : MPI_MODE_RDONLY;
+
+      ierr=MPI_Type_create_hindexed(len.size(), &len[0], &disp[0], siteType, &fileType);    assert(ierr==0);
+      ierr=MPI_Type_commit(&fileType);    assert(ierr==0);
+      ierr=MPI_Type_create_hindexed(memLen.size(), &memLen[0], &memDisp[0], siteType, &memType);    assert(ierr==0);
+      ierr=MPI_Type_commit(&memType);    assert(ierr==0);
+      ierr=MPI_File_open(aggr, (char *)file.c_str(), mode, info, &fh);
+      if (ierr != MPI_SUCCESS) {
+	std::cerr << "aggregatedIO: cannot open file " << file << std::endl;
+	MPI_Abort(MPI_COMM_WORLD, 1);
+      }
+      ierr=MPI_File_set_view(fh, offset, siteType, fileType, "native", info);    assert(ierr==0);
+      if (write) {
+	ierr=MPI_File_write_all(fh, gathered.data(), 1, memType, &status);    assert(ierr==0);
+      } else {
+	ierr=MPI_File_read_all(fh, gathered.data(), 1, memType, &status);    assert(ierr==0);
+      }
+      MPI_File_close(&fh);
+      MPI_Type_free(&memType);
+      MPI_Type_free(&fileType);
+      if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+    }
+    if (!write) {
+      ierr=MPI_Scatter(gathered.data(), 1, localType, data, 1, localType, 0, group);    assert(ierr==0);
+    }
+    MPI_Type_free(&localType);
+    MPI_Type_free(&siteType);
+  }
+#endif
+
   template<class word,class fobj>
   static inline void IOobject(word w,
 			      GridBase *grid,
 			      std::vector<fobj> &iodata,
 			      std::string file,
-			      Integer offset,
+			      uint64_t offset,
 			      const std::string &format, int control,
 			      uint32_t &nersc_csum,
 			      uint32_t &scidac_csuma,
@@ -270,10 +931,13 @@ class BinaryIO {
     grid->Barrier();
     GridStopWatch timer; 
     GridStopWatch bstimer;
+    bool prepared = control & BINARYIO_PREPARED;
     
-    nersc_csum=0;
-    scidac_csuma=0;
-    scidac_csumb=0;
+    if (!prepared) {
+      nersc_csum=0;
+      scidac_csuma=0;
+      scidac_csumb=0;
+    }
 
     int ndim                 = grid->Dimensions();
     int nrank                = grid->ProcessorCount();
@@ -356,11 +1020,19 @@ class BinaryIO {
 
       if ( (control & BINARYIO_LEXICOGRAPHIC) && (nrank > 1) ) {
 #ifdef USE_MPI_IO
-	std::cout<< GridLogMessage<<"IOobject: MPI read I/O "<< file<< std::endl;
-	ierr=MPI_File_open(grid->communicator,(char *) file.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);    assert(ierr==0);
-	ierr=MPI_File_set_view(fh, disp, mpiObject, fileArray, "native", MPI_INFO_NULL);    assert(ierr==0);
-	ierr=MPI_File_read_all(fh, &iodata[0], 1, localArray, &status);    assert(ierr==0);
-	MPI_File_close(&fh);
+	if (int nagg = ioAggregators(nrank)) {
+	  std::cout<< GridLogMessage<<"IOobject: MPI read I/O "<< file<< " through " << nagg << " aggregators" << std::endl;
+	  aggregatedIO(grid->communicator,nagg,file,offset,&iodata[0],sizeof(fobj),gLattice,lLattice,gStart,false);
+	} else {
+	  MPI_Info info = ioInfo();
+
+	  std::cout<< GridLogMessage<<"IOobject: MPI read I/O "<< file<< std::endl;
+	  ierr=MPI_File_open(grid->communicator,(char *) file.c_str(), MPI_MODE_RDONLY, info, &fh);    assert(ierr==0);
+	  ierr=MPI_File_set_view(fh, disp, mpiObject, fileArray, "native", info);    assert(ierr==0);
+	  ierr=MPI_File_read_all(fh, &iodata[0], 1, localArray, &status);    assert(ierr==0);
+	  MPI_File_close(&fh);
+	  if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+	}
 	MPI_Type_free(&fileArray);
 	MPI_Type_free(&localArray);
 #else 
@@ -387,57 +1059,69 @@ class BinaryIO {
 
       grid->Barrier();
 
-      bstimer.Start();
-      ScidacChecksum(grid,iodata,scidac_csuma,scidac_csumb);
-      if (ieee32big) be32toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      if (ieee32)    le32toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      if (ieee64big) be64toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      if (ieee64)    le64toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      NerscChecksum(grid,iodata,nersc_csum);
-      bstimer.Stop();
+      if (!prepared) {
+	bstimer.Start();
+	ScidacChecksum(grid,iodata,scidac_csuma,scidac_csumb);
+	if (ieee32big) be32toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	if (ieee32)    le32toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	if (ieee64big) be64toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	if (ieee64)    le64toh_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	NerscChecksum(grid,iodata,nersc_csum);
+	bstimer.Stop();
+      }
     }
     
     if ( control & BINARYIO_WRITE ) { 
 
-      bstimer.Start();
-      NerscChecksum(grid,iodata,nersc_csum);
-      if (ieee32big) htobe32_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      if (ieee32)    htole32_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      if (ieee64big) htobe64_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      if (ieee64)    htole64_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
-      ScidacChecksum(grid,iodata,scidac_csuma,scidac_csumb);
-      bstimer.Stop();
+      if (!prepared) {
+	bstimer.Start();
+	NerscChecksum(grid,iodata,nersc_csum);
+	if (ieee32big) htobe32_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	if (ieee32)    htole32_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	if (ieee64big) htobe64_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	if (ieee64)    htole64_v((void *)&iodata[0], sizeof(fobj)*iodata.size());
+	ScidacChecksum(grid,iodata,scidac_csuma,scidac_csumb);
+	bstimer.Stop();
+      }
 
       grid->Barrier();
 
       timer.Start();
       if ( (control & BINARYIO_LEXICOGRAPHIC) && (nrank > 1) ) {
 #ifdef USE_MPI_IO
-        std::cout << GridLogMessage <<"IOobject: MPI write I/O " << file << std::endl;
-        ierr = MPI_File_open(grid->communicator, (char *)file.c_str(), MPI_MODE_RDWR | MPI_MODE_CREATE, MPI_INFO_NULL, &fh);
-	//        std::cout << GridLogMessage << "Checking for errors" << std::endl;
-        if (ierr != MPI_SUCCESS)
-        {
-          char error_string[BUFSIZ];
-          int length_of_error_string, error_class;
-
-          MPI_Error_class(ierr, &error_class);
-          MPI_Error_string(error_class, error_string, &length_of_error_string);
-          fprintf(stderr, "%3d: %s\n", myrank, error_string);
-          MPI_Error_string(ierr, error_string, &length_of_error_string);
-          fprintf(stderr, "%3d: %s\n", myrank, error_string);
-          MPI_Abort(MPI_COMM_WORLD, 1); //assert(ierr == 0);
+        if (int nagg = ioAggregators(nrank)) {
+          std::cout << GridLogMessage <<"IOobject: MPI write I/O " << file << " through " << nagg << " aggregators" << std::endl;
+          aggregatedIO(grid->communicator,nagg,file,offset,&iodata[0],sizeof(fobj),gLattice,lLattice,gStart,true);
+        } else {
+          MPI_Info info = ioInfo();
+
+          std::cout << GridLogMessage <<"IOobject: MPI write I/O " << file << std::endl;
+          ierr = MPI_File_open(grid->communicator, (char *)file.c_str(), MPI_MODE_RDWR | MPI_MODE_CREATE, info, &fh);
+	  //        std::cout << GridLogMessage << "Checking for errors" << std::endl;
+          if (ierr != MPI_SUCCESS)
+          {
+            char error_string[BUFSIZ];
+            int length_of_error_string, error_class;
+
+            MPI_Error_class(ierr, &error_class);
+            MPI_Error_string(error_class, error_string, &length_of_error_string);
+            fprintf(stderr, "%3d: %s\n", myrank, error_string);
+            MPI_Error_string(ierr, error_string, &length_of_error_string);
+            fprintf(stderr, "%3d: %s\n", myrank, error_string);
+            MPI_Abort(MPI_COMM_WORLD, 1); //assert(ierr == 0);
+          }
+
+          std::cout << GridLogDebug << "MPI read I/O set view " << file << std::endl;
+          ierr = MPI_File_set_view(fh, disp, mpiObject, fileArray, "native", info);
+          assert(ierr == 0);
+
+          std::cout << GridLogDebug << "MPI read I/O write all " << file << std::endl;
+          ierr = MPI_File_write_all(fh, &iodata[0], 1, localArray, &status);
+          assert(ierr == 0);
+
+          MPI_File_close(&fh);
+          if (info != MPI_INFO_NULL) MPI_Info_free(&info);
         }
-
-        std::cout << GridLogDebug << "MPI read I/O set view " << file << std::endl;
-        ierr = MPI_File_set_view(fh, disp, mpiObject, fileArray, "native", MPI_INFO_NULL);
-        assert(ierr == 0);
-
-        std::cout << GridLogDebug << "MPI read I/O write all " << file << std::endl;
-        ierr = MPI_File_write_all(fh, &iodata[0], 1, localArray, &status);
-        assert(ierr == 0);
-
-        MPI_File_close(&fh);
         MPI_Type_free(&fileArray);
         MPI_Type_free(&localArray);
 #else 
@@ -494,20 +1178,18 @@ class BinaryIO {
       timer.Stop();
     }
     
-    std::cout<<GridLogMessage<<"IOobject: ";
-    if ( control & BINARYIO_READ) std::cout << " read  ";
-    else                          std::cout << " write ";
     uint64_t bytes = sizeof(fobj)*iodata.size()*nrank;
-    std::cout<< bytes <<" bytes in "<<timer.Elapsed() <<" "
+    std::cout<<GridLogMessage<<"IOobject: "<<((control & BINARYIO_READ) ? " read  " : " write ")
+	     << bytes <<" bytes in "<<timer.Elapsed() <<" "
 	     << (double)bytes/ (double)timer.useconds() <<" MB/s "<<std::endl;
 
-    std::cout<<GridLogMessage<<"IOobject: endian and checksum overhead "<<bstimer.Elapsed()  <<std::endl;
+    if (!prepared) std::cout<<GridLogMessage<<"IOobject: endian and checksum overhead "<<bstimer.Elapsed()  <<std::endl;
 
     //////////////////////////////////////////////////////////////////////////////
     // Safety check
     //////////////////////////////////////////////////////////////////////////////
     // if the data size is 1 we do not want to sum over the MPI ranks
-    if (iodata.size() != 1){
+    if ((iodata.size() != 1) && !prepared){
       grid->Barrier();
       grid->GlobalSum(nersc_csum);
       grid->GlobalXOR(scidac_csuma);
@@ -516,6 +1198,152 @@ class BinaryIO {
     }
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Read a Lattice of object from a memory mapped file (--io-mmap): the
+  // sites are checksummed, byte swapped and munged from the page cache
+  // straight into the vector layout, without intermediate buffers. Each rank
+  // maps the file and reads its own sites, so no MPI-IO is involved.
+  //////////////////////////////////////////////////////////////////////////////////////
+  static inline bool &mmapRead(void)
+  {
+    static bool m = false;
+
+    return m;
+  }
+
+  template<class vobj,class fobj,class munger>
+  static inline void readLatticeObjectMmap(Lattice<vobj> &Umu,
+					   std::string file,
+					   munger munge,
+					   uint64_t offset,
+					   const std::string &format,
+					   uint32_t &nersc_csum,
+					   uint32_t &scidac_csuma,
+					   uint32_t &scidac_csumb)
+  {
+    typedef typename vobj::scalar_object sobj;
+
+    GridBase *grid  = Umu._grid;
+    int ndim        = grid->Nd();
+    int nsimd       = grid->Nsimd();
+    const int order = byteOrder(format);
+    uint64_t bytes  = offset + grid->gSites()*sizeof(fobj);
+    struct stat st;
+    GridStopWatch timer;
+
+    // this rank only touches the lexicographic range between its first and
+    // last local sites, only that window (page aligned) is mapped
+    std::vector<int> lo(ndim), hi(ndim);
+    int              glo, ghi;
+
+    for(int mu=0;mu<ndim;mu++){
+      lo[mu] = grid->_processor_coor[mu]*grid->_ldimensions[mu];
+      hi[mu] = lo[mu] + grid->_ldimensions[mu] - 1;
+    }
+    Lexicographic::IndexFromCoor(lo, glo, grid->_fdimensions);
+    Lexicographic::IndexFromCoor(hi, ghi, grid->_fdimensions);
+
+    uint64_t page  = sysconf(_SC_PAGESIZE);
+    uint64_t start = offset + (uint64_t)glo*sizeof(fobj);
+    uint64_t end   = offset + ((uint64_t)ghi + 1)*sizeof(fobj);
+    uint64_t base  = (start/page)*page;
+    uint64_t len   = end - base;
+
+    timer.Start();
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if ((fd < 0) || (fstat(fd, &st) != 0) || ((uint64_t)st.st_size < bytes)) {
+      std::cout << GridLogError << "readLatticeObjectMmap: cannot open file " << file 
+		<< " or file too short (" << bytes << " bytes expected)" << std::endl;
+#ifdef USE_MPI_IO
+      MPI_Abort(MPI_COMM_WORLD,1);
+#else
+      exit(1);
+#endif
+    }
+    void *map = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, base);
+    if (map == MAP_FAILED) {
+      std::cout << GridLogError << "readLatticeObjectMmap: mmap failed on file " << file << std::endl;
+#ifdef USE_MPI_IO
+      MPI_Abort(MPI_COMM_WORLD,1);
+#else
+      exit(1);
+#endif
+    }
+    // hints only, failures are harmless
+    madvise(map, len, MADV_SEQUENTIAL);
+    madvise(map, len, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    madvise(map, len, MADV_HUGEPAGE);
+#endif
+
+    // first site of the window
+    const unsigned char *data = (const unsigned char *)map + (start - base);
+    std::vector<std::vector<int> > icoor(nsimd);
+
+    for(int lane=0; lane < nsimd; lane++){
+      icoor[lane].resize(ndim);
+      grid->iCoorFromIindex(icoor[lane],lane);
+    }
+    nersc_csum   = 0;
+    scidac_csuma = 0;
+    scidac_csumb = 0;
+#pragma omp parallel
+    {
+      std::vector<int>    ocoor(ndim), lcoor(ndim), gcoor(ndim);
+      std::vector<sobj>   site(nsimd);
+      std::vector<sobj *> ptrs(nsimd);
+      fobj     fsite;
+      uint32_t nersc_csum_thr   = 0;
+      uint32_t scidac_csuma_thr = 0;
+      uint32_t scidac_csumb_thr = 0;
+
+      for(int lane=0; lane < nsimd; lane++) ptrs[lane] = &site[lane];
+#pragma omp for
+      for(uint64_t oidx = 0; oidx < grid->oSites(); oidx++){
+	grid->oCoorFromOindex(ocoor, oidx);
+	for(int lane=0; lane < nsimd; lane++){
+	  uint32_t *site_buf = (uint32_t *)&fsite;
+	  uint32_t  site_crc;
+	  int       global_site;
+
+	  for(int mu=0;mu<ndim;mu++){
+	    lcoor[mu] = ocoor[mu] + grid->_rdimensions[mu]*icoor[lane][mu];
+	    gcoor[mu] = lcoor[mu] + grid->_processor_coor[mu]*grid->_ldimensions[mu];
+	  }
+	  Lexicographic::IndexFromCoor(gcoor, global_site, grid->_fdimensions);
+
+	  const unsigned char *src = data + (uint64_t)(global_site - glo)*sizeof(fobj);
+	  site_crc = crc32Sliced(0,src,sizeof(fobj));
+	  scidac_csuma_thr ^= crc32Rotate(site_crc,global_site%29);
+	  scidac_csumb_thr ^= crc32Rotate(site_crc,global_site%31);
+
+	  memcpy(reinterpret_cast<unsigned char *>(&fsite), src, sizeof(fobj));
+	  siteByteOrder(site_buf,sizeof(fobj),order);
+	  for (uint64_t j = 0; j < sizeof(fobj)/sizeof(uint32_t); j++) nersc_csum_thr += site_buf[j];
+	  munge(fsite, site[lane]);
+	}
+	merge1(Umu._odata[oidx], ptrs, 0);
+      }
+
+#pragma omp critical
+      {
+	nersc_csum   += nersc_csum_thr;
+	scidac_csuma ^= scidac_csuma_thr;
+	scidac_csumb ^= scidac_csumb_thr;
+      }
+    }
+    munmap(map, len);
+    ::close(fd);
+    grid->GlobalSum(nersc_csum);
+    grid->GlobalXOR(scidac_csuma);
+    grid->GlobalXOR(scidac_csumb);
+    grid->Barrier();
+    timer.Stop();
+
+    std::cout<<GridLogMessage<<"readLatticeObjectMmap: "<< end - start <<" bytes mapped in "<<timer.Elapsed() <<" "
+	     << (double)(end - start)/ (double)timer.useconds() <<" MB/s "<<std::endl;
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   // Read a Lattice of object
   //////////////////////////////////////////////////////////////////////////////////////
@@ -523,7 +1351,7 @@ class BinaryIO {
   static inline void readLatticeObject(Lattice<vobj> &Umu,
 				       std::string file,
 				       munger munge,
-				       Integer offset,
+				       uint64_t offset,
 				       const std::string &format,
 				       uint32_t &nersc_csum,
 				       uint32_t &scidac_csuma,
@@ -532,25 +1360,159 @@ class BinaryIO {
     typedef typename vobj::scalar_object sobj;
     typedef typename vobj::Realified::scalar_type word;    word w=0;
 
+    if (mmapRead()) {
+      readLatticeObjectMmap<vobj,fobj>(Umu,file,munge,offset,format,nersc_csum,scidac_csuma,scidac_csumb);
+      return;
+    }
+
     GridBase *grid = Umu._grid;
     int lsites = grid->lSites();
 
     std::vector<sobj> scalardata(lsites); 
     std::vector<fobj>     iodata(lsites); // Munge, checksum, byte order in here
     
-    IOobject(w,grid,iodata,file,offset,format,BINARYIO_READ|BINARYIO_LEXICOGRAPHIC,
+    IOobject(w,grid,iodata,file,offset,format,BINARYIO_READ|BINARYIO_LEXICOGRAPHIC|BINARYIO_PREPARED,
 	     nersc_csum,scidac_csuma,scidac_csumb);
 
     GridStopWatch timer; 
     timer.Start();
 
-    parallel_for(int x=0;x<lsites;x++) munge(iodata[x], scalardata[x]);
+    mungeChecksumRead(grid,scalardata,iodata,munge,format,nersc_csum,scidac_csuma,scidac_csumb);
+    grid->GlobalSum(nersc_csum);
+    grid->GlobalXOR(scidac_csuma);
+    grid->GlobalXOR(scidac_csumb);
 
     vectorizeFromLexOrdArray(scalardata,Umu);    
     grid->Barrier();
 
     timer.Stop();
-    std::cout<<GridLogMessage<<"readLatticeObject: vectorize overhead "<<timer.Elapsed()  <<std::endl;
+    std::cout<<GridLogMessage<<"readLatticeObject: checksum, munge and vectorize overhead "<<timer.Elapsed()  <<std::endl;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Read a hyperslab of a stored field: the file holds a lexicographic field
+  // of global size file_vol, Umu receives the sites [slab_start, slab_start +
+  // Umu global dimensions). Only the bytes of the slab are read, with an
+  // MPI-IO subarray view on several ranks and one read per contiguous run
+  // otherwise.
+  // The checksums are those of the slab sites (with their file positions),
+  // they equal the file checksums only if the slab is the whole field.
+  //////////////////////////////////////////////////////////////////////////////////////
+  template<class vobj,class fobj,class munger>
+  static inline void readLatticeObjectSlab(Lattice<vobj> &Umu,
+					   std::string file,
+					   munger munge,
+					   uint64_t offset,
+					   const std::string &format,
+					   const std::vector<int> &file_vol,
+					   const std::vector<int> &slab_start,
+					   uint32_t &nersc_csum,
+					   uint32_t &scidac_csuma,
+					   uint32_t &scidac_csumb)
+  {
+    typedef typename vobj::scalar_object sobj;
+    typedef typename vobj::Realified::scalar_type word;
+
+    GridBase *grid = Umu._grid;
+    int ndim       = grid->Nd();
+    int nrank      = grid->ProcessorCount();
+    int lsites     = grid->lSites();
+
+    std::vector<int> lLattice = grid->LocalDimensions();
+    std::vector<int> fStart(ndim);
+
+    assert(file_vol.size() == ndim);
+    assert(slab_start.size() == ndim);
+    for(int d=0;d<ndim;d++){
+      fStart[d] = slab_start[d] + grid->_processor_coor[d]*lLattice[d];
+      if ((slab_start[d] < 0) || (slab_start[d] + grid->_fdimensions[d] > file_vol[d])) {
+	std::cout << GridLogError << "readLatticeObjectSlab: slab outside of the field in direction "
+		  << d << std::endl;
+	assert(0);
+      }
+    }
+
+    std::vector<sobj> scalardata(lsites); 
+    std::vector<fobj>     iodata(lsites);
+
+    GridStopWatch timer, bstimer;
+    timer.Start();
+    if (nrank > 1) {
+#ifdef USE_MPI_IO
+      MPI_Datatype mpiObject, fileArray, localArray, mpiword;
+      MPI_Offset   disp = offset;
+      MPI_File     fh;
+      MPI_Status   status;
+      std::vector<int> lStart(ndim, 0), fVol(file_vol);
+      int numword, ierr;
+
+      if ( sizeof( word ) == sizeof(float ) ) {
+	numword = sizeof(fobj)/sizeof(float);
+	mpiword = MPI_FLOAT;
+      } else {
+	numword = sizeof(fobj)/sizeof(double);
+	mpiword = MPI_DOUBLE;
+      }
+      ierr=MPI_Type_contiguous(numword,mpiword,&mpiObject);    assert(ierr==0);
+      ierr=MPI_Type_commit(&mpiObject);    assert(ierr==0);
+      ierr=MPI_Type_create_subarray(ndim,&fVol[0],&lLattice[0],&fStart[0],MPI_ORDER_FORTRAN, mpiObject,&fileArray);    assert(ierr==0);
+      ierr=MPI_Type_commit(&fileArray);    assert(ierr==0);
+      ierr=MPI_Type_create_subarray(ndim,&lLattice[0],&lLattice[0],&lStart[0],MPI_ORDER_FORTRAN, mpiObject,&localArray);    assert(ierr==0);
+      ierr=MPI_Type_commit(&localArray);    assert(ierr==0);
+
+      std::cout<< GridLogMessage<<"readLatticeObjectSlab: MPI read I/O "<< file<< std::endl;
+      MPI_Info     info = ioInfo();
+
+      ierr=MPI_File_open(grid->communicator,(char *) file.c_str(), MPI_MODE_RDONLY, info, &fh);    assert(ierr==0);
+      ierr=MPI_File_set_view(fh, disp, mpiObject, fileArray, "native", info);    assert(ierr==0);
+      ierr=MPI_File_read_all(fh, &iodata[0], 1, localArray, &status);    assert(ierr==0);
+      MPI_File_close(&fh);
+      if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+      MPI_Type_free(&fileArray);
+      MPI_Type_free(&localArray);
+      MPI_Type_free(&mpiObject);
+#else 
+      assert(0);
+#endif
+    } else {
+      std::cout << GridLogMessage <<"readLatticeObjectSlab: C++ read I/O " << file << std::endl;
+      std::ifstream fin(file, std::ios::binary | std::ios::in);
+      std::vector<int> coor(ndim, 0);
+      // contiguous runs: x-rows, or whole planes when the slab spans the
+      // leading dimensions of the file
+      int run = lLattice[0];
+      for(int d=0;(d<ndim-1)&&(lLattice[d]==file_vol[d]);d++) run *= lLattice[d+1];
+      int nrun = lsites/run;
+
+      for(int r=0;r<nrun;r++){
+	int      lex;
+	uint64_t fsite;
+
+	Lexicographic::CoorFromIndex(coor,r*run,lLattice);
+	for(int d=0;d<ndim;d++) coor[d] += fStart[d];
+	Lexicographic::IndexFromCoor(coor,lex,file_vol);
+	fsite = lex;
+	fin.seekg(offset + fsite*sizeof(fobj));
+	fin.read((char *)&iodata[r*run], run*sizeof(fobj));
+      }
+      assert(fin.fail() == 0);
+    }
+    timer.Stop();
+    grid->Barrier();
+
+    bstimer.Start();
+    mungeChecksumRead(grid,scalardata,iodata,munge,format,nersc_csum,scidac_csuma,scidac_csumb,
+		      fStart,file_vol);
+    grid->GlobalSum(nersc_csum);
+    grid->GlobalXOR(scidac_csuma);
+    grid->GlobalXOR(scidac_csumb);
+    vectorizeFromLexOrdArray(scalardata,Umu);    
+    bstimer.Stop();
+
+    uint64_t bytes = sizeof(fobj)*grid->gSites();
+    std::cout<<GridLogMessage<<"readLatticeObjectSlab: read "<< bytes <<" bytes in "<<timer.Elapsed() <<" "
+	     << (double)bytes/ (double)timer.useconds() <<" MB/s, checksum, munge and vectorize overhead "
+	     << bstimer.Elapsed() <<std::endl;
   }
 
   /////////////////////////////////////////////////////////////////////////////
@@ -560,7 +1522,7 @@ class BinaryIO {
     static inline void writeLatticeObject(Lattice<vobj> &Umu,
 					  std::string file,
 					  munger munge,
-					  Integer offset,
+					  uint64_t offset,
 					  const std::string &format,
 					  uint32_t &nersc_csum,
 					  uint32_t &scidac_csuma,
@@ -575,20 +1537,23 @@ class BinaryIO {
     std::vector<fobj>     iodata(lsites); // Munge, checksum, byte order in here
 
     //////////////////////////////////////////////////////////////////////////////
-    // Munge [ .e.g 3rd row recon ]
+    // Munge [ .e.g 3rd row recon ], checksums and byte order in one pass
     //////////////////////////////////////////////////////////////////////////////
     GridStopWatch timer; timer.Start();
     unvectorizeToLexOrdArray(scalardata,Umu);    
 
-    parallel_for(int x=0;x<lsites;x++) munge(scalardata[x],iodata[x]);
+    mungeChecksumWrite(grid,scalardata,iodata,munge,format,nersc_csum,scidac_csuma,scidac_csumb);
+    grid->GlobalSum(nersc_csum);
+    grid->GlobalXOR(scidac_csuma);
+    grid->GlobalXOR(scidac_csumb);
 
     grid->Barrier();
     timer.Stop();
 
-    IOobject(w,grid,iodata,file,offset,format,BINARYIO_WRITE|BINARYIO_LEXICOGRAPHIC,
+    IOobject(w,grid,iodata,file,offset,format,BINARYIO_WRITE|BINARYIO_LEXICOGRAPHIC|BINARYIO_PREPARED,
 	     nersc_csum,scidac_csuma,scidac_csumb);
 
-    std::cout<<GridLogMessage<<"writeLatticeObject: unvectorize overhead "<<timer.Elapsed()  <<std::endl;
+    std::cout<<GridLogMessage<<"writeLatticeObject: unvectorize, munge and checksum overhead "<<timer.Elapsed()  <<std::endl;
   }
   
   /////////////////////////////////////////////////////////////////////////////
@@ -597,7 +1562,7 @@ class BinaryIO {
   static inline void readRNG(GridSerialRNG &serial,
 			     GridParallelRNG &parallel,
 			     std::string file,
-			     Integer offset,
+			     uint64_t offset,
 			     uint32_t &nersc_csum,
 			     uint32_t &scidac_csuma,
 			     uint32_t &scidac_csumb)
@@ -659,7 +1624,7 @@ class BinaryIO {
   static inline void writeRNG(GridSerialRNG &serial,
 			      GridParallelRNG &parallel,
 			      std::string file,
-			      Integer offset,
+			      uint64_t offset,
 			      uint32_t &nersc_csum,
 			      uint32_t &scidac_csuma,
 			      uint32_t &scidac_csumb)
@@ -712,6 +1677,231 @@ class BinaryIO {
     std::cout << GridLogMessage << "RNG file checksumb " << std::hex << scidac_csumb << std::dec << std::endl;
     std::cout << GridLogMessage << "RNG state overhead " << timer.Elapsed() << std::endl;
   }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Asynchronous version of IOobject for writes: the endian swap and the
+  // checksums are done in place on the staging buffer by the calling threads,
+  // then the file write is queued and the function returns. The buffer is
+  // owned by the request until the write is done.
+  //////////////////////////////////////////////////////////////////////////////////////
+  template<class word,class fobj>
+  static inline AsyncRequest IOobjectAsync(word w,
+					   GridBase *grid,
+					   std::shared_ptr<std::vector<fobj> > iodata,
+					   std::string file,
+					   uint64_t offset,
+					   const std::string &format, int control)
+  {
+    grid->Barrier();
+    GridStopWatch bstimer;
+    AsyncRequest  req;
+
+    assert(control & BINARYIO_WRITE);
+
+    int ndim                 = grid->Dimensions();
+    int nrank                = grid->ProcessorCount();
+    int myrank               = grid->ThisRank();
+    bool writer              = !(control & BINARYIO_MASTER_APPEND) || grid->IsBoss();
+    bool mpiio               = (control & BINARYIO_LEXICOGRAPHIC) && (nrank > 1);
+
+    std::vector<int>  pcoor  = grid->ThisProcessorCoor();
+    std::vector<int> gLattice= grid->GlobalDimensions();
+    std::vector<int> lLattice= grid->LocalDimensions();
+    std::vector<int> gStart(ndim);
+
+    uint64_t lsites = grid->lSites();
+    if ( control & BINARYIO_MASTER_APPEND )  {
+      assert(iodata->size()==1);
+    } else {
+      assert(lsites==iodata->size());
+    }
+    for(int d=0;d<ndim;d++){
+      gStart[d] = lLattice[d]*pcoor[d];
+    }
+
+    //////////////////////////////////////////////////////////////////////////////
+    // Checksums and byte order, as in IOobject
+    //////////////////////////////////////////////////////////////////////////////
+    std::vector<fobj> &buf = *iodata;
+
+    if (!(control & BINARYIO_PREPARED)) {
+      bstimer.Start();
+      NerscChecksum(grid,buf,req.nersc_csum);
+      if (format == std::string("IEEE32BIG")) htobe32_v((void *)&buf[0], sizeof(fobj)*buf.size());
+      if (format == std::string("IEEE32"))    htole32_v((void *)&buf[0], sizeof(fobj)*buf.size());
+      if (format == std::string("IEEE64BIG")) htobe64_v((void *)&buf[0], sizeof(fobj)*buf.size());
+      if (format == std::string("IEEE64"))    htole64_v((void *)&buf[0], sizeof(fobj)*buf.size());
+      ScidacChecksum(grid,buf,req.scidac_csuma,req.scidac_csumb);
+      bstimer.Stop();
+    }
+    if ((buf.size() != 1) && !(control & BINARYIO_PREPARED)){
+      grid->GlobalSum(req.nersc_csum);
+      grid->GlobalXOR(req.scidac_csuma);
+      grid->GlobalXOR(req.scidac_csumb);
+    }
+    req.bytes = sizeof(fobj)*buf.size()*((control & BINARYIO_MASTER_APPEND) ? 1 : nrank);
+
+    //////////////////////////////////////////////////////////////////////////////
+    // Queue the write, the geometry is captured by value
+    //////////////////////////////////////////////////////////////////////////////
+#ifdef USE_MPI_IO
+    MPI_Comm comm = mpiio ? AsyncQueue::instance().communicator(grid->communicator) 
+                          : MPI_COMM_NULL;
+#endif
+    int nagg = ioAggregators(nrank);
+    auto task = [=](void) {
+      if (mpiio && nagg) {
+#ifdef USE_MPI_IO
+	aggregatedIO(comm,nagg,file,offset,(void *)&(*iodata)[0],sizeof(fobj),gLattice,lLattice,gStart,true);
+#else
+	assert(0);
+#endif
+      } else if (mpiio) {
+#ifdef USE_MPI_IO
+	MPI_Info     info = ioInfo();
+	std::vector<int> lStart(ndim, 0), gl(gLattice), ll(lLattice), gs(gStart);
+	MPI_Datatype mpiObject, fileArray, localArray, mpiword;
+	MPI_Offset   disp = offset;
+	MPI_File     fh;
+	MPI_Status   status;
+	int          numword, ierr;
+
+	if ( sizeof( word ) == sizeof(float ) ) {
+	  numword = sizeof(fobj)/sizeof(float);
+	  mpiword = MPI_FLOAT;
+	} else {
+	  numword = sizeof(fobj)/sizeof(double);
+	  mpiword = MPI_DOUBLE;
+	}
+	ierr=MPI_Type_contiguous(numword,mpiword,&mpiObject);    assert(ierr==0);
+	ierr=MPI_Type_commit(&mpiObject);    assert(ierr==0);
+	ierr=MPI_Type_create_subarray(ndim,&gl[0],&ll[0],&gs[0],MPI_ORDER_FORTRAN, mpiObject,&fileArray);    assert(ierr==0);
+	ierr=MPI_Type_commit(&fileArray);    assert(ierr==0);
+	ierr=MPI_Type_create_subarray(ndim,&ll[0],&ll[0],&lStart[0],MPI_ORDER_FORTRAN, mpiObject,&localArray);    assert(ierr==0);
+	ierr=MPI_Type_commit(&localArray);    assert(ierr==0);
+	ierr=MPI_File_open(comm, (char *)file.c_str(), MPI_MODE_RDWR | MPI_MODE_CREATE, info, &fh);
+	if (ierr != MPI_SUCCESS) {
+	  std::cerr << "IOobjectAsync: rank " << myrank << " cannot open file " << file << std::endl;
+	  MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	ierr=MPI_File_set_view(fh, disp, mpiObject, fileArray, "native", info);    assert(ierr==0);
+	ierr=MPI_File_write_all(fh, (void *)&(*iodata)[0], 1, localArray, &status);    assert(ierr==0);
+	MPI_File_close(&fh);
+	if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+	MPI_Type_free(&fileArray);
+	MPI_Type_free(&localArray);
+	MPI_Type_free(&mpiObject);
+#else
+	assert(0);
+#endif
+      } else if (writer) {
+	std::ofstream fout(file,std::ios::binary|std::ios::out|std::ios::in);
+
+	if ( control & BINARYIO_MASTER_APPEND )  {
+	  fout.seekp(0,fout.end);
+	} else {
+	  fout.seekp(offset+myrank*lsites*sizeof(fobj));
+	}
+	fout.write((char *)&(*iodata)[0],iodata->size()*sizeof(fobj));
+	if (fout.fail()) {
+	  std::cerr << "IOobjectAsync: rank " << myrank << " error writing file " << file << std::endl;
+#ifdef USE_MPI_IO
+	  MPI_Abort(MPI_COMM_WORLD,1);
+#else
+	  exit(1);
+#endif
+	}
+      }
+    };
+    req.then(task);
+
+    std::cout<<GridLogMessage<<"IOobjectAsync: "<< req.bytes <<" bytes queued for "<< file
+	     <<", endian and checksum overhead "<<bstimer.Elapsed() <<std::endl;
+
+    return req;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Write a Lattice of object asynchronously, Umu can be modified as soon as
+  // the function returns
+  //////////////////////////////////////////////////////////////////////////////////////
+  template<class vobj,class fobj,class munger>
+  static inline AsyncRequest writeLatticeObjectAsync(Lattice<vobj> &Umu,
+						     std::string file,
+						     munger munge,
+						     uint64_t offset,
+						     const std::string &format)
+  {
+    typedef typename vobj::scalar_object sobj;
+    typedef typename vobj::Realified::scalar_type word;    word w=0;
+    GridBase *grid = Umu._grid;
+    int lsites = grid->lSites();
+
+    std::vector<sobj> scalardata(lsites); 
+    auto iodata = std::make_shared<std::vector<fobj> >(lsites);
+
+    uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+    AsyncRequest req;
+
+    GridStopWatch timer; timer.Start();
+    unvectorizeToLexOrdArray(scalardata,Umu);    
+
+    mungeChecksumWrite(grid,scalardata,*iodata,munge,format,nersc_csum,scidac_csuma,scidac_csumb);
+    grid->GlobalSum(nersc_csum);
+    grid->GlobalXOR(scidac_csuma);
+    grid->GlobalXOR(scidac_csumb);
+    timer.Stop();
+
+    std::cout<<GridLogMessage<<"writeLatticeObjectAsync: unvectorize, munge and checksum overhead "<<timer.Elapsed()  <<std::endl;
+
+    req = IOobjectAsync(w,grid,iodata,file,offset,format,BINARYIO_WRITE|BINARYIO_LEXICOGRAPHIC|BINARYIO_PREPARED);
+    req.nersc_csum   = nersc_csum;
+    req.scidac_csuma = scidac_csuma;
+    req.scidac_csumb = scidac_csumb;
+
+    return req;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Write a RNG asynchronously, same file layout as writeRNG
+  //////////////////////////////////////////////////////////////////////////////////////
+  static inline AsyncRequest writeRNGAsync(GridSerialRNG &serial,
+					   GridParallelRNG &parallel,
+					   std::string file,
+					   uint64_t offset)
+  {
+    typedef typename GridSerialRNG::RngStateType RngStateType;
+    typedef RngStateType word; word w=0;
+    const int RngStateCount = GridSerialRNG::RngStateCount;
+    typedef std::array<RngStateType,RngStateCount> RNGstate;
+
+    GridBase *grid = parallel._grid;
+    int lsites = grid->lSites();
+    std::string format = "IEEE32BIG";
+    AsyncRequest req;
+
+    auto iodata = std::make_shared<std::vector<RNGstate> >(lsites);
+    parallel_for(int lidx=0;lidx<lsites;lidx++){
+      std::vector<RngStateType> tmp(RngStateCount);
+      parallel.GetState(tmp,lidx);
+      std::copy(tmp.begin(),tmp.end(),(*iodata)[lidx].begin());
+    }
+    req = IOobjectAsync(w,grid,iodata,file,offset,format,BINARYIO_WRITE|BINARYIO_LEXICOGRAPHIC);
+
+    auto serialdata = std::make_shared<std::vector<RNGstate> >(1);
+    {
+      std::vector<RngStateType> tmp(RngStateCount);
+      serial.GetState(tmp,0);
+      std::copy(tmp.begin(),tmp.end(),(*serialdata)[0].begin());
+    }
+    req.merge(IOobjectAsync(w,grid,serialdata,file,offset,format,BINARYIO_WRITE|BINARYIO_MASTER_APPEND));
+
+    std::cout << GridLogMessage << "RNG file checksum " << std::hex << req.nersc_csum    << std::dec << std::endl;
+    std::cout << GridLogMessage << "RNG file checksuma " << std::hex << req.scidac_csuma << std::dec << std::endl;
+    std::cout << GridLogMessage << "RNG file checksumb " << std::hex << req.scidac_csumb << std::dec << std::endl;
+
+    return req;
+  }
 };
 }
 #endif
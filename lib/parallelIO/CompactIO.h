@@ -0,0 +1,1013 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid
+
+Source file: ./lib/parallelIO/CompactIO.h
+
+Copyright (C) 2015
+
+Author: Peter Boyle <paboyle@ph.ed.ac.uk>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution
+directory
+*************************************************************************************/
+/*  END LEGAL */
+#ifndef GRID_COMPACT_IO_H
+#define GRID_COMPACT_IO_H
+
+#include <map>
+
+namespace Grid {
+  namespace QCD {
+
+    using namespace Grid;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Compact gauge configurations: SU(3) links stored as their two first rows
+    // (reconstruct 12) or as 8 real parameters (reconstruct 8), optionally
+    // followed by a lossless byte-plane compression.
+    //
+    // File layout:  NERSC style ASCII header
+    //               uint64 big endian size of each brick, in brick lexicographic order
+    //               the bricks
+    // A brick is the local volume of one writer rank, in local lexicographic
+    // order, so readers on any decomposition pick the bricks they overlap.
+    // The checksums of the header are those of the uncompressed payload,
+    // as if it had been written lexicographically.
+    ////////////////////////////////////////////////////////////////////////////////
+    template<typename vtype> using iLorentzColour8 = iVector<iVector<vtype, 8>, Nd >;
+
+    typedef iLorentzColour8<RealF> LorentzColour8F;
+    typedef iLorentzColour8<RealD> LorentzColour8D;
+
+    // Rows 0 and 1 made orthonormal, row 2 rebuilt so that the determinant is one
+    inline void compactReunitarise(ComplexD u[3][3])
+    {
+      for(int i=0;i<2;i++){
+	for(int k=0;k<i;k++){
+	  ComplexD pr(0.0);
+	  for(int j=0;j<3;j++) pr += conjugate(u[k][j])*u[i][j];
+	  for(int j=0;j<3;j++) u[i][j] -= pr*u[k][j];
+	}
+	RealD nrm = 0.0;
+	for(int j=0;j<3;j++) nrm += real(conjugate(u[i][j])*u[i][j]);
+	nrm = 1.0/sqrt(nrm);
+	for(int j=0;j<3;j++) u[i][j] *= nrm;
+      }
+      u[2][0] = conjugate(u[0][1]*u[1][2]-u[0][2]*u[1][1]);
+      u[2][1] = conjugate(u[0][2]*u[1][0]-u[0][0]*u[1][2]);
+      u[2][2] = conjugate(u[0][0]*u[1][1]-u[0][1]*u[1][0]);
+    }
+
+    // The row shift of the 8 parameter form lives in the lowest mantissa bit
+    // of the two phases
+    template<class stype> inline void compactSetFlag(stype &x,int flag)
+    {
+      typedef typename std::conditional<sizeof(stype)==8,uint64_t,uint32_t>::type word;
+      word w;
+      memcpy(&w,&x,sizeof(stype));
+      w = (w & ~word(1)) | word(flag&0x1);
+      memcpy(&x,&w,sizeof(stype));
+    }
+    template<class stype> inline int compactGetFlag(stype x)
+    {
+      typedef typename std::conditional<sizeof(stype)==8,uint64_t,uint32_t>::type word;
+      word w;
+      memcpy(&w,&x,sizeof(stype));
+      return w & 0x1;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // 8 parameters: the phases of a1 and c1 and the complex a2, a3, b1 of
+    //
+    //        | a1 a2 a3 |
+    //   V =  | b1 b2 b3 |    V = U with rows shifted cyclically by s so that
+    //        | c1 c2 c3 |    |a1| is the smallest entry of the first column
+    //
+    // with N = 1-|a1|^2 >= 2/3 the rest follows from the unitarity of V:
+    //   b2 = -(c1* a3* + a2 a1* b1)/N   b3 = (c1* a2* - a3 a1* b1)/N
+    //   c2 =  (b1* a3* - a2 a1* c1)/N   c3 = -(b1* a2* + a3 a1* c1)/N
+    ////////////////////////////////////////////////////////////////////////////////
+    template<class stype> inline void compactEncode8(ComplexD u[3][3],stype *p)
+    {
+      int s = 0;
+      RealD m = norm(u[0][0]);
+      for(int i=1;i<3;i++){
+	if ( norm(u[i][0]) < m ) { m = norm(u[i][0]); s = i; }
+      }
+      ComplexD *a = u[s], *b = u[(s+1)%3], *c = u[(s+2)%3];
+      p[0] = std::arg(a[0]);
+      p[1] = std::arg(c[0]);
+      p[2] = real(a[1]); p[3] = imag(a[1]);
+      p[4] = real(a[2]); p[5] = imag(a[2]);
+      p[6] = real(b[0]); p[7] = imag(b[0]);
+      compactSetFlag(p[0],s);
+      compactSetFlag(p[1],s>>1);
+    }
+    template<class stype> inline void compactDecode8(const stype *p,ComplexD u[3][3])
+    {
+      int s = (compactGetFlag(p[0]) | (compactGetFlag(p[1])<<1))%3;
+      ComplexD *a = u[s], *b = u[(s+1)%3], *c = u[(s+2)%3];
+
+      a[1] = ComplexD(p[2],p[3]);
+      a[2] = ComplexD(p[4],p[5]);
+      b[0] = ComplexD(p[6],p[7]);
+      RealD N  = norm(a[1])+norm(a[2]);
+      RealD a1 = sqrt(std::max(0.0,1.0-N));
+      RealD c1 = sqrt(std::max(0.0,1.0-a1*a1-norm(b[0])));
+      a[0] = std::polar(a1,(RealD)p[0]);
+      c[0] = std::polar(c1,(RealD)p[1]);
+
+      ComplexD a1c_b1 = conjugate(a[0])*b[0];
+      ComplexD a1c_c1 = conjugate(a[0])*c[0];
+      b[1] = -(conjugate(c[0])*conjugate(a[2]) + a[1]*a1c_b1)/N;
+      b[2] =  (conjugate(c[0])*conjugate(a[1]) - a[2]*a1c_b1)/N;
+      c[1] =  (conjugate(b[0])*conjugate(a[2]) - a[1]*a1c_c1)/N;
+      c[2] = -(conjugate(b[0])*conjugate(a[1]) + a[2]*a1c_c1)/N;
+    }
+
+    template<class fobj,class sobj>
+    struct Gauge12munger{
+      void operator() (fobj &in,sobj &out){
+	ComplexD u[3][3];
+	for(int mu=0;mu<Nd;mu++){
+	  for(int i=0;i<2;i++){
+	  for(int j=0;j<3;j++){
+	    u[i][j] = in(mu)(i)(j);
+	  }}
+	  compactReunitarise(u);
+	  for(int i=0;i<3;i++){
+	  for(int j=0;j<3;j++){
+	    out(mu)()(i,j) = u[i][j];
+	  }}
+	}
+      }
+    };
+
+    template<class fobj,class sobj>
+    struct Gauge12unmunger{
+      void operator() (sobj &in,fobj &out){
+	for(int mu=0;mu<Nd;mu++){
+	  for(int i=0;i<2;i++){
+	  for(int j=0;j<3;j++){
+	    out(mu)(i)(j) = in(mu)()(i,j);
+	  }}
+	}
+      }
+    };
+
+    template<class fobj,class sobj>
+    struct Gauge8munger{
+      typedef typename getPrecision<fobj>::real_scalar_type fobj_stype;
+      void operator() (fobj &in,sobj &out){
+	ComplexD u[3][3];
+	for(int mu=0;mu<Nd;mu++){
+	  compactDecode8((fobj_stype *)&in(mu),u);
+	  compactReunitarise(u);
+	  for(int i=0;i<3;i++){
+	  for(int j=0;j<3;j++){
+	    out(mu)()(i,j) = u[i][j];
+	  }}
+	}
+      }
+    };
+
+    template<class fobj,class sobj>
+    struct Gauge8unmunger{
+      typedef typename getPrecision<fobj>::real_scalar_type fobj_stype;
+      void operator() (sobj &in,fobj &out){
+	ComplexD u[3][3];
+	for(int mu=0;mu<Nd;mu++){
+	  for(int i=0;i<3;i++){
+	  for(int j=0;j<3;j++){
+	    u[i][j] = in(mu)()(i,j);
+	  }}
+	  compactEncode8(u,(fobj_stype *)&out(mu));
+	}
+      }
+    };
+
+    class CompactIO : public BinaryIO {
+    public:
+
+      enum { BlockBytes = 64*1024 };
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Byte-plane compression. The words are cut in blocks of BlockBytes, the
+      // blocks are compressed in parallel. In a block the bytes are regrouped by
+      // their position in the word; each such plane is stored as
+      //   uint8 bits (0,1,2,4 or 8)
+      //   bits < 8: uint8 dictionary size, the dictionary, packed indices
+      //   bits = 8: the raw bytes
+      // Stream: uint64 nblock, uint64 block sizes (big endian), the blocks.
+      ////////////////////////////////////////////////////////////////////////////////
+      static inline void bytePlaneEncode(const unsigned char *in,uint64_t n,int wordBytes,
+					 std::vector<unsigned char> &out)
+      {
+	out.resize(0);
+	out.reserve(n*wordBytes+18*wordBytes);
+	for(int p=0;p<wordBytes;p++){
+	  unsigned char seen[256]  = {0};
+	  unsigned char index[256];
+	  int ndict = 0;
+	  for(uint64_t k=0;k<n;k++) seen[in[k*wordBytes+p]] = 1;
+	  for(int v=0;v<256;v++) if ( seen[v] ) index[v] = ndict++;
+
+	  int bits = (ndict<=1) ? 0 : (ndict<=2) ? 1 : (ndict<=4) ? 2 : (ndict<=16) ? 4 : 8;
+	  out.push_back(bits);
+	  if ( bits == 8 ) {
+	    for(uint64_t k=0;k<n;k++) out.push_back(in[k*wordBytes+p]);
+	    continue;
+	  }
+	  out.push_back(ndict);
+	  for(int v=0;v<256;v++) if ( seen[v] ) out.push_back(v);
+
+	  uint64_t o = out.size();
+	  out.resize(o+(n*bits+7)/8,0);
+	  if ( bits == 0 ) continue;
+	  for(uint64_t k=0;k<n;k++){
+	    out[o+(k*bits)/8] |= index[in[k*wordBytes+p]] << ((k*bits)%8);
+	  }
+	}
+      }
+
+      static inline void bytePlaneDecode(const unsigned char *in,uint64_t inBytes,
+					 unsigned char *out,uint64_t n,int wordBytes)
+      {
+	const unsigned char *end = in+inBytes;
+	for(int p=0;p<wordBytes;p++){
+	  assert(in < end);
+	  int bits = *in++;
+	  if ( bits == 8 ) {
+	    assert(in+n <= end);
+	    for(uint64_t k=0;k<n;k++) out[k*wordBytes+p] = in[k];
+	    in += n;
+	    continue;
+	  }
+	  assert((bits==0)||(bits==1)||(bits==2)||(bits==4));
+	  assert(in < end);
+	  int ndict = *in++;
+	  const unsigned char *dict = in;
+	  in += ndict;
+	  assert(in+(n*bits+7)/8 <= end);
+	  int mask = (1<<bits)-1;
+	  for(uint64_t k=0;k<n;k++){
+	    int i = bits ? (in[(k*bits)/8] >> ((k*bits)%8)) & mask : 0;
+	    assert(i < ndict);
+	    out[k*wordBytes+p] = dict[i];
+	  }
+	  in += (n*bits+7)/8;
+	}
+	assert(in == end);
+      }
+
+      static inline void bytePlaneCompress(const unsigned char *in,uint64_t bytes,int wordBytes,
+					   std::vector<unsigned char> &out)
+      {
+	uint64_t words      = bytes/wordBytes;
+	uint64_t blockWords = BlockBytes/wordBytes;
+	uint64_t nblock     = (words+blockWords-1)/blockWords;
+	assert(words*wordBytes == bytes);
+
+	std::vector<std::vector<unsigned char> > blocks(nblock);
+	parallel_for(uint64_t b=0;b<nblock;b++){
+	  uint64_t w = b*blockWords;
+	  bytePlaneEncode(in+w*wordBytes,std::min(blockWords,words-w),wordBytes,blocks[b]);
+	}
+
+	std::vector<uint64_t> table(nblock+1);
+	std::vector<uint64_t> offset(nblock+1);
+	table[0]  = nblock;
+	offset[0] = sizeof(uint64_t)*(nblock+1);
+	for(uint64_t b=0;b<nblock;b++){
+	  table[b+1]  = blocks[b].size();
+	  offset[b+1] = offset[b]+blocks[b].size();
+	}
+	out.resize(offset[nblock]);
+	htobe64_v((void *)&table[0],sizeof(uint64_t)*table.size());
+	memcpy(&out[0],&table[0],sizeof(uint64_t)*table.size());
+	parallel_for(uint64_t b=0;b<nblock;b++){
+	  memcpy(&out[offset[b]],&blocks[b][0],blocks[b].size());
+	}
+      }
+
+      static inline void bytePlaneDecompress(const unsigned char *in,uint64_t inBytes,
+					     unsigned char *out,uint64_t bytes,int wordBytes)
+      {
+	uint64_t words      = bytes/wordBytes;
+	uint64_t blockWords = BlockBytes/wordBytes;
+	uint64_t nblock     = (words+blockWords-1)/blockWords;
+
+	std::vector<uint64_t> table(nblock+1);
+	assert(inBytes >= sizeof(uint64_t)*table.size());
+	memcpy(&table[0],in,sizeof(uint64_t)*table.size());
+	be64toh_v((void *)&table[0],sizeof(uint64_t)*table.size());
+	assert(table[0] == nblock);
+
+	std::vector<uint64_t> offset(nblock+1);
+	offset[0] = sizeof(uint64_t)*(nblock+1);
+	for(uint64_t b=0;b<nblock;b++) offset[b+1] = offset[b]+table[b+1];
+	assert(offset[nblock] == inBytes);
+
+	parallel_for(uint64_t b=0;b<nblock;b++){
+	  uint64_t w = b*blockWords;
+	  bytePlaneDecode(in+offset[b],table[b+1],out+w*wordBytes,std::min(blockWords,words-w),wordBytes);
+	}
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Header: the NERSC keys followed by the brick dimensions and extra keys
+      ////////////////////////////////////////////////////////////////////////////////
+      typedef std::map<std::string,std::string> HeaderKeys;
+
+      static inline void truncate(std::string file){
+	std::ofstream fout(file,std::ios::out);
+      }
+
+      static inline std::string headerString(FieldMetaData &field,const std::vector<int> &brick,
+					     const HeaderKeys &extra)
+      {
+	std::stringstream s;
+	dump_meta_data(field,s);
+	std::string header = s.str();
+	header.resize(header.rfind("END_HEADER"));
+
+	std::stringstream t;
+	t << header;
+	for(int i=0;i<4;i++){
+	  t << "BRICK_" << i+1 << " = " << brick[i] << std::endl;
+	}
+	for(auto &kv: extra){
+	  t << kv.first << " = " << kv.second << std::endl;
+	}
+	t << "END_HEADER" << std::endl;
+	return t.str();
+      }
+
+      static inline int readHeader(std::string file,GridBase *grid,FieldMetaData &field,
+				   std::vector<int> &brick,HeaderKeys &header)
+      {
+	std::string line;
+
+	std::ifstream fin(file);
+	getline(fin,line);
+	removeWhitespace(line);
+	if ( line != std::string("BEGIN_HEADER") ) {
+	  std::cout << GridLogError << "CompactIO: " << file << " has no header" << std::endl;
+	  assert(0);
+	}
+	do {
+	  getline(fin,line);
+	  int eq = line.find("=");
+	  if(eq >0) {
+	    std::string key=line.substr(0,eq);
+	    std::string val=line.substr(eq+1);
+	    removeWhitespace(key);
+	    removeWhitespace(val);
+	    header[key] = val;
+	  }
+	} while( fin.good() && (line.find("END_HEADER") == std::string::npos) );
+	assert(fin.good());
+
+	field.data_start = fin.tellg();
+
+	field.hdr_version    = header["HDR_VERSION"];
+	field.data_type      = header["DATATYPE"];
+	field.storage_format = header["STORAGE_FORMAT"];
+	field.floating_point = header["FLOATING_POINT"];
+
+	assert(grid->_ndimension == 4);
+	brick.resize(4);
+	for(int d=0;d<4;d++){
+	  field.dimension[d] = std::stol(header["DIMENSION_"+std::to_string(d+1)]);
+	  field.boundary[d]  = header["BOUNDARY_"+std::to_string(d+1)];
+	  brick[d]           = std::stol(header["BRICK_"+std::to_string(d+1)]);
+	  assert(grid->_fdimensions[d]==field.dimension[d]);
+	  assert(field.dimension[d] % brick[d] == 0);
+	}
+
+	field.link_trace       = std::stod(header["LINK_TRACE"]);
+	field.plaquette        = std::stod(header["PLAQUETTE"]);
+	field.checksum         = std::stoul(header["CHECKSUM"],0,16);
+	field.scidac_checksuma = std::stoul(header["SCIDAC_CHECKSUMA"],0,16);
+	field.scidac_checksumb = std::stoul(header["SCIDAC_CHECKSUMB"],0,16);
+	field.ensemble_id      = header["ENSEMBLE_ID"];
+	field.ensemble_label   = header["ENSEMBLE_LABEL"];
+	field.sequence_number  = std::stol(header["SEQUENCE_NUMBER"]);
+	field.creator          = header["CREATOR"];
+	field.creator_hardware = header["CREATOR_HARDWARE"];
+	field.creation_date    = header["CREATION_DATE"];
+	field.archive_date     = header["ARCHIVE_DATE"];
+
+	return field.data_start;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Bricks of sites already in file byte order; compressed if the storage
+      // format is BYTEPLANE. Returns the file size.
+      ////////////////////////////////////////////////////////////////////////////////
+      template<class fobj>
+      static inline uint64_t writeBricks(GridBase *grid,std::string file,std::vector<fobj> &iodata,
+					 FieldMetaData &header,const HeaderKeys &extra)
+      {
+	bool compress = (header.storage_format == std::string("BYTEPLANE"));
+	int wordBytes = (header.floating_point == std::string("IEEE32BIG")) ? 4 : 8;
+
+	std::vector<unsigned char> packed;
+	const unsigned char *data = (const unsigned char *)&iodata[0];
+	uint64_t bytes = iodata.size()*sizeof(fobj);
+	if ( compress ) {
+	  bytePlaneCompress(data,bytes,wordBytes,packed);
+	  data  = &packed[0];
+	  bytes = packed.size();
+	}
+
+	// brick sizes are summed in double, exact below 2^53 bytes
+	int nbrick = grid->_Nprocessors;
+	int me;
+	Lexicographic::IndexFromCoor(grid->_processor_coor,me,grid->_processors);
+	std::vector<RealD> sizes(nbrick,0.0);
+	sizes[me] = bytes;
+	grid->GlobalSumVector(&sizes[0],nbrick);
+
+	const uint64_t chunk = 1ULL<<30;
+	std::vector<uint64_t> table(nbrick);
+	uint64_t offset = sizeof(uint64_t)*nbrick;
+	uint64_t total  = sizeof(uint64_t)*nbrick;
+	uint64_t nchunk = 0;
+	for(int b=0;b<nbrick;b++){
+	  table[b] = (uint64_t)sizes[b];
+	  if ( b < me ) offset += table[b];
+	  total += table[b];
+	  nchunk = std::max(nchunk,(table[b]+chunk-1)/chunk);
+	}
+
+	uint64_t data_start = 0;
+	if ( grid->IsBoss() ) {
+	  std::string h = headerString(header,grid->_ldimensions,extra);
+	  htobe64_v((void *)&table[0],sizeof(uint64_t)*nbrick);
+	  std::ofstream fout(file,std::ios::binary|std::ios::out|std::ios::trunc);
+	  fout.write(h.c_str(),h.size());
+	  fout.write((char *)&table[0],sizeof(uint64_t)*nbrick);
+	  if ( !fout.good() ) {
+	    std::cout << GridLogError << "CompactIO: cannot write " << file << std::endl;
+	    assert(0);
+	  }
+	  data_start = h.size();
+	}
+	grid->Broadcast(0,(void *)&data_start,sizeof(data_start));
+	header.data_start = data_start;
+	offset += data_start;
+	total  += data_start;
+
+#ifdef USE_MPI_IO
+	if ( grid->_Nprocessors > 1 ) {
+	  MPI_File   fh;
+	  MPI_Status status;
+	  MPI_Info   info = ioInfo();
+	  int ierr = MPI_File_open(grid->communicator,(char *)file.c_str(),MPI_MODE_WRONLY,info,&fh);
+	  assert(ierr==0);
+	  // every rank takes part in each collective call, possibly with nothing to write
+	  for(uint64_t c=0;c<nchunk;c++){
+	    uint64_t o = std::min(c*chunk,bytes);
+	    int count  = std::min(bytes-o,chunk);
+	    ierr = MPI_File_write_at_all(fh,(MPI_Offset)(offset+o),(void *)(data+o),count,MPI_BYTE,&status);
+	    assert(ierr==0);
+	  }
+	  MPI_File_close(&fh);
+	  if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+	} else
+#endif
+	{
+	  std::ofstream fout(file,std::ios::binary|std::ios::out|std::ios::in);
+	  fout.seekp(offset);
+	  fout.write((char *)data,bytes);
+	  if ( !fout.good() ) {
+	    std::cout << GridLogError << "CompactIO: cannot write " << file << std::endl;
+	    assert(0);
+	  }
+	}
+	grid->Barrier();
+	return total;
+      }
+
+      template<class fobj>
+      static inline uint64_t readBricks(GridBase *grid,std::string file,std::vector<fobj> &iodata,
+					FieldMetaData &header,const std::vector<int> &brick)
+      {
+	bool compress = (header.storage_format == std::string("BYTEPLANE"));
+	int wordBytes = (header.floating_point == std::string("IEEE32BIG")) ? 4 : 8;
+	const int nd  = 4;
+
+	std::vector<int> ldims  = grid->_ldimensions;
+	std::vector<int> lstart = grid->LocalStarts();
+	std::vector<int> nbricks(nd);
+	uint64_t bvol = 1;
+	int nbrick = 1;
+	for(int d=0;d<nd;d++){
+	  nbricks[d] = grid->_fdimensions[d]/brick[d];
+	  nbrick *= nbricks[d];
+	  bvol   *= brick[d];
+	}
+
+	std::ifstream fin(file,std::ios::binary|std::ios::in);
+	std::vector<uint64_t> table(nbrick);
+	fin.seekg(header.data_start);
+	fin.read((char *)&table[0],sizeof(uint64_t)*nbrick);
+	be64toh_v((void *)&table[0],sizeof(uint64_t)*nbrick);
+	std::vector<uint64_t> offset(nbrick+1);
+	offset[0] = header.data_start+sizeof(uint64_t)*nbrick;
+	for(int b=0;b<nbrick;b++) offset[b+1] = offset[b]+table[b];
+
+	iodata.resize(grid->lSites());
+	std::vector<fobj> bdata(bvol);
+	std::vector<unsigned char> packed;
+	std::vector<int> bcoor(nd), lo(nd), hi(nd);
+	for(int b=0;b<nbrick;b++){
+	  Lexicographic::CoorFromIndex(bcoor,b,nbricks);
+	  bool overlap = true;
+	  uint64_t ovol = 1;
+	  for(int d=0;d<nd;d++){
+	    lo[d] = std::max(bcoor[d]*brick[d],lstart[d]);
+	    hi[d] = std::min((bcoor[d]+1)*brick[d],lstart[d]+ldims[d]);
+	    overlap = overlap && (lo[d] < hi[d]);
+	    ovol *= std::max(hi[d]-lo[d],0);
+	  }
+	  if ( !overlap ) continue;
+
+	  packed.resize(table[b]);
+	  fin.seekg(offset[b]);
+	  fin.read((char *)&packed[0],table[b]);
+	  if ( !fin.good() ) {
+	    std::cout << GridLogError << "CompactIO: cannot read brick " << b << " of " << file << std::endl;
+	    assert(0);
+	  }
+	  if ( compress ) {
+	    bytePlaneDecompress(&packed[0],packed.size(),(unsigned char *)&bdata[0],bvol*sizeof(fobj),wordBytes);
+	  } else {
+	    assert(table[b] == bvol*sizeof(fobj));
+	    memcpy(&bdata[0],&packed[0],table[b]);
+	  }
+
+	  std::vector<int> odims(nd);
+	  for(int d=0;d<nd;d++) odims[d] = hi[d]-lo[d];
+	  parallel_for(uint64_t o=0;o<ovol;o++){
+	    std::vector<int> coor(nd), bc(nd), lc(nd);
+	    int bsite, lsite;
+	    Lexicographic::CoorFromIndex(coor,o,odims);
+	    for(int d=0;d<nd;d++){
+	      bc[d] = coor[d]+lo[d]-bcoor[d]*brick[d];
+	      lc[d] = coor[d]+lo[d]-lstart[d];
+	    }
+	    Lexicographic::IndexFromCoor(bc,bsite,brick);
+	    Lexicographic::IndexFromCoor(lc,lsite,ldims);
+	    iodata[lsite] = bdata[bsite];
+	  }
+	}
+	return offset[nbrick];
+      }
+
+      static inline void checkChecksums(std::string file,FieldMetaData &header,
+					uint32_t nersc_csum,uint32_t scidac_csuma,uint32_t scidac_csumb)
+      {
+	if ( (nersc_csum   != header.checksum) ||
+	     (scidac_csuma != header.scidac_checksuma) ||
+	     (scidac_csumb != header.scidac_checksumb) ) {
+	  std::cout << GridLogError << "CompactIO: " << file << " checksum "
+		    << std::hex << nersc_csum << "/" << scidac_csuma << "/" << scidac_csumb
+		    << " header " << header.checksum << "/" << header.scidac_checksuma << "/"
+		    << header.scidac_checksumb << std::dec << std::endl;
+	  assert(0);
+	}
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Links
+      ////////////////////////////////////////////////////////////////////////////////
+      template<class vobj,class fobj,class munger>
+      static inline void writeLinks(Lattice<vobj> &Umu,std::string file,munger munge,FieldMetaData &header)
+      {
+	typedef typename vobj::scalar_object sobj;
+
+	GridBase *grid  = Umu._grid;
+	uint64_t lsites = grid->lSites();
+	int wordBytes   = (header.floating_point == std::string("IEEE32BIG")) ? 4 : 8;
+
+	GridStopWatch timer;
+	timer.Start();
+
+	std::vector<sobj> scalardata(lsites);
+	std::vector<fobj> iodata(lsites);
+	uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+
+	unvectorizeToLexOrdArray(scalardata,Umu);
+	mungeChecksumWrite(grid,scalardata,iodata,munge,header.floating_point,
+			   nersc_csum,scidac_csuma,scidac_csumb);
+	grid->GlobalSum(nersc_csum);
+	grid->GlobalXOR(scidac_csuma);
+	grid->GlobalXOR(scidac_csumb);
+	header.checksum         = nersc_csum;
+	header.scidac_checksuma = scidac_csuma;
+	header.scidac_checksumb = scidac_csumb;
+
+	uint64_t total = writeBricks(grid,file,iodata,header,HeaderKeys());
+	timer.Stop();
+
+	std::cout << GridLogMessage << "CompactIO: wrote " << total << " bytes, "
+		  << std::setprecision(3) << 100.0*total/((RealD)grid->gSites()*Nd*Nc*Nc*2*wordBytes)
+		  << " % of the 3x3 field, in " << timer.Elapsed() << std::endl;
+      }
+
+      template<class vobj,class fobj,class munger>
+      static inline void readLinks(Lattice<vobj> &Umu,std::string file,munger munge,FieldMetaData &header,
+				   const std::vector<int> &brick)
+      {
+	typedef typename vobj::scalar_object sobj;
+
+	GridBase *grid  = Umu._grid;
+	uint64_t lsites = grid->lSites();
+
+	GridStopWatch timer;
+	timer.Start();
+
+	std::vector<fobj> iodata;
+	std::vector<sobj> scalardata(lsites);
+	uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+
+	uint64_t total = readBricks(grid,file,iodata,header,brick);
+	mungeChecksumRead(grid,scalardata,iodata,munge,header.floating_point,
+			  nersc_csum,scidac_csuma,scidac_csumb);
+	grid->GlobalSum(nersc_csum);
+	grid->GlobalXOR(scidac_csuma);
+	grid->GlobalXOR(scidac_csumb);
+	checkChecksums(file,header,nersc_csum,scidac_csuma,scidac_csumb);
+	vectorizeFromLexOrdArray(scalardata,Umu);
+	timer.Stop();
+
+	std::cout << GridLogMessage << "CompactIO: read " << total << " byte file "
+		  << file << " in " << timer.Elapsed() << std::endl;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Configurations
+      //   reconstruct: 12 or 8
+      //   compress   : byte-plane compression of the bricks
+      //   format     : IEEE64BIG or IEEE32BIG
+      ////////////////////////////////////////////////////////////////////////////////
+      template<class vsimd>
+      static inline void writeConfiguration(Lattice<iLorentzColourMatrix<vsimd> > &Umu,
+					    std::string file,
+					    int reconstruct = 12,
+					    bool compress = true,
+					    std::string format = std::string("IEEE64BIG"))
+      {
+	typedef iLorentzColourMatrix<vsimd> vobj;
+	typedef typename vobj::scalar_object sobj;
+
+	FieldMetaData header;
+	header.sequence_number = 1;
+	header.ensemble_id     = "UKQCD";
+	header.ensemble_label  = "DWF";
+	header.hdr_version     = "1.0";
+
+	GridBase *grid = Umu._grid;
+
+	GridMetaData(grid,header);
+	assert(header.nd==4);
+	GaugeStatistics(Umu,header);
+	MachineCharacteristics(header);
+
+	int bits32 = (format == std::string("IEEE32BIG"));
+	assert(bits32 || (format == std::string("IEEE64BIG")));
+	assert((reconstruct == 12) || (reconstruct == 8));
+
+	header.floating_point = format;
+	header.storage_format = compress ? std::string("BYTEPLANE") : std::string("RAW");
+
+	if ( reconstruct == 12 ) {
+	  header.data_type = std::string("4D_SU3_GAUGE_RECONSTRUCT12");
+	  if ( bits32 ) writeLinks<vobj,LorentzColour2x3F>(Umu,file,Gauge12unmunger<LorentzColour2x3F,sobj>(),header);
+	  else          writeLinks<vobj,LorentzColour2x3D>(Umu,file,Gauge12unmunger<LorentzColour2x3D,sobj>(),header);
+	} else {
+	  header.data_type = std::string("4D_SU3_GAUGE_RECONSTRUCT8");
+	  if ( bits32 ) writeLinks<vobj,LorentzColour8F>(Umu,file,Gauge8unmunger<LorentzColour8F,sobj>(),header);
+	  else          writeLinks<vobj,LorentzColour8D>(Umu,file,Gauge8unmunger<LorentzColour8D,sobj>(),header);
+	}
+
+	std::cout<<GridLogMessage <<"Written Compact Configuration on "<< file << " checksum "
+		 <<std::hex<<header.checksum<<"/"<<header.scidac_checksuma<<"/"<<header.scidac_checksumb
+		 <<std::dec<<" plaq "<< header.plaquette <<std::endl;
+      }
+
+      // Links are reunitarised as they are reconstructed; the checksums of the
+      // stored payload must agree bit for bit with the header
+      template<class vsimd>
+      static inline void readConfiguration(Lattice<iLorentzColourMatrix<vsimd> > &Umu,
+					   FieldMetaData& header,
+					   std::string file)
+      {
+	typedef iLorentzColourMatrix<vsimd> vobj;
+	typedef typename vobj::scalar_object sobj;
+
+	std::vector<int> brick;
+	HeaderKeys keys;
+	readHeader(file,Umu._grid,header,brick,keys);
+
+	int bits32 = (header.floating_point == std::string("IEEE32BIG"));
+	assert(bits32 || (header.floating_point == std::string("IEEE64BIG")));
+
+	if ( header.data_type == std::string("4D_SU3_GAUGE_RECONSTRUCT12") ) {
+	  if ( bits32 ) readLinks<vobj,LorentzColour2x3F>(Umu,file,Gauge12munger<LorentzColour2x3F,sobj>(),header,brick);
+	  else          readLinks<vobj,LorentzColour2x3D>(Umu,file,Gauge12munger<LorentzColour2x3D,sobj>(),header,brick);
+	} else if ( header.data_type == std::string("4D_SU3_GAUGE_RECONSTRUCT8") ) {
+	  if ( bits32 ) readLinks<vobj,LorentzColour8F>(Umu,file,Gauge8munger<LorentzColour8F,sobj>(),header,brick);
+	  else          readLinks<vobj,LorentzColour8D>(Umu,file,Gauge8munger<LorentzColour8D,sobj>(),header,brick);
+	} else {
+	  std::cout << GridLogError << "Compact configuration " << file << " has data type "
+		    << header.data_type << std::endl;
+	  assert(0);
+	}
+
+	FieldMetaData clone(header);
+	GaugeStatistics(Umu,clone);
+	std::cout<<GridLogMessage <<"Compact Configuration "<<file<<" plaquette "<<clone.plaquette
+		 <<" header "<<header.plaquette<<std::endl;
+	if ( fabs(clone.plaquette-header.plaquette) >= 1.0e-5 ) {
+	  std::cout << GridLogError << "Compact configuration " << file << " plaquette mismatch" << std::endl;
+	  assert(0);
+	}
+	std::cout<<GridLogMessage <<"Compact Configuration "<<file<< " checksums and plaquette agree"<<std::endl;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // RNG state. With the counter based SITMO engine the generators seeded by
+      // SeedFixedIntegers share one key and differ by their counter, which starts
+      // site<<40 draws into the stream: only the key and the number of draws of
+      // each site are stored (SITMO_COUNTER). Other engines, or generators not in
+      // that form, store the full state of each site. Either way the sites are
+      // byte-plane compressed bricks; the serial generator is kept in the header.
+      ////////////////////////////////////////////////////////////////////////////////
+      typedef GridRNGbase::RngStateType RngStateType;
+      typedef GridRNGbase::RngEngine    RngEngine;
+      typedef std::array<RngStateType,GridRNGbase::RngStateCount> RngState;
+
+      struct CopyMunger {
+	template<class obj> void operator()(obj &in,obj &out) { out = in; }
+      };
+
+      static inline std::string rngEngineName(void)
+      {
+#ifdef RNG_RANLUX
+	return std::string("RANLUX48");
+#endif
+#ifdef RNG_MT19937
+	return std::string("MT19937");
+#endif
+#ifdef RNG_SITMO
+	return std::string("SITMO");
+#endif
+      }
+
+      // comma separated hex words, as the header drops whitespace
+      static inline std::string joinState(const std::vector<RngStateType> &state)
+      {
+	std::stringstream s;
+	s << std::hex;
+	for(int i=0;i<state.size();i++) s << (i ? "," : "") << state[i];
+	return s.str();
+      }
+      static inline std::vector<RngStateType> splitState(const std::string &str)
+      {
+	std::vector<RngStateType> state;
+	std::stringstream s(str);
+	std::string word;
+	while ( getline(s,word,',') ) state.push_back(std::stoull(word,0,16));
+	return state;
+      }
+
+      // local lexicographic site to global site and generator
+      static inline void rngSite(GridParallelRNG &parallel,uint64_t lsite,uint64_t &gsite,int &gen)
+      {
+	GridBase *grid = parallel._grid;
+	std::vector<int> coor(4);
+	int gidx, rank, o_idx, i_idx;
+	Lexicographic::CoorFromIndex(coor,lsite,grid->_ldimensions);
+	for(int d=0;d<4;d++) coor[d] += grid->_lstart[d];
+	Lexicographic::IndexFromCoor(coor,gidx,grid->_fdimensions);
+	grid->GlobalCoorToRankIndex(rank,o_idx,i_idx,coor);
+	gsite = gidx;
+	gen   = parallel.generator_idx(o_idx,i_idx);
+      }
+
+#ifdef RNG_SITMO
+      // state words: key k[i] = 3i, counter s[i] = 3i+1, output 3i+2, output index 12
+      static inline bool sitmoCounter(const std::vector<RngStateType> &state,const std::vector<RngStateType> &key,
+				      uint64_t gsite,uint64_t &draws)
+      {
+	uint64_t base0 = gsite<<37;   // site<<40 draws, 8 per counter value
+	uint64_t base1 = gsite>>27;
+	uint64_t count = state[1]-base0;
+	for(int i=0;i<4;i++) if ( state[3*i] != key[i] ) return false;
+	if ( (state[4] != base1+(state[1] < base0)) || state[7] || state[10] ) return false;
+	if ( count >> 60 ) return false;
+	draws = (count<<3) + state[12];
+	return true;
+      }
+      static inline void sitmoRestore(RngEngine &eng,const std::vector<RngStateType> &key,
+				      uint64_t gsite,uint64_t draws)
+      {
+	uint64_t base0 = gsite<<37;
+	uint64_t base1 = gsite>>27;
+	uint64_t s0    = base0+(draws>>3);
+	eng.set_key(key[0],key[1],key[2],key[3]);
+	eng.set_counter(s0,base1+(s0 < base0),0,0,draws&0x7);
+      }
+#endif
+
+      static inline void writeRNGState(GridSerialRNG &serial,GridParallelRNG &parallel,std::string file,
+				       bool compress = true)
+      {
+	GridBase *grid  = parallel._grid;
+	uint64_t lsites = grid->lSites();
+
+	FieldMetaData header;
+	header.sequence_number = 1;
+	header.ensemble_id     = "UKQCD";
+	header.ensemble_label  = "DWF";
+	header.hdr_version     = "1.0";
+
+	GridMetaData(grid,header);
+	assert(header.nd==4);
+	header.link_trace=0.0;
+	header.plaquette=0.0;
+	MachineCharacteristics(header);
+	header.storage_format = compress ? std::string("BYTEPLANE") : std::string("RAW");
+
+	GridStopWatch timer;
+	timer.Start();
+
+	HeaderKeys extra;
+	std::vector<RngStateType> sstate;
+	serial.GetState(sstate,0);
+	extra["SERIAL_STATE"] = joinState(sstate);
+
+	uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+	uint64_t total = 0;
+	bool counters  = false;
+
+#ifdef RNG_SITMO
+	{
+	  std::vector<RngStateType> key(4);
+	  std::vector<RngStateType> state;
+	  parallel.GetState(state,0);
+	  for(int i=0;i<4;i++) key[i] = state[3*i];
+	  grid->Broadcast(0,(void *)&key[0],sizeof(RngStateType)*key.size());
+
+	  std::vector<uint64_t> draws(lsites), iodata(lsites);
+	  uint32_t mismatch = 0;
+	  parallel_for(uint64_t l=0;l<lsites;l++){
+	    std::vector<RngStateType> state;
+	    uint64_t gsite;
+	    int gen;
+	    rngSite(parallel,l,gsite,gen);
+	    parallel.GetState(state,gen);
+	    if ( !sitmoCounter(state,key,gsite,draws[l]) ) {
+#pragma omp atomic
+	      mismatch++;
+	    }
+	  }
+	  grid->GlobalSum(mismatch);
+
+	  if ( mismatch == 0 ) {
+	    counters = true;
+	    header.data_type      = std::string("SITMO_COUNTER");
+	    header.floating_point = std::string("IEEE64BIG");
+	    extra["SITMO_KEY"]    = joinState(key);
+	    mungeChecksumWrite(grid,draws,iodata,CopyMunger(),header.floating_point,
+			       nersc_csum,scidac_csuma,scidac_csumb);
+	    grid->GlobalSum(nersc_csum);
+	    grid->GlobalXOR(scidac_csuma);
+	    grid->GlobalXOR(scidac_csumb);
+	    header.checksum         = nersc_csum;
+	    header.scidac_checksuma = scidac_csuma;
+	    header.scidac_checksumb = scidac_csumb;
+	    total = writeBricks(grid,file,iodata,header,extra);
+	  }
+	}
+#endif
+	if ( !counters ) {
+	  std::vector<RngState> states(lsites), iodata(lsites);
+	  parallel_for(uint64_t l=0;l<lsites;l++){
+	    std::vector<RngStateType> state;
+	    uint64_t gsite;
+	    int gen;
+	    rngSite(parallel,l,gsite,gen);
+	    parallel.GetState(state,gen);
+	    std::copy(state.begin(),state.end(),states[l].begin());
+	  }
+	  header.data_type      = rngEngineName();
+	  header.floating_point = (sizeof(RngStateType) == 4) ? std::string("IEEE32BIG") : std::string("IEEE64BIG");
+	  mungeChecksumWrite(grid,states,iodata,CopyMunger(),header.floating_point,
+			     nersc_csum,scidac_csuma,scidac_csumb);
+	  grid->GlobalSum(nersc_csum);
+	  grid->GlobalXOR(scidac_csuma);
+	  grid->GlobalXOR(scidac_csumb);
+	  header.checksum         = nersc_csum;
+	  header.scidac_checksuma = scidac_csuma;
+	  header.scidac_checksumb = scidac_csumb;
+	  total = writeBricks(grid,file,iodata,header,extra);
+	}
+	timer.Stop();
+
+	std::cout << GridLogMessage << "Written Compact RNG state " << file << " " << header.data_type
+		  << " " << total << " bytes in " << timer.Elapsed() << " checksum "
+		  << std::hex << header.checksum << "/" << header.scidac_checksuma << "/"
+		  << header.scidac_checksumb << std::dec << std::endl;
+      }
+
+      static inline void readRNGState(GridSerialRNG &serial,GridParallelRNG &parallel,FieldMetaData &header,
+				      std::string file)
+      {
+	GridBase *grid  = parallel._grid;
+	uint64_t lsites = grid->lSites();
+
+	GridStopWatch timer;
+	timer.Start();
+
+	std::vector<int> brick;
+	HeaderKeys keys;
+	readHeader(file,grid,header,brick,keys);
+
+	uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+	uint64_t total;
+	if ( header.data_type == std::string("SITMO_COUNTER") ) {
+#ifdef RNG_SITMO
+	  std::vector<RngStateType> key = splitState(keys["SITMO_KEY"]);
+	  std::vector<uint64_t> draws(lsites), iodata;
+	  assert(key.size() == 4);
+	  total = readBricks(grid,file,iodata,header,brick);
+	  mungeChecksumRead(grid,draws,iodata,CopyMunger(),header.floating_point,
+			    nersc_csum,scidac_csuma,scidac_csumb);
+	  grid->GlobalSum(nersc_csum);
+	  grid->GlobalXOR(scidac_csuma);
+	  grid->GlobalXOR(scidac_csumb);
+	  checkChecksums(file,header,nersc_csum,scidac_csuma,scidac_csumb);
+	  parallel_for(uint64_t l=0;l<lsites;l++){
+	    uint64_t gsite;
+	    int gen;
+	    rngSite(parallel,l,gsite,gen);
+	    sitmoRestore(parallel._generators[gen],key,gsite,draws[l]);
+	  }
+#else
+	  std::cout << GridLogError << "Compact RNG state " << file << " needs the SITMO generator" << std::endl;
+	  assert(0);
+#endif
+	} else {
+	  if ( header.data_type != rngEngineName() ) {
+	    std::cout << GridLogError << "Compact RNG state " << file << " is for " << header.data_type
+		      << ", this build uses " << rngEngineName() << std::endl;
+	    assert(0);
+	  }
+	  std::vector<RngState> states(lsites), iodata;
+	  total = readBricks(grid,file,iodata,header,brick);
+	  mungeChecksumRead(grid,states,iodata,CopyMunger(),header.floating_point,
+			    nersc_csum,scidac_csuma,scidac_csumb);
+	  grid->GlobalSum(nersc_csum);
+	  grid->GlobalXOR(scidac_csuma);
+	  grid->GlobalXOR(scidac_csumb);
+	  checkChecksums(file,header,nersc_csum,scidac_csuma,scidac_csumb);
+	  parallel_for(uint64_t l=0;l<lsites;l++){
+	    std::vector<RngStateType> state(states[l].begin(),states[l].end());
+	    uint64_t gsite;
+	    int gen;
+	    rngSite(parallel,l,gsite,gen);
+	    parallel.SetState(state,gen);
+	  }
+	}
+
+	std::vector<RngStateType> sstate = splitState(keys["SERIAL_STATE"]);
+	assert(sstate.size() == GridRNGbase::RngStateCount);
+	serial.SetState(sstate,0);
+	timer.Stop();
+
+	std::cout << GridLogMessage << "Read Compact RNG state " << file << " " << header.data_type
+		  << " " << total << " bytes in " << timer.Elapsed() << std::endl;
+      }
+    };
+  }
+}
+#endif
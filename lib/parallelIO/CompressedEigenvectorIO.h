@@ -0,0 +1,226 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/parallelIO/CompressedEigenvectorIO.h
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#ifndef GRID_COMPRESSED_EIGENVECTOR_IO_H
+#define GRID_COMPRESSED_EIGENVECTOR_IO_H
+
+namespace Grid {
+
+class CompressedEigenvectorMetaData : Serializable {
+public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(CompressedEigenvectorMetaData,
+				  int, nbasis,
+				  int, nvec,
+				  int, checkerboard,
+				  int, coarse_checkerboard,
+				  std::vector<int>, fine_dimension,
+				  std::vector<int>, coarse_dimension,
+				  std::string, basis_format,
+				  std::string, coef_format,
+				  std::vector<RealD>, evals,
+				  std::vector<RealD>, scale,
+				  std::vector<uint32_t>, basis_scidac_checksuma,
+				  std::vector<uint32_t>, basis_scidac_checksumb,
+				  std::vector<uint32_t>, coef_scidac_checksuma,
+				  std::vector<uint32_t>, coef_scidac_checksumb);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Parallel I/O of CompressedEigenvectors through BinaryIO.
+//
+//   <stem>.xml        metadata, eigenvalues, norms and per record checksums
+//   <stem>.basis.bin  the block basis in the field precision, big endian
+//   <stem>.coef.bin   coarse coefficients, IEEE fp16 pairs (re,im), little endian
+//
+// Every record is lexicographic in the global coarse/fine lattice, so the files
+// can be read back on any processor decomposition.
+////////////////////////////////////////////////////////////////////////////////
+class CompressedEigenvectorIO : public BinaryIO {
+public:
+
+  static inline void truncate(GridBase *grid,std::string file){
+    if ( grid->IsBoss() ) {
+      std::ofstream fout(file,std::ios::out|std::ios::trunc);
+    }
+    grid->Barrier();
+  }
+
+  template<class Fobj,class CComplex,int nbasis>
+  static inline void writeEigenvectors(CompressedEigenvectors<Fobj,CComplex,nbasis> &evecs,std::string stem)
+  {
+    typedef CompressedEigenvectors<Fobj,CComplex,nbasis> Evecs;
+    typedef typename Evecs::CoarseField                  CoarseField;
+    typedef typename CoarseField::vector_object::scalar_object csobj;
+    typedef typename Fobj::scalar_object                 fsobj;
+    typedef std::array<uint32_t,nbasis>                  fp16obj;
+
+    GridBase *fgrid = evecs._FineGrid;
+    GridBase *cgrid = evecs._CoarseGrid;
+    uint32_t nersc_csum,scidac_csuma,scidac_csumb;
+
+    CompressedEigenvectorMetaData md;
+    md.nbasis              = nbasis;
+    md.nvec                = evecs.size();
+    md.checkerboard        = evecs._checkerboard;
+    md.coarse_checkerboard = evecs._coarse_checkerboard;
+    md.fine_dimension      = fgrid->FullDimensions();
+    md.coarse_dimension    = cgrid->FullDimensions();
+    md.basis_format        = getFormatString<Fobj>();
+    md.coef_format         = std::string("FP16LE");
+    md.evals               = evecs.evals;
+    md.scale               = evecs.scale;
+
+    GridStopWatch timer; timer.Start();
+
+    std::string file = stem + ".basis.bin";
+    truncate(fgrid,file);
+    uint64_t record = sizeof(fsobj)*fgrid->gSites();
+    for(int b=0;b<nbasis;b++){
+      QCD::BinarySimpleMunger<fsobj,fsobj> munge;
+      writeLatticeObject<Fobj,fsobj>(evecs.subspace[b],file,munge,b*record,md.basis_format,
+				     nersc_csum,scidac_csuma,scidac_csumb);
+      md.basis_scidac_checksuma.push_back(scidac_csuma);
+      md.basis_scidac_checksumb.push_back(scidac_csumb);
+    }
+
+    file = stem + ".coef.bin";
+    truncate(cgrid,file);
+    record = sizeof(fp16obj)*cgrid->gSites();
+    int lsites = cgrid->lSites();
+    CoarseField          tmp(cgrid);
+    std::vector<csobj>   scalardata(lsites);
+    std::vector<fp16obj> iodata(lsites);
+    for(int i=0;i<evecs.size();i++){
+      evecs.decompressCoarse(i,tmp);
+      unvectorizeToLexOrdArray(scalardata,tmp);
+      RealD inv = (evecs.scale[i]>0.0) ? 1.0/evecs.scale[i] : 0.0;
+      parallel_for(int x=0;x<lsites;x++){
+	for(int b=0;b<nbasis;b++){
+	  ComplexD c = TensorRemove(scalardata[x](b));
+	  uint32_t re = fp16FromFloat((float)(real(c)*inv));
+	  uint32_t im = fp16FromFloat((float)(imag(c)*inv));
+	  iodata[x][b] = re | (im<<16);
+	}
+      }
+      float w=0;
+      IOobject(w,cgrid,iodata,file,i*record,std::string("IEEE32"),BINARYIO_WRITE|BINARYIO_LEXICOGRAPHIC,
+	       nersc_csum,scidac_csuma,scidac_csumb);
+      md.coef_scidac_checksuma.push_back(scidac_csuma);
+      md.coef_scidac_checksumb.push_back(scidac_csumb);
+    }
+
+    if ( fgrid->IsBoss() ) {
+      XmlWriter WR(stem + ".xml");
+      WR.setPrecision(std::numeric_limits<double>::max_digits10); // exact evals and scales
+      write(WR,"CompressedEigenvectors",md);
+    }
+    fgrid->Barrier();
+    timer.Stop();
+
+    std::cout << GridLogMessage << "writeEigenvectors: "<< evecs.size() << " compressed vectors to "<< stem
+	      << " in "<< timer.Elapsed() <<std::endl;
+  }
+
+  template<class Fobj,class CComplex,int nbasis>
+  static inline void readEigenvectors(CompressedEigenvectors<Fobj,CComplex,nbasis> &evecs,std::string stem)
+  {
+    typedef CompressedEigenvectors<Fobj,CComplex,nbasis> Evecs;
+    typedef typename Evecs::CoarseField                  CoarseField;
+    typedef typename CoarseField::vector_object::scalar_object csobj;
+    typedef typename Fobj::scalar_object                 fsobj;
+    typedef std::array<uint32_t,nbasis>                  fp16obj;
+
+    GridBase *fgrid = evecs._FineGrid;
+    GridBase *cgrid = evecs._CoarseGrid;
+    uint32_t nersc_csum,scidac_csuma,scidac_csumb;
+
+    CompressedEigenvectorMetaData md;
+    {
+      XmlReader RD(stem + ".xml");
+      read(RD,"CompressedEigenvectors",md);
+    }
+    assert(md.nbasis == nbasis);
+    assert(md.checkerboard == evecs._checkerboard);
+    assert(md.fine_dimension   == fgrid->FullDimensions());
+    assert(md.coarse_dimension == cgrid->FullDimensions());
+    assert(md.coef_format == std::string("FP16LE"));
+
+    GridStopWatch timer; timer.Start();
+
+    std::string file = stem + ".basis.bin";
+    uint64_t record = sizeof(fsobj)*fgrid->gSites();
+    for(int b=0;b<nbasis;b++){
+      QCD::BinarySimpleMunger<fsobj,fsobj> munge;
+      evecs.subspace[b].checkerboard = evecs._checkerboard;
+      readLatticeObject<Fobj,fsobj>(evecs.subspace[b],file,munge,b*record,md.basis_format,
+				    nersc_csum,scidac_csuma,scidac_csumb);
+      checksumVerify(file,b,scidac_csuma,scidac_csumb,md.basis_scidac_checksuma[b],md.basis_scidac_checksumb[b]);
+    }
+
+    file = stem + ".coef.bin";
+    record = sizeof(fp16obj)*cgrid->gSites();
+    int lsites = cgrid->lSites();
+    CoarseField          tmp(cgrid);
+    std::vector<csobj>   scalardata(lsites);
+    std::vector<fp16obj> iodata(lsites);
+    evecs.resize(md.nvec);
+    for(int i=0;i<md.nvec;i++){
+      float w=0;
+      IOobject(w,cgrid,iodata,file,i*record,std::string("IEEE32"),BINARYIO_READ|BINARYIO_LEXICOGRAPHIC,
+	       nersc_csum,scidac_csuma,scidac_csumb);
+      checksumVerify(file,i,scidac_csuma,scidac_csumb,md.coef_scidac_checksuma[i],md.coef_scidac_checksumb[i]);
+      RealD s = md.scale[i];
+      parallel_for(int x=0;x<lsites;x++){
+	for(int b=0;b<nbasis;b++){
+	  RealD re = fp16ToFloat(iodata[x][b]&0xFFFF);
+	  RealD im = fp16ToFloat(iodata[x][b]>>16);
+	  scalardata[x](b) = ComplexD(re*s,im*s);
+	}
+      }
+      vectorizeFromLexOrdArray(scalardata,tmp);
+      tmp.checkerboard = md.coarse_checkerboard;
+      evecs.compress(i,tmp,md.evals[i],s);
+    }
+    timer.Stop();
+
+    std::cout << GridLogMessage << "readEigenvectors: "<< evecs.size() << " compressed vectors from "<< stem
+	      << " in "<< timer.Elapsed() <<std::endl;
+  }
+
+private:
+  static inline void checksumVerify(std::string file,int record,
+				    uint32_t csuma,uint32_t csumb,uint32_t expecta,uint32_t expectb)
+  {
+    if ( (csuma != expecta) || (csumb != expectb) ) {
+      std::cout << GridLogError << "CompressedEigenvectorIO: checksum mismatch in "<< file <<" record "<< record
+		<< std::hex << " computed "<< csuma <<"/"<< csumb <<" expected "<< expecta <<"/"<< expectb
+		<< std::dec << std::endl;
+      assert(0);
+    }
+  }
+};
+
+}
+#endif
@@ -0,0 +1,329 @@
+/*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./lib/parallelIO/Hdf5FieldIO.h
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+*************************************************************************************/
+/*  END LEGAL */
+#ifndef GRID_HDF5_FIELD_IO_H
+#define GRID_HDF5_FIELD_IO_H
+
+#include <hdf5.h>
+
+namespace Grid {
+
+/////////////////////////////////////////////////////////////////////////////////
+// Lattice fields as HDF5 datasets.
+//
+// A field is stored as a dataset of real words with dimensions
+// [L_{nd-1}, ..., L_1, L_0, nword] (x fastest, lexicographic as the other
+// formats), in the precision of the field; the reader converts precision if
+// needed. The dataset chunks are the local volumes of the ranks, each rank
+// writes or reads its own hyperslab. Several fields (propagator columns,
+// eigenvectors, ...) go in one file as separate datasets, names with '/'
+// create groups.
+//
+// With a parallel HDF5 library and MPI comms, the file is opened with the
+// MPI-IO driver (with the --io-hints MPI_Info hints) and the transfers are
+// collective. Otherwise the ranks access the file in turn, which is correct
+// but serialised.
+/////////////////////////////////////////////////////////////////////////////////
+#if defined(H5_HAVE_PARALLEL) && (defined(GRID_COMMS_MPI) || defined(GRID_COMMS_MPI3) || defined(GRID_COMMS_MPIT))
+#define GRID_HDF5_PARALLEL
+#endif
+
+class Hdf5FieldIO {
+ protected:
+  Hdf5FieldIO(GridBase *grid, const std::string &fileName)
+    : grid_(grid), fileName_(fileName) {}
+
+  template<class vobj> struct FieldType {
+    typedef typename vobj::scalar_object                    sobj;
+    typedef typename getPrecision<sobj>::real_scalar_type   word;
+    static const int nword = sizeof(sobj)/sizeof(word);
+    static hid_t memType(void) {
+      return (sizeof(word) == sizeof(double)) ? H5T_NATIVE_DOUBLE : H5T_NATIVE_FLOAT;
+    }
+  };
+
+  // dataset dimensions, chunk and hyperslab of this rank (slowest first)
+  void geometry(int nword, std::vector<hsize_t> &dims, std::vector<hsize_t> &start,
+		std::vector<hsize_t> &count)
+  {
+    int nd = grid_->_ndimension;
+
+    dims.resize(nd + 1); start.resize(nd + 1); count.resize(nd + 1);
+    for (int d = 0; d < nd; d++) {
+      dims[nd - 1 - d]  = grid_->_fdimensions[d];
+      count[nd - 1 - d] = grid_->_ldimensions[d];
+      start[nd - 1 - d] = grid_->_processor_coor[d]*grid_->_ldimensions[d];
+    }
+    dims[nd] = nword; count[nd] = nword; start[nd] = 0;
+  }
+
+  hid_t openFile(unsigned int flags, bool create)
+  {
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS), file;
+
+#ifdef GRID_HDF5_PARALLEL
+    MPI_Info info = BinaryIO::ioInfo();
+
+    H5Pset_fapl_mpio(fapl, grid_->communicator, info);
+    if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+#endif
+    if (create) {
+      file = H5Fcreate(fileName_.c_str(), flags, H5P_DEFAULT, fapl);
+    } else {
+      file = H5Fopen(fileName_.c_str(), flags, fapl);
+    }
+    H5Pclose(fapl);
+    if (file < 0) {
+      std::cout << GridLogError << "Hdf5FieldIO: cannot open file " << fileName_ << std::endl;
+      assert(0);
+    }
+
+    return file;
+  }
+
+  hid_t transferList(void)
+  {
+    hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
+
+#ifdef GRID_HDF5_PARALLEL
+    H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+
+    return dxpl;
+  }
+
+  // hyperslab transfer of this rank, buf is the local lexicographic array
+  void transfer(hid_t dataset, hid_t memType, void *buf, int nword, bool write)
+  {
+    std::vector<hsize_t> dims, start, count;
+    herr_t err;
+
+    geometry(nword, dims, start, count);
+
+    hid_t fileSpace = H5Dget_space(dataset);
+    hid_t memSpace  = H5Screate_simple(count.size(), count.data(), nullptr);
+    hid_t dxpl      = transferList();
+
+    err = H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr); assert(err>=0);
+    if (write) {
+      err = H5Dwrite(dataset, memType, memSpace, fileSpace, dxpl, buf); assert(err>=0);
+    } else {
+      err = H5Dread(dataset, memType, memSpace, fileSpace, dxpl, buf); assert(err>=0);
+    }
+    H5Pclose(dxpl);
+    H5Sclose(memSpace);
+    H5Sclose(fileSpace);
+  }
+
+ protected:
+  GridBase    *grid_;
+  std::string fileName_;
+};
+
+class Hdf5FieldWriter : public Hdf5FieldIO {
+ public:
+  // compression: deflate level (0 = none)
+  Hdf5FieldWriter(GridBase *grid, const std::string &fileName, unsigned int compression = 0)
+    : Hdf5FieldIO(grid, fileName), compression_(compression)
+  {
+#ifdef GRID_HDF5_PARALLEL
+    H5Fclose(openFile(H5F_ACC_TRUNC, true));
+#else
+    if (grid_->IsBoss()) H5Fclose(openFile(H5F_ACC_TRUNC, true));
+    grid_->Barrier();
+#endif
+  }
+
+  template<class vobj>
+  void writeField(const std::string &name, Lattice<vobj> &field)
+  {
+    typedef FieldType<vobj> F;
+    typedef typename F::sobj sobj;
+
+    assert(field._grid->_fdimensions == grid_->_fdimensions);
+    assert(field._grid->_processors  == grid_->_processors);
+
+    GridStopWatch timer;
+    std::vector<sobj> scalardata(grid_->lSites());
+    uint64_t bytes = sizeof(sobj)*grid_->gSites();
+
+    timer.Start();
+    unvectorizeToLexOrdArray(scalardata, field);
+#ifdef GRID_HDF5_PARALLEL
+    hid_t file    = openFile(H5F_ACC_RDWR, false);
+    hid_t dataset = createDataset<vobj>(file, name);
+
+    transfer(dataset, F::memType(), scalardata.data(), F::nword, true);
+    H5Dclose(dataset);
+    H5Fclose(file);
+#else
+    if (grid_->IsBoss()) {
+      hid_t file = openFile(H5F_ACC_RDWR, false);
+
+      H5Dclose(createDataset<vobj>(file, name));
+      H5Fclose(file);
+    }
+    for (int r = 0; r < grid_->ProcessorCount(); r++) {
+      grid_->Barrier();
+      if (r == grid_->ThisRank()) {
+	hid_t file    = openFile(H5F_ACC_RDWR, false);
+	hid_t dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+
+	transfer(dataset, F::memType(), scalardata.data(), F::nword, true);
+	H5Dclose(dataset);
+	H5Fclose(file);
+      }
+    }
+#endif
+    grid_->Barrier();
+    timer.Stop();
+
+    std::cout << GridLogMessage << "Hdf5FieldWriter: " << name << " " << bytes << " bytes in "
+	      << timer.Elapsed() << " " << (double)bytes/(double)timer.useconds() << " MB/s" << std::endl;
+  }
+
+  template<class vobj>
+  void writeField(const std::string &name, std::vector<Lattice<vobj> > &field)
+  {
+    for (unsigned int i = 0; i < field.size(); i++) {
+      writeField(name + "_" + std::to_string(i), field[i]);
+    }
+  }
+
+ private:
+  template<class vobj>
+  hid_t createDataset(hid_t file, const std::string &name)
+  {
+    typedef FieldType<vobj> F;
+
+    std::vector<hsize_t> dims, start, count;
+    hid_t dcpl  = H5Pcreate(H5P_DATASET_CREATE);
+    hid_t lcpl  = H5Pcreate(H5P_LINK_CREATE);
+    herr_t err;
+
+    geometry(F::nword, dims, start, count);
+    err = H5Pset_chunk(dcpl, count.size(), count.data()); assert(err>=0);
+    if (compression_ > 0) {
+#if defined(GRID_HDF5_PARALLEL) && !H5_VERSION_GE(1,10,2)
+      std::cout << GridLogError << "Hdf5FieldWriter: parallel compression needs HDF5 >= 1.10.2" << std::endl;
+      assert(0);
+#endif
+      err = H5Pset_shuffle(dcpl); assert(err>=0);
+      err = H5Pset_deflate(dcpl, compression_); assert(err>=0);
+    }
+    H5Pset_create_intermediate_group(lcpl, 1);
+
+    hid_t space   = H5Screate_simple(dims.size(), dims.data(), nullptr);
+    hid_t dataset = H5Dcreate2(file, name.c_str(), F::memType(), space, lcpl, dcpl, H5P_DEFAULT);
+
+    if (dataset < 0) {
+      std::cout << GridLogError << "Hdf5FieldWriter: cannot create dataset " << name << std::endl;
+      assert(0);
+    }
+    H5Sclose(space);
+    H5Pclose(lcpl);
+    H5Pclose(dcpl);
+
+    return dataset;
+  }
+
+ private:
+  unsigned int compression_;
+};
+
+class Hdf5FieldReader : public Hdf5FieldIO {
+ public:
+  Hdf5FieldReader(GridBase *grid, const std::string &fileName)
+    : Hdf5FieldIO(grid, fileName) {}
+
+  template<class vobj>
+  void readField(const std::string &name, Lattice<vobj> &field)
+  {
+    typedef FieldType<vobj> F;
+    typedef typename F::sobj sobj;
+
+    assert(field._grid->_fdimensions == grid_->_fdimensions);
+    assert(field._grid->_processors  == grid_->_processors);
+
+    GridStopWatch timer;
+    std::vector<sobj> scalardata(grid_->lSites());
+    uint64_t bytes = sizeof(sobj)*grid_->gSites();
+
+    // without the MPI-IO driver, the ranks read their hyperslab independently
+    timer.Start();
+    hid_t file    = openFile(H5F_ACC_RDONLY, false);
+    hid_t dataset = openDataset<vobj>(file, name);
+
+    transfer(dataset, F::memType(), scalardata.data(), F::nword, false);
+    H5Dclose(dataset);
+    H5Fclose(file);
+    vectorizeFromLexOrdArray(scalardata, field);
+    grid_->Barrier();
+    timer.Stop();
+
+    std::cout << GridLogMessage << "Hdf5FieldReader: " << name << " " << bytes << " bytes in "
+	      << timer.Elapsed() << " " << (double)bytes/(double)timer.useconds() << " MB/s" << std::endl;
+  }
+
+  template<class vobj>
+  void readField(const std::string &name, std::vector<Lattice<vobj> > &field)
+  {
+    for (unsigned int i = 0; i < field.size(); i++) {
+      readField(name + "_" + std::to_string(i), field[i]);
+    }
+  }
+
+ private:
+  template<class vobj>
+  hid_t openDataset(hid_t file, const std::string &name)
+  {
+    typedef FieldType<vobj> F;
+
+    std::vector<hsize_t> dims, start, count, fileDims;
+    hid_t dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+
+    if (dataset < 0) {
+      std::cout << GridLogError << "Hdf5FieldReader: no dataset " << name << " in " << fileName_ << std::endl;
+      assert(0);
+    }
+    geometry(F::nword, dims, start, count);
+
+    hid_t space = H5Dget_space(dataset);
+
+    fileDims.resize(H5Sget_simple_extent_ndims(space));
+    H5Sget_simple_extent_dims(space, fileDims.data(), nullptr);
+    H5Sclose(space);
+    if (fileDims != dims) {
+      std::cout << GridLogError << "Hdf5FieldReader: dataset " << name
+		<< " does not match the lattice dimensions or the field type" << std::endl;
+      assert(0);
+    }
+
+    return dataset;
+  }
+};
+
+}
+#endif
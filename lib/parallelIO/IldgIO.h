@@ -243,6 +243,53 @@ class GridLimeReader : public BinaryIO {
     }
   }
   ////////////////////////////////////////////
+  // Read a hyperslab of a generic lattice field, stored with global
+  // dimensions file_vol; the checksum record can only be verified if the
+  // slab is the whole field
+  ////////////////////////////////////////////
+  template<class vobj>
+  void readLimeLatticeBinaryObjectSlab(Lattice<vobj> &field,std::string record_name,
+				       const std::vector<int> &file_vol,
+				       const std::vector<int> &slab_start)
+  {
+    typedef typename vobj::scalar_object sobj;
+    scidacChecksum scidacChecksum_;
+    uint32_t nersc_csum,scidac_csuma,scidac_csumb;
+
+    std::string format = getFormatString<vobj>();
+
+    while ( limeReaderNextRecord(LimeR) == LIME_SUCCESS ) { 
+
+      uint64_t file_bytes =limeReaderBytes(LimeR);
+
+      if ( !strncmp(limeReaderType(LimeR), record_name.c_str(),strlen(record_name.c_str()) )  ) {
+
+	uint64_t file_sites = 1;
+	bool     whole      = true;
+
+	for(int d=0;d<file_vol.size();d++) {
+	  file_sites *= file_vol[d];
+	  whole = whole && (slab_start[d] == 0) && (file_vol[d] == field._grid->_fdimensions[d]);
+	}
+	assert(sizeof(sobj)*file_sites == file_bytes);// Must match or user error
+
+	uint64_t offset= ftello(File);
+	BinarySimpleMunger<sobj,sobj> munge;
+	BinaryIO::readLatticeObjectSlab< vobj, sobj >(field, filename, munge, offset, format, file_vol, slab_start,
+						      nersc_csum,scidac_csuma,scidac_csumb);
+
+	readLimeObject(scidacChecksum_,std::string("scidacChecksum"),std::string(SCIDAC_CHECKSUM));
+	if (whole) {
+	  assert(scidacChecksumVerify(scidacChecksum_,scidac_csuma,scidac_csumb)==1);
+	} else {
+	  std::cout << GridLogMessage << "Partial read of " << record_name 
+		    << ", checksum verification skipped" << std::endl;
+	}
+	return;
+      }
+    }
+  }
+  ////////////////////////////////////////////
   // Read a generic serialisable object
   ////////////////////////////////////////////
   template<class serialisable_object>
@@ -457,6 +504,22 @@ class ScidacReader : public GridLimeReader {
     readLimeObject(_scidacRecord,_scidacRecord.SerialisableClassName(),std::string(SCIDAC_PRIVATE_RECORD_XML));
     readLimeLatticeBinaryObject(field,std::string(ILDG_BINARY_DATA));
   }
+  ////////////////////////////////////////////////
+  // Read a hyperslab of a field in scidac format, the field global
+  // dimensions are the extent of the slab
+  ////////////////////////////////////////////////
+  template <class vobj, class userRecord>
+  void readScidacFieldSlab(Lattice<vobj> &field,userRecord &_userRecord,
+			   const std::vector<int> &slab_start) 
+  {
+    FieldMetaData header;
+    scidacRecord  _scidacRecord;
+
+    readLimeObject(header ,std::string("FieldMetaData"),std::string(GRID_FORMAT)); // Open message 
+    readLimeObject(_userRecord,_userRecord.SerialisableClassName(),std::string(SCIDAC_RECORD_XML));
+    readLimeObject(_scidacRecord,_scidacRecord.SerialisableClassName(),std::string(SCIDAC_PRIVATE_RECORD_XML));
+    readLimeLatticeBinaryObjectSlab(field,std::string(ILDG_BINARY_DATA),header.dimension,slab_start);
+  }
   void skipPastBinaryRecord(void) {
     std::string rec_name(ILDG_BINARY_DATA);
     while ( limeReaderNextRecord(LimeR) == LIME_SUCCESS ) { 
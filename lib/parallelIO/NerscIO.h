@@ -257,6 +257,48 @@ namespace Grid {
 		 <<std::dec<<" plaq "<< header.plaquette <<std::endl;
 
       }
+      // Same file as writeConfiguration, the data and the final header are
+      // written in the background, U can be modified on return
+      template<class vsimd>
+      static inline BinaryIO::AsyncRequest writeConfigurationAsync(Lattice<iLorentzColourMatrix<vsimd> > &Umu,
+								   std::string file)
+      {
+	typedef iLorentzColourMatrix<vsimd> vobj;
+	typedef typename vobj::scalar_object sobj;
+	typedef LorentzColourMatrixD fobj3D;
+
+	FieldMetaData header;
+	header.sequence_number = 1;
+	header.ensemble_id     = "UKQCD";
+	header.ensemble_label  = "DWF";
+
+	GridBase *grid = Umu._grid;
+
+	GridMetaData(grid,header);
+	assert(header.nd==4);
+	GaugeStatistics(Umu,header);
+	MachineCharacteristics(header);
+
+	int offset;
+
+	truncate(file);
+
+	header.floating_point = std::string("IEEE64BIG");
+	header.data_type      = std::string("4D_SU3_GAUGE_3x3");
+	GaugeSimpleUnmunger<fobj3D,sobj> munge;
+	offset = writeHeader(header,file);
+
+	BinaryIO::AsyncRequest req = 
+	  BinaryIO::writeLatticeObjectAsync<vobj,fobj3D>(Umu,file,munge,offset,header.floating_point);
+	header.checksum = req.nersc_csum;
+	req.then([header,file](void) { FieldMetaData h(header); writeHeader(h,file); });
+
+	std::cout<<GridLogMessage <<"Queued NERSC Configuration on "<< file << " checksum "
+		 <<std::hex<<header.checksum
+		 <<std::dec<<" plaq "<< header.plaquette <<std::endl;
+
+	return req;
+      }
       ///////////////////////////////
       // RNG state
       ///////////////////////////////
@@ -307,6 +349,50 @@ namespace Grid {
 
       }
     
+      static inline BinaryIO::AsyncRequest writeRNGStateAsync(GridSerialRNG &serial,GridParallelRNG &parallel,std::string file)
+      {
+	FieldMetaData header;
+	header.sequence_number = 1;
+	header.ensemble_id     = "UKQCD";
+	header.ensemble_label  = "DWF";
+
+	GridBase *grid = parallel._grid;
+
+	GridMetaData(grid,header);
+	assert(header.nd==4);
+	header.link_trace=0.0;
+	header.plaquette=0.0;
+	MachineCharacteristics(header);
+
+	int offset;
+  
+#ifdef RNG_RANLUX
+	header.floating_point = std::string("UINT64");
+	header.data_type      = std::string("RANLUX48");
+#endif
+#ifdef RNG_MT19937
+	header.floating_point = std::string("UINT32");
+	header.data_type      = std::string("MT19937");
+#endif
+#ifdef RNG_SITMO
+	header.floating_point = std::string("UINT64");
+	header.data_type      = std::string("SITMO");
+#endif
+
+	truncate(file);
+	offset = writeHeader(header,file);
+	BinaryIO::AsyncRequest req = BinaryIO::writeRNGAsync(serial,parallel,file,offset);
+	header.checksum = req.nersc_csum;
+	req.then([header,file](void) { FieldMetaData h(header); writeHeader(h,file); });
+
+	std::cout<<GridLogMessage 
+		 <<"Queued NERSC RNG STATE "<<file<< " checksum "
+		 <<std::hex<<header.checksum
+		 <<std::dec<<std::endl;
+
+	return req;
+      }
+    
       static inline void readRNGState(GridSerialRNG &serial,GridParallelRNG & parallel,FieldMetaData& header,std::string file)
       {
 	typedef typename GridParallelRNG::RngStateType RngStateType;
@@ -58,13 +58,18 @@ namespace QCD{
       bool use_heatbath_forecasting;
       AbstractEOFAFermion<Impl>& Lop; // the basic LH operator
       AbstractEOFAFermion<Impl>& Rop; // the basic RH operator
+      CountingOperatorFunction<FermionField> CountingSolver;
       SchurRedBlackDiagMooeeSolve<FermionField> Solver;
       FermionField Phi; // the pseudofermion field for this trajectory
+      ChronoSolutionHistory<FermionField> ChronoL; // initial guesses for the LH force solves
+      ChronoSolutionHistory<FermionField> ChronoR; // initial guesses for the RH force solves
 
     public:
       ExactOneFlavourRatioPseudoFermionAction(AbstractEOFAFermion<Impl>& _Lop, AbstractEOFAFermion<Impl>& _Rop,
-        OperatorFunction<FermionField>& S, Params& p, bool use_fc=false) : Lop(_Lop), Rop(_Rop), Solver(S),
-        Phi(_Lop.FermionGrid()), param(p), use_heatbath_forecasting(use_fc)
+        OperatorFunction<FermionField>& S, Params& p, bool use_fc=false) : Lop(_Lop), Rop(_Rop), CountingSolver(S), Solver(CountingSolver),
+        Phi(_Lop.FermionGrid()), param(p), use_heatbath_forecasting(use_fc),
+        ChronoL("ExactOneFlavourRatioPseudoFermionAction LH chrono"),
+        ChronoR("ExactOneFlavourRatioPseudoFermionAction RH chrono")
       {
         AlgRemez remez(param.lo, param.hi, param.precision);
 
@@ -74,6 +79,9 @@ namespace QCD{
         PowerNegHalf.Init(remez, param.tolerance, true);
       };
 
+      // Forecast force solve guesses from the last depth solutions; zero disables
+      void EnableChronoForecast(int depth) { ChronoL.setDepth(depth); ChronoR.setDepth(depth); }
+
       virtual std::string action_name() { return "ExactOneFlavourRatioPseudoFermionAction"; }
 
       virtual std::string LogParameters() {
@@ -182,6 +190,9 @@ namespace QCD{
         // Reset shift coefficients for energy and force evals
         Lop.RefreshShiftCoefficients(0.0);
         Rop.RefreshShiftCoefficients(-1.0);
+
+        ChronoL.Reset();
+        ChronoR.Reset();
       };
 
       // EOFA action: see Eqn. (10) of arXiv:1706.05843
@@ -189,6 +200,8 @@ namespace QCD{
       {
         Lop.ImportGauge(U);
         Rop.ImportGauge(U);
+        ChronoL.Reset(); // trajectory boundary
+        ChronoR.Reset();
 
         FermionField spProj_Phi(Lop.FermionGrid());
         std::vector<FermionField> tmp(2, Lop.FermionGrid());
@@ -240,7 +253,10 @@ namespace QCD{
         Lop.Omega(spProj_Phi, Omega_spProj_Phi, -1, 0);
         G5R5(CG_src, Omega_spProj_Phi);
         spProj_Phi = zero;
+        ChronoL.GuessSchur(Lop, CG_src, spProj_Phi);
+        uint64_t count = CountingSolver.Count;
         Solver(Lop, CG_src, spProj_Phi);
+        ChronoL.UpdateSchur(Lop, spProj_Phi, CountingSolver.Count-count);
         Lop.Dtilde(spProj_Phi, Chi);
         G5R5(g5_R5_Chi, Chi);
         Lop.MDeriv(force, g5_R5_Chi, Chi, DaggerNo);
@@ -252,7 +268,10 @@ namespace QCD{
         Rop.Omega(spProj_Phi, Omega_spProj_Phi, 1, 0);
         G5R5(CG_src, Omega_spProj_Phi);
         spProj_Phi = zero;
+        ChronoR.GuessSchur(Rop, CG_src, spProj_Phi);
+        count = CountingSolver.Count;
         Solver(Rop, CG_src, spProj_Phi);
+        ChronoR.UpdateSchur(Rop, spProj_Phi, CountingSolver.Count-count);
         Rop.Dtilde(spProj_Phi, Chi);
         G5R5(g5_R5_Chi, Chi);
         Lop.MDeriv(force, g5_R5_Chi, Chi, DaggerNo);
@@ -51,6 +51,8 @@ namespace Grid {
       FermionField PhiOdd;   // the pseudo fermion field for this trajectory
       FermionField PhiEven;  // the pseudo fermion field for this trajectory
 
+      ChronoSolutionHistory<FermionField> DerivChrono; // initial guesses for the force solves
+
     public:
       /////////////////////////////////////////////////
       // Pass in required objects.
@@ -62,8 +64,12 @@ namespace Grid {
 	  DerivativeSolver(DS),
 	  ActionSolver(AS),
 	  PhiEven(Op.FermionRedBlackGrid()),
-	  PhiOdd(Op.FermionRedBlackGrid())
+	  PhiOdd(Op.FermionRedBlackGrid()),
+	  DerivChrono("TwoFlavourEvenOddPseudoFermionAction chrono")
       {};
+
+      // Forecast force solve guesses from the last depth solutions; zero disables
+      void EnableChronoForecast(int depth) { DerivChrono.setDepth(depth); }
   
       virtual std::string action_name(){return "TwoFlavourEvenOddPseudoFermionAction";}
       
@@ -105,7 +111,8 @@ namespace Grid {
     
 	PhiOdd =PhiOdd*scale;
 	PhiEven=PhiEven*scale;
-    
+
+	DerivChrono.Reset();
       };
   
       //////////////////////////////////////////////////////
@@ -115,6 +122,7 @@ namespace Grid {
       virtual RealD S(const GaugeField &U) {
 	
 	FermOp.ImportGauge(U);
+	DerivChrono.Reset(); // trajectory boundary
 
 	FermionField X(FermOp.FermionRedBlackGrid());
 	FermionField Y(FermOp.FermionRedBlackGrid());
@@ -156,7 +164,7 @@ namespace Grid {
 	// So must take dSdU - adj(dSdU) and left multiply by mom to get dS/dt.
 
 	X=zero;
-	DerivativeSolver(Mpc,PhiOdd,X);
+	DerivChrono(DerivativeSolver,Mpc,PhiOdd,X);
 	Mpc.Mpc(X,Y);
   Mpc.MpcDeriv(tmp , Y, X );    dSdU=tmp;
   Mpc.MpcDagDeriv(tmp , X, Y);  dSdU=dSdU+tmp;
@@ -50,6 +50,8 @@ namespace Grid{
       FermionField PhiOdd;   // the pseudo fermion field for this trajectory
       FermionField PhiEven;  // the pseudo fermion field for this trajectory
 
+      ChronoSolutionHistory<FermionField> DerivChrono; // initial guesses for the force solves
+
     public:
       TwoFlavourEvenOddRatioPseudoFermionAction(FermionOperator<Impl>  &_NumOp, 
                                                 FermionOperator<Impl>  &_DenOp, 
@@ -60,7 +62,8 @@ namespace Grid{
       DerivativeSolver(DS), 
       ActionSolver(AS),
       PhiEven(_NumOp.FermionRedBlackGrid()),
-      PhiOdd(_NumOp.FermionRedBlackGrid()) 
+      PhiOdd(_NumOp.FermionRedBlackGrid()),
+      DerivChrono("TwoFlavourEvenOddRatioPseudoFermionAction chrono")
         {
           conformable(_NumOp.FermionGrid(), _DenOp.FermionGrid());
           conformable(_NumOp.FermionRedBlackGrid(), _DenOp.FermionRedBlackGrid());
@@ -68,6 +71,9 @@ namespace Grid{
           conformable(_NumOp.GaugeRedBlackGrid(), _DenOp.GaugeRedBlackGrid());
         };
 
+      // Forecast force solve guesses from the last depth solutions; zero disables
+      void EnableChronoForecast(int depth) { DerivChrono.setDepth(depth); }
+
       virtual std::string action_name(){return "TwoFlavourEvenOddRatioPseudoFermionAction";}
 
       virtual std::string LogParameters(){
@@ -120,7 +126,8 @@ namespace Grid{
 
         PhiOdd =PhiOdd*scale;
         PhiEven=PhiEven*scale;
-        
+
+        DerivChrono.Reset();
       };
 
       //////////////////////////////////////////////////////
@@ -130,6 +137,7 @@ namespace Grid{
 
         NumOp.ImportGauge(U);
         DenOp.ImportGauge(U);
+        DerivChrono.Reset(); // trajectory boundary
 
         SchurDifferentiableOperator<Impl> Mpc(DenOp);
         SchurDifferentiableOperator<Impl> Vpc(NumOp);
@@ -181,7 +189,7 @@ namespace Grid{
         //Y = (Mdag)^-1 V^dag  phi
         Vpc.MpcDag(PhiOdd,Y);          // Y= Vdag phi
         X=zero;
-        DerivativeSolver(Mpc,Y,X);     // X= (MdagM)^-1 Vdag phi
+        DerivChrono(DerivativeSolver,Mpc,Y,X); // X= (MdagM)^-1 Vdag phi
         Mpc.Mpc(X,Y);                  // Y=  Mdag^-1 Vdag phi
 
         // phi^dag V (Mdag M)^-1 dV^dag  phi
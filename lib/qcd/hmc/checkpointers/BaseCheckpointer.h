@@ -29,27 +29,66 @@ directory
 #ifndef BASE_CHECKPOINTER
 #define BASE_CHECKPOINTER
 
+#include <Grid/qcd/hmc/checkpointers/CheckpointManager.h>
+
 namespace Grid {
 namespace QCD {
 
+// Options added after the first four parameters. They are read as one
+// block with its own defaults, so that a parameter file written before they
+// existed (no <options> node) still reads.
+//  async: configuration and RNG files are written in the background
+//  (Binary and NERSC checkpointers)
+//  io_aggregators, io_hints: MPI-IO tuning as --io-aggregators and
+//  --io-hints, which they override when set
+//  reconstruct, compress: 12 or 8 parameters per link and byte-plane
+//  compression (Compact checkpointer)
+//  keep_last: with N > 0 only the last N checkpoints are kept, listed in
+//  <config_prefix>.index; files are renamed into place once complete and
+//  unchanged configurations or RNG states are not written again
+class CheckpointerOptions : Serializable {
+ public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(CheckpointerOptions, 
+  	bool, async, 
+  	int, io_aggregators, 
+  	std::string, io_hints, 
+  	int, reconstruct, 
+  	bool, compress, 
+  	int, keep_last, );
+
+  CheckpointerOptions(bool as = false, int agg = 0,
+                      const std::string &hints = "", int rec = 12,
+                      bool comp = true, int keep = 0)
+      : async(as),
+        io_aggregators(agg),
+        io_hints(hints),
+        reconstruct(rec),
+        compress(comp),
+        keep_last(keep){};
+};
+
 class CheckpointerParameters : Serializable {
  public:
   GRID_SERIALIZABLE_CLASS_MEMBERS(CheckpointerParameters, 
   	std::string, config_prefix, 
   	std::string, rng_prefix, 
   	int, saveInterval, 
-  	std::string, format, );
+  	std::string, format, 
+  	CheckpointerOptions, options, );
 
   CheckpointerParameters(std::string cf = "cfg", std::string rn = "rng",
-   		      int savemodulo = 1, const std::string &f = "IEEE64BIG")
+   		      int savemodulo = 1, const std::string &f = "IEEE64BIG",
+		      bool as = false, int agg = 0, const std::string &hints = "",
+		      int rec = 12, bool comp = true, int keep = 0)
       : config_prefix(cf),
         rng_prefix(rn),
         saveInterval(savemodulo),
-        format(f){};
+        format(f),
+        options(as, agg, hints, rec, comp, keep){};
 
 
   template <class ReaderClass >
-  CheckpointerParameters(Reader<ReaderClass> &Reader) {
+  CheckpointerParameters(Reader<ReaderClass> &Reader) : CheckpointerParameters() {
     read(Reader, "Checkpointer", *this);
   }
  
@@ -60,6 +99,9 @@ class CheckpointerParameters : Serializable {
 // Base class for checkpointers
 template <class Impl>
 class BaseHmcCheckpointer : public HmcObservable<typename Impl::Field> {
+ protected:
+  CheckpointManager manager;
+
  public:
   void build_filenames(int traj, CheckpointerParameters &Params,
                        std::string &conf_file, std::string &rng_file) {
@@ -76,6 +118,36 @@ class BaseHmcCheckpointer : public HmcObservable<typename Impl::Field> {
     }
  	} 
 
+  void set_io_parameters(const CheckpointerParameters &Params) {
+    if (Params.options.io_aggregators > 0) BinaryIO::ioParameters().aggregators = Params.options.io_aggregators;
+    if (!Params.options.io_hints.empty())  BinaryIO::ioParameters().hints       = Params.options.io_hints;
+  }
+
+  void set_manager(const CheckpointerParameters &Params) {
+    manager.initialize(Params.options.keep_last, Params.config_prefix);
+  }
+
+  // names to write the checkpoint of traj to, empty when the manager finds
+  // the data unchanged; commit_checkpoint once they are written
+  template <class Field>
+  void stage_filenames(int traj, CheckpointerParameters &Params, Field &U,
+                       GridSerialRNG &sRNG, GridParallelRNG &pRNG,
+                       std::string &conf_file, std::string &rng_file) {
+    build_filenames(traj, Params, conf_file, rng_file);
+    if (manager.enabled()) manager.stage(traj, conf_file, rng_file, U, sRNG, pRNG);
+  }
+
+  void commit_checkpoint(bool sync = true) {
+    if (manager.enabled()) manager.commit(sync);
+  }
+
+  // names to restore traj from, as listed in the index if there is one
+  void restore_filenames(int traj, CheckpointerParameters &Params,
+                         std::string &conf_file, std::string &rng_file) {
+    build_filenames(traj, Params, conf_file, rng_file);
+    if (manager.enabled()) manager.lookup(traj, conf_file, rng_file);
+  }
+
   virtual void initialize(const CheckpointerParameters &Params) = 0;
 
   virtual void CheckpointRestore(int traj, typename Impl::Field &U,
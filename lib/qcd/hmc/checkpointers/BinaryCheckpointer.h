@@ -41,6 +41,7 @@ template <class Impl>
 class BinaryHmcCheckpointer : public BaseHmcCheckpointer<Impl> {
  private:
   CheckpointerParameters Params;
+  BinaryIO::AsyncRequest pending;
 
  public:
   INHERIT_FIELD_TYPES(Impl);  // Gets the Field type, a Lattice object
@@ -55,7 +56,16 @@ class BinaryHmcCheckpointer : public BaseHmcCheckpointer<Impl> {
     initialize(Params_);
   }
 
-  void initialize(const CheckpointerParameters &Params_) { Params = Params_; }
+  ~BinaryHmcCheckpointer(void) {
+    pending.wait();
+    this->commit_checkpoint(false);
+  }
+
+  void initialize(const CheckpointerParameters &Params_) {
+    Params = Params_;
+    this->set_io_parameters(Params);
+    this->set_manager(Params);
+  }
 
   void truncate(std::string file) {
     std::ofstream fout(file, std::ios::out);
@@ -64,21 +74,51 @@ class BinaryHmcCheckpointer : public BaseHmcCheckpointer<Impl> {
 
   void TrajectoryComplete(int traj, Field &U, GridSerialRNG &sRNG, GridParallelRNG &pRNG) {
 
+    // at most one checkpoint in flight
+    pending.wait();
+    this->commit_checkpoint();
     if ((traj % Params.saveInterval) == 0) {
       std::string config, rng;
-      this->build_filenames(traj, Params, config, rng);
-
-      uint32_t nersc_csum;
-      uint32_t scidac_csuma;
-      uint32_t scidac_csumb;
+      this->stage_filenames(traj, Params, U, sRNG, pRNG, config, rng);
+
+      if (Params.options.async) {
+        BinarySimpleUnmunger<sobj_double, sobj> munge;
+        BinaryIO::AsyncRequest req;
+        pending = BinaryIO::AsyncRequest();
+        if (!rng.empty()) {
+          truncate(rng);
+          pending = BinaryIO::writeRNGAsync(sRNG, pRNG, rng, 0);
+        }
+        if (!config.empty()) {
+          truncate(config);
+          req = BinaryIO::writeLatticeObjectAsync<vobj, sobj_double>(U, config, munge, 0, Params.format);
+          pending.merge(req);
+
+          std::cout << GridLogMessage << "Queued Binary Configuration " << config
+                    << " checksum " << std::hex 
+                    << req.nersc_csum   <<"/"
+                    << req.scidac_csuma <<"/"
+                    << req.scidac_csumb 
+                    << std::dec << std::endl;
+        }
+        return;
+      }
+
+      uint32_t nersc_csum   = 0;
+      uint32_t scidac_csuma = 0;
+      uint32_t scidac_csumb = 0;
       
       BinarySimpleUnmunger<sobj_double, sobj> munge;
-      truncate(rng);
-      BinaryIO::writeRNG(sRNG, pRNG, rng, 0,nersc_csum,scidac_csuma,scidac_csumb);
-      truncate(config);
-
-      BinaryIO::writeLatticeObject<vobj, sobj_double>(U, config, munge, 0, Params.format,
-						      nersc_csum,scidac_csuma,scidac_csumb);
+      if (!rng.empty()) {
+        truncate(rng);
+        BinaryIO::writeRNG(sRNG, pRNG, rng, 0,nersc_csum,scidac_csuma,scidac_csumb);
+      }
+      if (!config.empty()) {
+        truncate(config);
+        BinaryIO::writeLatticeObject<vobj, sobj_double>(U, config, munge, 0, Params.format,
+						        nersc_csum,scidac_csuma,scidac_csumb);
+      }
+      this->commit_checkpoint();
 
       std::cout << GridLogMessage << "Written Binary Configuration " << config
                 << " checksum " << std::hex 
@@ -91,8 +131,10 @@ class BinaryHmcCheckpointer : public BaseHmcCheckpointer<Impl> {
   };
 
   void CheckpointRestore(int traj, Field &U, GridSerialRNG &sRNG, GridParallelRNG &pRNG) {
+    pending.wait();
+    this->commit_checkpoint();
     std::string config, rng;
-    this->build_filenames(traj, Params, config, rng);
+    this->restore_filenames(traj, Params, config, rng);
 
     BinarySimpleMunger<sobj_double, sobj> munge;
 
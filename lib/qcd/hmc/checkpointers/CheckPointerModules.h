@@ -122,6 +122,19 @@ class NerscCPModule: public CheckPointerModule< ImplementationPolicy> {
 };
 
 
+template<class ImplementationPolicy>
+class CompactCPModule: public CheckPointerModule< ImplementationPolicy> {
+  typedef CheckPointerModule< ImplementationPolicy> CPBase;
+  using CPBase::CPBase; // for constructors inheritance
+
+  // acquire resource
+  virtual void initialize(){
+     this->CheckPointPtr.reset(new CompactHmcCheckpointer<ImplementationPolicy>(this->Par_));
+  }
+
+};
+
+
 #ifdef HAVE_LIME
   
 template<class ImplementationPolicy>
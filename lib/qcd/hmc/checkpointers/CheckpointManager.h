@@ -0,0 +1,269 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid
+
+Source file: ./lib/qcd/hmc/checkpointers/CheckpointManager.h
+
+Copyright (C) 2015
+
+Author: Guido Cossu <guido.cossu@ed.ac.uk>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution
+directory
+*************************************************************************************/
+/*  END LEGAL */
+#ifndef CHECKPOINT_MANAGER
+#define CHECKPOINT_MANAGER
+
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace Grid {
+namespace QCD {
+
+class CheckpointEntry : Serializable {
+ public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(CheckpointEntry,
+  	int, traj,
+  	std::string, config,
+  	std::string, rng,
+  	std::string, config_fingerprint,
+  	std::string, rng_fingerprint);
+};
+
+class CheckpointIndex : Serializable {
+ public:
+  GRID_SERIALIZABLE_CLASS_MEMBERS(CheckpointIndex,
+  	std::vector<CheckpointEntry>, checkpoints);
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Keeps the last few checkpoints of a stream, listed in <config_prefix>.index
+//  - files are written under a temporary name and renamed once complete,
+//    then the index is replaced the same way, so that it only ever lists
+//    complete checkpoints
+//  - a configuration or RNG state identical to the one of the previous
+//    checkpoint (a rejected trajectory, a repeated save) is not written
+//    again, the new entry points to the existing file
+//  - files no longer listed are removed
+// Identity is decided on checksums of the fields in memory.
+//////////////////////////////////////////////////////////////////////////////
+class CheckpointManager {
+ private:
+  int keep = 0;
+  std::string indexFile;
+  CheckpointIndex index;
+  CheckpointEntry staged;
+  GridBase *grid  = nullptr;
+  bool pending    = false;
+  bool newConfig  = false;
+  bool newRng     = false;
+
+  static bool exists(const std::string &file) {
+    std::ifstream f(file);
+    return f.good();
+  }
+
+  static std::string hexString(uint32_t a, uint32_t b) {
+    std::stringstream s;
+    s << std::hex << std::setw(8) << std::setfill('0') << a << std::setw(8) << std::setfill('0') << b;
+    return s.str();
+  }
+
+  bool referenced(const std::string &file) {
+    for (auto &e : index.checkpoints) {
+      if ((e.config == file) || (e.rng == file)) return true;
+    }
+    return false;
+  }
+
+  static void move(const std::string &from, const std::string &to) {
+    if (std::rename(from.c_str(), to.c_str()) != 0) {
+      std::cout << GridLogError << "Checkpoint manager: cannot rename " << from << " to " << to << std::endl;
+      assert(0);
+    }
+  }
+
+ public:
+  void initialize(int keep_, const std::string &prefix) {
+    keep      = keep_;
+    indexFile = prefix + ".index";
+    pending   = false;
+    index.checkpoints.clear();
+    if ((keep > 0) && exists(indexFile)) {
+      XmlReader RD(indexFile);
+      read(RD, "CheckpointIndex", index);
+    }
+  }
+
+  bool enabled(void) const { return keep > 0; }
+
+  const CheckpointIndex &checkpoints(void) const { return index; }
+
+  // SciDAC style checksum pair of the local data, site positions folded in
+  template <class vobj>
+  static std::string fingerprint(Lattice<vobj> &U) {
+    GridBase *g     = U._grid;
+    uint64_t osites = g->oSites();
+    uint64_t base   = osites * g->ThisRank();
+    uint32_t a = 0, b = 0;
+#pragma omp parallel
+    {
+      uint32_t at = 0, bt = 0;
+#pragma omp for
+      for (uint64_t ss = 0; ss < osites; ss++) {
+        uint32_t crc = BinaryIO::crc32Sliced(0, (unsigned char *)&U._odata[ss], sizeof(vobj));
+        at ^= BinaryIO::crc32Rotate(crc, (base + ss) % 29);
+        bt ^= BinaryIO::crc32Rotate(crc, (base + ss) % 31);
+      }
+#pragma omp critical
+      {
+        a ^= at;
+        b ^= bt;
+      }
+    }
+    g->GlobalXOR(a);
+    g->GlobalXOR(b);
+    return hexString(a, b);
+  }
+
+  static std::string fingerprint(GridSerialRNG &sRNG, GridParallelRNG &pRNG) {
+    typedef typename GridParallelRNG::RngStateType RngStateType;
+    GridBase *g   = pRNG._grid;
+    uint64_t ngen = pRNG._generators.size();
+    uint64_t base = ngen * g->ThisRank();
+    uint32_t a = 0, b = 0;
+#pragma omp parallel
+    {
+      std::vector<RngStateType> state;
+      uint32_t at = 0, bt = 0;
+#pragma omp for
+      for (uint64_t gen = 0; gen < ngen; gen++) {
+        pRNG.GetState(state, gen);
+        uint32_t crc = BinaryIO::crc32Sliced(0, (unsigned char *)&state[0], sizeof(RngStateType) * state.size());
+        at ^= BinaryIO::crc32Rotate(crc, (base + gen) % 29);
+        bt ^= BinaryIO::crc32Rotate(crc, (base + gen) % 31);
+      }
+#pragma omp critical
+      {
+        a ^= at;
+        b ^= bt;
+      }
+    }
+    g->GlobalXOR(a);
+    g->GlobalXOR(b);
+    std::vector<RngStateType> state;
+    sRNG.GetState(state, 0);
+    uint32_t crc = BinaryIO::crc32Sliced(0, (unsigned char *)&state[0], sizeof(RngStateType) * state.size());
+    return hexString(a ^ crc, b ^ BinaryIO::crc32Rotate(crc, 1));
+  }
+
+  // On entry the final file names, on return the names to write to:
+  // temporary names, or empty if the data has not changed since the last
+  // checkpoint
+  template <class vobj>
+  void stage(int traj, std::string &config, std::string &rng, Lattice<vobj> &U,
+             GridSerialRNG &sRNG, GridParallelRNG &pRNG) {
+    assert(!pending);
+    grid                      = U._grid;
+    staged.traj               = traj;
+    staged.config             = config;
+    staged.rng                = rng;
+    staged.config_fingerprint = fingerprint(U);
+    staged.rng_fingerprint    = fingerprint(sRNG, pRNG);
+    newConfig = true;
+    newRng    = true;
+    if (!index.checkpoints.empty()) {
+      CheckpointEntry &last = index.checkpoints.back();
+      if ((last.config_fingerprint == staged.config_fingerprint) && exists(last.config)) {
+        staged.config = last.config;
+        newConfig     = false;
+      }
+      if ((last.rng_fingerprint == staged.rng_fingerprint) && exists(last.rng)) {
+        staged.rng = last.rng;
+        newRng     = false;
+      }
+    }
+    config  = newConfig ? staged.config + ".tmp" : std::string();
+    rng     = newRng    ? staged.rng    + ".tmp" : std::string();
+    pending = true;
+
+    if (!newConfig) std::cout << GridLogMessage << "Checkpoint " << traj << ": configuration unchanged, kept " << staged.config << std::endl;
+    if (!newRng)    std::cout << GridLogMessage << "Checkpoint " << traj << ": RNG state unchanged, kept " << staged.rng << std::endl;
+  }
+
+  // Once the staged files are written: rename them, replace the index and
+  // drop the oldest checkpoints. Without sync there is no barrier (after
+  // MPI is finalised); the local writes must be complete.
+  void commit(bool sync = true) {
+    if (!pending) return;
+    pending = false;
+    if (sync) grid->Barrier();
+
+    std::vector<CheckpointEntry> dropped;
+    std::vector<CheckpointEntry> &list = index.checkpoints;
+    for (auto e = list.begin(); e != list.end();) {
+      if (e->traj == staged.traj) {
+        dropped.push_back(*e);
+        e = list.erase(e);
+      } else {
+        e++;
+      }
+    }
+    list.push_back(staged);
+    while (list.size() > keep) {
+      dropped.push_back(list.front());
+      list.erase(list.begin());
+    }
+
+    if (grid->IsBoss()) {
+      if (newConfig) move(staged.config + ".tmp", staged.config);
+      if (newRng)    move(staged.rng + ".tmp", staged.rng);
+      {
+        XmlWriter WR(indexFile + ".tmp");
+        write(WR, "CheckpointIndex", index);
+      }
+      move(indexFile + ".tmp", indexFile);
+      for (auto &e : dropped) {
+        if (!referenced(e.config)) std::remove(e.config.c_str());
+        if (!referenced(e.rng))    std::remove(e.rng.c_str());
+      }
+    }
+    if (sync) grid->Barrier();
+
+    std::cout << GridLogMessage << "Checkpoint " << staged.traj << " committed, " << list.size()
+              << " restart points in " << indexFile << std::endl;
+  }
+
+  // files of a listed trajectory
+  bool lookup(int traj, std::string &config, std::string &rng) const {
+    for (auto &e : index.checkpoints) {
+      if (e.traj == traj) {
+        config = e.config;
+        rng    = e.rng;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+}
+}
+#endif
@@ -0,0 +1,84 @@
+/*************************************************************************************
+
+Grid physics library, www.github.com/paboyle/Grid
+
+Source file: ./lib/qcd/hmc/checkpointers/CompactCheckpointer.h
+
+Copyright (C) 2015
+
+Author: paboyle <paboyle@ph.ed.ac.uk>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+See the full license in the file "LICENSE" in the top level distribution
+directory
+*************************************************************************************/
+/*  END LEGAL */
+#ifndef COMPACT_CHECKPOINTER
+#define COMPACT_CHECKPOINTER
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace Grid {
+namespace QCD {
+
+// Gauge configurations as 12 or 8 real parameters per link, byte-plane
+// compressed; precision from the format, IEEE64BIG or IEEE32BIG.
+// RNG states as per site counters where the generator allows it
+template <class Gimpl>
+class CompactHmcCheckpointer : public BaseHmcCheckpointer<Gimpl> {
+ private:
+  CheckpointerParameters Params;
+
+ public:
+  INHERIT_GIMPL_TYPES(Gimpl);  // only for gauge configurations
+
+  CompactHmcCheckpointer(const CheckpointerParameters &Params_) { initialize(Params_); }
+
+  void initialize(const CheckpointerParameters &Params_) {
+    Params = Params_;
+    this->set_io_parameters(Params);
+    this->set_manager(Params);
+    if (Params.format != "IEEE32BIG") Params.format = "IEEE64BIG";
+    if (Params.options.reconstruct != 8) Params.options.reconstruct = 12;
+  }
+
+  void TrajectoryComplete(int traj, GaugeField &U, GridSerialRNG &sRNG,
+                          GridParallelRNG &pRNG) {
+    if ((traj % Params.saveInterval) == 0) {
+      std::string config, rng;
+      this->stage_filenames(traj, Params, U, sRNG, pRNG, config, rng);
+
+      if (!rng.empty())    CompactIO::writeRNGState(sRNG, pRNG, rng, Params.options.compress);
+      if (!config.empty()) CompactIO::writeConfiguration(U, config, Params.options.reconstruct, Params.options.compress, Params.format);
+      this->commit_checkpoint();
+    }
+  };
+
+  void CheckpointRestore(int traj, GaugeField &U, GridSerialRNG &sRNG,
+                         GridParallelRNG &pRNG) {
+    std::string config, rng;
+    this->restore_filenames(traj, Params, config, rng);
+
+    FieldMetaData header;
+    CompactIO::readRNGState(sRNG, pRNG, header, rng);
+    CompactIO::readConfiguration(U, header, config);
+  };
+};
+}
+}
+#endif
@@ -51,6 +51,8 @@ class ILDGHmcCheckpointer : public BaseHmcCheckpointer<Implementation> {
 
   void initialize(const CheckpointerParameters &Params_) {
     Params = Params_;
+    this->set_io_parameters(Params);
+    this->set_manager(Params);
 
     // check here that the format is valid
     int ieee32big = (Params.format == std::string("IEEE32BIG"));
@@ -73,14 +75,19 @@ class ILDGHmcCheckpointer : public BaseHmcCheckpointer<Implementation> {
                           GridParallelRNG &pRNG) {
     if ((traj % Params.saveInterval) == 0) {
       std::string config, rng;
-      this->build_filenames(traj, Params, config, rng);
+      std::string lfn, rng_final;
+      this->build_filenames(traj, Params, lfn, rng_final);
+      this->stage_filenames(traj, Params, U, sRNG, pRNG, config, rng);
       
-      uint32_t nersc_csum,scidac_csuma,scidac_csumb;
-      BinaryIO::writeRNG(sRNG, pRNG, rng, 0,nersc_csum,scidac_csuma,scidac_csumb);
-      IldgWriter _IldgWriter;
-      _IldgWriter.open(config);
-      _IldgWriter.writeConfiguration(U, traj, config, config);
-      _IldgWriter.close();
+      uint32_t nersc_csum = 0, scidac_csuma = 0, scidac_csumb = 0;
+      if (!rng.empty()) BinaryIO::writeRNG(sRNG, pRNG, rng, 0,nersc_csum,scidac_csuma,scidac_csumb);
+      if (!config.empty()) {
+        IldgWriter _IldgWriter;
+        _IldgWriter.open(config);
+        _IldgWriter.writeConfiguration(U, traj, lfn, lfn);
+        _IldgWriter.close();
+      }
+      this->commit_checkpoint();
 
       std::cout << GridLogMessage << "Written ILDG Configuration on " << config
                 << " checksum " << std::hex 
@@ -94,7 +101,7 @@ class ILDGHmcCheckpointer : public BaseHmcCheckpointer<Implementation> {
   void CheckpointRestore(int traj, GaugeField &U, GridSerialRNG &sRNG,
                          GridParallelRNG &pRNG) {
     std::string config, rng;
-    this->build_filenames(traj, Params, config, rng);
+    this->restore_filenames(traj, Params, config, rng);
 
     uint32_t nersc_csum,scidac_csuma,scidac_csumb;
     BinaryIO::readRNG(sRNG, pRNG, rng, 0,nersc_csum,scidac_csuma,scidac_csumb);
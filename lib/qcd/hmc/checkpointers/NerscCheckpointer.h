@@ -41,34 +41,54 @@ template <class Gimpl>
 class NerscHmcCheckpointer : public BaseHmcCheckpointer<Gimpl> {
  private:
   CheckpointerParameters Params;
+  BinaryIO::AsyncRequest pending;
 
  public:
   INHERIT_GIMPL_TYPES(Gimpl);  // only for gauge configurations
 
   NerscHmcCheckpointer(const CheckpointerParameters &Params_) { initialize(Params_); }
 
+  ~NerscHmcCheckpointer(void) {
+    pending.wait();
+    this->commit_checkpoint(false);
+  }
+
   void initialize(const CheckpointerParameters &Params_) {
     Params = Params_;
+    this->set_io_parameters(Params);
+    this->set_manager(Params);
     Params.format = "IEEE64BIG";  // fixed, overwrite any other choice
   }
 
   void TrajectoryComplete(int traj, GaugeField &U, GridSerialRNG &sRNG,
                           GridParallelRNG &pRNG) {
+    pending.wait();
+    this->commit_checkpoint();
+    this->commit_checkpoint();
     if ((traj % Params.saveInterval) == 0) {
       std::string config, rng;
-      this->build_filenames(traj, Params, config, rng);
-
-      int precision32 = 1;
-      int tworow = 0;
-      NerscIO::writeRNGState(sRNG, pRNG, rng);
-      NerscIO::writeConfiguration(U, config, tworow, precision32);
+      this->stage_filenames(traj, Params, U, sRNG, pRNG, config, rng);
+
+      if (Params.options.async) {
+        pending = BinaryIO::AsyncRequest();
+        if (!rng.empty())    pending.merge(NerscIO::writeRNGStateAsync(sRNG, pRNG, rng));
+        if (!config.empty()) pending.merge(NerscIO::writeConfigurationAsync(U, config));
+      } else {
+        int precision32 = 1;
+        int tworow = 0;
+        if (!rng.empty())    NerscIO::writeRNGState(sRNG, pRNG, rng);
+        if (!config.empty()) NerscIO::writeConfiguration(U, config, tworow, precision32);
+        this->commit_checkpoint();
+      }
     }
   };
 
   void CheckpointRestore(int traj, GaugeField &U, GridSerialRNG &sRNG,
                          GridParallelRNG &pRNG) {
+    pending.wait();
+    this->commit_checkpoint();
     std::string config, rng;
-    this->build_filenames(traj, Params, config, rng);
+    this->restore_filenames(traj, Params, config, rng);
 
     FieldMetaData header;
     NerscIO::readRNGState(sRNG, pRNG, header, rng);
@@ -56,10 +56,13 @@ namespace Grid
     template <typename U>
     void writeDefault(const std::string &s, const std::vector<U> &x);
     std::string XmlString(void);
+    // digits printed for floating point values, stream default if zero
+    void setPrecision(int digits) { precision_ = digits; }
   private:
     pugi::xml_document doc_;
     pugi::xml_node     node_;
     std::string        fileName_;
+    int                precision_{0};
   };
   
   class XmlReader: public Reader<XmlReader>
@@ -97,6 +100,7 @@ namespace Grid
   {
     std::ostringstream os;
     
+    if (precision_ > 0) os.precision(precision_);
     os << std::boolalpha << x;
     pugi::xml_node leaf = node_.append_child(s.c_str());
     leaf.append_child(pugi::node_pcdata).set_value(os.str().c_str());
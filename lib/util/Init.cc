@@ -345,6 +345,14 @@ void Grid_init(int *argc,char ***argv)
     std::cout<<GridLogMessage<<"  --lebesgue      : Cache oblivious Lebesgue curve/Morton order/Z-graph stencil looping"<<std::endl;    
     std::cout<<GridLogMessage<<"  --cacheblocking n.m.o.p : Hypercuboidal cache blocking"<<std::endl;    
     std::cout<<GridLogMessage<<std::endl;
+    std::cout<<GridLogMessage<<"  --io-mmap       : read lattice files through mmap instead of MPI-IO/streams"<<std::endl;    
+    std::cout<<GridLogMessage<<"  --io-aggregators n : funnel MPI-IO lattice file accesses through n ranks"<<std::endl;    
+    std::cout<<GridLogMessage<<"  --io-hints k=v,... : MPI_Info hints for MPI-IO (striping_factor, cb_nodes, ...)"<<std::endl;    
+    std::cout<<GridLogMessage<<std::endl;
+    std::cout<<GridLogMessage<<"Setup:"<<std::endl;
+    std::cout<<GridLogMessage<<std::endl;
+    std::cout<<GridLogMessage<<"  --remez-cache dir : look up and store Remez approximations in dir"<<std::endl;
+    std::cout<<GridLogMessage<<std::endl;
     exit(EXIT_SUCCESS);
   }
 
@@ -388,6 +396,19 @@ void Grid_init(int *argc,char ***argv)
     arg= GridCmdOptionPayload(*argv,*argv+*argc,"--cacheblocking");
     GridCmdOptionIntVector(arg,LebesgueOrder::Block);
   }
+  if( GridCmdOptionExists(*argv,*argv+*argc,"--io-mmap") ){
+    BinaryIO::mmapRead() = true;
+  }
+  if( GridCmdOptionExists(*argv,*argv+*argc,"--io-aggregators") ){
+    arg= GridCmdOptionPayload(*argv,*argv+*argc,"--io-aggregators");
+    GridCmdOptionInt(arg,BinaryIO::ioParameters().aggregators);
+  }
+  if( GridCmdOptionExists(*argv,*argv+*argc,"--io-hints") ){
+    BinaryIO::ioParameters().hints = GridCmdOptionPayload(*argv,*argv+*argc,"--io-hints");
+  }
+  if( GridCmdOptionExists(*argv,*argv+*argc,"--remez-cache") ){
+    RemezCache::Directory = GridCmdOptionPayload(*argv,*argv+*argc,"--remez-cache");
+  }
   if( GridCmdOptionExists(*argv,*argv+*argc,"--notimestamp") ){
     GridLogTimestamp(0);
   } else {
@@ -420,6 +441,8 @@ void Grid_init(int *argc,char ***argv)
 
 void Grid_finalize(void)
 {
+  // background writes use MPI-IO
+  BinaryIO::asyncFinalize();
 #if defined (GRID_COMMS_MPI) || defined (GRID_COMMS_MPI3) || defined (GRID_COMMS_MPIT)
   MPI_Finalize();
   Grid_unquiesce_nodes();
@@ -0,0 +1,134 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid 
+
+    Source file: ./tests/IO/Test_async_io.cc
+
+    Copyright (C) 2015
+
+Author: Azusa Yamaguchi <ayamaguc@staffmail.ed.ac.uk>
+Author: Peter Boyle <paboyle@ph.ed.ac.uk>
+Author: paboyle <paboyle@ph.ed.ac.uk>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// Asynchronous writes must produce the same files and checksums as the
+// synchronous ones, even if the fields are modified while the writes run.
+static bool sameFile(const std::string &a, const std::string &b)
+{
+  std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+  std::string   sa((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+  std::string   sb((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+
+  return (sa.size() > 0) && (sa == sb);
+}
+
+static void truncate(const std::string &file)
+{
+  std::ofstream fout(file, std::ios::out);
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  std::vector<int> simd_layout = GridDefaultSimd(4,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+  std::vector<int> latt_size   = GridDefaultLatt();
+
+  GridCartesian     Fine(latt_size,simd_layout,mpi_layout);
+  GridParallelRNG   pRNG(&Fine);
+  GridSerialRNG     sRNG;
+
+  pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+  sRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+
+  typedef LatticeGaugeField::vector_object vobj;
+  typedef vobj::scalar_object sobj;
+  typedef sobj::DoublePrecision sobj_double;
+
+  LatticeGaugeField Umu(&Fine), Umu_saved(&Fine), Umu_read(&Fine);
+  BinarySimpleUnmunger<sobj_double, sobj> unmunge;
+  BinarySimpleMunger<sobj_double, sobj>   munge;
+  std::string format("IEEE64BIG");
+  uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+  bool pass = true;
+
+  SU3::HotConfiguration(pRNG,Umu);
+  Umu_saved = Umu;
+  Fine.Barrier();
+  if (Fine.IsBoss()) {
+    truncate("./ckpoint_sync.bin");
+    truncate("./ckpoint_async.bin");
+    truncate("./ckpoint_sync.rng");
+    truncate("./ckpoint_async.rng");
+  }
+
+  std::cout << GridLogMessage << "Synchronous writes" << std::endl;
+  BinaryIO::writeLatticeObject<vobj,sobj_double>(Umu,"./ckpoint_sync.bin",unmunge,0,format,
+						 nersc_csum,scidac_csuma,scidac_csumb);
+  BinaryIO::writeRNG(sRNG,pRNG,"./ckpoint_sync.rng",0,nersc_csum,scidac_csuma,scidac_csumb);
+
+  std::cout << GridLogMessage << "Asynchronous writes" << std::endl;
+  BinaryIO::AsyncRequest rngReq = BinaryIO::writeRNGAsync(sRNG,pRNG,"./ckpoint_async.rng",0);
+  BinaryIO::AsyncRequest req = 
+    BinaryIO::writeLatticeObjectAsync<vobj,sobj_double>(Umu,"./ckpoint_async.bin",unmunge,0,format);
+  // the field and the generators are free as soon as the requests are returned
+  SU3::HotConfiguration(pRNG,Umu);
+  random(pRNG,Umu_read);
+  rngReq.wait();
+  pass = pass && (rngReq.nersc_csum == nersc_csum) && (rngReq.scidac_csuma == scidac_csuma)
+              && (rngReq.scidac_csumb == scidac_csumb);
+  req.wait();
+  Fine.Barrier();
+  pass = pass && sameFile("./ckpoint_sync.bin","./ckpoint_async.bin");
+
+  // the serial state is appended once, by the boss, so only the generators
+  // read back are compared
+  GridParallelRNG pRNGa(&Fine), pRNGb(&Fine);
+  GridSerialRNG   sRNGa, sRNGb;
+  LatticeComplex  ra(&Fine), rb(&Fine);
+  ComplexD        sa, sb;
+
+  BinaryIO::readRNG(sRNGa,pRNGa,"./ckpoint_sync.rng",0,nersc_csum,scidac_csuma,scidac_csumb);
+  BinaryIO::readRNG(sRNGb,pRNGb,"./ckpoint_async.rng",0,nersc_csum,scidac_csuma,scidac_csumb);
+  random(pRNGa,ra); random(sRNGa,sa);
+  random(pRNGb,rb); random(sRNGb,sb);
+  ra = ra - rb;
+  pass = pass && (norm2(ra) == 0.) && (sa == sb);
+
+  BinaryIO::readLatticeObject<vobj,sobj_double>(Umu_read,"./ckpoint_async.bin",munge,0,format,
+						nersc_csum,scidac_csuma,scidac_csumb);
+  pass = pass && (req.nersc_csum == nersc_csum) && (req.scidac_csuma == scidac_csuma)
+              && (req.scidac_csumb == scidac_csumb);
+  Umu_read = Umu_read - Umu_saved;
+  std::cout << GridLogMessage << "norm2 Gauge Diff = " << norm2(Umu_read) << std::endl;
+  pass = pass && (norm2(Umu_read) == 0.);
+
+  std::cout << GridLogMessage << "Asynchronous writes " << (pass ? "agree" : "DIFFER") 
+	    << " with the synchronous ones" << std::endl;
+  assert(pass);
+
+  Grid_finalize();
+}
@@ -0,0 +1,177 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./tests/IO/Test_checkpoint_manager.cc
+
+    Copyright (C) 2015
+
+Author: Peter Boyle <paboyle@ph.ed.ac.uk>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// A stream of checkpoints with the last two kept: trajectories with an
+// unchanged configuration share its file, older files are removed, and the
+// index restores the stream whichever checkpointer wrote it.
+static bool exists(const std::string &file)
+{
+  std::ifstream f(file);
+  return f.good();
+}
+
+template<class Checkpointer>
+void stream(GridCartesian &grid,bool async)
+{
+  std::string prefix = async ? "./ckpoint_managed_async" : "./ckpoint_managed";
+  std::remove((prefix+".index").c_str());
+
+  GridSerialRNG   sRNG;
+  GridParallelRNG pRNG(&grid);
+  sRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+  pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+
+  LatticeGaugeField U(&grid), Ucopy(&grid);
+  SU3::HotConfiguration(pRNG,U);
+
+  CheckpointerParameters Params(prefix,prefix+"_rng",1,"IEEE64BIG",async);
+  Params.options.keep_last = 2;
+  {
+    Checkpointer Ckpt(Params);
+    Ckpt.TrajectoryComplete(1,U,sRNG,pRNG);
+    Ckpt.TrajectoryComplete(2,U,sRNG,pRNG);   // nothing changed
+    SU3::HotConfiguration(pRNG,U);
+    Ckpt.TrajectoryComplete(3,U,sRNG,pRNG);
+    Ucopy = U;
+    LatticeGaugeField P(&grid);
+    gaussian(pRNG,P);
+    Ckpt.TrajectoryComplete(4,U,sRNG,pRNG);   // rejected: same links, RNG moved on
+  }
+  grid.Barrier();
+
+  // 3 and 4 kept, sharing the configuration of 3; 1 and 2 removed
+  assert(!exists(prefix+".1")      && !exists(prefix+"_rng.1"));
+  assert(!exists(prefix+".2")      && !exists(prefix+"_rng.2"));
+  assert( exists(prefix+".3")      &&  exists(prefix+"_rng.3"));
+  assert(!exists(prefix+".4")      &&  exists(prefix+"_rng.4"));
+  assert(!exists(prefix+".3.tmp")  && !exists(prefix+".index.tmp"));
+
+  CheckpointIndex index;
+  {
+    XmlReader RD(prefix+".index");
+    read(RD,"CheckpointIndex",index);
+  }
+  std::cout << GridLogMessage << index << std::endl;
+  assert(index.checkpoints.size() == 2);
+  assert(index.checkpoints[1].traj   == 4);
+  assert(index.checkpoints[1].config == prefix+".3");
+  assert(index.checkpoints[1].rng    == prefix+"_rng.4");
+
+  // restart from the index
+  GridSerialRNG   sRNGr;
+  GridParallelRNG pRNGr(&grid);
+  LatticeGaugeField Ur(&grid);
+  Checkpointer Restart(Params);
+  Restart.CheckpointRestore(4,Ur,sRNGr,pRNGr);
+
+  LatticeGaugeField diff(&grid);
+  diff = Ur - Ucopy;
+  RealD err = std::sqrt(norm2(diff)/norm2(Ucopy));
+  LatticeComplex r(&grid), rr(&grid);
+  gaussian(pRNG,r);
+  gaussian(pRNGr,rr);
+  std::cout << GridLogMessage << "Restored configuration relative error " << err
+	    << ", RNG streams " << norm2(r) << " " << norm2(rr) << std::endl;
+  assert(err < 1.0e-6);
+  assert(norm2(r) == norm2(rr));
+}
+
+// A <Checkpointer> block with only the original four parameters (written
+// before the options existed) reads with the default options, through the
+// reader constructor and through read() as the HMC checkpointer modules do.
+static void legacyParameters(GridCartesian &grid)
+{
+  std::string file = "./ckpoint_legacy_par.xml";
+
+  if (grid.IsBoss()) {
+    XmlWriter WR(file);
+    push(WR,"Checkpointer");
+    write(WR,"config_prefix",std::string("ckpoint_lat"));
+    write(WR,"rng_prefix",std::string("ckpoint_rng"));
+    write(WR,"saveInterval",5);
+    write(WR,"format",std::string("IEEE64BIG"));
+    pop(WR);
+  }
+  grid.Barrier();
+
+  CheckpointerOptions    Default;
+  CheckpointerParameters Legacy, Module;
+  {
+    XmlReader RD(file);
+    Legacy = CheckpointerParameters(RD);
+  }
+  {
+    XmlReader RD(file);
+    read(RD,"Checkpointer",Module);
+  }
+  std::cout << GridLogMessage << Legacy << std::endl;
+  for (auto P: {Legacy, Module}) {
+    assert(P.config_prefix == "ckpoint_lat");
+    assert(P.rng_prefix    == "ckpoint_rng");
+    assert(P.saveInterval  == 5);
+    assert(P.options       == Default);
+  }
+
+  // the options round trip
+  CheckpointerParameters Params("ckpoint_lat","ckpoint_rng",5,"IEEE64BIG",
+                                true,4,"striping_factor=4",8,false,3), Read;
+  if (grid.IsBoss()) {
+    XmlWriter WR(file);
+    write(WR,"Checkpointer",Params);
+  }
+  grid.Barrier();
+  {
+    XmlReader RD(file);
+    Read = CheckpointerParameters(RD);
+  }
+  assert(Read == Params);
+  grid.Barrier();
+  if (grid.IsBoss()) std::remove(file.c_str());
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  std::vector<int> simd_layout = GridDefaultSimd(Nd,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+  std::vector<int> latt_size   = GridDefaultLatt();
+  GridCartesian    Fine(latt_size,simd_layout,mpi_layout);
+
+  typedef PeriodicGimplR Gimpl;
+  legacyParameters(Fine);
+  stream<CompactHmcCheckpointer<Gimpl> >(Fine,false);
+  stream<BinaryHmcCheckpointer<Gimpl> >(Fine,true);
+
+  Grid_finalize();
+}
@@ -0,0 +1,132 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./tests/IO/Test_compact_io.cc
+
+    Copyright (C) 2015
+
+Author: Peter Boyle <paboyle@ph.ed.ac.uk>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// Compact configurations in all formats are written on one decomposition and
+// read back on another; the links must agree with the original to the
+// precision of the format and be unitary. The RNG state read back must
+// continue the same streams.
+static uint64_t fileSize(const std::string &file)
+{
+  std::ifstream f(file, std::ios::binary|std::ios::ate);
+  return f.tellg();
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  std::vector<int> simd_layout = GridDefaultSimd(Nd,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+  std::vector<int> latt_size   = GridDefaultLatt();
+
+  // the reader runs on the processor grid reversed
+  std::vector<int> mpi_read(mpi_layout.rbegin(),mpi_layout.rend());
+  for(int d=0;d<Nd;d++) if ( latt_size[d] % (mpi_read[d]*simd_layout[d]) ) mpi_read = mpi_layout;
+
+  GridCartesian     Fine(latt_size,simd_layout,mpi_layout);
+  GridCartesian     Other(latt_size,simd_layout,mpi_read);
+  GridParallelRNG   pRNG(&Fine), pRNGo(&Other);
+  pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+  pRNGo.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+
+  // the parallel RNG is decomposition independent
+  LatticeGaugeField Umu(&Fine), Uref(&Other), Uread(&Other);
+  SU3::HotConfiguration(pRNG,Umu);
+  SU3::HotConfiguration(pRNGo,Uref);
+
+  std::string formats[] = {"IEEE64BIG","IEEE32BIG"};
+  int reconstructs[] = {12,8};
+  bool compress[] = {false,true};
+
+  for(auto format: formats){
+  for(auto reconstruct: reconstructs){
+  for(auto comp: compress){
+    std::string file("./ckpoint_compact");
+    std::cout << GridLogMessage << "Compact configuration " << format << " reconstruct " << reconstruct
+	      << (comp ? " byte-plane compressed" : " uncompressed") << std::endl;
+
+    CompactIO::writeConfiguration(Umu,file,reconstruct,comp,format);
+    uint64_t bytes = fileSize(file);
+
+    FieldMetaData header;
+    CompactIO::readConfiguration(Uread,header,file);
+
+    LatticeGaugeField diff(&Other);
+    diff = Uread - Uref;
+    RealD err = std::sqrt(norm2(diff)/norm2(Uref));
+
+    LatticeColourMatrix U(&Other), UU(&Other);
+    RealD unit = 0.0;
+    for(int mu=0;mu<Nd;mu++){
+      U  = PeekIndex<LorentzIndex>(Uread,mu);
+      UU = U*adj(U) - 1.0;
+      unit += norm2(UU);
+    }
+    unit = std::sqrt(unit/(Nd*Other.gSites()));
+
+    std::cout << GridLogMessage << "  " << bytes << " bytes, relative error " << err
+	      << ", unitarity violation " << unit << std::endl;
+
+    RealD tol = (format == std::string("IEEE64BIG")) ? 1.0e-12 : 1.0e-6;
+    assert(err  < tol);
+    assert(unit < tol);
+  }}}
+
+  // some sites drawn more often than others
+  GridSerialRNG sRNG, sRNGr;
+  GridParallelRNG pRNGr(&Other);
+  sRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+  for(int gsite=0;gsite<Fine.gSites();gsite+=7) pRNG.GlobalU01(gsite);
+
+  CompactIO::writeRNGState(sRNG,pRNG,"./ckpoint_compact.rng");
+  FieldMetaData header;
+  CompactIO::readRNGState(sRNGr,pRNGr,header,"./ckpoint_compact.rng");
+  if ( Fine.IsBoss() ) { std::ofstream f("./ckpoint_binary.rng"); }
+  uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+  BinaryIO::writeRNG(sRNG,pRNG,"./ckpoint_binary.rng",0,nersc_csum,scidac_csuma,scidac_csumb);
+  std::cout << GridLogMessage << "RNG state " << fileSize("./ckpoint_compact.rng") << " bytes, binary "
+	    << fileSize("./ckpoint_binary.rng") << " bytes" << std::endl;
+
+  for(int gsite=0;gsite<Fine.gSites();gsite+=3){
+    assert(pRNG.GlobalU01(gsite) == pRNGr.GlobalU01(gsite));
+  }
+  LatticeComplex r(&Fine), rr(&Other);
+  ComplexD s, sr;
+  gaussian(pRNG,r);  random(sRNG,s);
+  gaussian(pRNGr,rr); random(sRNGr,sr);
+  std::cout << GridLogMessage << "RNG streams " << norm2(r) << " " << norm2(rr) << std::endl;
+  assert(fabs(norm2(r)-norm2(rr)) < 1.0e-10*norm2(r));
+  assert(s == sr);
+
+  Grid_finalize();
+}
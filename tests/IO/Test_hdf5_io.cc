@@ -0,0 +1,122 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid 
+
+    Source file: ./tests/IO/Test_hdf5_io.cc
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+#ifdef HAVE_HDF5
+  std::vector<int> simd_layout = GridDefaultSimd(4,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+  std::vector<int> latt_size   = GridDefaultLatt();
+
+  GridCartesian     Fine(latt_size,simd_layout,mpi_layout);
+  GridCartesian     FineF(latt_size,GridDefaultSimd(4,vComplexF::Nsimd()),mpi_layout);
+  GridParallelRNG   pRNG(&Fine);
+
+  pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+
+  typedef LatticeGaugeField::vector_object vobj;
+  typedef vobj::scalar_object sobj;
+  typedef sobj::DoublePrecision sobj_double;
+
+  const int nVec = 4;
+  LatticeGaugeField Umu(&Fine), Umu_read(&Fine);
+  LatticeGaugeFieldF UmuF(&FineF);
+  std::vector<LatticeFermion> vec(nVec, &Fine), vec_read(nVec, &Fine);
+  bool pass = true;
+
+  SU3::HotConfiguration(pRNG,Umu);
+  for (int i = 0; i < nVec; i++) gaussian(pRNG,vec[i]);
+
+  // several fields in one file, one dataset each
+  {
+    GridStopWatch timer;
+    Hdf5FieldWriter writer(&Fine, "./ckpoint_fields.h5");
+
+    timer.Start();
+    writer.writeField("gauge", Umu);
+    writer.writeField("evec/v", vec);
+    timer.Stop();
+    std::cout << GridLogMessage << "HDF5 write: " << timer.Elapsed() << std::endl;
+  }
+  {
+    Hdf5FieldReader reader(&Fine, "./ckpoint_fields.h5");
+
+    reader.readField("gauge", Umu_read);
+    reader.readField("evec/v", vec_read);
+    Umu_read = Umu_read - Umu;
+    std::cout << GridLogMessage << "norm2 Gauge Diff = " << norm2(Umu_read) << std::endl;
+    pass = pass && (norm2(Umu_read) == 0.);
+    for (int i = 0; i < nVec; i++) {
+      vec_read[i] = vec_read[i] - vec[i];
+      pass = pass && (norm2(vec_read[i]) == 0.);
+    }
+    // precision converted by the reader
+    LatticeGaugeField Umu_conv(&Fine);
+
+    reader.readField("gauge", UmuF);
+    precisionChange(Umu_conv, UmuF);
+    Umu_conv = Umu_conv - Umu;
+    std::cout << GridLogMessage << "norm2 Gauge Diff (single) = " << norm2(Umu_conv)/norm2(Umu) << std::endl;
+    pass = pass && (norm2(Umu_conv)/norm2(Umu) < 1.0e-12);
+  }
+
+  // compressed datasets
+  {
+    Hdf5FieldWriter writer(&Fine, "./ckpoint_deflate.h5", 4);
+    Hdf5FieldReader reader(&Fine, "./ckpoint_deflate.h5");
+
+    writer.writeField("gauge", Umu);
+    reader.readField("gauge", Umu_read);
+    Umu_read = Umu_read - Umu;
+    pass = pass && (norm2(Umu_read) == 0.);
+  }
+
+  // binary lattice payload (as in ILDG/NERSC files) for comparison
+  {
+    BinarySimpleUnmunger<sobj_double, sobj> unmunge;
+    uint32_t nersc_csum, scidac_csuma, scidac_csumb;
+    GridStopWatch timer;
+
+    if (Fine.IsBoss()) std::ofstream("./ckpoint_fields.bin", std::ios::out);
+    Fine.Barrier();
+    timer.Start();
+    BinaryIO::writeLatticeObject<vobj,sobj_double>(Umu,"./ckpoint_fields.bin",unmunge,0,"IEEE64BIG",
+						   nersc_csum,scidac_csuma,scidac_csumb);
+    timer.Stop();
+    std::cout << GridLogMessage << "Binary gauge write: " << timer.Elapsed() << std::endl;
+  }
+
+  std::cout << GridLogMessage << "HDF5 fields " << (pass ? "agree" : "DIFFER") << std::endl;
+  assert(pass);
+#endif
+  Grid_finalize();
+}
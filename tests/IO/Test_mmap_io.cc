@@ -0,0 +1,98 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./tests/IO/Test_mmap_io.cc
+
+    Copyright (C) 2015
+
+Author: Peter Boyle <paboyle@ph.ed.ac.uk>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// The memory-mapped read (--io-mmap) must give the same field and checksums
+// as the IOobject read, in both byte orders and precisions, and with a data
+// offset which is not a multiple of the page size.
+template<class sobj_io>
+static bool compare(GridCartesian &grid, LatticeGaugeField &Umu,
+                    const std::string &format, uint64_t offset)
+{
+  typedef LatticeGaugeField::vector_object vobj;
+  typedef vobj::scalar_object sobj;
+
+  std::string file("./ckpoint_mmap.bin");
+  LatticeGaugeField Uio(&grid), Ummap(&grid);
+  BinarySimpleUnmunger<sobj_io, sobj> unmunge;
+  BinarySimpleMunger<sobj_io, sobj>   munge;
+  uint32_t w[3], io[3], mm[3];
+
+  if (grid.IsBoss()) {
+    std::ofstream fout(file, std::ios::out);
+  }
+  grid.Barrier();
+  BinaryIO::writeLatticeObject<vobj,sobj_io>(Umu,file,unmunge,offset,format,w[0],w[1],w[2]);
+
+  BinaryIO::mmapRead() = false;
+  BinaryIO::readLatticeObject<vobj,sobj_io>(Uio,file,munge,offset,format,io[0],io[1],io[2]);
+  BinaryIO::mmapRead() = true;
+  BinaryIO::readLatticeObject<vobj,sobj_io>(Ummap,file,munge,offset,format,mm[0],mm[1],mm[2]);
+  BinaryIO::mmapRead() = false;
+
+  Ummap = Ummap - Uio;
+  bool pass = (norm2(Ummap) == 0.);
+  for (int i = 0; i < 3; i++) pass = pass && (mm[i] == io[i]) && (io[i] == w[i]);
+
+  std::cout << GridLogMessage << format << " offset " << offset << ": norm2 diff = "
+	    << norm2(Ummap) << ", checksums " << std::hex << mm[0] << " " << mm[1] << " "
+	    << mm[2] << std::dec << (pass ? " agree" : " DIFFER") << std::endl;
+  grid.Barrier();
+  if (grid.IsBoss()) std::remove(file.c_str());
+
+  return pass;
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  std::vector<int> simd_layout = GridDefaultSimd(4,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+  std::vector<int> latt_size   = GridDefaultLatt();
+
+  GridCartesian     Fine(latt_size,simd_layout,mpi_layout);
+  GridParallelRNG   pRNG(&Fine);
+
+  pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+
+  LatticeGaugeField Umu(&Fine);
+  bool pass = true;
+
+  SU3::HotConfiguration(pRNG,Umu);
+  pass = pass && compare<LorentzColourMatrixD>(Fine,Umu,"IEEE64BIG",0);
+  pass = pass && compare<LorentzColourMatrixD>(Fine,Umu,"IEEE64",4133);
+  pass = pass && compare<LorentzColourMatrixF>(Fine,Umu,"IEEE32BIG",517);
+  assert(pass);
+
+  Grid_finalize();
+}
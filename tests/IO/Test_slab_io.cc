@@ -0,0 +1,208 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./tests/IO/Test_slab_io.cc
+
+    Copyright (C) 2015
+
+Author: Peter Boyle <paboyle@ph.ed.ac.uk>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// Hyperslab reads: a timeslice and a sub-box of a stored field, read with the
+// BinaryIO, Lime and Scidac slab readers, must equal the same region of a full
+// read. The sub-box starts at odd coordinates, so its sites cross the domains
+// of the ranks which wrote the field.
+
+// same region of a full field, site by site
+static void extractSlab(LatticeGaugeField &slab, LatticeGaugeField &full,
+			const std::vector<int> &start)
+{
+  GridBase *grid = slab._grid;
+  std::vector<int> coor, fcoor(grid->_ndimension);
+  LorentzColourMatrix s;
+
+  for(int site=0;site<grid->gSites();site++){
+    Lexicographic::CoorFromIndex(coor,site,grid->_fdimensions);
+    for(int d=0;d<grid->_ndimension;d++) fcoor[d] = coor[d] + start[d];
+    peekSite(s,full,fcoor);
+    pokeSite(s,slab,coor);
+  }
+}
+
+static bool check(const std::string &name, LatticeGaugeField &slab,
+		  LatticeGaugeField &ref)
+{
+  LatticeGaugeField diff(slab._grid);
+
+  diff = slab - ref;
+  RealD n = norm2(diff);
+  std::cout << GridLogMessage << name << ": norm2 diff = " << n << std::endl;
+
+  return (n == 0.);
+}
+
+// timeslice grid: no SIMD lane nor process in time, the time processes are
+// folded into the first space direction which can take them
+static GridCartesian *timesliceGrid(const std::vector<int> &latt,
+				    const std::vector<int> &mpi)
+{
+  std::vector<int> tLatt(latt), tSimd, tMpi(mpi);
+
+  tSimd = GridDefaultSimd(Nd-1,vComplex::Nsimd());
+  tSimd.push_back(1);
+  tLatt[Nd-1] = 1;
+  tMpi[Nd-1]  = 1;
+  for(int d=0;d<Nd-1;d++){
+    if (latt[d] % (mpi[d]*mpi[Nd-1]*tSimd[d]) == 0) {
+      tMpi[d] *= mpi[Nd-1];
+      return new GridCartesian(tLatt,tSimd,tMpi);
+    }
+  }
+  std::cout << GridLogError << "no timeslice decomposition for this lattice" << std::endl;
+  assert(0);
+
+  return nullptr;
+}
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  std::vector<int> simd_layout = GridDefaultSimd(Nd,vComplex::Nsimd());
+  std::vector<int> mpi_layout  = GridDefaultMpi();
+  std::vector<int> latt_size   = GridDefaultLatt();
+  std::vector<int> box_size(Nd), box_start(Nd), ts_start(Nd, 0);
+
+  // sub-box of half the lattice, starting at odd coordinates
+  for(int d=0;d<Nd;d++){
+    box_size[d]  = latt_size[d]/2;
+    box_start[d] = 1 + (d % 2);
+    assert(box_size[d] % (mpi_layout[d]*simd_layout[d]) == 0);
+  }
+  ts_start[Nd-1] = latt_size[Nd-1] - 1;
+
+  GridCartesian     Fine(latt_size,simd_layout,mpi_layout);
+  GridCartesian     Box(box_size,simd_layout,mpi_layout);
+  GridCartesian    *Timeslice = timesliceGrid(latt_size,mpi_layout);
+  GridParallelRNG   pRNG(&Fine);
+
+  pRNG.SeedFixedIntegers(std::vector<int>({45,12,81,9}));
+
+  typedef LatticeGaugeField::vector_object vobj;
+  typedef vobj::scalar_object sobj;
+
+  LatticeGaugeField Umu(&Fine), Ufull(&Fine);
+  LatticeGaugeField Ubox(&Box), Ubox_ref(&Box);
+  LatticeGaugeField Uts(Timeslice), Uts_ref(Timeslice);
+  std::string format("IEEE64BIG"), file("./ckpoint_slab.bin");
+  uint64_t offset = 0;
+  uint32_t nersc, scidaca, scidacb, full[3];
+  bool pass = true;
+
+  SU3::HotConfiguration(pRNG,Umu);
+
+  extractSlab(Ubox_ref,Umu,box_start);
+  extractSlab(Uts_ref,Umu,ts_start);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // BinaryIO
+  //////////////////////////////////////////////////////////////////////////////
+  {
+    BinarySimpleUnmunger<sobj, sobj> unmunge;
+    BinarySimpleMunger<sobj, sobj>   munge;
+
+    if (Fine.IsBoss()) {
+      std::ofstream fout(file, std::ios::out);
+    }
+    Fine.Barrier();
+    BinaryIO::writeLatticeObject<vobj,sobj>(Umu,file,unmunge,offset,format,nersc,scidaca,scidacb);
+    BinaryIO::readLatticeObject<vobj,sobj>(Ufull,file,munge,offset,format,full[0],full[1],full[2]);
+    pass = check("BinaryIO full read",Ufull,Umu) && pass;
+
+    // the whole field through the slab reader gives the file checksums
+    BinaryIO::readLatticeObjectSlab<vobj,sobj>(Umu,file,munge,offset,format,latt_size,
+					       std::vector<int>(Nd,0),nersc,scidaca,scidacb);
+    pass = check("BinaryIO whole slab",Umu,Ufull) && pass;
+    pass = pass && (nersc == full[0]) && (scidaca == full[1]) && (scidacb == full[2]);
+
+    BinaryIO::readLatticeObjectSlab<vobj,sobj>(Uts,file,munge,offset,format,latt_size,
+					       ts_start,nersc,scidaca,scidacb);
+    pass = check("BinaryIO timeslice",Uts,Uts_ref) && pass;
+    BinaryIO::readLatticeObjectSlab<vobj,sobj>(Ubox,file,munge,offset,format,latt_size,
+					       box_start,nersc,scidaca,scidacb);
+    pass = check("BinaryIO sub-box",Ubox,Ubox_ref) && pass;
+    Fine.Barrier();
+    if (Fine.IsBoss()) std::remove(file.c_str());
+  }
+
+#ifdef HAVE_LIME
+  //////////////////////////////////////////////////////////////////////////////
+  // Lime and Scidac
+  //////////////////////////////////////////////////////////////////////////////
+  {
+    std::string     sfile("./ckpoint_slab.scidac");
+    emptyUserRecord record;
+
+    ScidacWriter _ScidacWriter;
+    _ScidacWriter.open(sfile);
+    _ScidacWriter.writeScidacFieldRecord(Umu,record);
+    _ScidacWriter.close();
+
+    ScidacReader _ScidacReader;
+    _ScidacReader.open(sfile);
+    _ScidacReader.readScidacFieldRecord(Ufull,record);
+    _ScidacReader.close();
+    pass = check("Scidac full read",Ufull,Umu) && pass;
+
+    GridLimeReader _LimeReader;
+    _LimeReader.open(sfile);
+    _LimeReader.readLimeLatticeBinaryObjectSlab(Uts,std::string(ILDG_BINARY_DATA),
+						latt_size,ts_start);
+    _LimeReader.close();
+    pass = check("Lime timeslice",Uts,Uts_ref) && pass;
+    _LimeReader.open(sfile);
+    _LimeReader.readLimeLatticeBinaryObjectSlab(Ubox,std::string(ILDG_BINARY_DATA),
+						latt_size,box_start);
+    _LimeReader.close();
+    pass = check("Lime sub-box",Ubox,Ubox_ref) && pass;
+
+    _ScidacReader.open(sfile);
+    _ScidacReader.readScidacFieldSlab(Uts,record,ts_start);
+    _ScidacReader.close();
+    pass = check("Scidac timeslice",Uts,Uts_ref) && pass;
+    _ScidacReader.open(sfile);
+    _ScidacReader.readScidacFieldSlab(Ubox,record,box_start);
+    _ScidacReader.close();
+    pass = check("Scidac sub-box",Ubox,Ubox_ref) && pass;
+    Fine.Barrier();
+    if (Fine.IsBoss()) std::remove(sfile.c_str());
+  }
+#endif
+  assert(pass);
+  delete Timeslice;
+
+  Grid_finalize();
+}
@@ -0,0 +1,137 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid 
+
+    Source file: ./tests/forces/Test_dwf_force_chrono.cc
+
+    Copyright (C) 2015
+
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+// Force solves along a sequence of gauge fields, with and without
+// chronological forecasting; the forces must agree to solver tolerance.
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  const int Ls=8;
+
+  GridCartesian         * UGrid   = SpaceTimeGrid::makeFourDimGrid(GridDefaultLatt(), GridDefaultSimd(Nd,vComplex::Nsimd()),GridDefaultMpi());
+  GridRedBlackCartesian * UrbGrid = SpaceTimeGrid::makeFourDimRedBlackGrid(UGrid);
+  GridCartesian         * FGrid   = SpaceTimeGrid::makeFiveDimGrid(Ls,UGrid);
+  GridRedBlackCartesian * FrbGrid = SpaceTimeGrid::makeFiveDimRedBlackGrid(Ls,UGrid);
+
+  std::vector<int> seeds({1,2,3,4});
+  GridParallelRNG RNG4(UGrid);  RNG4.SeedFixedIntegers(seeds);
+
+  LatticeGaugeField U(UGrid);
+  SU3::HotConfiguration(RNG4,U);
+
+  RealD mass=0.1;
+  RealD M5  =1.8;
+  DomainWallFermionR Ddwf(U,*FGrid,*FrbGrid,*UGrid,*UrbGrid,mass,M5);
+  ConjugateGradient<LatticeFermion> CG(1.0e-10,10000);
+
+  TwoFlavourEvenOddPseudoFermionAction<WilsonImplR> Cold (Ddwf,CG,CG);
+  TwoFlavourEvenOddPseudoFermionAction<WilsonImplR> Chrono(Ddwf,CG,CG);
+  Chrono.EnableChronoForecast(4);
+
+  // Same pseudofermion for both
+  GridParallelRNG RNG5a(FGrid);  RNG5a.SeedFixedIntegers(seeds);
+  GridParallelRNG RNG5b(FGrid);  RNG5b.SeedFixedIntegers(seeds);
+  Cold.refresh(U,RNG5a);
+  Chrono.refresh(U,RNG5b);
+
+  LatticeGaugeField mom(UGrid);
+  LatticeGaugeField dSdU_cold(UGrid);
+  LatticeGaugeField dSdU_chrono(UGrid);
+  LatticeGaugeField diff(UGrid);
+  LatticeColourMatrix mommu(UGrid);
+  LatticeColourMatrix Umu(UGrid);
+
+  for(int mu=0;mu<Nd;mu++){
+    SU3::GaussianFundamentalLieAlgebraMatrix(RNG4, mommu);
+    PokeIndex<LorentzIndex>(mom,mommu,mu);
+  }
+
+  RealD dt = 0.02;
+  for(int step=0;step<8;step++){
+
+    Cold.deriv(U,dSdU_cold);
+    Chrono.deriv(U,dSdU_chrono);
+
+    diff = dSdU_cold - dSdU_chrono;
+    RealD err = std::sqrt(norm2(diff)/norm2(dSdU_cold));
+    std::cout << GridLogMessage << "step "<<step<<" |dSdU_cold - dSdU_chrono|/|dSdU_cold| = "<< err <<std::endl;
+    assert(err < 1.0e-6);
+
+    // First order step of the gauge field; unitarity is irrelevant here
+    for(int mu=0;mu<Nd;mu++){
+      Umu   = PeekIndex<LorentzIndex>(U,mu);
+      mommu = PeekIndex<LorentzIndex>(mom,mu);
+      Umu   = Umu + dt*mommu*Umu;
+      PokeIndex<LorentzIndex>(U,Umu,mu);
+    }
+  }
+
+  // Trajectory boundary; reports the saving
+  Chrono.S(U);
+
+  // EOFA, forecasting in the red-black space of its Schur solves
+  RealD mf = 0.1;
+  RealD mb = 1.0;
+  DomainWallEOFAFermionR Lop(U,*FGrid,*FrbGrid,*UGrid,*UrbGrid,mf,mf,mb,0.0,-1,M5);
+  DomainWallEOFAFermionR Rop(U,*FGrid,*FrbGrid,*UGrid,*UrbGrid,mb,mf,mb,-1.0,1,M5);
+  OneFlavourRationalParams Params(0.95,100.0,5000,1.0e-12,12);
+  ExactOneFlavourRatioPseudoFermionAction<WilsonImplR> EofaCold  (Lop,Rop,CG,Params);
+  ExactOneFlavourRatioPseudoFermionAction<WilsonImplR> EofaChrono(Lop,Rop,CG,Params);
+  EofaChrono.EnableChronoForecast(4);
+
+  RNG5a.SeedFixedIntegers(seeds);
+  RNG5b.SeedFixedIntegers(seeds);
+  EofaCold.refresh(U,RNG5a);
+  EofaChrono.refresh(U,RNG5b);
+
+  for(int step=0;step<4;step++){
+
+    EofaCold.deriv(U,dSdU_cold);
+    EofaChrono.deriv(U,dSdU_chrono);
+
+    diff = dSdU_cold - dSdU_chrono;
+    RealD err = std::sqrt(norm2(diff)/norm2(dSdU_cold));
+    std::cout << GridLogMessage << "EOFA step "<<step<<" |dSdU_cold - dSdU_chrono|/|dSdU_cold| = "<< err <<std::endl;
+    assert(err < 1.0e-6);
+
+    for(int mu=0;mu<Nd;mu++){
+      Umu   = PeekIndex<LorentzIndex>(U,mu);
+      mommu = PeekIndex<LorentzIndex>(mom,mu);
+      Umu   = Umu + dt*mommu*Umu;
+      PokeIndex<LorentzIndex>(U,Umu,mu);
+    }
+  }
+  EofaChrono.S(U);
+
+  Grid_finalize();
+}
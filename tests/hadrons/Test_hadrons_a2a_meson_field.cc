@@ -0,0 +1,133 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_a2a_meson_field.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+/*******************************************************************************
+ * Compare the meson fields of MContraction::A2AMesonField with a direct 
+ * computation, one gamma, momentum and vector pair at a time. The block sizes
+ * do not divide the numbers of vectors, to check the partial tiles. The 
+ * modules are run by hand so that the vectors are still in the environment.
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    // run setup ///////////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    // vectors
+    MUtilities::RandomVectors::Par vecPar;
+    vecPar.size = 7;
+    application.createModule<MUtilities::RandomVectors>("w", vecPar);
+    vecPar.size = 5;
+    application.createModule<MUtilities::RandomVectors>("v", vecPar);
+    // meson fields
+    MContraction::A2AMesonField::Par mfPar;
+    mfPar.left       = "w";
+    mfPar.right      = "v";
+    mfPar.gammas     = "all";
+    mfPar.mom        = {"0 0 0", "1 0 0", "-1 2 1"};
+    mfPar.block      = 3;
+    mfPar.cacheBlock = 2;
+    mfPar.output     = "a2a_mf";
+    application.createModule<MContraction::A2AMesonField>("mf", mfPar);
+
+    // execution ///////////////////////////////////////////////////////////////
+    auto &vm  = VirtualMachine::getInstance();
+    auto &env = Environment::getInstance();
+
+    vm.setTrajectory(0);
+    for (auto &m: {"w", "v", "mf"})
+    {
+        (*vm.getModule(m))();
+    }
+
+    // comparison //////////////////////////////////////////////////////////////
+    typedef std::vector<LatticeFermion> Vectors;
+
+    auto                  &w  = *env.getObject<Vectors>("w");
+    auto                  &v  = *env.getObject<Vectors>("v");
+    unsigned int          ni  = w.size(), nj = v.size(), nt = env.getDim(Tp);
+    unsigned int          nGamma = Gamma::nGamma/2, nMom = mfPar.mom.size();
+    std::vector<ComplexD> mf(nMom*nGamma*nt*ni*nj);
+    std::ifstream         file("a2a_mf.0.bin", std::ios::binary);
+    LatticeComplex        ph(env.getGrid()), coor(env.getGrid());
+    LatticeComplex        c(env.getGrid());
+    LatticeFermion        gv(env.getGrid());
+    std::vector<TComplex> buf;
+    Complex               i(0.0, 1.0);
+    RealD                 diff = 0., norm = 0.;
+
+    file.read(reinterpret_cast<char *>(mf.data()), mf.size()*sizeof(ComplexD));
+    assert(file.good());
+    for (unsigned int p = 0; p < nMom; ++p)
+    {
+        std::vector<Real> mom = strToVec<Real>(mfPar.mom[p]);
+
+        ph = zero;
+        for (unsigned int mu = 0; mu < mom.size(); ++mu)
+        {
+            LatticeCoordinate(coor, mu);
+            ph = ph + (mom[mu]/env.getGrid()->_fdimensions[mu])*coor;
+        }
+        ph = exp((Real)(2*M_PI)*i*ph);
+        for (unsigned int g = 0; g < nGamma; ++g)
+        for (unsigned int b = 0; b < nj; ++b)
+        {
+            gv = Gamma(static_cast<Gamma::Algebra>(2*g + 1))*v[b];
+            for (unsigned int a = 0; a < ni; ++a)
+            {
+                c = ph*localInnerProduct(w[a], gv);
+                sliceSum(c, buf, Tp);
+                for (unsigned int t = 0; t < nt; ++t)
+                {
+                    ComplexD ref = TensorRemove(buf[t]);
+                    ComplexD res = mf[(((p*nGamma + g)*nt + t)*ni + a)*nj + b];
+
+                    diff += std::norm(res - ref);
+                    norm += std::norm(ref);
+                }
+            }
+        }
+    }
+
+    RealD rel = std::sqrt(diff/norm);
+
+    LOG(Message) << "Relative difference with the direct computation: " << rel
+                 << std::endl;
+    assert(rel < 1.0e-12);
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_baryon.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+typedef MContraction::TBaryon<FIMPL, FIMPL, FIMPL>::Result BaryonResult;
+
+/*******************************************************************************
+ * Compare MContraction::Baryon with a direct sum over all the colour, spin
+ * and Wick contraction indices, site by site, for the flavour structures
+ * lll, llh, lhl and hll. The modules are run by hand so that the
+ * propagators are still in the environment afterwards.
+ ******************************************************************************/
+static std::vector<SpinMatrix>
+naiveBaryon(const std::vector<LatticePropagator *> &q,
+            const std::vector<std::string> &name,
+            const MContraction::GammaPair &gp, GridBase *grid)
+{
+    static const int eps[6][3]  = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1},
+                                   {0, 2, 1}, {2, 1, 0}, {1, 0, 2}};
+    static const int epsSign[6] = {1, 1, 1, -1, -1, -1};
+
+    int                                        nt = grid->_fdimensions[Tp];
+    int                                        ld = grid->_ldimensions[Tp];
+    std::vector<ComplexD>                      c(nt*Ns*Ns, 0.);
+    std::vector<std::vector<SpinColourMatrix>> s(3);
+    SpinMatrix                                 id, g, gBar;
+    Gamma                                      gT(Gamma::Algebra::GammaT);
+    Gamma                                      gC = Gamma(Gamma::Algebra::GammaY)*gT;
+    std::vector<int>                           coor;
+
+    id = zero;
+    for (unsigned int a = 0; a < Ns; ++a)
+    {
+        id()(a, a)() = 1.;
+    }
+    g    = gC*(Gamma(gp.first)*id);
+    gBar = gT*adj(gC*(Gamma(gp.second)*id))*gT;
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+        unvectorizeToLexOrdArray(s[k], *q[k]);
+    }
+    for (unsigned int x = 0; x < s[0].size(); ++x)
+    {
+        Lexicographic::CoorFromIndex(coor, x, grid->_ldimensions);
+
+        int t = coor[Tp] + grid->_processor_coor[Tp]*ld;
+
+        // source permutations pi, sink quark k contracted with source quark
+        // pi[k], weighted by the parity of pi
+        for (unsigned int pi = 0; pi < 6; ++pi)
+        {
+            const int *p = eps[pi];
+
+            if ((name[0] != name[p[0]]) or (name[1] != name[p[1]])
+                or (name[2] != name[p[2]]))
+            {
+                continue;
+            }
+            for (unsigned int e1 = 0; e1 < 6; ++e1)
+            for (unsigned int e2 = 0; e2 < 6; ++e2)
+            for (int r = 0; r < Ns; ++r)
+            for (int sg = 0; sg < Ns; ++sg)
+            for (int rp = 0; rp < Ns; ++rp)
+            for (int sp = 0; sp < Ns; ++sp)
+            {
+                ComplexD w = g()(r, sg)()*gBar()(sp, rp)()
+                             *(double)(epsSign[pi]*epsSign[e1]*epsSign[e2]);
+
+                if (std::abs(w) == 0.)
+                {
+                    continue;
+                }
+                for (int al = 0; al < Ns; ++al)
+                for (int alp = 0; alp < Ns; ++alp)
+                {
+                    int      sinkS[3] = {r, sg, al}, srcS[3] = {rp, sp, alp};
+                    ComplexD prod     = w;
+
+                    for (unsigned int k = 0; k < 3; ++k)
+                    {
+                        prod *= s[k][x]()(sinkS[k], srcS[p[k]])(eps[e1][k],
+                                                                eps[e2][p[k]]);
+                    }
+                    c[(t*Ns + al)*Ns + alp] += prod;
+                }
+            }
+        }
+    }
+    grid->GlobalSumVector(c.data(), c.size());
+
+    std::vector<SpinMatrix> res(nt);
+
+    for (int t = 0; t < nt; ++t)
+    {
+        res[t] = zero;
+        for (int al = 0; al < Ns; ++al)
+        for (int alp = 0; alp < Ns; ++alp)
+        {
+            res[t]()(al, alp)() = c[(t*Ns + al)*Ns + alp];
+        }
+    }
+
+    return res;
+}
+
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    // run setup ///////////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    std::vector<std::string> flavour = {"l", "h"};
+    std::vector<double>      mass    = {.1, .2};
+
+    // gauge field
+    application.createModule<MGauge::Random>("gauge");
+    // source
+    MSource::Point::Par ptPar;
+    ptPar.position = "0 0 0 0";
+    application.createModule<MSource::Point>("pt", ptPar);
+    for (unsigned int i = 0; i < flavour.size(); ++i)
+    {
+        // action
+        MAction::DWF::Par actionPar;
+        actionPar.gauge    = "gauge";
+        actionPar.Ls       = 8;
+        actionPar.M5       = 1.8;
+        actionPar.mass     = mass[i];
+        actionPar.boundary = "1 1 1 -1";
+        application.createModule<MAction::DWF>("DWF_" + flavour[i], actionPar);
+        // solver
+        MSolver::RBPrecCG::Par solverPar;
+        solverPar.action   = "DWF_" + flavour[i];
+        solverPar.residual = 1.0e-8;
+        application.createModule<MSolver::RBPrecCG>("CG_" + flavour[i],
+                                                    solverPar);
+        // propagator
+        MFermion::GaugeProp::Par quarkPar;
+        quarkPar.source = "pt";
+        quarkPar.solver = "CG_" + flavour[i];
+        application.createModule<MFermion::GaugeProp>("Q_" + flavour[i],
+                                                      quarkPar);
+    }
+    // baryons
+    std::vector<std::string> baryon = {"lll", "llh", "lhl", "hll"};
+    MContraction::Baryon::Par barPar;
+    barPar.gammas     = "<Gamma5 Gamma5><Identity Identity><GammaT Gamma5>";
+    barPar.projectors = "P+ P-";
+    for (auto &b: baryon)
+    {
+        barPar.q1     = "Q_" + b.substr(0, 1);
+        barPar.q2     = "Q_" + b.substr(1, 1);
+        barPar.q3     = "Q_" + b.substr(2, 1);
+        barPar.output = "baryon_" + b;
+        application.createModule<MContraction::Baryon>("baryon_" + b, barPar);
+    }
+
+    // execution ///////////////////////////////////////////////////////////////
+    auto &vm  = VirtualMachine::getInstance();
+    auto &env = Environment::getInstance();
+
+    vm.setTrajectory(0);
+    for (auto &m: {"gauge", "pt", "DWF_l", "CG_l", "Q_l", "DWF_h", "CG_h", "Q_h"})
+    {
+        (*vm.getModule(m))();
+    }
+
+    // comparison //////////////////////////////////////////////////////////////
+    typedef MContraction::GammaPair GammaPair;
+
+    std::vector<GammaPair> gammaList = strToVec<GammaPair>(barPar.gammas);
+    SpinMatrix             id, proj[2];
+    Gamma                  gT(Gamma::Algebra::GammaT);
+    RealD                  diff = 0., norm = 0.;
+    GridStopWatch          kernelTimer, naiveTimer;
+
+    id = zero;
+    for (unsigned int a = 0; a < Ns; ++a)
+    {
+        id()(a, a)() = 1.;
+    }
+    proj[0] = 0.5*(id + gT*id);
+    proj[1] = 0.5*(id - gT*id);
+    for (auto &b: baryon)
+    {
+        std::vector<LatticePropagator *> q;
+        std::vector<std::string>         name;
+        std::vector<BaryonResult>        result;
+
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            name.push_back(b.substr(k, 1));
+            q.push_back(env.getObject<LatticePropagator>("Q_" + name.back()));
+        }
+        kernelTimer.Start();
+        (*vm.getModule("baryon_" + b))();
+        kernelTimer.Stop();
+        {
+            ResultReader reader("baryon_" + b + ".0." + resultFileExt);
+
+            read(reader, "baryon", result);
+        }
+        assert(result.size() == 2*gammaList.size());
+        for (unsigned int p = 0; p < gammaList.size(); ++p)
+        {
+            std::vector<SpinMatrix> ref;
+
+            naiveTimer.Start();
+            ref = naiveBaryon(q, name, gammaList[p], env.getGrid());
+            naiveTimer.Stop();
+            for (unsigned int j = 0; j < 2; ++j)
+            for (unsigned int t = 0; t < ref.size(); ++t)
+            {
+                ComplexD c = 0.;
+
+                for (int al = 0; al < Ns; ++al)
+                for (int alp = 0; alp < Ns; ++alp)
+                {
+                    c += proj[j]()(alp, al)()*ref[t]()(al, alp)();
+                }
+                diff += std::norm(result[2*p + j].corr[t] - c);
+                norm += std::norm(c);
+            }
+        }
+    }
+
+    RealD rel = std::sqrt(diff/norm);
+
+    LOG(Message) << "Baryon module    : " << kernelTimer.Elapsed() << std::endl;
+    LOG(Message) << "Direct summation : " << naiveTimer.Elapsed() << std::endl;
+    LOG(Message) << "Relative difference with the direct summation: " << rel
+                 << std::endl;
+    assert(rel < 1.0e-10);
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
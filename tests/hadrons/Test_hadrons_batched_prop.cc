@@ -0,0 +1,119 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_batched_prop.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+/*******************************************************************************
+ * Compare MFermion::GaugeProp with one solve per spin-colour component against
+ * the batched solve through MSolver::RBPrecBlockCG.
+ * The modules are run by hand rather than through Application::run() so that
+ * both propagators are still in the environment afterwards.
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    // run setup ///////////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    // gauge field
+    application.createModule<MGauge::Random>("gauge");
+    // source
+    MSource::Point::Par ptPar;
+    ptPar.position = "0 0 0 0";
+    application.createModule<MSource::Point>("pt", ptPar);
+    // action
+    MAction::DWF::Par actionPar;
+    actionPar.gauge    = "gauge";
+    actionPar.Ls       = 8;
+    actionPar.M5       = 1.8;
+    actionPar.mass     = 0.1;
+    actionPar.boundary = "1 1 1 -1";
+    application.createModule<MAction::DWF>("DWF", actionPar);
+    // solver
+    MSolver::RBPrecCG::Par solverPar;
+    solverPar.action   = "DWF";
+    solverPar.residual = 1.0e-8;
+    application.createModule<MSolver::RBPrecCG>("CG", solverPar);
+    MSolver::RBPrecBlockCG::Par blockSolverPar;
+    blockSolverPar.action   = "DWF";
+    blockSolverPar.residual = 1.0e-8;
+    application.createModule<MSolver::RBPrecBlockCG>("BCG", blockSolverPar);
+    // propagators
+    MFermion::GaugeProp::Par quarkPar;
+    quarkPar.source = "pt";
+    quarkPar.solver = "CG";
+    application.createModule<MFermion::GaugeProp>("Q_seq", quarkPar);
+    quarkPar.solver = "BCG";
+    application.createModule<MFermion::GaugeProp>("Q_batch", quarkPar);
+
+    // execution ///////////////////////////////////////////////////////////////
+    auto &vm  = VirtualMachine::getInstance();
+    auto &env = Environment::getInstance();
+
+    for (auto &m: {"gauge", "pt", "DWF", "CG", "BCG"})
+    {
+        (*vm.getModule(m))();
+    }
+
+    GridStopWatch seqTimer, batchTimer;
+
+    seqTimer.Start();
+    (*vm.getModule("Q_seq"))();
+    seqTimer.Stop();
+    batchTimer.Start();
+    (*vm.getModule("Q_batch"))();
+    batchTimer.Stop();
+
+    // comparison //////////////////////////////////////////////////////////////
+    LatticePropagator &qSeq   = *env.getObject<LatticePropagator>("Q_seq");
+    LatticePropagator &qBatch = *env.getObject<LatticePropagator>("Q_batch");
+    LatticePropagator diff(env.getGrid());
+    RealD             tol = 1.0e-5;
+
+    diff = qSeq - qBatch;
+
+    RealD rel = std::sqrt(norm2(diff)/norm2(qSeq));
+
+    LOG(Message) << "Sequential solves : " << seqTimer.Elapsed() << std::endl;
+    LOG(Message) << "Batched solve     : " << batchTimer.Elapsed() << std::endl;
+    LOG(Message) << "Speed-up          : "
+                 << (double)seqTimer.useconds()/batchTimer.useconds()
+                 << std::endl;
+    LOG(Message) << "Relative difference between propagators: " << rel
+                 << std::endl;
+    assert(rel < tol);
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
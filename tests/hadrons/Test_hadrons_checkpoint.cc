@@ -0,0 +1,244 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_checkpoint.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+typedef MContraction::TBaryon<FIMPL, FIMPL, FIMPL>::Result BaryonResult;
+typedef MContraction::Meson::Result                      MesonResult;
+
+/*******************************************************************************
+ * Checkpoint/restart of a program. The baryon module first fails (invalid
+ * parameter), the program is then restarted from the checkpoint with the
+ * propagator read back, and must agree with a run without checkpoints,
+ * including a Z2 source drawn after the restart point, which needs the random
+ * number generator state of the checkpoint (the seed is reset before each
+ * run). With a corrupted propagator file, the propagator cannot be recomputed
+ * without drawing the random gauge field again, and the whole program runs
+ * again.
+ ******************************************************************************/
+static std::vector<BaryonResult> readBaryon(void)
+{
+    std::vector<BaryonResult> result;
+    ResultReader              reader("baryon.0." + resultFileExt);
+
+    read(reader, "baryon", result);
+
+    return result;
+}
+
+static std::vector<MesonResult> readMeson(void)
+{
+    std::vector<MesonResult> result;
+    ResultReader             reader("meson_z2.0." + resultFileExt);
+
+    read(reader, "meson", result);
+
+    return result;
+}
+
+static void copyFile(const std::string from, const std::string to)
+{
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary);
+
+    assert(in.good() and out.good());
+    out << in.rdbuf();
+}
+
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    // run setup ///////////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    Application::GlobalPar globalPar = application.getPar();
+
+    globalPar.checkpoint.directory = ".";
+    globalPar.checkpoint.interval  = 0.;
+    application.setPar(globalPar);
+
+    // gauge field
+    application.createModule<MGauge::Random>("gauge");
+    // source
+    MSource::Point::Par ptPar;
+    ptPar.position = "0 0 0 0";
+    application.createModule<MSource::Point>("pt", ptPar);
+    // action
+    MAction::DWF::Par actionPar;
+    actionPar.gauge    = "gauge";
+    actionPar.Ls       = 8;
+    actionPar.M5       = 1.8;
+    actionPar.mass     = 0.1;
+    actionPar.boundary = "1 1 1 -1";
+    application.createModule<MAction::DWF>("DWF", actionPar);
+    // solver
+    MSolver::RBPrecCG::Par solverPar;
+    solverPar.action   = "DWF";
+    solverPar.residual = 1.0e-8;
+    application.createModule<MSolver::RBPrecCG>("CG", solverPar);
+    // propagator
+    MFermion::GaugeProp::Par quarkPar;
+    quarkPar.source = "pt";
+    quarkPar.solver = "CG";
+    application.createModule<MFermion::GaugeProp>("Q", quarkPar);
+    // contractions
+    MSink::Point::Par sinkPar;
+    sinkPar.mom = "0 0 0";
+    application.createModule<MSink::ScalarPoint>("sink", sinkPar);
+    MContraction::Meson::Par mesPar;
+    mesPar.q1     = "Q";
+    mesPar.q2     = "Q";
+    mesPar.gammas = "all";
+    mesPar.sink   = "sink";
+    mesPar.output = "meson";
+    application.createModule<MContraction::Meson>("meson", mesPar);
+    MContraction::Baryon::Par barPar;
+    barPar.q1         = "Q";
+    barPar.q2         = "Q";
+    barPar.q3         = "Q";
+    barPar.projectors = "P0";
+    barPar.output     = "baryon";
+    application.createModule<MContraction::Baryon>("baryon", barPar);
+    // random source after the restart point, contracted with Q directly
+    MSource::Z2::Par z2Par;
+    z2Par.tA = 0;
+    z2Par.tB = 0;
+    application.createModule<MSource::Z2>("z2", z2Par);
+    mesPar.q1     = "z2";
+    mesPar.q2     = "Q";
+    mesPar.gammas = "<Gamma5 Gamma5>";
+    mesPar.output = "meson_z2";
+    application.createModule<MContraction::Meson>("meson_z2", mesPar);
+
+    // execution ///////////////////////////////////////////////////////////////
+    auto &vm  = VirtualMachine::getInstance();
+    auto &env = Environment::getInstance();
+    std::vector<std::string> program = {"gauge", "sink", "pt", "DWF", "CG",
+                                        "Q", "meson", "baryon", "z2",
+                                        "meson_z2"};
+    std::vector<std::vector<BaryonResult>> result;
+    std::vector<std::vector<MesonResult>>  resultZ2;
+    bool                                   failed = false;
+    GridBase                               *g = env.getGrid();
+
+    vm.setTrajectory(0);
+    // first run, stops at the baryon module
+    try
+    {
+        vm.executeProgram(program);
+    }
+    catch (Exceptions::Argument &e)
+    {
+        failed = true;
+    }
+    assert(failed);
+    if (g->IsBoss())
+    {
+        copyFile("checkpoint.0.xml", "checkpoint.0.xml.bak");
+        copyFile("Q.0.bin", "Q.0.bin.bak");
+        // generator state after the one random module run (gauge)
+        copyFile("rng.1.0.bin", "rng.1.0.bin.bak");
+    }
+    g->Barrier();
+    barPar.projectors = "P+ P-";
+    vm.getModule<MContraction::Baryon>("baryon")->setPar(barPar);
+    // restart, only the modules from the baryon one run
+    application.setPar(globalPar);
+    env.freeAll();
+    vm.executeProgram(program);
+    assert(vm.getRunProfile().size() == 3);
+    result.push_back(readBaryon());
+    resultZ2.push_back(readMeson());
+    // restart with a corrupted propagator
+    application.setPar(globalPar);
+    if (g->IsBoss())
+    {
+        copyFile("checkpoint.0.xml.bak", "checkpoint.0.xml");
+        copyFile("Q.0.bin.bak", "Q.0.bin");
+        copyFile("rng.1.0.bin.bak", "rng.1.0.bin");
+
+        std::fstream file("Q.0.bin", std::ios::in | std::ios::out
+                                     | std::ios::binary);
+
+        file.seekp(1000);
+        file.put('x');
+    }
+    g->Barrier();
+    env.freeAll();
+    vm.executeProgram(program);
+    assert(vm.getRunProfile().size() == program.size());
+    result.push_back(readBaryon());
+    resultZ2.push_back(readMeson());
+    // no checkpoint
+    if (g->IsBoss())
+    {
+        std::remove("checkpoint.0.xml.bak");
+        std::remove("Q.0.bin.bak");
+        std::remove("rng.1.0.bin.bak");
+    }
+    globalPar.checkpoint.directory = "";
+    application.setPar(globalPar);
+    env.freeAll();
+    vm.executeProgram(program);
+    assert(vm.getRunProfile().size() == program.size());
+    result.push_back(readBaryon());
+    resultZ2.push_back(readMeson());
+
+    // comparison //////////////////////////////////////////////////////////////
+    RealD diff = 0., norm = 0.;
+
+    for (unsigned int r = 0; r < 2; ++r)
+    for (unsigned int i = 0; i < result[2].size(); ++i)
+    for (unsigned int t = 0; t < result[2][i].corr.size(); ++t)
+    {
+        diff += std::norm(result[r][i].corr[t] - result[2][i].corr[t]);
+        norm += std::norm(result[2][i].corr[t]);
+    }
+    for (unsigned int r = 0; r < 2; ++r)
+    for (unsigned int i = 0; i < resultZ2[2].size(); ++i)
+    for (unsigned int t = 0; t < resultZ2[2][i].corr.size(); ++t)
+    {
+        diff += std::norm(resultZ2[r][i].corr[t] - resultZ2[2][i].corr[t]);
+        norm += std::norm(resultZ2[2][i].corr[t]);
+    }
+
+    RealD rel = std::sqrt(diff/norm);
+
+    LOG(Message) << "Relative difference with the run without checkpoints: "
+                 << rel << std::endl;
+    assert(rel < 1.0e-12);
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,281 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_list_scheduler.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+#include <Grid/Hadrons/ListScheduler.hpp>
+
+using namespace Grid;
+using namespace Hadrons;
+
+typedef ListScheduler<unsigned long, unsigned int> Scheduler;
+
+/*******************************************************************************
+ * List scheduler. On random graphs, the schedule must be a topological order
+ * of the vertices, its memory peak recomputed here must be the one reported by
+ * the scheduler, and must not exceed the one of the natural vertex order. The
+ * same checks are then done on the module graph of a Hadrons program, with the
+ * memory needed computed by the virtual machine.
+ ******************************************************************************/
+// memory peak of a schedule, objects are allocated by their producer and freed
+// after their last use, after their producer or never
+static unsigned long peak(const std::vector<unsigned int> &schedule,
+                          const std::vector<Scheduler::Object> &object)
+{
+    std::map<unsigned int, unsigned int> pos;
+    std::vector<unsigned long>           alloc(schedule.size(), 0);
+    std::vector<unsigned long>           freed(schedule.size(), 0);
+    unsigned long                        current = 0, max = 0;
+
+    for (unsigned int i = 0; i < schedule.size(); ++i)
+    {
+        pos[schedule[i]] = i;
+    }
+    for (auto &o: object)
+    {
+        unsigned int p = pos.at(o.producer), last = p;
+
+        for (auto u: o.user)
+        {
+            last = std::max(last, pos.at(u));
+        }
+        alloc[p] += o.size;
+        if (o.lifetime == Scheduler::Lifetime::lastUse)
+        {
+            freed[last] += o.size;
+        }
+        else if (o.lifetime == Scheduler::Lifetime::producer)
+        {
+            freed[p] += o.size;
+        }
+    }
+    for (unsigned int i = 0; i < schedule.size(); ++i)
+    {
+        current += alloc[i];
+        max      = std::max(max, current);
+        current -= freed[i];
+    }
+
+    return max;
+}
+
+static bool isTopological(const std::vector<unsigned int> &schedule,
+                          const std::vector<unsigned int> &vertex,
+                          const std::vector<Scheduler::Object> &object)
+{
+    std::map<unsigned int, unsigned int> pos;
+
+    for (unsigned int i = 0; i < schedule.size(); ++i)
+    {
+        pos[schedule[i]] = i;
+    }
+    if ((schedule.size() != vertex.size()) or (pos.size() != vertex.size()))
+    {
+        return false;
+    }
+    for (auto &o: object)
+    for (auto u: o.user)
+    {
+        if (pos.at(u) < pos.at(o.producer))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// random graph, vertex labels are a topological order but are given to the
+// scheduler shuffled
+static void randomGraph(std::vector<unsigned int> &vertex,
+                        std::vector<Scheduler::Object> &object,
+                        const unsigned int n, std::mt19937 &gen)
+{
+    std::uniform_int_distribution<unsigned int>  size(1, 100), nUser(0, 3);
+    std::uniform_real_distribution<double>       u(0., 1.);
+
+    vertex.resize(n);
+    object.clear();
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        vertex[v] = v;
+        for (unsigned int k = 0; k < 1 + (u(gen) < 0.3); ++k)
+        {
+            Scheduler::Object o;
+            double            l = u(gen);
+
+            o.producer = v;
+            o.size     = size(gen);
+            o.lifetime = (l < 0.7) ? Scheduler::Lifetime::lastUse :
+                         ((l < 0.85) ? Scheduler::Lifetime::producer :
+                                       Scheduler::Lifetime::never);
+            if ((v + 1 < n) and (o.lifetime != Scheduler::Lifetime::producer))
+            {
+                std::uniform_int_distribution<unsigned int> user(v + 1, n - 1);
+
+                for (unsigned int i = nUser(gen); i > 0; --i)
+                {
+                    o.user.push_back(user(gen));
+                }
+            }
+            object.push_back(o);
+        }
+    }
+    std::shuffle(vertex.begin(), vertex.end(), gen);
+}
+
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    Scheduler::Parameters par;
+
+    par.lookahead = 2;
+    par.maxIter   = 1000;
+
+    // two independent chains, interleaving them doubles the peak /////////////
+    {
+        std::vector<unsigned int>      vertex = {0, 1, 2, 3};
+        std::vector<Scheduler::Object> object(2);
+
+        object[0].size     = 100;
+        object[0].producer = 0;
+        object[0].user     = {2};
+        object[0].lifetime = Scheduler::Lifetime::lastUse;
+        object[1].size     = 100;
+        object[1].producer = 1;
+        object[1].user     = {3};
+        object[1].lifetime = Scheduler::Lifetime::lastUse;
+
+        Scheduler scheduler(vertex, object, par);
+        auto      &schedule = scheduler.getSchedule();
+
+        LOG(Message) << "Chains: peak " << scheduler.getPeak()
+                     << " (natural order " << peak(vertex, object) << ")"
+                     << std::endl;
+        assert(isTopological(schedule, vertex, object));
+        assert(peak(schedule, object) == scheduler.getPeak());
+        assert(scheduler.getPeak() == 100);
+    }
+
+    // random graphs ///////////////////////////////////////////////////////////
+    std::mt19937 gen(42);
+
+    for (unsigned int n: {1, 2, 5, 10, 50, 200, 1000})
+    for (unsigned int r = 0; r < 10; ++r)
+    {
+        std::vector<unsigned int>      vertex, natural;
+        std::vector<Scheduler::Object> object;
+
+        randomGraph(vertex, object, n, gen);
+        natural = vertex;
+        std::sort(natural.begin(), natural.end());
+
+        Scheduler     scheduler(vertex, object, par);
+        auto          &schedule = scheduler.getSchedule();
+        unsigned long p = peak(schedule, object), pNat = peak(natural, object);
+
+        if (r == 0)
+        {
+            LOG(Message) << n << " vertices: peak " << p << " (natural order "
+                         << pNat << ", " << scheduler.getNIter()
+                         << " local search iteration(s))" << std::endl;
+        }
+        assert(isTopological(schedule, vertex, object));
+        assert(p == scheduler.getPeak());
+        assert(p <= pNat);
+    }
+
+    // Hadrons program /////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    std::vector<std::string> pos = {"0 0 0 0", "1 2 3 4", "2 0 1 3"};
+
+    application.createModule<MGauge::Unit>("gauge");
+    MAction::Wilson::Par actionPar;
+    actionPar.gauge    = "gauge";
+    actionPar.mass     = 0.1;
+    actionPar.boundary = "1 1 1 -1";
+    application.createModule<MAction::Wilson>("Wilson", actionPar);
+    MSolver::RBPrecCG::Par solverPar;
+    solverPar.action   = "Wilson";
+    solverPar.residual = 1.0e-8;
+    application.createModule<MSolver::RBPrecCG>("CG", solverPar);
+    for (unsigned int i = 0; i < pos.size(); ++i)
+    {
+        MSource::Point::Par ptPar;
+        ptPar.position = pos[i];
+        application.createModule<MSource::Point>(INIT_INDEX("pt", i), ptPar);
+        MFermion::GaugeProp::Par quarkPar;
+        quarkPar.source = INIT_INDEX("pt", i);
+        quarkPar.solver = "CG";
+        application.createModule<MFermion::GaugeProp>(INIT_INDEX("Q", i),
+                                                      quarkPar);
+    }
+    for (unsigned int i = 0; i < pos.size(); ++i)
+    for (unsigned int j = i; j < pos.size(); ++j)
+    {
+        MContraction::Meson::Par mesPar;
+        mesPar.q1     = INIT_INDEX("Q", i);
+        mesPar.q2     = INIT_INDEX("Q", j);
+        mesPar.gammas = "<Gamma5 Gamma5>";
+        mesPar.mom    = {"0 0 0"};
+        mesPar.output = ADD_INDEX(INIT_INDEX("meson", i), j);
+        application.createModule<MContraction::Meson>(
+            ADD_INDEX(INIT_INDEX("meson", i), j), mesPar);
+    }
+
+    auto                                 &vm   = VirtualMachine::getInstance();
+    auto                                 graph = vm.getModuleGraph();
+    VirtualMachine::Program              program, natural;
+    VirtualMachine::ListPar              listPar;
+    std::map<unsigned int, unsigned int> modPos;
+
+    program = vm.schedule(listPar);
+    natural = graph.topoSort();
+    for (unsigned int i = 0; i < program.size(); ++i)
+    {
+        modPos[program[i]] = i;
+    }
+    assert(program.size() == vm.getNModule());
+    assert(modPos.size() == vm.getNModule());
+    for (auto m: graph.getVertices())
+    for (auto p: graph.getParents(m))
+    {
+        assert(modPos.at(p) < modPos.at(m));
+    }
+    LOG(Message) << "Program: memory needed "
+                 << sizeString(vm.memoryNeeded(program))
+                 << " (topological sort " << sizeString(vm.memoryNeeded(natural))
+                 << ")" << std::endl;
+    assert(vm.memoryNeeded(program) <= vm.memoryNeeded(natural));
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_meson_kernel.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+/*******************************************************************************
+ * Compare the single-pass MesonKernel of MContraction::Meson with the
+ * per-pair trace tr[g5 gSnk q1 adj(gSrc) g5 adj(q2) sink] for all the 16x16
+ * gamma pairs, site by site, on random propagators and a random sink.
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    typedef vComplex vec;
+    
+    Grid_init(&argc, &argv);
+    
+    GridCartesian     *grid = SpaceTimeGrid::makeFourDimGrid(
+        GridDefaultLatt(), GridDefaultSimd(Nd, vComplex::Nsimd()),
+        GridDefaultMpi());
+    GridParallelRNG   rng(grid);
+    LatticePropagator q1(grid), q2(grid);
+    LatticeComplex    sink(grid), ref(grid), diff(grid);
+    Gamma             g5(Gamma::Algebra::Gamma5);
+    
+    std::vector<MContraction::GammaPair> gammaList;
+    
+    rng.SeedFixedIntegers(std::vector<int>({1, 2, 3, 4}));
+    random(rng, q1);
+    random(rng, q2);
+    random(rng, sink);
+    for (unsigned int i = 1; i < Gamma::nGamma; i += 2)
+    for (unsigned int j = 1; j < Gamma::nGamma; j += 2)
+    {
+        gammaList.push_back(std::make_pair((Gamma::Algebra)i,
+                                           (Gamma::Algebra)j));
+    }
+    
+    MContraction::MesonKernel   kernel(gammaList);
+    const unsigned int          np = kernel.size();
+    std::vector<LatticeComplex> c(np, grid), cSink(np, grid);
+    RealD                       maxRel = 0.;
+    
+    assert(np == 256);
+    parallel_for(int ss = 0; ss < grid->oSites(); ss++)
+    {
+        vec res[256];
+        
+        kernel(res, q1._odata[ss], adj(q2._odata[ss]));
+        for (unsigned int p = 0; p < np; ++p)
+        {
+            c[p]._odata[ss]()()() = res[p];
+        }
+        kernel(res, q1._odata[ss], adj(q2._odata[ss])*sink._odata[ss]);
+        for (unsigned int p = 0; p < np; ++p)
+        {
+            cSink[p]._odata[ss]()()() = res[p];
+        }
+    }
+    for (unsigned int p = 0; p < np; ++p)
+    {
+        Gamma gSnk(gammaList[p].first);
+        Gamma gSrc(gammaList[p].second);
+        RealD rel, relSink;
+        
+        ref     = trace((g5*gSnk)*q1*(adj(gSrc)*g5)*adj(q2));
+        diff    = ref - c[p];
+        rel     = std::sqrt(norm2(diff)/norm2(ref));
+        ref     = trace((g5*gSnk)*q1*(adj(gSrc)*g5)*adj(q2)*sink);
+        diff    = ref - cSink[p];
+        relSink = std::sqrt(norm2(diff)/norm2(ref));
+        if ((rel > 1.0e-13) or (relSink > 1.0e-13))
+        {
+            LOG(Error) << "<" << gammaList[p].first << " " 
+                       << gammaList[p].second << ">: relative difference "
+                       << rel << " (point sink) " << relSink 
+                       << " (random sink)" << std::endl;
+        }
+        maxRel = std::max(maxRel, std::max(rel, relSink));
+    }
+    LOG(Message) << "Maximum relative difference over " << np 
+                 << " gamma pairs: " << maxRel << std::endl;
+    assert(maxRel < 1.0e-13);
+    
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+    
+    return EXIT_SUCCESS;
+}
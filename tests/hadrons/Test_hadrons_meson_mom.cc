@@ -0,0 +1,169 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_meson_mom.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+typedef MContraction::Meson::Result MesonResult;
+
+/*******************************************************************************
+ * Compare the momentum projection of MContraction::Meson (all momenta in one
+ * pass) with one point sink per momentum. The modules are run by hand so that
+ * the propagator is computed only once.
+ ******************************************************************************/
+static std::vector<MesonResult> readMeson(const std::string name)
+{
+    std::vector<MesonResult> result;
+    ResultReader             reader(name + ".0." + resultFileExt);
+
+    read(reader, "meson", result);
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    // run setup ///////////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    std::vector<std::string> mom = {"0 0 0", "1 0 0", "0 -1 1", "1 2 -1",
+                                    "2 2 2"};
+
+    // gauge field
+    application.createModule<MGauge::Random>("gauge");
+    // source
+    MSource::Point::Par ptPar;
+    ptPar.position = "0 0 0 0";
+    application.createModule<MSource::Point>("pt", ptPar);
+    // action
+    MAction::DWF::Par actionPar;
+    actionPar.gauge    = "gauge";
+    actionPar.Ls       = 8;
+    actionPar.M5       = 1.8;
+    actionPar.mass     = 0.1;
+    actionPar.boundary = "1 1 1 -1";
+    application.createModule<MAction::DWF>("DWF", actionPar);
+    // solver
+    MSolver::RBPrecCG::Par solverPar;
+    solverPar.action   = "DWF";
+    solverPar.residual = 1.0e-8;
+    application.createModule<MSolver::RBPrecCG>("CG", solverPar);
+    // propagator
+    MFermion::GaugeProp::Par quarkPar;
+    quarkPar.source = "pt";
+    quarkPar.solver = "CG";
+    application.createModule<MFermion::GaugeProp>("Q", quarkPar);
+    // contractions, one sink per momentum
+    MContraction::Meson::Par mesPar;
+    mesPar.q1     = "Q";
+    mesPar.q2     = "Q";
+    mesPar.gammas = "all";
+    for (unsigned int m = 0; m < mom.size(); ++m)
+    {
+        MSink::Point::Par sinkPar;
+        std::string       m_str = std::to_string(m);
+
+        sinkPar.mom = mom[m] + " 0";
+        application.createModule<MSink::ScalarPoint>("sink_" + m_str, sinkPar);
+        mesPar.sink   = "sink_" + m_str;
+        mesPar.output = "meson_sink_" + m_str;
+        application.createModule<MContraction::Meson>("meson_sink_" + m_str,
+                                                      mesPar);
+    }
+    // contractions, all momenta at once
+    mesPar.sink   = "";
+    mesPar.mom    = mom;
+    mesPar.output = "meson_mom";
+    application.createModule<MContraction::Meson>("meson_mom", mesPar);
+
+    // execution ///////////////////////////////////////////////////////////////
+    auto          &vm = VirtualMachine::getInstance();
+    GridStopWatch sinkTimer, momTimer;
+
+    vm.setTrajectory(0);
+    for (auto &m: {"gauge", "pt", "DWF", "CG", "Q"})
+    {
+        (*vm.getModule(m))();
+    }
+    sinkTimer.Start();
+    for (unsigned int m = 0; m < mom.size(); ++m)
+    {
+        std::string m_str = std::to_string(m);
+
+        (*vm.getModule("sink_" + m_str))();
+        (*vm.getModule("meson_sink_" + m_str))();
+    }
+    sinkTimer.Stop();
+    momTimer.Start();
+    (*vm.getModule("meson_mom"))();
+    momTimer.Stop();
+
+    // comparison //////////////////////////////////////////////////////////////
+    std::vector<MesonResult> res = readMeson("meson_mom");
+    RealD                    diff = 0., norm = 0.;
+    unsigned int             np;
+
+    assert(res.size() % mom.size() == 0);
+    np = res.size()/mom.size();
+    for (unsigned int m = 0; m < mom.size(); ++m)
+    {
+        std::vector<MesonResult> ref = readMeson("meson_sink_"
+                                                 + std::to_string(m));
+
+        assert(ref.size() == np);
+        for (unsigned int p = 0; p < np; ++p)
+        {
+            auto &r = res[m*np + p];
+
+            assert(r.mom == mom[m]);
+            assert(r.gamma_snk == ref[p].gamma_snk);
+            assert(r.gamma_src == ref[p].gamma_src);
+            for (unsigned int t = 0; t < ref[p].corr.size(); ++t)
+            {
+                diff += std::norm(r.corr[t] - ref[p].corr[t]);
+                norm += std::norm(ref[p].corr[t]);
+            }
+        }
+    }
+
+    RealD rel = std::sqrt(diff/norm);
+
+    LOG(Message) << "One sink per momentum: " << sinkTimer.Elapsed() << std::endl;
+    LOG(Message) << "Momentum projection  : " << momTimer.Elapsed() << std::endl;
+    LOG(Message) << "Relative difference  : " << rel << std::endl;
+    assert(rel < 1.0e-12);
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
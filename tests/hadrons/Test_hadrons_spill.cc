@@ -0,0 +1,177 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_spill.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+typedef MContraction::Meson::Result MesonResult;
+
+/*******************************************************************************
+ * Disk spilling of environment objects. A gauge field is spilled and reloaded
+ * by hand and must come back bit-identical. A program with three propagators
+ * is then run under a memory budget small enough to force spills and reloads,
+ * and its correlators must be identical to the ones of a run without budget.
+ ******************************************************************************/
+static std::vector<MesonResult> readMeson(const std::string name)
+{
+    std::vector<MesonResult> result;
+    ResultReader             reader(name + ".0." + resultFileExt);
+
+    read(reader, "meson", result);
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    // run setup ///////////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    Application::GlobalPar   globalPar = application.getPar();
+    std::vector<std::string> program   = {"gauge", "Wilson", "CG"};
+    std::vector<std::string> pos       = {"0 0 0 0", "1 2 3 4", "2 0 1 3"};
+    std::vector<std::string> mesons;
+
+    // gauge field
+    application.createModule<MGauge::Random>("gauge");
+    // action
+    MAction::Wilson::Par actionPar;
+    actionPar.gauge    = "gauge";
+    actionPar.mass     = 0.1;
+    actionPar.boundary = "1 1 1 -1";
+    application.createModule<MAction::Wilson>("Wilson", actionPar);
+    // solver
+    MSolver::RBPrecCG::Par solverPar;
+    solverPar.action   = "Wilson";
+    solverPar.residual = 1.0e-8;
+    application.createModule<MSolver::RBPrecCG>("CG", solverPar);
+    // sources and propagators
+    for (unsigned int i = 0; i < pos.size(); ++i)
+    {
+        std::string         i_str = std::to_string(i);
+        MSource::Point::Par ptPar;
+        ptPar.position = pos[i];
+        application.createModule<MSource::Point>("pt_" + i_str, ptPar);
+        MFermion::GaugeProp::Par quarkPar;
+        quarkPar.source = "pt_" + i_str;
+        quarkPar.solver = "CG";
+        application.createModule<MFermion::GaugeProp>("Q_" + i_str, quarkPar);
+        program.push_back("pt_" + i_str);
+        program.push_back("Q_" + i_str);
+    }
+    // contractions, each one needs propagators computed several steps before
+    for (unsigned int i = 0; i < pos.size(); ++i)
+    for (unsigned int j = i; j < pos.size(); ++j)
+    {
+        std::string              name = "meson_" + std::to_string(i)
+                                        + std::to_string(j);
+        MContraction::Meson::Par mesPar;
+        mesPar.q1     = "Q_" + std::to_string(i);
+        mesPar.q2     = "Q_" + std::to_string(j);
+        mesPar.gammas = "<Gamma5 Gamma5><GammaX GammaX>";
+        mesPar.mom    = {"0 0 0", "1 0 0"};
+        mesPar.output = name;
+        application.createModule<MContraction::Meson>(name, mesPar);
+        program.push_back(name);
+        mesons.push_back(name);
+    }
+
+    // execution ///////////////////////////////////////////////////////////////
+    auto &vm  = VirtualMachine::getInstance();
+    auto &env = Environment::getInstance();
+    std::vector<std::vector<MesonResult>> result, ref;
+
+    vm.setTrajectory(0);
+    // spill and reload by hand
+    (*vm.getModule("gauge"))();
+    {
+        unsigned int       address = env.getObjectAddress("gauge");
+        LatticeGaugeField  &U      = *env.getObject<LatticeGaugeField>("gauge");
+        LatticeGaugeField  copy(U._grid);
+        size_t             bytes   = U._odata.size()*sizeof(U._odata[0]);
+
+        copy = U;
+        env.spillObject(address);
+        assert(env.isObjectSpilled(address));
+        env.reloadObject(address);
+        assert(!env.isObjectSpilled(address));
+
+        LatticeGaugeField &V = *env.getObject<LatticeGaugeField>("gauge");
+
+        assert(memcmp(&V._odata[0], &copy._odata[0], bytes) == 0);
+        LOG(Message) << "Gauge field bit-identical after spill and reload"
+                     << std::endl;
+    }
+    env.freeAll();
+    // run under a budget of about two propagators, then without budget (same
+    // random gauge field, hence the seed reset)
+    globalPar.spill.memoryBudget = 
+        2.*env.getGrid()->lSites()*sizeof(SpinColourMatrix)/1024./1024.;
+    globalPar.spill.directory    = ".";
+    application.setPar(globalPar);
+    vm.executeProgram(program);
+
+    auto stats = env.getSpillStats();
+
+    LOG(Message) << stats.nSpill << " spills and " << stats.nReload 
+                 << " reloads" << std::endl;
+    assert((stats.nSpill > 0) and (stats.nReload > 0));
+    for (auto &m: mesons)
+    {
+        result.push_back(readMeson(m));
+    }
+    globalPar.spill.memoryBudget = 0.;
+    application.setPar(globalPar);
+    env.freeAll();
+    vm.executeProgram(program);
+    for (auto &m: mesons)
+    {
+        ref.push_back(readMeson(m));
+    }
+
+    // comparison //////////////////////////////////////////////////////////////
+    for (unsigned int m = 0; m < mesons.size(); ++m)
+    {
+        assert(result[m].size() == ref[m].size());
+        for (unsigned int i = 0; i < ref[m].size(); ++i)
+        {
+            assert(result[m][i].corr == ref[m][i].corr);
+        }
+    }
+    LOG(Message) << "Correlators identical to the run without budget"
+                 << std::endl;
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*******************************************************************************
+ Grid physics library, www.github.com/paboyle/Grid
+
+ Source file: tests/hadrons/Test_hadrons_split.cc
+
+ Copyright (C) 2015
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ See the full license in the file "LICENSE" in the top level distribution
+ directory.
+ *******************************************************************************/
+
+#include "Test_hadrons.hpp"
+
+using namespace Grid;
+using namespace Hadrons;
+
+typedef MContraction::Meson::Result MesonResult;
+
+/*******************************************************************************
+ * Split execution against a sequential run of the same program. The program
+ * mixes point and Z2 sources: the Z2 sources draw random numbers, so they must
+ * run on the full grid for the stream to be the one of the sequential run,
+ * while the propagators and contractions are batched on one-process groups.
+ * Trajectory 0 runs sequentially and trajectory 1 on split grids.
+ * Run on several processes, e.g. --mpi 1.1.2.2.
+ ******************************************************************************/
+static std::vector<MesonResult> readMeson(const std::string name,
+                                          const unsigned int traj)
+{
+    std::vector<MesonResult> result;
+    ResultReader             reader(name + "." + std::to_string(traj) + "."
+                                    + resultFileExt);
+
+    read(reader, "meson", result);
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // initialization //////////////////////////////////////////////////////////
+    HADRONS_DEFAULT_INIT;
+
+    // run setup ///////////////////////////////////////////////////////////////
+    Application application;
+    HADRONS_DEFAULT_GLOBALS(application);
+
+    Application::GlobalPar   globalPar = application.getPar();
+    std::vector<std::string> program   = {"gauge", "Wilson", "CG"};
+    std::vector<std::string> src, mesons;
+
+    // gauge field
+    application.createModule<MGauge::Random>("gauge");
+    // action
+    MAction::Wilson::Par actionPar;
+    actionPar.gauge    = "gauge";
+    actionPar.mass     = 0.1;
+    actionPar.boundary = "1 1 1 -1";
+    application.createModule<MAction::Wilson>("Wilson", actionPar);
+    // solver
+    MSolver::RBPrecCG::Par solverPar;
+    solverPar.action   = "Wilson";
+    solverPar.residual = 1.0e-8;
+    application.createModule<MSolver::RBPrecCG>("CG", solverPar);
+    // sources
+    for (unsigned int t = 0; t < 2; ++t)
+    {
+        MSource::Point::Par ptPar;
+        ptPar.position = "0 0 0 " + std::to_string(t);
+        application.createModule<MSource::Point>("pt_" + std::to_string(t),
+                                                 ptPar);
+        src.push_back("pt_" + std::to_string(t));
+        MSource::Z2::Par z2Par;
+        z2Par.tA = t;
+        z2Par.tB = t;
+        application.createModule<MSource::Z2>("z2_" + std::to_string(t), 
+                                              z2Par);
+        src.push_back("z2_" + std::to_string(t));
+    }
+    program.insert(program.end(), src.begin(), src.end());
+    // propagators
+    for (auto &s: src)
+    {
+        MFermion::GaugeProp::Par quarkPar;
+        quarkPar.source = s;
+        quarkPar.solver = "CG";
+        application.createModule<MFermion::GaugeProp>("Q_" + s, quarkPar);
+        program.push_back("Q_" + s);
+    }
+    // contractions
+    for (auto &s: src)
+    {
+        MContraction::Meson::Par mesPar;
+        mesPar.q1     = "Q_" + s;
+        mesPar.q2     = "Q_" + s;
+        mesPar.gammas = "<Gamma5 Gamma5><GammaX GammaX>";
+        mesPar.mom    = {"0 0 0", "1 0 0"};
+        mesPar.output = "meson_" + s;
+        application.createModule<MContraction::Meson>("meson_" + s, mesPar);
+        program.push_back("meson_" + s);
+        mesons.push_back("meson_" + s);
+    }
+
+    // execution ///////////////////////////////////////////////////////////////
+    auto &vm  = VirtualMachine::getInstance();
+    auto &env = Environment::getInstance();
+
+    // the memory profile tells which modules can be batched, it also
+    // registers the temporaries so that they are freed after each run
+    vm.getMemoryProfile();
+    vm.setTrajectory(0);
+    vm.executeProgram(program);
+    // same seed, one process per group
+    globalPar.split.mpi = "1 1 1 1";
+    application.setPar(globalPar);
+    LOG(Message) << env.getNSplitGroup() << " split group(s)" << std::endl;
+    vm.setTrajectory(1);
+    vm.executeProgram(program);
+
+    // comparison //////////////////////////////////////////////////////////////
+    RealD diff = 0., norm = 0.;
+
+    // batched results are written by the boss of their split group
+    env.getGrid()->Barrier();
+
+    for (auto &m: mesons)
+    {
+        std::vector<MesonResult> seq = readMeson(m, 0);
+        std::vector<MesonResult> spl = readMeson(m, 1);
+
+        assert(seq.size() == spl.size());
+        for (unsigned int i = 0; i < seq.size(); ++i)
+        for (unsigned int t = 0; t < seq[i].corr.size(); ++t)
+        {
+            diff += std::norm(seq[i].corr[t] - spl[i].corr[t]);
+            norm += std::norm(seq[i].corr[t]);
+        }
+    }
+
+    RealD rel = std::sqrt(diff/norm);
+
+    LOG(Message) << "Relative difference with the sequential run: " << rel
+                 << std::endl;
+    assert(rel < 1.0e-10);
+
+    // epilogue
+    LOG(Message) << "Grid is finalizing now" << std::endl;
+    Grid_finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -249,6 +249,40 @@ int main (int argc, char ** argv) {
     _LocalCoherenceLanczos.checkpointCoarseRestore(std::string("evecs.coarse.scidac"),std::string("evals.coarse.xml"),coarse.Nstop);
     _LocalCoherenceLanczos.testCoarse(coarse.resid*100.0,Params.Smoother,Params.coarse_relax_tol); // Coarse check
   }
+
+  if ( Params.doCoarse || Params.doCoarseRead ) {
+    typedef CompressedEigenvectors<vSpinColourVector,vTComplex,nbasis> CompressedEvecs;
+
+    std::cout << GridLogIRL<<"Compressing coarse evecs to fp16"<<std::endl;
+    CompressedEvecs evecs(FrbGrid,CoarseGrid5rb,Odd);
+    _LocalCoherenceLanczos.compress(evecs);
+    CompressedEigenvectorIO::writeEigenvectors(evecs,std::string("evecs.compressed"));
+
+    CompressedEvecs evecs_read(FrbGrid,CoarseGrid5rb,Odd);
+    CompressedEigenvectorIO::readEigenvectors(evecs_read,std::string("evecs.compressed"));
+    assert(evecs_read.size() == evecs.size());
+    assert(evecs_read.coef   == evecs.coef);
+
+    // Deflated guess straight from the compressed vectors
+    std::vector<int> seeds5({5,6,7,8});
+    GridParallelRNG  RNG5(FGrid);  RNG5.SeedFixedIntegers(seeds5);
+    LatticeFermion   src_full(FGrid); gaussian(RNG5,src_full);
+    LatticeFermion   src(FrbGrid);    pickCheckerboard(Odd,src,src_full);
+    LatticeFermion   sol(FrbGrid);
+
+    ConjugateGradient<LatticeFermion> CG(1.0e-8,10000);
+    sol = zero;
+    CG(HermOp,src,sol);
+    int iter_plain = CG.IterationsToComplete;
+
+    LocalCoherenceDeflatedGuesser<vSpinColourVector,vTComplex,nbasis> Guesser(evecs_read);
+    Guesser(src,sol);
+    CG(HermOp,src,sol);
+    int iter_defl = CG.IterationsToComplete;
+
+    std::cout << GridLogMessage << "CG iterations undeflated "<< iter_plain
+	      << " deflated with "<< evecs_read.size() <<" compressed evecs "<< iter_defl << std::endl;
+  }
   Grid_finalize();
 }
 
@@ -0,0 +1,113 @@
+    /*************************************************************************************
+
+    Grid physics library, www.github.com/paboyle/Grid
+
+    Source file: ./tests/solver/Test_dwf_block_cg_mixedprec.cc
+
+    Copyright (C) 2015
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    See the full license in the file "LICENSE" in the top level distribution directory
+    *************************************************************************************/
+    /*  END LEGAL */
+#include <Grid/Grid.h>
+
+using namespace std;
+using namespace Grid;
+using namespace Grid::QCD;
+
+int main (int argc, char ** argv)
+{
+  Grid_init(&argc,&argv);
+
+  const int Ls=8;
+  const int nrhs=12;
+
+  GridCartesian         * UGrid   = SpaceTimeGrid::makeFourDimGrid(GridDefaultLatt(), GridDefaultSimd(Nd,vComplexD::Nsimd()),GridDefaultMpi());
+  GridRedBlackCartesian * UrbGrid = SpaceTimeGrid::makeFourDimRedBlackGrid(UGrid);
+  GridCartesian         * FGrid   = SpaceTimeGrid::makeFiveDimGrid(Ls,UGrid);
+  GridRedBlackCartesian * FrbGrid = SpaceTimeGrid::makeFiveDimRedBlackGrid(Ls,UGrid);
+
+  GridCartesian         * UGrid_f   = SpaceTimeGrid::makeFourDimGrid(GridDefaultLatt(), GridDefaultSimd(Nd,vComplexF::Nsimd()),GridDefaultMpi());
+  GridRedBlackCartesian * UrbGrid_f = SpaceTimeGrid::makeFourDimRedBlackGrid(UGrid_f);
+  GridCartesian         * FGrid_f   = SpaceTimeGrid::makeFiveDimGrid(Ls,UGrid_f);
+  GridRedBlackCartesian * FrbGrid_f = SpaceTimeGrid::makeFiveDimRedBlackGrid(Ls,UGrid_f);
+
+  std::vector<int> seeds4({1,2,3,4});
+  std::vector<int> seeds5({5,6,7,8});
+  GridParallelRNG          RNG5(FGrid);  RNG5.SeedFixedIntegers(seeds5);
+  GridParallelRNG          RNG4(UGrid);  RNG4.SeedFixedIntegers(seeds4);
+
+  LatticeGaugeFieldD Umu(UGrid);
+  LatticeGaugeFieldF Umu_f(UGrid_f);
+  SU3::HotConfiguration(RNG4,Umu);
+  precisionChange(Umu_f,Umu);
+
+  RealD mass=0.1;
+  RealD M5=1.8;
+  DomainWallFermionD Ddwf(Umu,*FGrid,*FrbGrid,*UGrid,*UrbGrid,mass,M5);
+  DomainWallFermionF Ddwf_f(Umu_f,*FGrid_f,*FrbGrid_f,*UGrid_f,*UrbGrid_f,mass,M5);
+
+  SchurDiagMooeeOperator<DomainWallFermionD,LatticeFermionD> HermOpEO(Ddwf);
+  SchurDiagMooeeOperator<DomainWallFermionF,LatticeFermionF> HermOpEO_f(Ddwf_f);
+
+  ////////////////////////////////////////////////////////////////
+  // Twelve sources, the last two linearly dependent on the others
+  // so the block must deflate them rather than break down.
+  ////////////////////////////////////////////////////////////////
+  LatticeFermionD src(FGrid);
+  std::vector<LatticeFermionD> src_o(nrhs,FrbGrid);
+  std::vector<LatticeFermionD> result_o(nrhs,FrbGrid);
+  for(int s=0;s<nrhs-2;s++){
+    random(RNG5,src);
+    pickCheckerboard(Odd,src_o[s],src);
+  }
+  src_o[nrhs-2] = src_o[0] + 2.0*src_o[1];
+  src_o[nrhs-1] = 0.5*src_o[2];
+  for(int s=0;s<nrhs;s++){
+    result_o[s].checkerboard = Odd;
+    result_o[s] = zero;
+  }
+
+  std::cout << GridLogMessage << "************************************************************************"<<std::endl;
+  std::cout << GridLogMessage << " Mixed precision block CG, "<< nrhs <<" right hand sides"<<std::endl;
+  std::cout << GridLogMessage << "************************************************************************"<<std::endl;
+  MixedPrecisionBlockConjugateGradient<LatticeFermionD,LatticeFermionF> BCG(1.0e-8,10000,1.0e-3,FrbGrid_f,HermOpEO_f,HermOpEO);
+  BCG(src_o,result_o);
+
+  std::cout << GridLogMessage << "************************************************************************"<<std::endl;
+  std::cout << GridLogMessage << " Double precision CG on each right hand side"<<std::endl;
+  std::cout << GridLogMessage << "************************************************************************"<<std::endl;
+  ConjugateGradient<LatticeFermionD> CG(1.0e-8,10000);
+  LatticeFermionD result_cg(FrbGrid);
+  LatticeFermionD diff(FrbGrid);
+  int cg_iters=0;
+  for(int s=0;s<nrhs;s++){
+    result_cg.checkerboard = Odd;
+    result_cg = zero;
+    CG(HermOpEO,src_o[s],result_cg);
+    cg_iters += CG.IterationsToComplete;
+    RealD vdiff = axpy_norm(diff,-1.0,result_cg,result_o[s]);
+    RealD vnorm = norm2(result_cg);
+    std::cout << GridLogMessage << "rhs "<< s <<" relative difference to CG "<< std::sqrt(vdiff/vnorm) <<std::endl;
+    assert(std::sqrt(vdiff/vnorm) < 1.0e-6);
+  }
+
+  std::cout << GridLogMessage << "Block CG single prec matvecs "<< BCG.MatVecsF <<" double prec matvecs "<< BCG.MatVecsD
+	    <<" ; CG double prec matvecs "<< cg_iters <<std::endl;
+
+  Grid_finalize();
+}